@@ -50,6 +50,9 @@ INCS := -I./src
 
 OBJS := \
 	obj/blitter.o      \
+	obj/capture.o      \
+	obj/cdcache.o      \
+	obj/cdimage.o      \
 	obj/cdintf.o       \
 	obj/cdrom.o        \
 	obj/crc32.o        \
@@ -75,6 +78,7 @@ OBJS := \
 	obj/memtrack.o     \
 	obj/mmu.o          \
 	obj/op.o           \
+	obj/resampler.o    \
 	obj/settings.o     \
 	obj/state.o        \
 	obj/tom.o          \
@@ -28,6 +28,7 @@
 #include "log.h"
 //#include "memory.h"
 #include "settings.h"
+#include "state.h"
 
 // Various conditional compilation goodies...
 
@@ -51,13 +52,13 @@ extern int jaguar_active_memory_dumps;
 // Local global variables
 
 int start_logging = 0;
-uint8_t blitter_working = 0;
+MACHINE_STATE uint8_t blitter_working = 0;
 bool startConciseBlitLogging = false;
 bool logBlit = false;
 
 // Blitter register RAM (most of it is hidden from the user)
 
-static uint8_t blitter_ram[0x100];
+static MACHINE_STATE uint8_t blitter_ram[0x100];
 
 // Other crapola
 
@@ -312,60 +313,60 @@ void BlitterMidsummer2(void);
 
 //static uint8_t * tom_ram_8;
 //static uint8_t * paletteRam;
-static uint8_t src;
-static uint8_t dst;
-static uint8_t misc;
-static uint8_t a1ctl;
-static uint8_t mode;
-static uint8_t ity;
-static uint8_t zop;
-static uint8_t op;
-static uint8_t ctrl;
-static uint32_t a1_addr;
-static uint32_t a2_addr;
-static int32_t a1_zoffs;
-static int32_t a2_zoffs;
-static uint32_t xadd_a1_control;
-static uint32_t xadd_a2_control;
-static int32_t a1_pitch;
-static int32_t a2_pitch;
-static uint32_t n_pixels;
-static uint32_t n_lines;
-static int32_t a1_x;
-static int32_t a1_y;
-static int32_t a1_width;
-static int32_t a2_x;
-static int32_t a2_y;
-static int32_t a2_width;
-static int32_t a2_mask_x;
-static int32_t a2_mask_y;
-static int32_t a1_xadd;
-static int32_t a1_yadd;
-static int32_t a2_xadd;
-static int32_t a2_yadd;
-static uint8_t a1_phrase_mode;
-static uint8_t a2_phrase_mode;
-static int32_t a1_step_x = 0;
-static int32_t a1_step_y = 0;
-static int32_t a2_step_x = 0;
-static int32_t a2_step_y = 0;
-static uint32_t outer_loop;
-static uint32_t inner_loop;
-static uint32_t a2_psize;
-static uint32_t a1_psize;
-static uint32_t gouraud_add;
+static MACHINE_STATE uint8_t src;
+static MACHINE_STATE uint8_t dst;
+static MACHINE_STATE uint8_t misc;
+static MACHINE_STATE uint8_t a1ctl;
+static MACHINE_STATE uint8_t mode;
+static MACHINE_STATE uint8_t ity;
+static MACHINE_STATE uint8_t zop;
+static MACHINE_STATE uint8_t op;
+static MACHINE_STATE uint8_t ctrl;
+static MACHINE_STATE uint32_t a1_addr;
+static MACHINE_STATE uint32_t a2_addr;
+static MACHINE_STATE int32_t a1_zoffs;
+static MACHINE_STATE int32_t a2_zoffs;
+static MACHINE_STATE uint32_t xadd_a1_control;
+static MACHINE_STATE uint32_t xadd_a2_control;
+static MACHINE_STATE int32_t a1_pitch;
+static MACHINE_STATE int32_t a2_pitch;
+static MACHINE_STATE uint32_t n_pixels;
+static MACHINE_STATE uint32_t n_lines;
+static MACHINE_STATE int32_t a1_x;
+static MACHINE_STATE int32_t a1_y;
+static MACHINE_STATE int32_t a1_width;
+static MACHINE_STATE int32_t a2_x;
+static MACHINE_STATE int32_t a2_y;
+static MACHINE_STATE int32_t a2_width;
+static MACHINE_STATE int32_t a2_mask_x;
+static MACHINE_STATE int32_t a2_mask_y;
+static MACHINE_STATE int32_t a1_xadd;
+static MACHINE_STATE int32_t a1_yadd;
+static MACHINE_STATE int32_t a2_xadd;
+static MACHINE_STATE int32_t a2_yadd;
+static MACHINE_STATE uint8_t a1_phrase_mode;
+static MACHINE_STATE uint8_t a2_phrase_mode;
+static MACHINE_STATE int32_t a1_step_x = 0;
+static MACHINE_STATE int32_t a1_step_y = 0;
+static MACHINE_STATE int32_t a2_step_x = 0;
+static MACHINE_STATE int32_t a2_step_y = 0;
+static MACHINE_STATE uint32_t outer_loop;
+static MACHINE_STATE uint32_t inner_loop;
+static MACHINE_STATE uint32_t a2_psize;
+static MACHINE_STATE uint32_t a1_psize;
+static MACHINE_STATE uint32_t gouraud_add;
 //static uint32_t gouraud_data;
 //static uint16_t gint[4];
 //static uint16_t gfrac[4];
 //static uint8_t  gcolour[4];
-static int gd_i[4];
-static int gd_c[4];
-static int gd_ia, gd_ca;
-static int colour_index = 0;
-static int32_t zadd;
-static uint32_t z_i[4];
+static MACHINE_STATE int gd_i[4];
+static MACHINE_STATE int gd_c[4];
+static MACHINE_STATE int gd_ia, gd_ca;
+static MACHINE_STATE int colour_index = 0;
+static MACHINE_STATE int32_t zadd;
+static MACHINE_STATE uint32_t z_i[4];
 
-static int32_t a1_clip_x, a1_clip_y;
+static MACHINE_STATE int32_t a1_clip_x, a1_clip_y;
 
 // In the spirit of "get it right first, *then* optimize" I've taken the liberty
 // of removing all the unnecessary code caching. If it turns out to be a good way
@@ -1565,6 +1566,17 @@ void BlitterDone(void)
 }
 
 
+//
+// See STATE.CPP. A blit runs to the end once it's started, so everything else
+// is set up again from the registers the next time.
+//
+void BlitterSnapshot(void)
+{
+	SNAPSHOT(blitter_working);
+	SNAPSHOT(blitter_ram);
+}
+
+
 uint8_t BlitterReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
 	offset &= 0xFF;
@@ -5037,7 +5049,7 @@ void ADDARRAY(uint16_t * addq, uint8_t daddasel, uint8_t daddbsel, uint8_t daddm
 
 	uint8_t cinsel = (daddmode >= 1 && daddmode <= 4 ? 1 : 0);
 
-static uint8_t co[4];//These are preserved between calls...
+static MACHINE_STATE uint8_t co[4];//These are preserved between calls...
 	uint8_t cin[4];
 
 	for(int i=0; i<4; i++)
@@ -5366,7 +5378,7 @@ Ci_y		:= EO (ci_y, cyt[1], suba_y);*/
 
 ////////////////////////////////////// C++ CODE //////////////////////////////////////
 //I'm sure the following will generate a bunch of warnings, but will have to do for now.
-	static uint16_t co_x = 0, co_y = 0;	// Carry out has to propogate between function calls...
+	static MACHINE_STATE uint16_t co_x = 0, co_y = 0;	// Carry out has to propogate between function calls...
 	uint16_t ci_x = co_x ^ (suba_x ? 1 : 0);
 	uint16_t ci_y = co_y ^ (suba_y ? 1 : 0);
 	uint32_t addqt_x = adda_x + addb_x + ci_x;
@@ -0,0 +1,534 @@
+//
+// CAPTURE.CPP: Audio/video capture
+//
+// Finished frames (from the emulation thread) and blocks of DSP output (from
+// the audio thread) get copied into single producer/single consumer queues,
+// and an encoder thread takes them from there to disk. Neither emulation
+// thread ever waits on the encoder: if a queue is full, what didn't fit is
+// dropped and counted.
+//
+// Output is either a YUV4MPEG2 (.y4m) file plus a .wav file alongside it, or
+// (if the filename ends in .vjc) a single zlib compressed file, laid out like
+// so (all values little endian):
+//
+//   Header: 'VJCP' (32 bits), version (32), frame rate numerator (32),
+//           denominator (32), audio rate (32), audio channels (32)
+//   Chunks: type (8), payload length (32), payload
+//           'V': width (16), height (16), zlib compressed 24-bit RGB
+//           'R': repeat of the previous frame (no payload)
+//           'A': zlib compressed 16-bit signed stereo samples
+//
+
+#include "capture.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "SDL.h"
+#include "log.h"
+#include "settings.h"
+
+#define CAPTURE_VIDEO_SLOTS		16
+#define CAPTURE_MAX_WIDTH		1024
+#define CAPTURE_MAX_HEIGHT		576
+// In 16-bit samples (L & R are separate); must be a power of two. This is
+// about 2.7s at 48 KHz.
+#define CAPTURE_AUDIO_SIZE		(1 << 18)
+#define CAPTURE_AUDIO_MASK		(CAPTURE_AUDIO_SIZE - 1)
+#define CAPTURE_AUDIO_RATE		48000
+#define VJC_VERSION				1
+
+enum { FORMAT_Y4M, FORMAT_VJC };
+
+struct VideoSlot
+{
+	uint32_t width, height;
+	bool repeat;
+	uint32_t * pixels;
+};
+
+// Local variables
+
+static VideoSlot videoSlot[CAPTURE_VIDEO_SLOTS];
+static std::atomic<uint32_t> videoHead, videoTail;
+static int lastSlot;						// Last slot with a real frame in it
+static int16_t * audioRing = NULL;
+static std::atomic<uint32_t> audioHead, audioTail;
+static std::atomic<bool> capturing(false);
+static std::atomic<bool> quitEncoder;
+static SDL_Thread * encoderThread = NULL;
+static CaptureStats stats;
+
+// Only the encoder thread touches these
+static int format;
+static FILE * videoFile = NULL;
+static FILE * audioFile = NULL;
+static uint32_t frameWidth, frameHeight;	// Size of the Y4M stream
+static uint8_t * frameData = NULL;			// Last frame, as written to disk
+static uint32_t frameDataSize;
+static uint8_t * packBuffer = NULL;
+static uint8_t * zBuffer = NULL;
+static uint32_t audioBytes;
+
+// Private function prototypes
+
+static int EncoderThread(void * data);
+static void EncodeFrame(VideoSlot & slot);
+static void EncodeAudio(uint32_t head, uint32_t tail);
+static void ConvertToYUV(VideoSlot & slot);
+static void WriteChunk(uint8_t type, const uint8_t * data, uint32_t length, const uint8_t * prefix = NULL, uint32_t prefixLength = 0);
+static void Write16(FILE * fp, uint16_t value);
+static void Write32(FILE * fp, uint32_t value);
+static void WriteWAVHeader(FILE * fp, uint32_t dataBytes);
+static void FreeBuffers(void);
+
+
+//
+// Start capturing to <filename>. If it ends in .vjc, we write our own
+// compressed format, otherwise we write <filename> as Y4M and put the audio
+// in a WAV file next to it.
+//
+bool CaptureStart(const char * filename)
+{
+	if (capturing)
+		CaptureStop();
+
+	char name[MAX_PATH];
+	strncpy(name, filename, MAX_PATH - 5);
+	name[MAX_PATH - 5] = 0;
+	char * ext = strrchr(name, '.');
+	format = ((ext != NULL) && (strcasecmp(ext, ".vjc") == 0) ? FORMAT_VJC : FORMAT_Y4M);
+
+	videoFile = fopen(name, "wb");
+
+	if (videoFile == NULL)
+	{
+		WriteLog("CAPTURE: Could not open \"%s\" for writing!\n", name);
+		return false;
+	}
+
+	if (format == FORMAT_Y4M)
+	{
+		if ((ext != NULL) && (strcasecmp(ext, ".y4m") == 0))
+			*ext = 0;
+
+		strcat(name, ".wav");
+		audioFile = fopen(name, "wb");
+
+		if (audioFile == NULL)
+		{
+			WriteLog("CAPTURE: Could not open \"%s\" for writing!\n", name);
+			fclose(videoFile);
+			videoFile = NULL;
+			return false;
+		}
+
+		// Sizes get filled in when we're done
+		WriteWAVHeader(audioFile, 0);
+	}
+	else
+	{
+		Write32(videoFile, 0x50434A56);			// 'VJCP'
+		Write32(videoFile, VJC_VERSION);
+		Write32(videoFile, vjs.hardwareTypeNTSC ? 60000 : 50);
+		Write32(videoFile, vjs.hardwareTypeNTSC ? 1001 : 1);
+		Write32(videoFile, CAPTURE_AUDIO_RATE);
+		Write32(videoFile, 2);
+	}
+
+	for(int i=0; i<CAPTURE_VIDEO_SLOTS; i++)
+		videoSlot[i].pixels = (uint32_t *)malloc(CAPTURE_MAX_WIDTH * CAPTURE_MAX_HEIGHT * sizeof(uint32_t));
+
+	audioRing = (int16_t *)malloc(CAPTURE_AUDIO_SIZE * sizeof(int16_t));
+	// Big enough for 4:2:0 YUV or packed RGB, with room for zlib to expand it
+	frameDataSize = CAPTURE_MAX_WIDTH * CAPTURE_MAX_HEIGHT * 3;
+	frameData = (uint8_t *)malloc(frameDataSize);
+	packBuffer = (uint8_t *)malloc(frameDataSize);
+	zBuffer = (uint8_t *)malloc(compressBound(frameDataSize));
+	frameWidth = frameHeight = 0;
+	audioBytes = 0;
+	lastSlot = -1;
+	videoHead = videoTail = 0;
+	audioHead = audioTail = 0;
+	memset(&stats, 0, sizeof(stats));
+	quitEncoder = false;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	encoderThread = SDL_CreateThread(EncoderThread, "A/V capture", NULL);
+#else
+	encoderThread = SDL_CreateThread(EncoderThread, NULL);
+#endif
+
+	if (encoderThread == NULL)
+	{
+		WriteLog("CAPTURE: Could not start encoder thread!\n");
+		FreeBuffers();
+		return false;
+	}
+
+	capturing = true;
+	WriteLog("CAPTURE: Started capturing to \"%s\".\n", filename);
+
+	return true;
+}
+
+
+void CaptureStop(void)
+{
+	if (!capturing)
+		return;
+
+	// Make sure the audio thread isn't in the middle of handing us something
+	SDL_LockAudio();
+	capturing = false;
+	SDL_UnlockAudio();
+
+	// The encoder drains the queues before it quits
+	quitEncoder = true;
+	SDL_WaitThread(encoderThread, NULL);
+	encoderThread = NULL;
+
+	if (audioFile)
+	{
+		fseek(audioFile, 0, SEEK_SET);
+		WriteWAVHeader(audioFile, audioBytes);
+	}
+
+	FreeBuffers();
+
+	WriteLog("CAPTURE: Done. %llu frames (%llu duplicates, %llu dropped), %llu audio samples (%llu dropped)\n",
+		(unsigned long long)stats.frames, (unsigned long long)stats.duplicates,
+		(unsigned long long)stats.droppedFrames, (unsigned long long)stats.audioFrames,
+		(unsigned long long)stats.droppedAudioFrames);
+}
+
+
+bool CaptureIsRunning(void)
+{
+	return capturing;
+}
+
+
+//
+// Called from the emulation thread when a frame is done. Frames that are the
+// same as the last one don't get copied; the encoder just repeats the last
+// one it wrote.
+//
+void CaptureVideoFrame(const uint32_t * buffer, uint32_t pitch, uint32_t width, uint32_t height)
+{
+	if (!capturing)
+		return;
+
+	stats.frames++;
+
+	if (width > CAPTURE_MAX_WIDTH)
+		width = CAPTURE_MAX_WIDTH;
+
+	if (height > CAPTURE_MAX_HEIGHT)
+		height = CAPTURE_MAX_HEIGHT;
+
+	uint32_t head = videoHead.load(std::memory_order_relaxed);
+
+	if ((head - videoTail.load(std::memory_order_acquire)) >= CAPTURE_VIDEO_SLOTS)
+	{
+		stats.droppedFrames++;
+		return;
+	}
+
+	VideoSlot & slot = videoSlot[head % CAPTURE_VIDEO_SLOTS];
+	bool repeat = false;
+
+	// The encoder never looks at a slot again once it's done with it, and we
+	// only ever write to the slot at the head, so the last real frame is
+	// still there for us to look at.
+	if ((lastSlot >= 0) && (videoSlot[lastSlot].width == width)
+		&& (videoSlot[lastSlot].height == height))
+	{
+		repeat = true;
+
+		for(uint32_t y=0; y<height; y++)
+		{
+			if (memcmp(buffer + (y * pitch), videoSlot[lastSlot].pixels + (y * width), width * sizeof(uint32_t)) != 0)
+			{
+				repeat = false;
+				break;
+			}
+		}
+	}
+
+	slot.width = width;
+	slot.height = height;
+	slot.repeat = repeat;
+
+	if (repeat)
+		stats.duplicates++;
+	else
+	{
+		for(uint32_t y=0; y<height; y++)
+			memcpy(slot.pixels + (y * width), buffer + (y * pitch), width * sizeof(uint32_t));
+
+		lastSlot = head % CAPTURE_VIDEO_SLOTS;
+	}
+
+	videoHead.store(head + 1, std::memory_order_release);
+}
+
+
+//
+// Called from the audio thread with each buffer it makes
+//
+void CaptureAudio(const int16_t * samples, uint32_t frames)
+{
+	if (!capturing)
+		return;
+
+	stats.audioFrames += frames;
+	uint32_t count = frames * 2;
+	uint32_t head = audioHead.load(std::memory_order_relaxed);
+
+	if ((CAPTURE_AUDIO_SIZE - (head - audioTail.load(std::memory_order_acquire))) < count)
+	{
+		stats.droppedAudioFrames += frames;
+		return;
+	}
+
+	for(uint32_t i=0; i<count; i++)
+		audioRing[(head + i) & CAPTURE_AUDIO_MASK] = samples[i];
+
+	audioHead.store(head + count, std::memory_order_release);
+}
+
+
+void CaptureGetStats(CaptureStats & s)
+{
+	s = stats;
+}
+
+
+static int EncoderThread(void * data)
+{
+	while (true)
+	{
+		bool didSomething = false;
+		uint32_t head = videoHead.load(std::memory_order_acquire);
+		uint32_t tail = videoTail.load(std::memory_order_relaxed);
+
+		for(; tail!=head; tail++)
+		{
+			EncodeFrame(videoSlot[tail % CAPTURE_VIDEO_SLOTS]);
+			videoTail.store(tail + 1, std::memory_order_release);
+			didSomething = true;
+		}
+
+		head = audioHead.load(std::memory_order_acquire);
+		tail = audioTail.load(std::memory_order_relaxed);
+
+		if (head != tail)
+		{
+			EncodeAudio(head, tail);
+			audioTail.store(head, std::memory_order_release);
+			didSomething = true;
+		}
+
+		// Only quit once there's nothing left to write
+		if (!didSomething)
+		{
+			if (quitEncoder)
+				break;
+
+			SDL_Delay(5);
+		}
+	}
+
+	return 0;
+}
+
+
+static void EncodeFrame(VideoSlot & slot)
+{
+	if (format == FORMAT_Y4M)
+	{
+		// Y4M has no way of saying "same as before", so we just write the
+		// last one out again (at least we don't have to convert it again)
+		if (frameWidth == 0)
+		{
+			frameWidth = slot.width, frameHeight = slot.height;
+			fprintf(videoFile, "YUV4MPEG2 W%u H%u F%s Ip A1:1 C420jpeg\n",
+				frameWidth, frameHeight, (vjs.hardwareTypeNTSC ? "60000:1001" : "50:1"));
+		}
+
+		if (!slot.repeat)
+			ConvertToYUV(slot);
+
+		uint32_t chromaSize = ((frameWidth + 1) / 2) * ((frameHeight + 1) / 2);
+		fputs("FRAME\n", videoFile);
+		fwrite(frameData, 1, (frameWidth * frameHeight) + (chromaSize * 2), videoFile);
+		return;
+	}
+
+	if (slot.repeat)
+	{
+		WriteChunk('R', NULL, 0);
+		return;
+	}
+
+	uint8_t * p = packBuffer;
+
+	for(uint32_t i=0; i<slot.width*slot.height; i++)
+	{
+		uint32_t pixel = slot.pixels[i];
+		*p++ = (pixel >> 24) & 0xFF;
+		*p++ = (pixel >> 16) & 0xFF;
+		*p++ = (pixel >> 8) & 0xFF;
+	}
+
+	uLongf zLength = compressBound(frameDataSize);
+	compress2(zBuffer, &zLength, packBuffer, p - packBuffer, Z_BEST_SPEED);
+	uint8_t size[4] = { (uint8_t)slot.width, (uint8_t)(slot.width >> 8),
+		(uint8_t)slot.height, (uint8_t)(slot.height >> 8) };
+	WriteChunk('V', zBuffer, zLength, size, 4);
+}
+
+
+//
+// Write out everything in the audio ring from <tail> up to <head>
+//
+static void EncodeAudio(uint32_t head, uint32_t tail)
+{
+	uint32_t count = head - tail;
+	uint8_t * p = packBuffer;
+
+	// Samples go out little endian, whatever the host is
+	for(uint32_t i=0; i<count; i++)
+	{
+		int16_t sample = audioRing[(tail + i) & CAPTURE_AUDIO_MASK];
+		*p++ = sample & 0xFF;
+		*p++ = (sample >> 8) & 0xFF;
+	}
+
+	if (format == FORMAT_Y4M)
+	{
+		fwrite(packBuffer, 1, count * 2, audioFile);
+		audioBytes += count * 2;
+		return;
+	}
+
+	uLongf zLength = compressBound(frameDataSize);
+	compress2(zBuffer, &zLength, packBuffer, count * 2, Z_BEST_SPEED);
+	WriteChunk('A', zBuffer, zLength);
+}
+
+
+//
+// RGB -> 4:2:0 YCbCr (BT.601, studio swing). If the frame size changed since
+// we wrote the Y4M header, the frame gets cropped or padded with black to fit.
+//
+static void ConvertToYUV(VideoSlot & slot)
+{
+	uint32_t chromaWidth = (frameWidth + 1) / 2, chromaHeight = (frameHeight + 1) / 2;
+	uint8_t * yPlane = frameData;
+	uint8_t * uPlane = yPlane + (frameWidth * frameHeight);
+	uint8_t * vPlane = uPlane + (chromaWidth * chromaHeight);
+
+	for(uint32_t y=0; y<frameHeight; y++)
+	{
+		for(uint32_t x=0; x<frameWidth; x++)
+		{
+			uint32_t pixel = ((x < slot.width) && (y < slot.height) ? slot.pixels[(y * slot.width) + x] : 0);
+			int r = (pixel >> 24) & 0xFF, g = (pixel >> 16) & 0xFF, b = (pixel >> 8) & 0xFF;
+			yPlane[(y * frameWidth) + x] = (uint8_t)(16 + (((66 * r) + (129 * g) + (25 * b) + 128) >> 8));
+		}
+	}
+
+	for(uint32_t cy=0; cy<chromaHeight; cy++)
+	{
+		for(uint32_t cx=0; cx<chromaWidth; cx++)
+		{
+			int r = 0, g = 0, b = 0, n = 0;
+
+			for(uint32_t y=cy*2; y<(cy*2)+2 && y<frameHeight; y++)
+			{
+				for(uint32_t x=cx*2; x<(cx*2)+2 && x<frameWidth; x++, n++)
+				{
+					uint32_t pixel = ((x < slot.width) && (y < slot.height) ? slot.pixels[(y * slot.width) + x] : 0);
+					r += (pixel >> 24) & 0xFF, g += (pixel >> 16) & 0xFF, b += (pixel >> 8) & 0xFF;
+				}
+			}
+
+			r /= n, g /= n, b /= n;
+			uPlane[(cy * chromaWidth) + cx] = (uint8_t)(128 + (((-38 * r) - (74 * g) + (112 * b) + 128) >> 8));
+			vPlane[(cy * chromaWidth) + cx] = (uint8_t)(128 + (((112 * r) - (94 * g) - (18 * b) + 128) >> 8));
+		}
+	}
+}
+
+
+static void WriteChunk(uint8_t type, const uint8_t * data, uint32_t length, const uint8_t * prefix/*= NULL*/, uint32_t prefixLength/*= 0*/)
+{
+	fputc(type, videoFile);
+	Write32(videoFile, length + prefixLength);
+
+	if (prefixLength)
+		fwrite(prefix, 1, prefixLength, videoFile);
+
+	if (length)
+		fwrite(data, 1, length, videoFile);
+}
+
+
+static void Write16(FILE * fp, uint16_t value)
+{
+	fputc(value & 0xFF, fp);
+	fputc((value >> 8) & 0xFF, fp);
+}
+
+
+static void Write32(FILE * fp, uint32_t value)
+{
+	Write16(fp, value & 0xFFFF);
+	Write16(fp, value >> 16);
+}
+
+
+static void WriteWAVHeader(FILE * fp, uint32_t dataBytes)
+{
+	fwrite("RIFF", 1, 4, fp);
+	Write32(fp, 36 + dataBytes);
+	fwrite("WAVEfmt ", 1, 8, fp);
+	Write32(fp, 16);							// Size of fmt chunk
+	Write16(fp, 1);								// PCM
+	Write16(fp, 2);								// Channels
+	Write32(fp, CAPTURE_AUDIO_RATE);
+	Write32(fp, CAPTURE_AUDIO_RATE * 4);		// Bytes/sec
+	Write16(fp, 4);								// Bytes/sample (all channels)
+	Write16(fp, 16);							// Bits/sample
+	fwrite("data", 1, 4, fp);
+	Write32(fp, dataBytes);
+}
+
+
+static void FreeBuffers(void)
+{
+	if (videoFile)
+		fclose(videoFile);
+
+	if (audioFile)
+		fclose(audioFile);
+
+	videoFile = audioFile = NULL;
+
+	for(int i=0; i<CAPTURE_VIDEO_SLOTS; i++)
+	{
+		free(videoSlot[i].pixels);
+		videoSlot[i].pixels = NULL;
+	}
+
+	free(audioRing);
+	free(frameData);
+	free(packBuffer);
+	free(zBuffer);
+	audioRing = NULL;
+	frameData = packBuffer = zBuffer = NULL;
+}
@@ -0,0 +1,26 @@
+//
+// CAPTURE.H: Audio/video capture
+//
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stdint.h>
+
+struct CaptureStats
+{
+	uint64_t frames;				// Frames handed to us
+	uint64_t duplicates;			// ...that were the same as the one before
+	uint64_t droppedFrames;			// ...that didn't fit in the queue
+	uint64_t audioFrames;			// Stereo samples handed to us
+	uint64_t droppedAudioFrames;	// ...that didn't fit in the queue
+};
+
+bool CaptureStart(const char * filename);
+void CaptureStop(void);
+bool CaptureIsRunning(void);
+void CaptureVideoFrame(const uint32_t * buffer, uint32_t pitch, uint32_t width, uint32_t height);
+void CaptureAudio(const int16_t * samples, uint32_t frames);
+void CaptureGetStats(CaptureStats & stats);
+
+#endif	// __CAPTURE_H__
@@ -0,0 +1,288 @@
+//
+// CDCACHE.CPP: Read-ahead sector cache for the CD-ROM emulation
+//
+// Reading a sector from a real drive (or even a disc image on a slow disk) can
+// take long enough to stall the emulation, which shows up as stuttering in CD
+// FMV. So after every seek, a background thread reads ahead sequentially into
+// a small ring of sectors, and BUTCH pulls its data out of that instead of
+// going to the drive directly.
+//
+
+#include "cdcache.h"
+
+#include <string.h>
+#include "SDL.h"
+#include "cdintf.h"
+#include "log.h"
+
+// Number of sectors we'll read ahead of the one BUTCH is working on. Must be
+// a power of two.
+#define CDCACHE_SECTORS		128
+#define CDCACHE_MASK		(CDCACHE_SECTORS - 1)
+#define CD_SECTOR_SIZE		2352
+
+struct CacheSlot
+{
+	uint32_t sector;
+	bool good;
+	uint8_t data[CD_SECTOR_SIZE];
+};
+
+// Local variables
+
+static CacheSlot slot[CDCACHE_SECTORS];
+static SDL_mutex * cacheMutex = NULL;
+static SDL_mutex * driveMutex = NULL;
+static SDL_cond * workCond = NULL;			// Prefetch thread waits on this
+static SDL_cond * dataCond = NULL;			// BUTCH waits on this
+static SDL_Thread * prefetchThread = NULL;
+static bool quitThread = false;
+static bool prefetchActive = false;
+// Sectors [windowStart, nextSector) are in the cache; the thread keeps going
+// until it's CDCACHE_SECTORS ahead of windowStart.
+static uint32_t windowStart = 0;
+static uint32_t nextSector = 0;
+// Bumped on every seek, so reads that were in flight across one get tossed
+static uint32_t generation = 0;
+static CDCacheStats stats;
+
+// Private function prototypes
+
+static int PrefetchThread(void * data);
+static void StartReadAhead(uint32_t sector);
+static uint64_t GetMicroseconds(void);
+
+
+void CDCacheInit(void)
+{
+	memset(&stats, 0, sizeof(stats));
+	cacheMutex = SDL_CreateMutex();
+	driveMutex = SDL_CreateMutex();
+	workCond = SDL_CreateCond();
+	dataCond = SDL_CreateCond();
+	quitThread = false;
+	prefetchActive = false;
+
+	if (cacheMutex && driveMutex && workCond && dataCond)
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		prefetchThread = SDL_CreateThread(PrefetchThread, "CD prefetch", NULL);
+#else
+		prefetchThread = SDL_CreateThread(PrefetchThread, NULL);
+#endif
+
+	if (prefetchThread == NULL)
+		WriteLog("CDCACHE: Could not start prefetch thread, reading synchronously.\n");
+}
+
+
+//
+// Stop reading ahead and forget what's in the cache
+//
+void CDCacheReset(void)
+{
+	if (prefetchThread == NULL)
+		return;
+
+	SDL_mutexP(cacheMutex);
+	prefetchActive = false;
+	generation++;
+	SDL_mutexV(cacheMutex);
+}
+
+
+void CDCacheDone(void)
+{
+	if (prefetchThread)
+	{
+		SDL_mutexP(cacheMutex);
+		quitThread = true;
+		SDL_CondSignal(workCond);
+		SDL_mutexV(cacheMutex);
+		SDL_WaitThread(prefetchThread, NULL);
+		prefetchThread = NULL;
+	}
+
+	WriteLog("CDCACHE: %llu hits, %llu misses, %llu seeks, %llu sectors read, %llu us stalled\n",
+		(unsigned long long)stats.hits, (unsigned long long)stats.misses,
+		(unsigned long long)stats.seeks, (unsigned long long)stats.sectorsRead,
+		(unsigned long long)stats.stallMicroseconds);
+
+	if (dataCond)
+		SDL_DestroyCond(dataCond);
+
+	if (workCond)
+		SDL_DestroyCond(workCond);
+
+	if (driveMutex)
+		SDL_DestroyMutex(driveMutex);
+
+	if (cacheMutex)
+		SDL_DestroyMutex(cacheMutex);
+
+	dataCond = workCond = NULL;
+	driveMutex = cacheMutex = NULL;
+}
+
+
+//
+// Called when BUTCH is told to go somewhere on the disc. If we're already
+// reading ahead from there, we leave things be.
+//
+void CDCacheSeek(uint32_t sector)
+{
+	if (prefetchThread == NULL)
+		return;
+
+	SDL_mutexP(cacheMutex);
+
+	if (!prefetchActive || (sector - windowStart) >= CDCACHE_SECTORS)
+		StartReadAhead(sector);
+
+	SDL_mutexV(cacheMutex);
+}
+
+
+//
+// Get a sector out of the cache, waiting for the prefetch thread if it
+// hasn't gotten there yet.
+//
+bool CDCacheReadSector(uint32_t sector, uint8_t * buffer)
+{
+	if (prefetchThread == NULL)
+	{
+		stats.misses++;
+		stats.sectorsRead++;
+		return CDIntfReadBlock(sector, buffer);
+	}
+
+	SDL_mutexP(cacheMutex);
+
+	// If BUTCH wandered off without a seek, treat it like one
+	if (!prefetchActive || (sector - windowStart) >= CDCACHE_SECTORS)
+		StartReadAhead(sector);
+
+	// Anything before this sector is fair game for the thread to overwrite now
+	if (sector != windowStart)
+	{
+		windowStart = sector;
+		SDL_CondSignal(workCond);
+	}
+
+	if ((sector - windowStart) < (nextSector - windowStart))
+		stats.hits++;
+	else
+	{
+		stats.misses++;
+		uint64_t stallStart = GetMicroseconds();
+
+		while ((sector - windowStart) >= (nextSector - windowStart))
+			SDL_CondWait(dataCond, cacheMutex);
+
+		stats.stallMicroseconds += GetMicroseconds() - stallStart;
+	}
+
+	CacheSlot & s = slot[sector & CDCACHE_MASK];
+	memcpy(buffer, s.data, CD_SECTOR_SIZE);
+	bool good = s.good;
+	SDL_mutexV(cacheMutex);
+
+	return good;
+}
+
+
+//
+// Anything else that talks to the drive (TOC reads, etc.) needs to hold this
+// so it doesn't trip over the prefetch thread.
+//
+void CDCacheLockDrive(void)
+{
+	if (driveMutex)
+		SDL_mutexP(driveMutex);
+}
+
+
+void CDCacheUnlockDrive(void)
+{
+	if (driveMutex)
+		SDL_mutexV(driveMutex);
+}
+
+
+void CDCacheGetStats(CDCacheStats & s)
+{
+	if (cacheMutex)
+		SDL_mutexP(cacheMutex);
+
+	s = stats;
+
+	if (cacheMutex)
+		SDL_mutexV(cacheMutex);
+}
+
+
+//
+// Must be called with cacheMutex held
+//
+static void StartReadAhead(uint32_t sector)
+{
+	generation++;
+	windowStart = nextSector = sector;
+	prefetchActive = true;
+	stats.seeks++;
+	SDL_CondSignal(workCond);
+}
+
+
+static int PrefetchThread(void * data)
+{
+	uint8_t buffer[CD_SECTOR_SIZE];
+
+	SDL_mutexP(cacheMutex);
+
+	while (!quitThread)
+	{
+		if (!prefetchActive || (nextSector - windowStart) >= CDCACHE_SECTORS)
+		{
+			SDL_CondWait(workCond, cacheMutex);
+			continue;
+		}
+
+		uint32_t sector = nextSector;
+		uint32_t readGeneration = generation;
+		SDL_mutexV(cacheMutex);
+
+		// Do the slow part without holding up BUTCH
+		SDL_mutexP(driveMutex);
+		bool good = CDIntfReadBlock(sector, buffer);
+		SDL_mutexV(driveMutex);
+
+		SDL_mutexP(cacheMutex);
+		stats.sectorsRead++;
+
+		if (readGeneration == generation)
+		{
+			CacheSlot & s = slot[sector & CDCACHE_MASK];
+			s.sector = sector;
+			s.good = good;
+			memcpy(s.data, buffer, CD_SECTOR_SIZE);
+			nextSector++;
+			SDL_CondBroadcast(dataCond);
+		}
+	}
+
+	SDL_mutexV(cacheMutex);
+
+	return 0;
+}
+
+
+static uint64_t GetMicroseconds(void)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return (uint64_t)(((double)SDL_GetPerformanceCounter() * 1000000.0)
+		/ (double)SDL_GetPerformanceFrequency());
+#else
+	return (uint64_t)SDL_GetTicks() * 1000;
+#endif
+}
+
@@ -0,0 +1,28 @@
+//
+// CDCACHE.H: Read-ahead sector cache for the CD-ROM emulation
+//
+
+#ifndef __CDCACHE_H__
+#define __CDCACHE_H__
+
+#include <stdint.h>
+
+struct CDCacheStats
+{
+	uint64_t hits;					// Sector was already there when asked for
+	uint64_t misses;				// Had to wait for it
+	uint64_t seeks;					// Read-ahead restarted somewhere else
+	uint64_t sectorsRead;			// Sectors pulled from the drive/image
+	uint64_t stallMicroseconds;		// Time spent waiting on misses
+};
+
+void CDCacheInit(void);
+void CDCacheReset(void);
+void CDCacheDone(void);
+void CDCacheSeek(uint32_t sector);
+bool CDCacheReadSector(uint32_t sector, uint8_t * buffer);
+void CDCacheLockDrive(void);
+void CDCacheUnlockDrive(void);
+void CDCacheGetStats(CDCacheStats & stats);
+
+#endif	// __CDCACHE_H__
@@ -0,0 +1,617 @@
+//
+// CD disc image support
+//
+// This lets the CD subsystem run from CUE/BIN or ISO images instead of a
+// physical drive. Track data is memory mapped where the host allows it, so
+// reading a sector is just a copy out of the page cache.
+//
+// Layout of the disc follows the Red Book: track 1's INDEX 01 is at LSN 0 (MSF
+// 00:02:00), sessions after the first are separated from the previous one by
+// its lead-out (6750 sectors for the first, 2250 for the rest) and a lead-in
+// of 4500 sectors. PREGAP commands in the cue sheet describe gaps that aren't
+// in the file; INDEX 00 describes gaps that are.
+//
+
+#include "cdimage.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log.h"
+
+#ifdef __GCCUNIX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct CDImageFile
+{
+	char name[512];
+	bool byteSwap;				// MOTOROLA (big endian) audio
+	uint64_t size;
+	const uint8_t * map;
+	FILE * fp;					// Used when we can't map the file
+};
+
+// What the cue sheet says, before we work out where things are on the disc
+struct CueTrack
+{
+	int32_t index0;				// Frame in file of INDEX 00 (-1 if none)
+	int32_t index1;				// Frame in file of INDEX 01
+	int32_t pregap;				// Frames of PREGAP not present in the file
+};
+
+static CDImageFile files[CDIMAGE_MAX_TRACKS];
+static uint32_t numFiles = 0;
+static CDImageTrack tracks[CDIMAGE_MAX_TRACKS];
+static CueTrack cueTracks[CDIMAGE_MAX_TRACKS];
+static uint32_t numTracks = 0;
+static CDImageSession sessions[CDIMAGE_MAX_SESSIONS];
+static uint32_t numSessions = 0;
+static uint32_t lastTrackRead = 0;
+
+// Private function prototypes
+static bool OpenImageFile(CDImageFile & file);
+static void CloseImageFile(CDImageFile & file);
+static bool ParseCueSheet(const char * path);
+static bool LayOutDisc(void);
+static int32_t ParseMSF(const char * str);
+static void MakeRawHeader(int32_t lsn, uint8_t * buffer);
+
+
+bool CDImageOpen(const char * path)
+{
+	CDImageClose();
+
+	const char * ext = strrchr(path, '.');
+
+	if (ext == NULL)
+		return false;
+
+	if (strcasecmp(ext, ".cue") == 0)
+	{
+		if (!ParseCueSheet(path))
+		{
+			CDImageClose();
+			return false;
+		}
+	}
+	else if (strcasecmp(ext, ".iso") == 0)
+	{
+		// An ISO is just a single MODE1/2048 data track
+		strncpy(files[0].name, path, 511);
+		files[0].name[511] = 0;
+		files[0].byteSwap = false;
+		numFiles = 1;
+		tracks[0].number = 1;
+		tracks[0].session = 0;
+		tracks[0].audio = false;
+		tracks[0].sectorSize = 2048;
+		tracks[0].fileNum = 0;
+		cueTracks[0].index0 = -1;
+		cueTracks[0].index1 = 0;
+		cueTracks[0].pregap = 0;
+		numTracks = 1;
+	}
+	else
+	{
+		WriteLog("CDIMAGE: Don't know how to open \"%s\".\n", path);
+		return false;
+	}
+
+	for(uint32_t i=0; i<numFiles; i++)
+	{
+		if (!OpenImageFile(files[i]))
+		{
+			WriteLog("CDIMAGE: Could not open \"%s\".\n", files[i].name);
+			CDImageClose();
+			return false;
+		}
+	}
+
+	if (!LayOutDisc())
+	{
+		CDImageClose();
+		return false;
+	}
+
+	WriteLog("CDIMAGE: Opened \"%s\" (%u session%s, %u track%s).\n", path,
+		numSessions, (numSessions == 1 ? "" : "s"), numTracks, (numTracks == 1 ? "" : "s"));
+
+	for(uint32_t i=0; i<numTracks; i++)
+		WriteLog("CDIMAGE:   Track %2u: session %u, %s, LSN %6i, %u sectors\n",
+			tracks[i].number, tracks[i].session + 1, (tracks[i].audio ? "audio" : "data "),
+			tracks[i].startLSN, tracks[i].length);
+
+	return true;
+}
+
+
+void CDImageClose(void)
+{
+	for(uint32_t i=0; i<numFiles; i++)
+		CloseImageFile(files[i]);
+
+	numFiles = numTracks = numSessions = 0;
+	lastTrackRead = 0;
+}
+
+
+bool CDImageIsOpen(void)
+{
+	return (numTracks > 0);
+}
+
+
+//
+// Read one raw (2352 byte) sector. Sectors that fall in gaps between tracks
+// or sessions read back as silence.
+//
+bool CDImageReadSector(int32_t lsn, uint8_t * buffer)
+{
+	if (numTracks == 0)
+		return false;
+
+	// Reads are nearly always sequential, so start with the track we hit last
+	uint32_t t = lastTrackRead;
+
+	if ((lsn < tracks[t].dataLSN) || (lsn >= tracks[t].dataLSN + (int32_t)tracks[t].length))
+	{
+		for(t=0; t<numTracks; t++)
+		{
+			if ((lsn >= tracks[t].dataLSN) && (lsn < tracks[t].dataLSN + (int32_t)tracks[t].length))
+				break;
+		}
+
+		if (t == numTracks)
+		{
+			memset(buffer, 0, 2352);
+			return true;
+		}
+
+		lastTrackRead = t;
+	}
+
+	const CDImageTrack & trk = tracks[t];
+	CDImageFile & file = files[trk.fileNum];
+	uint64_t offset = trk.fileOffset + ((uint64_t)(lsn - trk.dataLSN) * trk.sectorSize);
+	uint8_t * dest = buffer;
+
+	// Cooked sectors get a sync pattern & header stuck on the front, and the
+	// EDC/ECC area zeroed, so they look the same as raw ones to the caller
+	if (trk.sectorSize == 2048)
+	{
+		MakeRawHeader(lsn, buffer);
+		memset(buffer + 16 + 2048, 0, 2352 - 16 - 2048);
+		dest = buffer + 16;
+	}
+
+	if (file.map != NULL)
+		memcpy(dest, file.map + offset, trk.sectorSize);
+	else
+	{
+		if ((fseek(file.fp, offset, SEEK_SET) != 0)
+			|| (fread(dest, 1, trk.sectorSize, file.fp) != trk.sectorSize))
+			return false;
+	}
+
+	if (file.byteSwap)
+	{
+		for(uint32_t i=0; i<trk.sectorSize; i+=2)
+		{
+			uint8_t b = dest[i];
+			dest[i] = dest[i + 1];
+			dest[i + 1] = b;
+		}
+	}
+
+	return true;
+}
+
+
+uint32_t CDImageGetNumTracks(void)
+{
+	return numTracks;
+}
+
+
+uint32_t CDImageGetNumSessions(void)
+{
+	return numSessions;
+}
+
+
+//
+// Tracks are looked up by their number on the disc (starting at 1)
+//
+const CDImageTrack * CDImageGetTrack(uint32_t trackNum)
+{
+	for(uint32_t i=0; i<numTracks; i++)
+	{
+		if (tracks[i].number == trackNum)
+			return &tracks[i];
+	}
+
+	return NULL;
+}
+
+
+//
+// Sessions are numbered from zero, same as BUTCH does it
+//
+const CDImageSession * CDImageGetSession(uint32_t session)
+{
+	if (session >= numSessions)
+		return NULL;
+
+	return &sessions[session];
+}
+
+
+static bool OpenImageFile(CDImageFile & file)
+{
+	file.map = NULL;
+	file.fp = NULL;
+
+#ifdef __GCCUNIX__
+	int fd = open(file.name, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+	{
+		close(fd);
+		return false;
+	}
+
+	file.size = st.st_size;
+	void * map = mmap(NULL, file.size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map != MAP_FAILED)
+	{
+		// Ask the kernel to start pulling the image in now, so the emulation
+		// thread doesn't end up waiting on the disk when it gets around to
+		// reading it
+		madvise(map, file.size, MADV_WILLNEED);
+		file.map = (const uint8_t *)map;
+		return true;
+	}
+#endif
+
+	file.fp = fopen(file.name, "rb");
+
+	if (file.fp == NULL)
+		return false;
+
+	fseek(file.fp, 0, SEEK_END);
+	file.size = ftell(file.fp);
+
+	return true;
+}
+
+
+static void CloseImageFile(CDImageFile & file)
+{
+#ifdef __GCCUNIX__
+	if (file.map != NULL)
+		munmap((void *)file.map, file.size);
+#endif
+
+	if (file.fp != NULL)
+		fclose(file.fp);
+
+	file.map = NULL;
+	file.fp = NULL;
+}
+
+
+//
+// Pull the tracks & files out of the cue sheet. Where they actually go on the
+// disc gets worked out later, in LayOutDisc().
+//
+static bool ParseCueSheet(const char * path)
+{
+	FILE * fp = fopen(path, "r");
+
+	if (fp == NULL)
+		return false;
+
+	// Files in the cue sheet are relative to the cue sheet itself
+	char dir[512];
+	strncpy(dir, path, 511);
+	dir[511] = 0;
+	char * slash = strrchr(dir, '/');
+	char * backslash = strrchr(dir, '\\');
+
+	if (backslash > slash)
+		slash = backslash;
+
+	if (slash != NULL)
+		slash[1] = 0;
+	else
+		dir[0] = 0;
+
+	char line[1024];
+	int lineNum = 0;
+	uint32_t session = 0;
+	bool ok = true;
+
+	while (ok && (fgets(line, sizeof(line), fp) != NULL))
+	{
+		lineNum++;
+		char * p = line;
+
+		while (isspace(*p))
+			p++;
+
+		char command[32];
+		int n = 0;
+
+		if (sscanf(p, "%31s %n", command, &n) < 1)
+			continue;
+
+		p += n;
+		p[strcspn(p, "\r\n")] = 0;
+
+		if (strcasecmp(command, "FILE") == 0)
+		{
+			if (numFiles == CDIMAGE_MAX_TRACKS)
+			{
+				ok = false;
+				break;
+			}
+
+			char name[512];
+
+			if (*p == '"')
+			{
+				char * end = strchr(p + 1, '"');
+
+				if (end == NULL)
+				{
+					ok = false;
+					break;
+				}
+
+				*end = 0;
+				strncpy(name, p + 1, 511);
+				p = end + 1;
+			}
+			else
+			{
+				sscanf(p, "%511s %n", name, &n);
+				p += n;
+			}
+
+			name[511] = 0;
+
+			while (isspace(*p))
+				p++;
+
+			CDImageFile & file = files[numFiles++];
+			file.map = NULL;
+			file.fp = NULL;
+			file.byteSwap = (strncasecmp(p, "MOTOROLA", 8) == 0);
+
+			if ((strncasecmp(p, "BINARY", 6) != 0) && !file.byteSwap)
+			{
+				WriteLog("CDIMAGE: Line %i: Unsupported file type \"%s\".\n", lineNum, p);
+				ok = false;
+			}
+
+			if ((name[0] == '/') || (name[0] == '\\') || (strchr(name, ':') != NULL))
+				strcpy(file.name, name);
+			else
+				snprintf(file.name, 512, "%s%s", dir, name);
+		}
+		else if (strcasecmp(command, "TRACK") == 0)
+		{
+			int number;
+			char mode[32];
+
+			if ((numFiles == 0) || (numTracks == CDIMAGE_MAX_TRACKS)
+				|| (sscanf(p, "%d %31s", &number, mode) != 2))
+			{
+				ok = false;
+				break;
+			}
+
+			CDImageTrack & trk = tracks[numTracks];
+			trk.number = number;
+			trk.session = session;
+			trk.fileNum = numFiles - 1;
+			trk.audio = (strcasecmp(mode, "AUDIO") == 0);
+
+			if (trk.audio || (strcasecmp(mode, "MODE1/2352") == 0)
+				|| (strcasecmp(mode, "MODE2/2352") == 0))
+				trk.sectorSize = 2352;
+			else if (strcasecmp(mode, "MODE1/2048") == 0)
+				trk.sectorSize = 2048;
+			else
+			{
+				WriteLog("CDIMAGE: Line %i: Unsupported track mode \"%s\".\n", lineNum, mode);
+				ok = false;
+				break;
+			}
+
+			cueTracks[numTracks].index0 = -1;
+			cueTracks[numTracks].index1 = -1;
+			cueTracks[numTracks].pregap = 0;
+			numTracks++;
+		}
+		else if (strcasecmp(command, "INDEX") == 0)
+		{
+			int index;
+			char msf[32];
+
+			if ((numTracks == 0) || (sscanf(p, "%d %31s", &index, msf) != 2))
+			{
+				ok = false;
+				break;
+			}
+
+			if (index == 0)
+				cueTracks[numTracks - 1].index0 = ParseMSF(msf);
+			else if (index == 1)
+				cueTracks[numTracks - 1].index1 = ParseMSF(msf);
+		}
+		else if (strcasecmp(command, "PREGAP") == 0)
+		{
+			if (numTracks == 0)
+			{
+				ok = false;
+				break;
+			}
+
+			cueTracks[numTracks - 1].pregap = ParseMSF(p);
+		}
+		else if (strcasecmp(command, "REM") == 0)
+		{
+			int num;
+
+			if ((sscanf(p, "SESSION %d", &num) == 1) && (num >= 1)
+				&& (num <= CDIMAGE_MAX_SESSIONS))
+				session = num - 1;
+		}
+	}
+
+	fclose(fp);
+
+	if (!ok)
+	{
+		WriteLog("CDIMAGE: Error parsing cue sheet \"%s\" (line %i).\n", path, lineNum);
+		return false;
+	}
+
+	for(uint32_t i=0; i<numTracks; i++)
+	{
+		if ((cueTracks[i].index1 < 0) || (cueTracks[i].pregap < 0))
+		{
+			WriteLog("CDIMAGE: Track %u has a missing/bad index.\n", tracks[i].number);
+			return false;
+		}
+	}
+
+	return (numTracks > 0);
+}
+
+
+//
+// Work out where each track lives in its file, and where it sits on the disc
+//
+static bool LayOutDisc(void)
+{
+	// First, where each track's data is in its file, and how long it is
+	for(uint32_t i=0; i<numTracks; i++)
+	{
+		CDImageTrack & trk = tracks[i];
+		int32_t start = (cueTracks[i].index0 >= 0 ? cueTracks[i].index0 : cueTracks[i].index1);
+
+		if ((i == 0) || (tracks[i - 1].fileNum != trk.fileNum))
+			trk.fileOffset = start * trk.sectorSize;
+		else
+		{
+			int32_t prevStart = (cueTracks[i - 1].index0 >= 0 ? cueTracks[i - 1].index0 : cueTracks[i - 1].index1);
+			trk.fileOffset = tracks[i - 1].fileOffset + ((start - prevStart) * tracks[i - 1].sectorSize);
+		}
+
+		if ((i > 0) && (tracks[i - 1].fileNum == trk.fileNum))
+			tracks[i - 1].length = (trk.fileOffset - tracks[i - 1].fileOffset) / tracks[i - 1].sectorSize;
+
+		if (trk.fileOffset > files[trk.fileNum].size)
+		{
+			WriteLog("CDIMAGE: Track %u starts past the end of its file.\n", trk.number);
+			return false;
+		}
+
+		trk.length = (files[trk.fileNum].size - trk.fileOffset) / trk.sectorSize;
+	}
+
+	// Then lay them out on the disc
+	int32_t lsn = 0;
+	numSessions = 0;
+
+	for(uint32_t i=0; i<numTracks; i++)
+	{
+		CDImageTrack & trk = tracks[i];
+		int32_t start = (cueTracks[i].index0 >= 0 ? cueTracks[i].index0 : cueTracks[i].index1);
+		int32_t gapInFile = cueTracks[i].index1 - start;
+
+		if (i == 0)
+		{
+			trk.startLSN = 0;
+			trk.dataLSN = -gapInFile;
+		}
+		else
+		{
+			if (trk.session != tracks[i - 1].session)
+			{
+				// Lead-out of the last session & lead-in of this one
+				sessions[numSessions - 1].leadOutLSN = lsn;
+				lsn += (numSessions == 1 ? 6750 : 2250) + 4500;
+			}
+
+			lsn += cueTracks[i].pregap;
+			trk.dataLSN = lsn;
+			trk.startLSN = lsn + gapInFile;
+		}
+
+		lsn = trk.dataLSN + trk.length;
+
+		if ((numSessions == 0) || (trk.session != tracks[i - 1].session))
+		{
+			if (numSessions == CDIMAGE_MAX_SESSIONS)
+				return false;
+
+			sessions[numSessions].firstTrack = trk.number;
+			numSessions++;
+		}
+
+		sessions[numSessions - 1].lastTrack = trk.number;
+		// Sessions have to be in order, so we renumber them as we go
+		trk.session = numSessions - 1;
+	}
+
+	sessions[numSessions - 1].leadOutLSN = lsn;
+
+	return true;
+}
+
+
+//
+// Convert "mm:ss:ff" into frames. Returns -1 if it's not in that form.
+//
+static int32_t ParseMSF(const char * str)
+{
+	int m, s, f;
+
+	if ((sscanf(str, "%d:%d:%d", &m, &s, &f) != 3) || (m < 0) || (s < 0)
+		|| (s > 59) || (f < 0) || (f > 74))
+		return -1;
+
+	return (((m * 60) + s) * 75) + f;
+}
+
+
+//
+// Sync pattern & MODE1 header for a cooked sector
+//
+static void MakeRawHeader(int32_t lsn, uint8_t * buffer)
+{
+	static const uint8_t sync[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+	uint32_t frames = lsn + 150;
+	uint32_t m = frames / (60 * 75), s = (frames / 75) % 60, f = frames % 75;
+
+	memcpy(buffer, sync, 12);
+	buffer[12] = ((m / 10) << 4) | (m % 10);
+	buffer[13] = ((s / 10) << 4) | (s % 10);
+	buffer[14] = ((f / 10) << 4) | (f % 10);
+	buffer[15] = 0x01;
+}
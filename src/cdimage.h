@@ -0,0 +1,42 @@
+//
+// CDIMAGE.H: CD disc image (CUE/BIN & ISO) support
+//
+
+#ifndef __CDIMAGE_H__
+#define __CDIMAGE_H__
+
+#include <stdint.h>
+
+#define CDIMAGE_MAX_TRACKS		99
+#define CDIMAGE_MAX_SESSIONS	8
+
+struct CDImageTrack
+{
+	uint8_t number;
+	uint8_t session;
+	bool audio;
+	int32_t startLSN;			// Absolute LSN of INDEX 01
+	int32_t dataLSN;			// Absolute LSN of the first sector in the file
+	uint32_t length;			// # of sectors in the file belonging to this track
+	uint32_t sectorSize;		// 2352 or 2048
+	uint32_t fileNum;			// Which file the data lives in
+	uint32_t fileOffset;		// Byte offset of the track's data in its file
+};
+
+struct CDImageSession
+{
+	uint8_t firstTrack;
+	uint8_t lastTrack;
+	int32_t leadOutLSN;
+};
+
+bool CDImageOpen(const char * path);
+void CDImageClose(void);
+bool CDImageIsOpen(void);
+bool CDImageReadSector(int32_t lsn, uint8_t * buffer);
+uint32_t CDImageGetNumTracks(void);
+uint32_t CDImageGetNumSessions(void);
+const CDImageTrack * CDImageGetTrack(uint32_t trackNum);
+const CDImageSession * CDImageGetSession(uint32_t session);
+
+#endif	// __CDIMAGE_H__
@@ -23,21 +23,39 @@
 //  change permanent.)
 //#define HAVE_LIB_CDIO
 
+//
+// Disc images (CUE/BIN & ISO) are handled by cdimage.cpp; if one is named in
+// the settings, it takes precedence over any physical drive.
+//
+
 #include "cdintf.h"				// Every OS has to implement these
 
+#include <string.h>
 #ifdef HAVE_LIB_CDIO
 #include <cdio/cdio.h>			// Now using OS agnostic CD access routines!
 #include <cdio/util.h>
 #endif
+#include "cdimage.h"
 #include "log.h"
+#include "settings.h"
 
 // Private function prototypes
 
+struct CDIntfMSF
+{
+	uint8_t m, s, f;
+};
+
+static bool OpenDiscImage(void);
+static CDIntfMSF LSNToMSF(int lsn);
+static uint16_t ImageReadShortTOC(uint32_t session);
+static uint16_t ImageReadLongTOC(uint32_t session);
 
 
 #ifdef HAVE_LIB_CDIO
 static CdIo_t * cdHandle = NULL;
 #endif
+static char imagePath[MAX_PATH] = "";
 
 // Exported vars
 TOCEntry track[99];
@@ -49,6 +67,8 @@ uint16_t numSessions;
 
 bool CDIntfInit(void)
 {
+	bool haveImage = OpenDiscImage();
+
 #ifdef HAVE_LIB_CDIO
 	// The native CD-ROM routines all hinge on this open call: if the open call
 	// fails, the emulated CD-ROM will not use any of the other CDIntf*
@@ -59,7 +79,7 @@ bool CDIntfInit(void)
 	if (cdHandle == NULL)
 	{
 		WriteLog("CDINTF: No suitable CD-ROM driver found.\n");
-		return false;
+		return haveImage;
 	}
 
 	WriteLog("CDINTF: Successfully opened CD-ROM interface.\n");
@@ -127,15 +147,54 @@ Last session start LSN: 016165
 
 	return true;
 #else
-	WriteLog("CDINTF: CDIO not compiled into Jaguar core; CD-ROM will be unavailable.\n");
-	return false;
+	if (!haveImage)
+		WriteLog("CDINTF: CDIO not compiled into Jaguar core & no disc image; CD-ROM will be unavailable.\n");
+
+	return haveImage;
+#endif
+}
+
+
+//
+// Make sure the disc image we have open (if any) is the one named in the
+// settings, since that can change after CDIntfInit() is called. Returns true if
+// there's something (image or drive) to read from.
+//
+bool CDIntfRefresh(void)
+{
+	if (strcmp(vjs.CDImagePath, imagePath) != 0)
+		OpenDiscImage();
+
+#ifdef HAVE_LIB_CDIO
+	return (CDImageIsOpen() || (cdHandle != NULL));
+#else
+	return CDImageIsOpen();
 #endif
 }
 
 
+static bool OpenDiscImage(void)
+{
+	CDImageClose();
+	strcpy(imagePath, vjs.CDImagePath);
+
+	if (imagePath[0] == 0)
+		return false;
+
+	if (!CDImageOpen(imagePath))
+	{
+		WriteLog("CDINTF: Could not open disc image \"%s\".\n", imagePath);
+		return false;
+	}
+
+	return true;
+}
+
+
 void CDIntfDone(void)
 {
 	WriteLog("CDINTF: Shutting down CD-ROM subsystem.\n");
+	CDImageClose();
 
 #ifdef HAVE_LIB_CDIO
 	if (cdHandle)
@@ -148,7 +207,7 @@ void CDIntfDone(void)
 // Convert LSN to MSF. We have to write this because libcdio doesn't have one.
 // :-P
 //
-msf_t LSNToMSF(int lsn)
+static CDIntfMSF LSNToMSF(int lsn)
 {
 	// MSF is ahead of LSN by 150 frames for some reason...
 	lsn += 150;
@@ -156,7 +215,7 @@ msf_t LSNToMSF(int lsn)
 	// 75 frames to a second...
 	int hi = lsn / 75, lo = lsn % 75;
 
-	msf_t time;
+	CDIntfMSF time;
 	time.f = lo;
 	time.s = hi % 60;
 	time.m = hi / 60;
@@ -173,6 +232,9 @@ msf_t LSNToMSF(int lsn)
 //
 uint16_t CDIntfReadShortTOC(uint32_t session)
 {
+	if (CDImageIsOpen())
+		return ImageReadShortTOC(session);
+
 #ifdef HAVE_LIB_CDIO
 	// Sanity check
 	if (!cdHandle)
@@ -197,7 +259,7 @@ uint16_t CDIntfReadShortTOC(uint32_t session)
 			return 0x0429;
 
 		// Not a multisession disc...
-		msf_t time = LSNToMSF(leadOutLSN);
+		CDIntfMSF time = LSNToMSF(leadOutLSN);
 
 		track[0].firstTrack = firstTrack;
 		track[0].lastTrack = numTracks;
@@ -222,7 +284,7 @@ uint16_t CDIntfReadShortTOC(uint32_t session)
 
 			if (lastSessionLSN == currentTrack)
 			{
-				msf_t time = LSNToMSF(currentTrack);
+				CDIntfMSF time = LSNToMSF(currentTrack);
 				track[0].lastTrack = i - 1;
 				track[0].mins = time.m;
 				track[0].secs = time.s;
@@ -241,7 +303,7 @@ uint16_t CDIntfReadShortTOC(uint32_t session)
 
 			if (lastSessionLSN == currentTrack)
 			{
-				msf_t time = LSNToMSF(leadOutLSN);
+				CDIntfMSF time = LSNToMSF(leadOutLSN);
 				track[0].firstTrack = i;
 				track[0].mins = time.m;
 				track[0].secs = time.s;
@@ -270,6 +332,9 @@ uint16_t CDIntfReadShortTOC(uint32_t session)
 //
 uint16_t CDIntfReadLongTOC(uint32_t session)
 {
+	if (CDImageIsOpen())
+		return ImageReadLongTOC(session);
+
 #ifdef HAVE_LIB_CDIO
 	// Sanity check
 	if (!cdHandle)
@@ -374,8 +439,64 @@ WriteLog("CDINTF: Start/end track is %i/%i\n", startTrack, endTrack);
 }
 
 
+//
+// The TOC functions for disc images. These work the same as the ones above,
+// only we can get the session information right since it's all in the cue
+// sheet.
+//
+static uint16_t ImageReadShortTOC(uint32_t session)
+{
+	const CDImageSession * sess = CDImageGetSession(session);
+
+	// Return DSA error "Illegal value" if the session # is out of whack
+	if (sess == NULL)
+		return 0x0429;
+
+	CDIntfMSF time = LSNToMSF(sess->leadOutLSN);
+	track[0].firstTrack = sess->firstTrack;
+	track[0].lastTrack = sess->lastTrack;
+	track[0].mins = time.m;
+	track[0].secs = time.s;
+	track[0].frms = time.f;
+
+	return 0x0000;
+}
+
+
+static uint16_t ImageReadLongTOC(uint32_t session)
+{
+	const CDImageSession * sess = CDImageGetSession(session);
+
+	if (sess == NULL)
+		return 0x0429;
+
+	startTrack = sess->firstTrack;
+	endTrack = sess->lastTrack;
+
+	for(int i=startTrack; i<=endTrack; i++)
+	{
+		const CDImageTrack * trk = CDImageGetTrack(i);
+
+		if (trk == NULL)
+			return 0x0429;
+
+		CDIntfMSF time = LSNToMSF(trk->startLSN);
+		track[i].firstTrack = i;
+		track[i].lastTrack = 0x01;
+		track[i].mins = time.m;
+		track[i].secs = time.s;
+		track[i].frms = time.f;
+	}
+
+	return 0x0000;
+}
+
+
 bool CDIntfReadBlock(uint32_t sector, uint8_t * buffer)
 {
+	if (CDImageIsOpen())
+		return CDImageReadSector((int32_t)sector, buffer);
+
 #ifdef HAVE_LIB_CDIO
 	driver_return_code_t code = cdio_read_sector(cdHandle, buffer, sector, CDIO_READ_MODE_AUDIO);
 
@@ -388,6 +509,9 @@ bool CDIntfReadBlock(uint32_t sector, uint8_t * buffer)
 
 uint32_t CDIntfGetNumSessions(void)
 {
+	if (CDImageIsOpen())
+		return CDImageGetNumSessions();
+
 #ifdef HAVE_LIB_CDIO
 #warning "!!! FIX !!! CDIntfGetNumSessions not implemented!"
 	// Still need relevant code here... !!! FIX !!!
@@ -425,6 +549,9 @@ const uint8_t * CDIntfGetDriveName(uint32_t driveNum)
 #warning "!!! FIX !!! CDIntfGetDriveName driveNum is currently ignored!"
 	// driveNum is currently ignored... !!! FIX !!!
 
+	if (CDImageIsOpen())
+		return (const uint8_t *)imagePath;
+
 #ifdef HAVE_LIB_CDIO
 	uint8_t * driveName = (uint8_t *)cdio_get_default_device(cdHandle);
 	WriteLog("CDINTF: The drive name for the current driver is %s.\n", driveName);
@@ -436,8 +563,25 @@ const uint8_t * CDIntfGetDriveName(uint32_t driveNum)
 }
 
 
+//
+// For disc images, offset 0 & 1 are the first & last tracks of the session,
+// and 2-4 are the lead out MSF.
+//
 uint8_t CDIntfGetSessionInfo(uint32_t session, uint32_t offset)
 {
+	if (CDImageIsOpen())
+	{
+		const CDImageSession * sess = CDImageGetSession(session);
+
+		if (sess == NULL)
+			return 0xFF;
+
+		CDIntfMSF time = LSNToMSF(sess->leadOutLSN);
+		uint8_t info[5] = { sess->firstTrack, sess->lastTrack, time.m, time.s, time.f };
+
+		return (offset < 5 ? info[offset] : 0xFF);
+	}
+
 #ifdef HAVE_LIB_CDIO
 #warning "!!! FIX !!! CDIntfGetSessionInfo not implemented!"
 	WriteLog("CDINTF: GetSessionInfo unimplemented!\n");
@@ -450,9 +594,24 @@ uint8_t CDIntfGetSessionInfo(uint32_t session, uint32_t offset)
 
 //
 // The track parameter is easy to figure out, but what is the offset???
+// For disc images, offset 0-2 are the start MSF, 3 is the session (from zero)
+// and 4 is $01 for data tracks and $00 for audio.
 //
 uint8_t CDIntfGetTrackInfo(uint32_t track, uint32_t offset)
 {
+	if (CDImageIsOpen())
+	{
+		const CDImageTrack * trk = CDImageGetTrack(track);
+
+		if (trk == NULL)
+			return 0xFF;
+
+		CDIntfMSF time = LSNToMSF(trk->startLSN);
+		uint8_t info[5] = { time.m, time.s, time.f, trk->session, (uint8_t)(trk->audio ? 0x00 : 0x01) };
+
+		return (offset < 5 ? info[offset] : 0xFF);
+	}
+
 #ifdef HAVE_LIB_CDIO
 #warning "!!! FIX !!! CDIntfTrackInfo not implemented!"
 	WriteLog("CDINTF: GetTrackInfo unimplemented!\n");
@@ -21,6 +21,7 @@ struct TOCEntry
 
 bool CDIntfInit(void);
 void CDIntfDone(void);
+bool CDIntfRefresh(void);
 uint16_t CDIntfReadShortTOC(uint32_t session);
 uint16_t CDIntfReadLongTOC(uint32_t session);
 bool CDIntfReadBlock(uint32_t, uint8_t *);
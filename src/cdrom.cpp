@@ -17,13 +17,14 @@
 #include "cdrom.h"
 
 #include <string.h>				// For memset, etc.
+#include "cdcache.h"
 #include "cdintf.h"				// System agnostic CD interface functions
 #include "dac.h"
 #include "dsp.h"
 #include "eeprom.h"
-#include "event.h"
 #include "jaguar.h"
 #include "log.h"
+#include "state.h"
 
 
 //#define CDROM_LOG				// For CDROM logging, obviously
@@ -192,46 +193,59 @@ const char * BReg[12] = { "BUTCH", "DSCNTRL", "DS_DATA", "???", "I2CNTRL",
 	"I2SBUS" };
 
 // BUTCH internal shite
-static bool haveCDGoodness;
-static uint32_t min, sec, frm, block;
-static uint16_t cdCmd = 0;
-static uint32_t cdPtr = 0;
-static uint8_t cdBuffer[2352 + 96];
-static uint32_t cdBufPtr = 2352;
-static uint8_t trackNum = 1, minTrack, maxTrack;
-static uint8_t wordStrobe;
-static uint32_t currentSector, sectorRead;
-static uint32_t cdSpeed;
+static MACHINE_STATE bool haveCDGoodness;
+static MACHINE_STATE uint32_t min, sec, frm, block;
+static MACHINE_STATE uint16_t cdCmd = 0;
+static MACHINE_STATE uint32_t cdPtr = 0;
+static MACHINE_STATE uint8_t cdBuffer[2352 + 96];
+static MACHINE_STATE uint32_t cdBufPtr = 2352;
+static MACHINE_STATE uint8_t trackNum = 1, minTrack, maxTrack;
+static MACHINE_STATE uint8_t wordStrobe;
+static MACHINE_STATE uint32_t currentSector, sectorRead;
+static MACHINE_STATE uint32_t cdSpeed;
 
 // BUTCH internal FIFO
 #define FIFO_MASK 0x1FF
-static uint16_t dsfifo[FIFO_MASK + 1];
-static uint16_t dsfStart, dsfEnd;
+static MACHINE_STATE uint16_t dsfifo[FIFO_MASK + 1];
+static MACHINE_STATE uint16_t dsfStart, dsfEnd;
+
+// I2S sample FIFO. Data going out to JERRY is pulled from the CD one sector's
+// worth of stereo samples at a time, and the DSP's run loop clocks it out
+// one sample at a time (see BUTCHTimeToNextSample()).
+#define I2S_BLOCK_SIZE	((2352 / 4) * 2)
+static MACHINE_STATE uint16_t i2sFIFO[I2S_BLOCK_SIZE];
+static MACHINE_STATE uint32_t i2sFIFOPtr = I2S_BLOCK_SIZE;
+static MACHINE_STATE bool i2sRunning = false;
+static MACHINE_STATE double i2sTimeToSample;
 
 // BUTCH registers
 // N.B.: At some point, need to change these out to use the ones in memory.cpp
 //uint32_t butchControl;
-uint32_t butchDSCntrl;
-uint32_t butchI2Cntrl;
-uint32_t butchSBCntrl;
-uint32_t butchSubDatA;
-uint32_t butchSubDatB;
-uint32_t butchSBTime;
-uint32_t butchFIFOData;
-uint32_t butchI2SDat2;
+MACHINE_STATE uint32_t butchDSCntrl;
+MACHINE_STATE uint32_t butchI2Cntrl;
+MACHINE_STATE uint32_t butchSBCntrl;
+MACHINE_STATE uint32_t butchSubDatA;
+MACHINE_STATE uint32_t butchSubDatB;
+MACHINE_STATE uint32_t butchSBTime;
+MACHINE_STATE uint32_t butchFIFOData;
+MACHINE_STATE uint32_t butchI2SDat2;
 
 // Private function prototypes
 static void QueueDSFIFO(uint16_t data);
 static uint32_t ReadDSFIFO(void);
 static void ButchCommand(uint16_t cmd);
 static void HandleButchControl(void);
-void BUTCHI2SCallback(void);
+static void StartI2S(void);
+static void ClockOutI2SSample(void);
 uint16_t BUTCHGetDataFromCD(void);
 
+static MACHINE_STATE uint16_t lastLeft, lastRight;
+
 
 void CDROMInit(void)
 {
 	haveCDGoodness = CDIntfInit();
+	CDCacheInit();
 	dsfStart = dsfEnd = 0;
 	currentSector = -1;
 	sectorRead = 0;
@@ -245,22 +259,115 @@ void CDROMReset(void)
 	dsfStart = dsfEnd = 0;
 	currentSector = -1;
 	sectorRead = 0;
+	i2sRunning = false;
+	i2sFIFOPtr = I2S_BLOCK_SIZE;
+	CDCacheReset();
+	// Pick up the disc image, if it's been changed since CDROMInit()
+	CDCacheLockDrive();
+	haveCDGoodness = CDIntfRefresh();
+	CDCacheUnlockDrive();
 }
 
 
 void CDROMDone(void)
 {
+	CDCacheDone();
 	CDIntfDone();
 }
 
 
 //
-// We're leveraging the timing subsystem to handle this properly...
+// See STATE.CPP. The disc itself (& the cache in front of it) only ever gets
+// read, so it's just where BUTCH is in it that goes in.
+//
+void CDROMSnapshot(void)
+{
+	SNAPSHOT(min);
+	SNAPSHOT(sec);
+	SNAPSHOT(frm);
+	SNAPSHOT(block);
+	SNAPSHOT(cdCmd);
+	SNAPSHOT(cdPtr);
+	SNAPSHOT(cdBuffer);
+	SNAPSHOT(cdBufPtr);
+	SNAPSHOT(trackNum);
+	SNAPSHOT(minTrack);
+	SNAPSHOT(maxTrack);
+	SNAPSHOT(wordStrobe);
+	SNAPSHOT(currentSector);
+	SNAPSHOT(sectorRead);
+	SNAPSHOT(cdSpeed);
+	SNAPSHOT(dsfifo);
+	SNAPSHOT(dsfStart);
+	SNAPSHOT(dsfEnd);
+	SNAPSHOT(i2sFIFO);
+	SNAPSHOT(i2sFIFOPtr);
+	SNAPSHOT(i2sRunning);
+	SNAPSHOT(i2sTimeToSample);
+	SNAPSHOT(butchDSCntrl);
+	SNAPSHOT(butchI2Cntrl);
+	SNAPSHOT(butchSBCntrl);
+	SNAPSHOT(butchSubDatA);
+	SNAPSHOT(butchSubDatB);
+	SNAPSHOT(butchSBTime);
+	SNAPSHOT(butchFIFOData);
+	SNAPSHOT(butchI2SDat2);
+	SNAPSHOT(lastLeft);
+	SNAPSHOT(lastRight);
+}
+
+
+//
+// Kick off the flow of data to JERRY. The first sample goes out one sample
+// period from now.
+//
+static void StartI2S(void)
+{
+	if (i2sRunning)
+		return;
+
+	wordStrobe = 1;
+	i2sTimeToSample = 1000000.0 / (cdSpeed == 1 ? 44100.0 : 88200.0);
+	i2sRunning = true;
+}
+
+
+//
+// Time (in usec) until BUTCH sends the next sample to JERRY, or a negative
+// number if it isn't sending anything. The DSP's run loop uses this to stop at
+// each sample so the SSI IRQ happens at the right cycle, without having to
+// put an event on the JERRY list for every one of them.
+//
+double BUTCHTimeToNextSample(void)
+{
+	return (i2sRunning ? i2sTimeToSample : -1.0);
+}
+
+
+//
+// Let BUTCH know that <time> usec have gone by; sends out the next sample if
+// it's due.
 //
-static uint16_t lastLeft, lastRight;
-void BUTCHI2SCallback(void)
+void BUTCHAdvanceTime(double time)
 {
-	// Figure callback interval
+	if (!i2sRunning)
+		return;
+
+	i2sTimeToSample -= time;
+
+	if (i2sTimeToSample > 0)
+		return;
+
+	ClockOutI2SSample();
+}
+
+
+//
+// Send one stereo sample out to JERRY & schedule the next one
+//
+static void ClockOutI2SSample(void)
+{
+	// Figure sample interval
 	double interval = 1000000.0 / (cdSpeed == 1 ? 44100.0 : 88200.0);
 	// Do we need to do this because there's L&R for each 1/44100th of a second?
 	// I.e., 32 bits of data for each interval, and we're only stuffing 16?
@@ -271,8 +378,18 @@ void BUTCHI2SCallback(void)
 	// Set which part of the word strobe we're looking for (0x10 == FALLING)
 	uint8_t sendType = (smode & 0x10 ? 1 : 0);
 
-	uint16_t left = BUTCHGetDataFromCD();
-	uint16_t right = BUTCHGetDataFromCD();
+	// Top up the FIFO a block at a time
+	if (i2sFIFOPtr >= I2S_BLOCK_SIZE)
+	{
+		for(uint32_t i=0; i<I2S_BLOCK_SIZE; i++)
+			i2sFIFO[i] = BUTCHGetDataFromCD();
+
+		i2sFIFOPtr = 0;
+	}
+
+	uint16_t left = i2sFIFO[i2sFIFOPtr + 0];
+	uint16_t right = i2sFIFO[i2sFIFOPtr + 1];
+	i2sFIFOPtr += 2;
 
 	// Set the appropriate spot for our data, depending on WS setting...
 #if 0
@@ -300,16 +417,24 @@ void BUTCHI2SCallback(void)
 	lastLeft = left;
 	lastRight = right;
 
+	// With JERRY slaved to BUTCH's word clock, this is also when L/RTXD goes
+	// out to the DAC
+	if (!(smode & SMODE_INTERNAL))
+		DACCaptureSample(1000000.0 / interval);
+
 	// Send IRQ at the appropriate time...
 //	if (wordStrobe == sendType)
 		DSPSetIRQLine(DSPIRQ_SSI, ASSERT_LINE);
 
 	// If all 3 bits aren't set, get outta here...
 	if ((butchI2Cntrl & (I2S_DATA_FROM_CD | I2S_DATA_TO_JERRY | I2S_DATA_ENABLE)) != (I2S_DATA_FROM_CD | I2S_DATA_TO_JERRY | I2S_DATA_ENABLE))
+	{
+		i2sRunning = false;
 		return;
-	
+	}
+
 	// Should turn this off once the I2CNTRL is no longer set... [DONE above]
-	SetCallbackTime(BUTCHI2SCallback, interval, EVENT_JERRY);
+	i2sTimeToSample += interval;
 }
 
 
@@ -320,7 +445,7 @@ uint16_t BUTCHGetDataFromCD(void)
 {
 	if (currentSector != sectorRead)
 	{
-		bool status = CDIntfReadBlock(currentSector, cdBuffer);
+		bool status = CDCacheReadSector(currentSector, cdBuffer);
 
 		if (status == false)
 		{
@@ -684,10 +809,7 @@ void CDROMWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 		butchI2Cntrl = (butchI2Cntrl & 0xFFFF0000) | data;
 
 		if ((butchI2Cntrl & (I2S_DATA_FROM_CD | I2S_DATA_TO_JERRY | I2S_DATA_ENABLE)) == (I2S_DATA_FROM_CD | I2S_DATA_TO_JERRY | I2S_DATA_ENABLE))
-		{
-			wordStrobe = 1;
-			SetCallbackTime(BUTCHI2SCallback, 1000000.0 / 44100.0, EVENT_JERRY);
-		}
+			StartI2S();
 
 		break;
 	case SBCNTRL:
@@ -806,7 +928,9 @@ static void ButchCommand(uint16_t cmd)
 		break;
 	case CMD_READ_TOC:		// Read TOC, session #<param> (1st session is zero)
 	{
+		CDCacheLockDrive();
 		uint16_t status = CDIntfReadShortTOC(param);
+		CDCacheUnlockDrive();
 
 		if (status != 0)
 			QueueDSFIFO(status);
@@ -837,12 +961,20 @@ static void ButchCommand(uint16_t cmd)
 		frm = (uint32_t)param;
 		// Convert MSF into block #
 		currentSector = ((((min * 60) + sec) * 75) + frm) - 150;
+		// Anything still sitting in the I2S FIFO is from the old spot, so
+		// toss it & start over at the top of the new sector
+		i2sFIFOPtr = I2S_BLOCK_SIZE;
+		sectorRead = -1;
+		// Get the prefetch thread going on it before BUTCH asks for data
+		CDCacheSeek(currentSector);
 		// Send back seek response OK
 		QueueDSFIFO(0x0100);
 		break;
 	case CMD_READ_LONG_TOC:	// Read long TOC, session #<param> (1st session is zero)
 	{
+		CDCacheLockDrive();
 		uint16_t status = CDIntfReadLongTOC(param);
+		CDCacheUnlockDrive();
 
 		if (status != 0)
 			QueueDSFIFO(status);
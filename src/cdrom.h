@@ -10,8 +10,11 @@
 void CDROMInit(void);
 void CDROMReset(void);
 void CDROMDone(void);
+void CDROMSnapshot(void);
 
 void BUTCHExec(uint32_t cycles);
+double BUTCHTimeToNextSample(void);
+void BUTCHAdvanceTime(double time);
 
 uint8_t CDROMReadByte(uint32_t offset, uint32_t who = UNKNOWN);
 uint16_t CDROMReadWord(uint32_t offset, uint32_t who = UNKNOWN);
@@ -15,6 +15,14 @@
 
 #include "crc32.h"
 
+#include <stdint.h>
+
+// Carry-less multiply needs GCC style target attributes & CPU detection
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32_HAVE_CLMUL
+#include <immintrin.h>
+#endif
+
 static unsigned long crctable[256] =
 {
 	0x00000000L, 0x77073096L, 0xEE0E612CL, 0x990951BAL, 0x076DC419L, 0x706AF48FL, 0xE963A535L, 0x9E6495A3L,
@@ -52,12 +60,214 @@ static unsigned long crctable[256] =
 };
 
 
+//
+// Tables for slicing-by-8. Table 0 is the same as the table above; each of the
+// others advances the CRC by one more byte of zeros. These are built at
+// startup (before anyone can possibly be hashing anything) so there's no need
+// to worry about threads racing to fill them in.
+//
+static uint32_t crcSliceTable[8][256];
+
+static struct CRCSliceTableInit
+{
+	CRCSliceTableInit()
+	{
+		for(int i=0; i<256; i++)
+			crcSliceTable[0][i] = (uint32_t)crctable[i];
+
+		for(int i=0; i<256; i++)
+		{
+			for(int j=1; j<8; j++)
+				crcSliceTable[j][i] = crcSliceTable[0][crcSliceTable[j - 1][i] & 0xFF]
+					^ (crcSliceTable[j - 1][i] >> 8);
+		}
+	}
+} crcSliceTableInit;
+
+
+//
+// The original byte at a time CRC. Here for the odd bytes at the ends of a
+// buffer, and as the reference the faster ones have to agree with.
+//
+static uint32_t CRC32Bytewise(uint32_t crc, const uint8_t * data, uint32_t length)
+{
+	while (length--)
+		crc = crcSliceTable[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+
+	return crc;
+}
+
+
+//
+// Slicing-by-8: eight bytes per iteration, via eight table lookups. We pull
+// the data in a byte at a time so this works the same on big endian hosts.
+//
+static uint32_t CRC32Slice8(uint32_t crc, const uint8_t * data, uint32_t length)
+{
+	while (length >= 8)
+	{
+		uint32_t one = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8)
+			| ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+		uint32_t two = (uint32_t)data[4] | ((uint32_t)data[5] << 8)
+			| ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+
+		crc = crcSliceTable[7][one & 0xFF] ^ crcSliceTable[6][(one >> 8) & 0xFF]
+			^ crcSliceTable[5][(one >> 16) & 0xFF] ^ crcSliceTable[4][one >> 24]
+			^ crcSliceTable[3][two & 0xFF] ^ crcSliceTable[2][(two >> 8) & 0xFF]
+			^ crcSliceTable[1][(two >> 16) & 0xFF] ^ crcSliceTable[0][two >> 24];
+
+		data += 8;
+		length -= 8;
+	}
+
+	return CRC32Bytewise(crc, data, length);
+}
+
+
+#ifdef CRC32_HAVE_CLMUL
+//
+// Carry-less multiply folding (see Intel's "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction"). Folds four 128-bit lanes at a time
+// down the buffer, then folds those into one and does a Barrett reduction
+// down to 32 bits. Needs at least 64 bytes, and the length has to be a
+// multiple of 16; the caller deals with whatever's left over.
+//
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t CRC32CLMul(uint32_t crc, const uint8_t * data, uint32_t length)
+{
+	// Constants for the bit reflected CRC-32 polynomial, from the paper
+	static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442BD4ULL, 0x01C6E41596ULL };
+	static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997D0ULL, 0x00CCAA009EULL };
+	static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163CD6124ULL, 0x0000000000ULL };
+	static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01DB710641ULL, 0x01F7011641ULL };
+
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+	x1 = _mm_loadu_si128((const __m128i *)(data + 0x00));
+	x2 = _mm_loadu_si128((const __m128i *)(data + 0x10));
+	x3 = _mm_loadu_si128((const __m128i *)(data + 0x20));
+	x4 = _mm_loadu_si128((const __m128i *)(data + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+	x0 = _mm_load_si128((const __m128i *)k1k2);
+	data += 64;
+	length -= 64;
+
+	// Fold 64 bytes at a time
+	while (length >= 64)
+	{
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+		y5 = _mm_loadu_si128((const __m128i *)(data + 0x00));
+		y6 = _mm_loadu_si128((const __m128i *)(data + 0x10));
+		y7 = _mm_loadu_si128((const __m128i *)(data + 0x20));
+		y8 = _mm_loadu_si128((const __m128i *)(data + 0x30));
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+		data += 64;
+		length -= 64;
+	}
+
+	// Fold the four lanes into one
+	x0 = _mm_load_si128((const __m128i *)k3k4);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold 16 bytes at a time
+	while (length >= 16)
+	{
+		x2 = _mm_loadu_si128((const __m128i *)data);
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+		data += 16;
+		length -= 16;
+	}
+
+	// 128 bits -> 64 bits
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+	x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction down to 32 bits
+	x0 = _mm_load_si128((const __m128i *)poly);
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+
+static bool HaveCLMul(void)
+{
+	static int haveCLMul = -1;
+
+	// Benign race: everyone who gets here computes the same answer
+	if (haveCLMul < 0)
+	{
+		__builtin_cpu_init();
+		haveCLMul = (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1") ? 1 : 0);
+	}
+
+	return (haveCLMul == 1);
+}
+#endif
+
+
+//
+// Update a running CRC (pre/post inversion is up to the caller) using the
+// fastest method this host supports.
+//
+static uint32_t CRC32Update(uint32_t crc, const uint8_t * data, uint32_t length)
+{
+#ifdef CRC32_HAVE_CLMUL
+	if ((length >= 64) && HaveCLMul())
+	{
+		uint32_t chunk = length & ~15;
+		crc = CRC32CLMul(crc, data, chunk);
+		data += chunk;
+		length -= chunk;
+	}
+#endif
+
+	return CRC32Slice8(crc, data, length);
+}
+
+
 int crc32_calcCheckSum(unsigned char * data, unsigned int length)
 {
-	unsigned long crc = 0xFFFFFFFF;
+	return CRC32Update(0xFFFFFFFF, data, length) ^ 0xFFFFFFFF;
+}
 
-	for(unsigned int i=0; i<length; i++)
-		crc = crctable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
 
-	return crc ^ 0xFFFFFFFF;
+//
+// Here for comparing against the faster versions (see utils/crc32check.cpp);
+// this is how it used to be done.
+//
+int crc32_calcCheckSumReference(unsigned char * data, unsigned int length)
+{
+	return CRC32Bytewise(0xFFFFFFFF, data, length) ^ 0xFFFFFFFF;
 }
@@ -6,5 +6,6 @@
 #define __CRC32_H__
 
 int crc32_calcCheckSum(unsigned char * data, unsigned int length);
+int crc32_calcCheckSumReference(unsigned char * data, unsigned int length);
 
 #endif	// __CRC32_H__
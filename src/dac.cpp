@@ -43,21 +43,24 @@
 #include "dac.h"
 
 //#include <ctype.h>
+#include <atomic>
 #include "SDL.h"
+#include "capture.h"
 #include "cdrom.h"
 #include "dsp.h"
 #include "event.h"
+#include "gpu.h"
 #include "jerry.h"
 #include "jaguar.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
+#include "resampler.h"
 #include "settings.h"
 
 
 //#define DEBUG_DAC
 
 #define BUFFER_SIZE			0x10000				// Make the DAC buffers 64K x 16 bits
-#define DAC_AUDIO_RATE		48000				// Set the audio rate to 48 KHz
 
 // Jaguar memory locations
 
@@ -75,15 +78,24 @@
 
 // Local variables
 
-static SDL_AudioSpec desired;
-static bool SDLSoundInitialized;
+static MACHINE_STATE SDL_AudioSpec desired;
+static MACHINE_STATE bool SDLSoundInitialized;
+// Amount of DSP time (in usec) the audio thread has run so far; when pacing
+// off of the audio clock, this is the clock (and the GUI thread reads it)
+static MACHINE_STATE std::atomic<uint64_t> audioTime;
+static MACHINE_STATE std::atomic<uint32_t> underruns;
+static MACHINE_STATE volatile double playbackSpeed = 1.0;
+static MACHINE_STATE bool callerRunsDSP = false;	// See DACRunByCaller()
 //static uint8_t SCLKFrequencyDivider = 19;			// Default is roughly 22 KHz (20774 Hz in NTSC mode)
 // /*static*/ uint16_t serialMode = 0;
 
 // Private function prototypes
 
 void SDLSoundCallback(void * userdata, Uint8 * buffer, int length);
-void DSPSampleCallback(void);
+static void FillAudioBuffer(Uint8 * buffer, int length);
+void DSPBufferCallback(void);
+static void RunJERRY(double time);
+static void RunDSP(double time);
 
 
 //
@@ -104,16 +116,30 @@ void DACInit(void)
 	desired.format = AUDIO_S16SYS;
 	desired.channels = 2;
 	desired.samples = 2048;						// 2K buffer = audio delay of 42.67 ms (@ 48 KHz)
+
+	// If we're being paced by the audio, we can get away with a much smaller
+	// buffer: the biggest power of two that fits in the latency we're after
+	if (vjs.audioSync)
+	{
+		uint32_t samples = (vjs.audioLatency * DAC_AUDIO_RATE) / 1000;
+
+		for(desired.samples=2048; desired.samples>256 && desired.samples>samples; desired.samples>>=1)
+			;
+	}
 	desired.callback = SDLSoundCallback;
 
-	if (SDL_OpenAudio(&desired, NULL) < 0)		// NULL means SDL guarantees what we want
+	// Without host audio, whoever's running us has to call SDLSoundCallback()
+	// to keep the DSP going
+	if (callerRunsDSP)
+		WriteLog("DAC: Host audio disabled, DSP is run by the caller.\n");
+	else if (SDL_OpenAudio(&desired, NULL) < 0)	// NULL means SDL guarantees what we want
 		WriteLog("DAC: Failed to initialize SDL sound...\n");
 	else
 	{
 		SDLSoundInitialized = true;
 		DACReset();
 		SDL_PauseAudio(false);					// Start playback!
-		WriteLog("DAC: Successfully initialized. Sample rate: %u\n", desired.freq);
+		WriteLog("DAC: Successfully initialized. Sample rate: %u, buffer: %u samples\n", desired.freq, desired.samples);
 	}
 
 	ltxd = lrxd = desired.silence;
@@ -122,6 +148,18 @@ void DACInit(void)
 	uint32_t riscClockRate = (vjs.hardwareTypeNTSC ? RISC_CLOCK_RATE_NTSC : RISC_CLOCK_RATE_PAL);
 	uint32_t cyclesPerSample = riscClockRate / DAC_AUDIO_RATE;
 	WriteLog("DAC: RISC clock = %u, cyclesPerSample = %u\n", riscClockRate, cyclesPerSample);
+	ResamplerInit((double)riscClockRate / (32.0 * (2.0 * (sclk + 1))), (double)DAC_AUDIO_RATE);
+}
+
+
+//
+// Don't open host audio; whoever's running us calls SDLSoundCallback() to
+// keep the DSP going instead. (For the tools in UTILS/; this has to be set
+// before JaguarInit(), and isn't saved anywhere.)
+//
+void DACRunByCaller(bool state/*= true*/)
+{
+	callerRunsDSP = state;
 }
 
 
@@ -132,6 +170,7 @@ void DACReset(void)
 {
 //	LeftFIFOHeadPtr = LeftFIFOTailPtr = 0, RightFIFOHeadPtr = RightFIFOTailPtr = 1;
 	ltxd = lrxd = desired.silence;
+	ResamplerReset();
 }
 
 
@@ -144,6 +183,22 @@ void DACPauseAudioThread(bool state/*= true*/)
 }
 
 
+//
+// Keep the SDL audio thread (and so the DSP, which it runs) out while the
+// rest of the machine is looked at, or let it back in
+//
+void DACLockAudioThread(bool state/*= true*/)
+{
+	if (!SDLSoundInitialized)
+		return;
+
+	if (state)
+		SDL_LockAudio();
+	else
+		SDL_UnlockAudio();
+}
+
+
 //
 // Close down the SDL sound subsystem
 //
@@ -153,9 +208,10 @@ void DACDone(void)
 	{
 		SDL_PauseAudio(true);
 		SDL_CloseAudio();
+		SDLSoundInitialized = false;
 	}
 
-	WriteLog("DAC: Done.\n");
+	WriteLog("DAC: Done. (%u underruns)\n", underruns.load());
 }
 
 
@@ -176,14 +232,27 @@ void DACDone(void)
 // Note: The samples are packed in the buffer in 16 bit left/16 bit right pairs.
 //       Also, length is the length of the buffer in BYTES
 //
-static Uint8 * sampleBuffer;
-static int bufferIndex = 0;
-static int numberOfSamples = 0;
-static bool bufferDone = false;
+static MACHINE_STATE bool bufferDone = false;
+static MACHINE_STATE uint32_t samplesCaptured = 0;
 void SDLSoundCallback(void * userdata, Uint8 * buffer, int length)
+{
+	FillAudioBuffer(buffer, length);
+
+	// Hand a copy to the A/V capture, if it's running (it never blocks)
+	CaptureAudio((int16_t *)buffer, length / 4);
+}
+
+
+static void FillAudioBuffer(Uint8 * buffer, int length)
 {
 	// 1st, check to see if the DSP is running. If not, fill the buffer with L/RXTD and exit.
 
+	// length is in BYTES, and each stereo sample is 4 of them
+	uint32_t frames = length / 4;
+	// When fast forwarding, we have to run the DSP faster than real time
+	double bufferTime = ((1000000.0 * frames) / (double)DAC_AUDIO_RATE) * playbackSpeed;
+	audioTime += (uint64_t)bufferTime;
+
 	if (!DSPIsRunning())
 	{
 		for(int i=0; i<(length/2); i+=2)
@@ -195,49 +264,162 @@ void SDLSoundCallback(void * userdata, Uint8 * buffer, int length)
 		return;
 	}
 
-	// Now, run the DSP for that length of time for each sample we need to make
+	// Now, run the DSP for as long as it takes to play the buffer. Whatever
+	// JERRY sends out in that time gets captured at its own rate, then
+	// resampled to ours.
 
-	bufferIndex = 0;
-	sampleBuffer = buffer;
-// If length is the length of the sample buffer in BYTES, then shouldn't the #
-// of samples be / 4? No, because we bump the sample count by 2, so this is OK.
-	numberOfSamples = length / 2;
-	bufferDone = false;
+	samplesCaptured = 0;
+	// The GPU can't be off running ahead while it does (see GPU.CPP)
+	GPULockOutSpeculation();
+	RunJERRY(bufferTime);
+	GPULockOutSpeculation(false);
 
-	SetCallbackTime(DSPSampleCallback, 1000000.0 / (double)DAC_AUDIO_RATE, EVENT_JERRY);
+	// If nothing clocked any samples out of JERRY (I2S isn't running), all
+	// we can do is hold what's in L/RTXD
+	if (samplesCaptured == 0)
+	{
+		for(int i=0; i<(length/2); i+=2)
+		{
+			((uint16_t *)buffer)[i + 0] = ltxd;
+			((uint16_t *)buffer)[i + 1] = rtxd;
+		}
+
+		return;
+	}
+
+	if (ResamplerRead((int16_t *)buffer, frames) < frames)
+		underruns++;
+}
+
+
+//
+// Run the DSP for <time> usec, without anything it sends out going to the
+// host. This is for frames that are only being looked ahead at (see
+// JAGUAR.CPP), with the audio thread locked out.
+//
+void DACRunSilently(double time)
+{
+	if (DSPIsRunning())
+		RunJERRY(time);
+}
+
+
+//
+// Run the DSP & JERRY's timers for <time> usec
+//
+static void RunJERRY(double time)
+{
+	bufferDone = false;
+	SetCallbackTime(DSPBufferCallback, time, EVENT_JERRY);
 
 	// These timings are tied to NTSC, need to fix that in event.cpp/h! [FIXED]
 	do
 	{
 		double timeToNextEvent = GetTimeToNextEvent(EVENT_JERRY);
-
-		if (vjs.DSPEnabled)
-		{
-			if (vjs.usePipelinedDSP)
-				DSPExecP2(USEC_TO_RISC_CYCLES(timeToNextEvent));
-			else
-				DSPExec(USEC_TO_RISC_CYCLES(timeToNextEvent));
-		}
-
+		RunDSP(timeToNextEvent);
 		HandleNextEvent(EVENT_JERRY);
 	}
 	while (!bufferDone);
 }
 
 
-void DSPSampleCallback(void)
+//
+// Run the DSP for <time> usec. If BUTCH is sending CD data over I2S, we stop
+// at each sample it sends so the SSI IRQ lands where it should; doing it here
+// keeps 44100 events/sec off of the JERRY event list.
+//
+static void RunDSP(double time)
 {
-	((uint16_t *)sampleBuffer)[bufferIndex + 0] = ltxd;
-	((uint16_t *)sampleBuffer)[bufferIndex + 1] = rtxd;
-	bufferIndex += 2;
+	double timeToSample = BUTCHTimeToNextSample();
 
-	if (bufferIndex == numberOfSamples)
+	while ((timeToSample >= 0) && (timeToSample < time))
 	{
-		bufferDone = true;
-		return;
+		if (vjs.DSPEnabled)
+			DSPExec(USEC_TO_RISC_CYCLES(timeToSample));
+
+		BUTCHAdvanceTime(timeToSample);
+		time -= timeToSample;
+		timeToSample = BUTCHTimeToNextSample();
 	}
 
-	SetCallbackTime(DSPSampleCallback, 1000000.0 / (double)DAC_AUDIO_RATE, EVENT_JERRY);
+	if (vjs.DSPEnabled)
+		DSPExec(USEC_TO_RISC_CYCLES(time));
+
+	BUTCHAdvanceTime(time);
+}
+
+
+void DSPBufferCallback(void)
+{
+	bufferDone = true;
+}
+
+
+//
+// JERRY's (or BUTCH's) word clock just ticked: grab what's going out over
+// I2S. <sampleRate> is the current rate of the word clock.
+//
+void DACCaptureSample(double sampleRate)
+{
+	if (!SDLSoundInitialized || jaguarRunningAhead)
+		return;
+
+	// Sped up, we play samples faster than they were made. The speed moves
+	// every frame in fast forward, so it only changes the step, not the filter.
+	ResamplerSetInputRate(sampleRate);
+	ResamplerSetSpeed(playbackSpeed);
+	ResamplerWrite((int16_t)ltxd, (int16_t)rtxd);
+	samplesCaptured++;
+}
+
+
+//
+// Whether the host audio is running (and thus whether DACGetAudioTime() means
+// anything)
+//
+bool DACIsActive(void)
+{
+	return SDLSoundInitialized && (SDL_GetAudioStatus() == SDL_AUDIO_PLAYING);
+}
+
+
+//
+// How much DSP time (in usec) the audio thread has run, total
+//
+uint64_t DACGetAudioTime(void)
+{
+	return audioTime;
+}
+
+
+//
+// How long (in usec) it takes the host to play one of our buffers
+//
+uint32_t DACGetBufferLatency(void)
+{
+	if (!SDLSoundInitialized)
+		return 0;
+
+	return (uint32_t)(((uint64_t)desired.samples * 1000000) / desired.freq);
+}
+
+
+//
+// Number of buffers that came up short because JERRY didn't send enough
+// samples
+//
+uint32_t DACGetUnderruns(void)
+{
+	return underruns;
+}
+
+
+//
+// For fast forward; 1.0 is normal speed
+//
+void DACSetSpeed(double speed)
+{
+	playbackSpeed = speed;
 }
 
 
@@ -310,7 +492,7 @@ uint8_t DACReadByte(uint32_t offset, uint32_t who/*= UNKNOWN*/)
 
 
 #define DEBUG_CDROM
-static uint32_t zeroSeen = 0;
+static MACHINE_STATE uint32_t zeroSeen = 0;
 uint16_t DACReadWord(uint32_t offset, uint32_t who/*= UNKNOWN*/)
 {
 //	WriteLog("DAC: %s reading word from %08X\n", whoName[who], offset);
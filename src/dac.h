@@ -8,9 +8,19 @@
 #include "memory.h"
 
 void DACInit(void);
+void DACRunByCaller(bool state = true);
 void DACReset(void);
 void DACPauseAudioThread(bool state = true);
+void DACLockAudioThread(bool state = true);
+void DACRunSilently(double time);
 void DACDone(void);
+void DACCaptureSample(double sampleRate);
+bool DACIsActive(void);
+uint64_t DACGetAudioTime(void);
+uint32_t DACGetBufferLatency(void);
+uint32_t DACGetUnderruns(void);
+void DACSetSpeed(double speed);
+void SDLSoundCallback(void * userdata, uint8_t * buffer, int length);
 //int GetCalculatedFrequency(void);
 
 // DAC memory access
@@ -23,6 +33,8 @@ uint16_t DACReadWord(uint32_t offset, uint32_t who = UNKNOWN);
 
 // DAC defines
 
+#define DAC_AUDIO_RATE		48000				// Set the audio rate to 48 KHz
+
 #define SMODE_INTERNAL		0x01
 #define SMODE_MODE			0x02
 #define SMODE_WSEN			0x04
@@ -17,15 +17,22 @@
 #include "dsp.h"
 
 #include <SDL.h>								// Used only for SDL_GetTicks...
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "dac.h"
 #include "gpu.h"
 #include "jagdasm.h"
+#include "jagrisc.h"
 #include "jaguar.h"
 #include "jerry.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
 //#include "memory.h"
+#include "settings.h"
+#include "state.h"
+#include "zlib.h"
 
 
 // Like it says...
@@ -39,7 +46,6 @@
 //#define DSP_DEBUG_IRQ
 //#define DSP_DEBUG_PL2
 //#define DSP_DEBUG_STALL
-//#define DSP_DEBUG_CC
 #define NEW_SCOREBOARD
 
 // Disassembly definitions
@@ -189,13 +195,13 @@ struct PipelineStage
 #define TYPE_DWORD			2
 #define PIPELINE_STALL		64						// Set to # of opcodes + 1
 #ifndef NEW_SCOREBOARD
-bool scoreboard[32];
+MACHINE_STATE bool scoreboard[32];
 #else
-uint8_t scoreboard[32];
+MACHINE_STATE uint8_t scoreboard[32];
 #endif
-uint8_t plPtrFetch, plPtrRead, plPtrExec, plPtrWrite;
-PipelineStage pipeline[4];
-bool IMASKCleared = false;
+MACHINE_STATE uint8_t plPtrFetch, plPtrRead, plPtrExec, plPtrWrite;
+MACHINE_STATE PipelineStage pipeline[4];
+MACHINE_STATE bool IMASKCleared = false;
 
 // DSP flags (old--have to get rid of this crap)
 
@@ -248,69 +254,11 @@ bool IMASKCleared = false;
 extern uint32_t jaguar_mainRom_crc32;
 
 // Is opcode 62 *really* a NOP? Seems like it...
-static void dsp_opcode_abs(void);
-static void dsp_opcode_add(void);
-static void dsp_opcode_addc(void);
-static void dsp_opcode_addq(void);
 static void dsp_opcode_addqmod(void);
-static void dsp_opcode_addqt(void);
-static void dsp_opcode_and(void);
-static void dsp_opcode_bclr(void);
-static void dsp_opcode_bset(void);
-static void dsp_opcode_btst(void);
-static void dsp_opcode_cmp(void);
-static void dsp_opcode_cmpq(void);
-static void dsp_opcode_div(void);
-static void dsp_opcode_imacn(void);
-static void dsp_opcode_imult(void);
-static void dsp_opcode_imultn(void);
-static void dsp_opcode_jr(void);
-static void dsp_opcode_jump(void);
-static void dsp_opcode_load(void);
-static void dsp_opcode_loadb(void);
-static void dsp_opcode_loadw(void);
-static void dsp_opcode_load_r14_indexed(void);
-static void dsp_opcode_load_r14_ri(void);
-static void dsp_opcode_load_r15_indexed(void);
-static void dsp_opcode_load_r15_ri(void);
+static void dsp_opcode_subqmod(void);
 static void dsp_opcode_mirror(void);
-static void dsp_opcode_mmult(void);
-static void dsp_opcode_move(void);
-static void dsp_opcode_movei(void);
-static void dsp_opcode_movefa(void);
-static void dsp_opcode_move_pc(void);
-static void dsp_opcode_moveq(void);
-static void dsp_opcode_moveta(void);
-static void dsp_opcode_mtoi(void);
-static void dsp_opcode_mult(void);
-static void dsp_opcode_neg(void);
-static void dsp_opcode_nop(void);
-static void dsp_opcode_normi(void);
-static void dsp_opcode_not(void);
-static void dsp_opcode_or(void);
-static void dsp_opcode_resmac(void);
-static void dsp_opcode_ror(void);
-static void dsp_opcode_rorq(void);
-static void dsp_opcode_xor(void);
 static void dsp_opcode_sat16s(void);
 static void dsp_opcode_sat32s(void);
-static void dsp_opcode_sh(void);
-static void dsp_opcode_sha(void);
-static void dsp_opcode_sharq(void);
-static void dsp_opcode_shlq(void);
-static void dsp_opcode_shrq(void);
-static void dsp_opcode_store(void);
-static void dsp_opcode_storeb(void);
-static void dsp_opcode_storew(void);
-static void dsp_opcode_store_r14_indexed(void);
-static void dsp_opcode_store_r14_ri(void);
-static void dsp_opcode_store_r15_indexed(void);
-static void dsp_opcode_store_r15_ri(void);
-static void dsp_opcode_sub(void);
-static void dsp_opcode_subc(void);
-static void dsp_opcode_subq(void);
-static void dsp_opcode_subqmod(void);
-static void dsp_opcode_subqt(void);
 static void dsp_opcode_illegal(void);
 
 /*uint8_t dsp_opcode_cycles[64] =
@@ -343,27 +291,7 @@ uint8_t dsp_opcode_cycles[64] =
 	1,  1,  3,  3,  1,  1,  1,  1
 };//*/
 
-void (* dsp_opcode[64])() =
-{
-	dsp_opcode_add,					dsp_opcode_addc,				dsp_opcode_addq,				dsp_opcode_addqt,
-	dsp_opcode_sub,					dsp_opcode_subc,				dsp_opcode_subq,				dsp_opcode_subqt,
-	dsp_opcode_neg,					dsp_opcode_and,					dsp_opcode_or,					dsp_opcode_xor,
-	dsp_opcode_not,					dsp_opcode_btst,				dsp_opcode_bset,				dsp_opcode_bclr,
-	dsp_opcode_mult,				dsp_opcode_imult,				dsp_opcode_imultn,				dsp_opcode_resmac,
-	dsp_opcode_imacn,				dsp_opcode_div,					dsp_opcode_abs,					dsp_opcode_sh,
-	dsp_opcode_shlq,				dsp_opcode_shrq,				dsp_opcode_sha,					dsp_opcode_sharq,
-	dsp_opcode_ror,					dsp_opcode_rorq,				dsp_opcode_cmp,					dsp_opcode_cmpq,
-	dsp_opcode_subqmod,				dsp_opcode_sat16s,				dsp_opcode_move,				dsp_opcode_moveq,
-	dsp_opcode_moveta,				dsp_opcode_movefa,				dsp_opcode_movei,				dsp_opcode_loadb,
-	dsp_opcode_loadw,				dsp_opcode_load,				dsp_opcode_sat32s,				dsp_opcode_load_r14_indexed,
-	dsp_opcode_load_r15_indexed,	dsp_opcode_storeb,				dsp_opcode_storew,				dsp_opcode_store,
-	dsp_opcode_mirror,				dsp_opcode_store_r14_indexed,	dsp_opcode_store_r15_indexed,	dsp_opcode_move_pc,
-	dsp_opcode_jump,				dsp_opcode_jr,					dsp_opcode_mmult,				dsp_opcode_mtoi,
-	dsp_opcode_normi,				dsp_opcode_nop,					dsp_opcode_load_r14_ri,			dsp_opcode_load_r15_ri,
-	dsp_opcode_store_r14_ri,		dsp_opcode_store_r15_ri,		dsp_opcode_illegal,				dsp_opcode_addqmod,
-};
-
-uint32_t dsp_opcode_use[65];
+MACHINE_STATE uint32_t dsp_opcode_use[65];
 
 const char * dsp_opcode_str[65]=
 {
@@ -386,22 +314,36 @@ const char * dsp_opcode_str[65]=
 	"STALL"
 };
 
-uint32_t dsp_pc;
-static uint64_t dsp_acc;								// 40 bit register, NOT 32!
-static uint32_t dsp_remain;
-static uint32_t dsp_modulo;
-static uint32_t dsp_flags;
-static uint32_t dsp_matrix_control;
-static uint32_t dsp_pointer_to_matrix;
-static uint32_t dsp_data_organization;
-uint32_t dsp_control;
-static uint32_t dsp_div_control;
-static uint8_t dsp_flag_z, dsp_flag_n, dsp_flag_c;
-static uint32_t * dsp_reg = NULL, * dsp_alternate_reg = NULL;
-uint32_t dsp_reg_bank_0[32], dsp_reg_bank_1[32];
-
-static uint32_t dsp_opcode_first_parameter;
-static uint32_t dsp_opcode_second_parameter;
+MACHINE_STATE uint32_t dsp_pc;
+static MACHINE_STATE uint64_t dsp_acc;								// 40 bit register, NOT 32!
+static MACHINE_STATE uint32_t dsp_remain;
+static MACHINE_STATE uint32_t dsp_modulo;
+static MACHINE_STATE uint32_t dsp_flags;
+static MACHINE_STATE uint32_t dsp_matrix_control;
+static MACHINE_STATE uint32_t dsp_pointer_to_matrix;
+static MACHINE_STATE uint32_t dsp_data_organization;
+MACHINE_STATE uint32_t dsp_control;
+static MACHINE_STATE uint32_t dsp_div_control;
+static MACHINE_STATE uint8_t dsp_flag_z, dsp_flag_n, dsp_flag_c;
+// Z & N are worked out lazily, from the last ALU result (see
+// JaguarRISC::UpdateFlags())
+static MACHINE_STATE uint32_t dsp_flag_result;
+static MACHINE_STATE bool dsp_flags_pending = false;
+static MACHINE_STATE uint32_t * dsp_reg = NULL, * dsp_alternate_reg = NULL;
+MACHINE_STATE uint32_t dsp_reg_bank_0[32], dsp_reg_bank_1[32];
+
+static MACHINE_STATE uint32_t dsp_opcode_first_parameter;
+static MACHINE_STATE uint32_t dsp_opcode_second_parameter;
+
+// Idle loop detection: what the DSP looked like the last time it came around
+// a short backward branch
+struct DSPIdleState
+{
+	uint64_t acc;
+	uint32_t reg0[32], reg1[32];
+	uint32_t remain, modulo, flags;
+	uint32_t flag_z, flag_n, flag_c;
+};
 
 #define DSP_RUNNING			(dsp_control & 0x01)
 
@@ -412,40 +354,162 @@ static uint32_t dsp_opcode_second_parameter;
 #define IMM_1				dsp_opcode_first_parameter
 #define IMM_2				dsp_opcode_second_parameter
 
-#define CLR_Z				(dsp_flag_z = 0)
-#define CLR_ZN				(dsp_flag_z = dsp_flag_n = 0)
-#define CLR_ZNC				(dsp_flag_z = dsp_flag_n = dsp_flag_c = 0)
-#define SET_Z(r)			(dsp_flag_z = ((r) == 0))
-#define SET_N(r)			(dsp_flag_n = (((uint32_t)(r) >> 31) & 0x01))
+#define CLR_ZNC				(dsp_flag_z = dsp_flag_n = dsp_flag_c = 0, dsp_flags_pending = false)
 #define SET_C_ADD(a,b)		(dsp_flag_c = ((uint32_t)(b) > (uint32_t)(~(a))))
 #define SET_C_SUB(a,b)		(dsp_flag_c = ((uint32_t)(b) > (uint32_t)(a)))
-#define SET_ZN(r)			SET_N(r); SET_Z(r)
-#define SET_ZNC_ADD(a,b,r)	SET_N(r); SET_Z(r); SET_C_ADD(a,b)
-#define SET_ZNC_SUB(a,b,r)	SET_N(r); SET_Z(r); SET_C_SUB(a,b)
+#define SET_ZN(r)			(dsp_flag_result = (r), dsp_flags_pending = true)
+#define SET_ZNC_ADD(a,b,r)	(SET_ZN(r), SET_C_ADD(a,b))
+#define SET_ZNC_SUB(a,b,r)	(SET_ZN(r), SET_C_SUB(a,b))
+
+// The flags as they stand right now (for the disassembly logs & the like)
+#define FLAG_Z				(DSPRISC::UpdateFlags(), dsp_flag_z)
+#define FLAG_N				(DSPRISC::UpdateFlags(), dsp_flag_n)
+#define FLAG_C				dsp_flag_c
 
 uint32_t dsp_convert_zero[32] = {
 	32, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
 	17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
 };
 
-uint8_t dsp_branch_condition_table[32 * 8];
-static uint16_t mirror_table[65536];
-static uint8_t dsp_ram_8[0x2000];
+MACHINE_STATE uint8_t dsp_branch_condition_table[32 * 8];
+static MACHINE_STATE uint16_t mirror_table[65536];
+static MACHINE_STATE uint8_t dsp_ram_8[0x2000];
 
 #define BRANCH_CONDITION(x)		dsp_branch_condition_table[(x) + ((jaguar_flags & 7) << 5)]
 
-static uint32_t dsp_in_exec = 0;
-static uint32_t dsp_releaseTimeSlice_flag = 0;
+static MACHINE_STATE uint32_t dsp_in_exec = 0;
+static MACHINE_STATE uint32_t dsp_releaseTimeSlice_flag = 0;
+static MACHINE_STATE uint64_t dsp_instructions = 0;	// Run by the interpreter
 
-FILE * dsp_fp;
+// Lockstep passes (see DSPLockstepStep()), traces & their replays
+
+enum { DSP_PASS_REFERENCE = 0, DSP_PASS_CHECKED, DSP_PASS_NONE };
+
+static MACHINE_STATE uint32_t dspPass = DSP_PASS_NONE;
+static MACHINE_STATE gzFile dspTraceFile = NULL;
+static MACHINE_STATE bool dspReplaying = false;
+static MACHINE_STATE uint64_t dspLockstepChecked = 0;
+static MACHINE_STATE uint64_t dspDivergences = 0;
+
+// Nothing outside of the DSP gets to hear about the reference pass of a
+// lockstep check, or about anything in a trace replay
+static inline bool DSPIsolated(void) { return dspPass == DSP_PASS_REFERENCE || dspReplaying; }
+
+static uint32_t DSPExternalRead(uint32_t offset, uint32_t size);
+static void DSPExternalWrite(uint32_t offset, uint32_t data, uint32_t size);
+
+//
+// The DSP, as far as the RISC core (JAGRISC.H) is concerned
+//
+struct DSPChip
+{
+	enum { WHO = DSP, DASM_TYPE = JAGUAR_DSP, RAM_BASE = DSP_WORK_RAM_BASE, RAM_SIZE = 0x2000,
+		IRQ_SOURCES = 6, HAS_STOREP = 0 };
+	typedef uint64_t MAC;							// 40 bits, really
+	typedef DSPIdleState IdleState;
+
+	static inline const char * Name(void) { return "DSP"; }
+	static inline uint32_t * Reg(void) { return dsp_reg; }
+	static inline uint32_t * AltReg(void) { return dsp_alternate_reg; }
+	static inline uint32_t & Op1(void) { return dsp_opcode_first_parameter; }
+	static inline uint32_t & Op2(void) { return dsp_opcode_second_parameter; }
+	static inline uint32_t & PC(void) { return dsp_pc; }
+	static inline MAC & Acc(void) { return dsp_acc; }
+	static inline uint32_t & Remain(void) { return dsp_remain; }
+	static inline uint32_t & DivControl(void) { return dsp_div_control; }
+	static inline uint32_t & MatrixControl(void) { return dsp_matrix_control; }
+	static inline uint32_t & PointerToMatrix(void) { return dsp_pointer_to_matrix; }
+	static inline uint32_t & Flags(void) { return dsp_flags; }
+	static inline uint32_t & Control(void) { return dsp_control; }
+	static inline uint8_t & FlagZ(void) { return dsp_flag_z; }
+	static inline uint8_t & FlagN(void) { return dsp_flag_n; }
+	static inline uint8_t & FlagC(void) { return dsp_flag_c; }
+	static inline uint32_t & FlagResult(void) { return dsp_flag_result; }
+	static inline bool & FlagsPending(void) { return dsp_flags_pending; }
+	static inline uint32_t & InExec(void) { return dsp_in_exec; }
+	static inline const uint8_t * BranchTable(void) { return dsp_branch_condition_table; }
+
+	static inline uint16_t ReadWord(uint32_t offset) { return DSPReadWord(offset, DSP); }
+	static inline uint32_t ReadLong(uint32_t offset) { return DSPReadLong(offset, DSP); }
+	static inline void WriteLong(uint32_t offset, uint32_t data) { DSPWriteLong(offset, data, DSP); }
+	static inline uint8_t ExternalReadByte(uint32_t offset) { return DSPReadByte(offset, DSP); }
+	static inline uint16_t ExternalReadWord(uint32_t offset) { return DSPReadWord(offset, DSP); }
+	static inline void ExternalWriteByte(uint32_t offset, uint8_t data) { DSPWriteByte(offset, data, DSP); }
+	static inline void ExternalWriteWord(uint32_t offset, uint16_t data) { DSPWriteWord(offset, data, DSP); }
+	static inline void UpdateRegisterBanks(void) { DSPUpdateRegisterBanks(); }
+
+	static inline uint32_t PendingIRQs(void)
+	{
+		// Interrupt latches & enables (#5 lives apart from the others)
+		uint32_t bits = ((dsp_control >> 10) & 0x20) | ((dsp_control >> 6) & 0x1F),
+			mask = ((dsp_flags >> 11) & 0x20) | ((dsp_flags >> 4) & 0x1F);
+		return bits & mask;
+	}
 
-#ifdef DSP_DEBUG_CC
-// Comparison core vars (used only for core comparison! :-)
-static uint64_t count = 0;
-static uint8_t ram1[0x2000], ram2[0x2000];
-static uint32_t regs1[64], regs2[64];
-static uint32_t ctrl1[14], ctrl2[14];
+	static inline bool Tracing(void) { return false; }
+
+	static inline bool BeginExec(int32_t & cycles)
+	{
+#ifdef DSP_SINGLE_STEPPING
+		if (dsp_control & 0x18)
+		{
+			cycles = 1;
+			dsp_control &= ~0x10;
+		}
 #endif
+//There is *no* good reason to do this here!
+//		DSPHandleIRQs();
+		dsp_releaseTimeSlice_flag = 0;
+		return true;
+	}
+
+	static inline bool MayExecute(void) { return true; }
+	static void PreInstruction(void);
+	static inline void PostInstruction(void) { dsp_instructions++; }
+	static inline bool SkipIdleLoop(void) { return true; }
+
+	static void Dispatch(uint32_t index);
+	static inline uint8_t Cycles(uint32_t index) { return dsp_opcode_cycles[index]; }
+	static inline uint32_t & OpcodeUse(uint32_t index) { return dsp_opcode_use[index]; }
+
+	static inline void SaveIdleState(IdleState & state)
+	{
+		state.acc = dsp_acc;
+		memcpy(state.reg0, dsp_reg_bank_0, sizeof(state.reg0));
+		memcpy(state.reg1, dsp_reg_bank_1, sizeof(state.reg1));
+		state.remain = dsp_remain, state.modulo = dsp_modulo, state.flags = dsp_flags;
+		state.flag_z = dsp_flag_z, state.flag_n = dsp_flag_n, state.flag_c = dsp_flag_c;
+	}
+};
+
+typedef JaguarRISC<DSPChip> DSPRISC;
+
+void (* dsp_opcode[64])() =
+{
+	DSPRISC::opcode_add,				DSPRISC::opcode_addc,				DSPRISC::opcode_addq,				DSPRISC::opcode_addqt,
+	DSPRISC::opcode_sub,				DSPRISC::opcode_subc,				DSPRISC::opcode_subq,				DSPRISC::opcode_subqt,
+	DSPRISC::opcode_neg,				DSPRISC::opcode_and,				DSPRISC::opcode_or,					DSPRISC::opcode_xor,
+	DSPRISC::opcode_not,				DSPRISC::opcode_btst,				DSPRISC::opcode_bset,				DSPRISC::opcode_bclr,
+	DSPRISC::opcode_mult,				DSPRISC::opcode_imult,				DSPRISC::opcode_imultn,				DSPRISC::opcode_resmac,
+	DSPRISC::opcode_imacn,				DSPRISC::opcode_div,				DSPRISC::opcode_abs,				DSPRISC::opcode_sh,
+	DSPRISC::opcode_shlq,				DSPRISC::opcode_shrq,				DSPRISC::opcode_sha,				DSPRISC::opcode_sharq,
+	DSPRISC::opcode_ror,				DSPRISC::opcode_rorq,				DSPRISC::opcode_cmp,				DSPRISC::opcode_cmpq,
+	dsp_opcode_subqmod,					dsp_opcode_sat16s,					DSPRISC::opcode_move,				DSPRISC::opcode_moveq,
+	DSPRISC::opcode_moveta,				DSPRISC::opcode_movefa,				DSPRISC::opcode_movei,				DSPRISC::opcode_loadb,
+	DSPRISC::opcode_loadw,				DSPRISC::opcode_load,				dsp_opcode_sat32s,					DSPRISC::opcode_load_r14_indexed,
+	DSPRISC::opcode_load_r15_indexed,	DSPRISC::opcode_storeb,				DSPRISC::opcode_storew,				DSPRISC::opcode_store,
+	dsp_opcode_mirror,					DSPRISC::opcode_store_r14_indexed,	DSPRISC::opcode_store_r15_indexed,	DSPRISC::opcode_move_pc,
+	DSPRISC::opcode_jump,				DSPRISC::opcode_jr,					DSPRISC::opcode_mmult,				DSPRISC::opcode_mtoi,
+	DSPRISC::opcode_normi,				DSPRISC::opcode_nop,				DSPRISC::opcode_load_r14_ri,		DSPRISC::opcode_load_r15_ri,
+	DSPRISC::opcode_store_r14_ri,		DSPRISC::opcode_store_r15_ri,		dsp_opcode_illegal,					dsp_opcode_addqmod,
+};
+
+inline void DSPChip::Dispatch(uint32_t index)
+{
+	dsp_opcode[index]();
+}
+
+FILE * dsp_fp;
 
 // Private function prototypes
 
@@ -453,6 +517,12 @@ void DSPDumpRegisters(void);
 void DSPDumpState(void);
 void DSPDumpDisassembly(void);
 void FlushDSPPipeline(void);
+static void DSPPipelineWriteback(PipelineStage & stage);
+static void DSPLogAccess(uint8_t type, uint32_t offset, uint32_t data, uint32_t size);
+static void DSPExecPipelined(int32_t cycles);
+static void DSPExecLockstep(int32_t cycles);
+static void DSPTraceBeginSlice(void);
+static void DSPTraceEndSlice(void);
 
 
 void dsp_reset_stats(void)
@@ -539,6 +609,9 @@ uint8_t DSPReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return (data & 0xFF);
 	}
 
+	if (who == DSP)
+		return DSPExternalRead(offset, 1);
+
 	return JaguarReadByte(offset, who);
 }
 
@@ -567,6 +640,9 @@ uint16_t DSPReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return data >> 16;
 	}
 
+	if (who == DSP)
+		return DSPExternalRead(offset, 2);
+
 	return JaguarReadWord(offset, who);
 }
 
@@ -596,6 +672,7 @@ uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 		switch (offset)
 		{
 		case 0x00:
+			DSPRISC::UpdateFlags();
 			dsp_flags = (dsp_flags & 0xFFFFFFF8) | (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
 			return dsp_flags & 0xFFFFC1FF;
 		case 0x04: return dsp_matrix_control;
@@ -612,6 +689,9 @@ uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 		return 0xFFFFFFFF;
 	}
 
+	if (who == DSP)
+		return DSPExternalRead(offset, 4);
+
 	return JaguarReadLong(offset, who);
 }
 
@@ -621,6 +701,9 @@ void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 	if (offset >= 0xF1A000 && offset <= 0xF1A0FF)
 		WriteLog("DSP: WriteByte--Attempt to write to DSP register file by %s!\n", whoName[who]);
 
+	if (who == DSP && dspPass != DSP_PASS_NONE)
+		DSPLogAccess('W', offset, data, 1);
+
 	if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE + 0x2000))
 	{
 		offset -= DSP_WORK_RAM_BASE;
@@ -653,7 +736,10 @@ void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 //	WriteLog("dsp: writing %.2x at 0x%.8x\n",data,offset);
 //Should this *ever* happen??? Shouldn't we be saying "unknown" here???
 // Well, yes, it can. There are 3 MMU users after all: 68K, GPU & DSP...!
-	JaguarWriteByte(offset, data, who);
+	if (who == DSP)
+		DSPExternalWrite(offset, data, 1);
+	else
+		JaguarWriteByte(offset, data, who);
 }
 
 
@@ -662,6 +748,10 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 	if (offset >= 0xF1A000 && offset <= 0xF1A0FF)
 		WriteLog("DSP: WriteWord--Attempt to write to DSP register file by %s!\n", whoName[who]);
 	offset &= 0xFFFFFFFE;
+
+	if (who == DSP && dspPass != DSP_PASS_NONE)
+		DSPLogAccess('W', offset, data, 2);
+
 /*if (offset == 0xF1BCF4)
 {
 	WriteLog("DSPWriteWord: Writing to 0xF1BCF4... %04X -> %04X\n", GET16(dsp_ram_8, 0x0CF4), data);
@@ -674,8 +764,7 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 	WriteLog("DSP: %s is writing %04X at location 0xF1B2F4 (DSP_PC: %08X)...\n", whoName[who], data, dsp_pc);
 }//*/
 		offset -= DSP_WORK_RAM_BASE;
-		dsp_ram_8[offset] = data >> 8;
-		dsp_ram_8[offset+1] = data & 0xFF;
+		SET16(dsp_ram_8, offset, data);
 //This is rather stupid! !!! FIX !!!
 /*		if (dsp_in_exec == 0)
 		{
@@ -683,12 +772,6 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 			m68k_end_timeslice();
 			dsp_releaseTimeslice();
 		}*/
-//CC only!
-#ifdef DSP_DEBUG_CC
-SET16(ram1, offset, data),
-SET16(ram2, offset, data);
-#endif
-//!!!!!!!!
 		return;
 	}
 	else if ((offset >= DSP_CONTROL_RAM_BASE) && (offset < DSP_CONTROL_RAM_BASE+0x20))
@@ -715,7 +798,10 @@ SET16(ram2, offset, data);
 		return;
 	}
 
-	JaguarWriteWord(offset, data, who);
+	if (who == DSP)
+		DSPExternalWrite(offset, data, 2);
+	else
+		JaguarWriteWord(offset, data, who);
 }
 
 
@@ -729,6 +815,10 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 		WriteLog("DSP: WriteLong--Attempt to write to DSP register file by %s!\n", whoName[who]);
 	// ??? WHY ???
 	offset &= 0xFFFFFFFC;
+
+	if (who == DSP && dspPass != DSP_PASS_NONE)
+		DSPLogAccess('W', offset, data, 4);
+
 /*if (offset == 0xF1BCF4)
 {
 	WriteLog("DSPWriteLong: Writing to 0xF1BCF4... %08X -> %08X\n", GET32(dsp_ram_8, 0x0CF4), data);
@@ -742,12 +832,6 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 }//*/
 		offset -= DSP_WORK_RAM_BASE;
 		SET32(dsp_ram_8, offset, data);
-//CC only!
-#ifdef DSP_DEBUG_CC
-SET32(ram1, offset, data),
-SET32(ram2, offset, data);
-#endif
-//!!!!!!!!
 		return;
 	}
 	else if (offset >= DSP_CONTROL_RAM_BASE && offset <= (DSP_CONTROL_RAM_BASE + 0x1F))
@@ -766,6 +850,7 @@ SET32(ram2, offset, data);
 			//       only the IRQ logic can set it. So we mask it out here to
 			//       prevent problems...
 			dsp_flags = data & (~IMASK);
+			dsp_flags_pending = false;
 			dsp_flag_z = dsp_flags & 0x01;
 			dsp_flag_c = (dsp_flags >> 1) & 0x01;
 			dsp_flag_n = (dsp_flags >> 2) & 0x01;
@@ -790,12 +875,6 @@ SET32(ram2, offset, data);
 #ifdef DSP_DEBUG
 			WriteLog("DSP: Setting DSP PC to %08X by %s%s\n", dsp_pc, whoName[who], (DSP_RUNNING ? " (DSP is RUNNING!)" : ""));//*/
 #endif
-//CC only!
-#ifdef DSP_DEBUG_CC
-if (who != DSP)
-	ctrl1[0] = ctrl2[0] = data;
-#endif
-//!!!!!!!!
 			break;
 		case 0x14:
 		{
@@ -812,7 +891,7 @@ WriteLog("Write to DSP CTRL by %s: %08X (DSP PC=$%08X, IMASK=%X)\n", whoName[who
 #endif
 
 #warning "!!! DSP IRQs that go to the 68K have to be routed thru TOM !!! FIX !!!"
-				if (JERRYIRQEnabled(IRQ2_DSP))
+				if (!DSPIsolated() && JERRYIRQEnabled(IRQ2_DSP))
 				{
 					JERRYSetPendingIRQ(IRQ2_DSP);
 					DSPReleaseTimeslice();
@@ -830,7 +909,9 @@ WriteLog("Write to DSP CTRL by %s: %08X (DSP PC=$%08X, IMASK=%X)\n", whoName[who
 WriteLog("     R28-31 = $%08X $%08X $%08X $%08X", dsp_reg_bank_0[28], dsp_reg_bank_0[29], dsp_reg_bank_0[30], dsp_reg_bank_0[31]);
 DSPDumpState();
 //#endif
-				m68k_end_timeslice();
+				if (!DSPIsolated())
+					m68k_end_timeslice();
+
 //				DSPReleaseTimeslice();
 				DSPSetIRQLine(DSPIRQ_CPU, ASSERT_LINE);
 				data &= ~DSPINT0;
@@ -845,12 +926,6 @@ DSPDumpState();
 			// Protect writes to VERSION and the interrupt latches...
 			uint32_t mask = VERSION | INT_LAT0 | INT_LAT1 | INT_LAT2 | INT_LAT3 | INT_LAT4 | INT_LAT5;
 			dsp_control = (dsp_control & mask) | (data & ~mask);
-//CC only!
-#ifdef DSP_DEBUG_CC
-if (who != DSP)
-	ctrl1[8] = ctrl2[8] = dsp_control;
-#endif
-//!!!!!!!!
 
 			// if dsp wasn't running but is now running
 			// execute a few cycles
@@ -913,7 +988,10 @@ if (data == 0xFFFFF800)
 
 //if (offset > 0xF1FFFF)
 //	badWrite = true;
-	JaguarWriteLong(offset, data, who);
+	if (who == DSP)
+		DSPExternalWrite(offset, data, 4);
+	else
+		JaguarWriteLong(offset, data, who);
 }
 
 
@@ -999,40 +1077,9 @@ WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", p
 WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
 WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister, dsp_opcode_str[pipeline[plPtrWrite].opcode]);
 #endif
-	if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-	{
-		if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-				dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-			else
-			{
-				if (pipeline[plPtrWrite].type == TYPE_BYTE)
-					JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				else if (pipeline[plPtrWrite].type == TYPE_WORD)
-					JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				else
-					JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-			}
-		}
-
-#ifndef NEW_SCOREBOARD
-		if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-			scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-		if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-			if (scoreboard[pipeline[plPtrWrite].operand2])
-				scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-	}
+	DSPPipelineWriteback(pipeline[plPtrWrite]);
 
 	dsp_flags |= IMASK;
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl2[4] = dsp_flags;
-#endif
-//!!!!!!!!
 	DSPUpdateRegisterBanks();
 #ifdef DSP_DEBUG_IRQ
 //	WriteLog(" [PC will return to %08X, R31 = %08X]\n", dsp_pc, dsp_reg[31]);
@@ -1043,11 +1090,6 @@ ctrl2[4] = dsp_flags;
 	// move   pc,r30		; address of interrupted code
 	// store  r30,(r31)     ; store return address
 	dsp_reg[31] -= 4;
-//CC only!
-#ifdef DSP_DEBUG_CC
-regs2[31] -= 4;
-#endif
-//!!!!!!!!
 //This might not come back to the right place if the instruction was MOVEI #. !!! FIX !!!
 //But, then again, JTRM says that it adds two regardless of what the instruction was...
 //It missed the place that it was supposed to come back to, so this is WRONG!
@@ -1065,21 +1107,11 @@ regs2[31] -= 4;
 
 //	DSPWriteLong(dsp_reg[31], dsp_pc - 2, DSP);
 	DSPWriteLong(dsp_reg[31], dsp_pc - 2 - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)), DSP);
-//CC only!
-#ifdef DSP_DEBUG_CC
-SET32(ram2, regs2[31] - 0xF1B000, dsp_pc - 2 - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)));
-#endif
-//!!!!!!!!
 
 	// movei  #service_address,r30  ; pointer to ISR entry
 	// jump  (r30)					; jump to ISR
 	// nop
 	dsp_pc = dsp_reg[30] = DSP_WORK_RAM_BASE + (which * 0x10);
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl2[0] = regs2[30] = dsp_pc;
-#endif
-//!!!!!!!!
 	FlushDSPPipeline();
 }
 
@@ -1089,107 +1121,9 @@ ctrl2[0] = regs2[30] = dsp_pc;
 //
 void DSPHandleIRQsNP(void)
 {
-//CC only!
-#ifdef DSP_DEBUG_CC
-		memcpy(dsp_ram_8, ram1, 0x2000);
-		memcpy(dsp_reg_bank_0, regs1, 32 * 4);
-		memcpy(dsp_reg_bank_1, &regs1[32], 32 * 4);
-		dsp_pc					= ctrl1[0];
-		dsp_acc					= ctrl1[1];
-		dsp_remain				= ctrl1[2];
-		dsp_modulo				= ctrl1[3];
-		dsp_flags				= ctrl1[4];
-		dsp_matrix_control		= ctrl1[5];
-		dsp_pointer_to_matrix	= ctrl1[6];
-		dsp_data_organization	= ctrl1[7];
-		dsp_control				= ctrl1[8];
-		dsp_div_control			= ctrl1[9];
-		IMASKCleared			= ctrl1[10];
-		dsp_flag_z				= ctrl1[11];
-		dsp_flag_n				= ctrl1[12];
-		dsp_flag_c				= ctrl1[13];
-DSPUpdateRegisterBanks();
-#endif
-//!!!!!!!!
-	if (dsp_flags & IMASK) 							// Bail if we're already inside an interrupt
-		return;
-
-	// Get the active interrupt bits (latches) & interrupt mask (enables)
-	uint32_t bits = ((dsp_control >> 10) & 0x20) | ((dsp_control >> 6) & 0x1F),
-		mask = ((dsp_flags >> 11) & 0x20) | ((dsp_flags >> 4) & 0x1F);
-
-//	WriteLog("dsp: bits=%.2x mask=%.2x\n",bits,mask);
-	bits &= mask;
-
-	if (!bits)										// Bail if nothing is enabled
-		return;
-
-	int which = 0;									// Determine which interrupt
-	if (bits & 0x01)
-		which = 0;
-	if (bits & 0x02)
-		which = 1;
-	if (bits & 0x04)
-		which = 2;
-	if (bits & 0x08)
-		which = 3;
-	if (bits & 0x10)
-		which = 4;
-	if (bits & 0x20)
-		which = 5;
-
-	dsp_flags |= IMASK;		// Force Bank #0
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl1[4] = dsp_flags;
-#endif
-//!!!!!!!!
-#ifdef DSP_DEBUG_IRQ
-	WriteLog("DSP: Bank 0: R30=%08X, R31=%08X\n", dsp_reg_bank_0[30], dsp_reg_bank_0[31]);
-	WriteLog("DSP: Bank 1: R30=%08X, R31=%08X\n", dsp_reg_bank_1[30], dsp_reg_bank_1[31]);
-#endif
-	DSPUpdateRegisterBanks();
-#ifdef DSP_DEBUG_IRQ
-	WriteLog("DSP: Bank 0: R30=%08X, R31=%08X\n", dsp_reg_bank_0[30], dsp_reg_bank_0[31]);
-	WriteLog("DSP: Bank 1: R30=%08X, R31=%08X\n", dsp_reg_bank_1[30], dsp_reg_bank_1[31]);
-#endif
-
-#ifdef DSP_DEBUG_IRQ
-	WriteLog("DSP: Generating interrupt #%i...", which);
-	WriteLog(" [PC will return to %08X, R31 = %08X]\n", dsp_pc, dsp_reg[31]);
-#endif
-
-	// subqt  #4,r31		; pre-decrement stack pointer
-	// move   pc,r30		; address of interrupted code
-	// store  r30,(r31)     ; store return address
-	dsp_reg[31] -= 4;
-	dsp_reg[30] = dsp_pc - 2; // -2 because we've executed the instruction already
-
-//CC only!
-#ifdef DSP_DEBUG_CC
-regs1[31] -= 4;
-#endif
-//!!!!!!!!
-//	DSPWriteLong(dsp_reg[31], dsp_pc - 2, DSP);
-	DSPWriteLong(dsp_reg[31], dsp_reg[30], DSP);
-//CC only!
-#ifdef DSP_DEBUG_CC
-SET32(ram1, regs1[31] - 0xF1B000, dsp_pc - 2);
-#endif
-//!!!!!!!!
-
-	// movei  #service_address,r30  ; pointer to ISR entry
-	// jump  (r30)					; jump to ISR
-	// nop
-	dsp_pc = dsp_reg[30] = DSP_WORK_RAM_BASE + (which * 0x10);
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl1[0] = regs1[30] = dsp_pc;
-#endif
-//!!!!!!!!
+	DSPRISC::HandleIRQs();
 }
 
-
 //
 // Set the specified DSP IRQ line to a given state
 //
@@ -1198,24 +1132,15 @@ void DSPSetIRQLine(int irqline, int state)
 //NOTE: This doesn't take INT_LAT5 into account. !!! FIX !!!
 	uint32_t mask = INT_LAT0 << irqline;
 	dsp_control &= ~mask;							// Clear the latch bit
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl1[8] = ctrl2[8] = dsp_control;
-#endif
-//!!!!!!!!
 
 	if (state)
 	{
 		dsp_control |= mask;						// Set the latch bit
-#warning !!! No checking done to see if we're using pipelined DSP or not !!!
-//		DSPHandleIRQs();
-		DSPHandleIRQsNP();
-//CC only!
-#ifdef DSP_DEBUG_CC
-ctrl1[8] = ctrl2[8] = dsp_control;
-DSPHandleIRQsNP();
-#endif
-//!!!!!!!!
+
+		if (vjs.dspEngine == DSP_ENGINE_PIPELINED)
+			DSPHandleIRQs();
+		else
+			DSPHandleIRQsNP();
 	}
 
 	// Not sure if this is correct behavior, but according to JTRM,
@@ -1239,6 +1164,8 @@ void DSPInit(void)
 
 	dsp_build_branch_condition_table();
 	DSPReset();
+	dsp_instructions = 0;
+	dspLockstepChecked = dspDivergences = 0;
 }
 
 
@@ -1292,7 +1219,7 @@ void DSPDumpDisassembly(void)
 void DSPDumpRegisters(void)
 {
 //Shoud add modulus, etc to dump here...
-	WriteLog("\n---[DSP flags: NCZ %d%d%d, DSP PC: %08X]------------\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_pc);
+	WriteLog("\n---[DSP flags: NCZ %d%d%d, DSP PC: %08X]------------\n", FLAG_N, FLAG_C, FLAG_Z, dsp_pc);
 	WriteLog("\nRegisters bank 0\n");
 
 	for(int j=0; j<8; j++)
@@ -1322,7 +1249,7 @@ void DSPDumpState(void)
 	WriteLog("\n\n---------------------------------------------------------------------\n");
 	WriteLog("DSP I/O Registers\n");
 	WriteLog("---------------------------------------------------------------------\n");
-	WriteLog("F1A1%02X   (D_FLAGS): $%06X\n", 0x00, (dsp_flags & 0xFFFFFFF8) | (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z);
+	WriteLog("F1A1%02X   (D_FLAGS): $%06X\n", 0x00, (dsp_flags & 0xFFFFFFF8) | (FLAG_N << 2) | (FLAG_C << 1) | FLAG_Z);
 	WriteLog("F1A1%02X    (D_MTXC): $%04X\n", 0x04, dsp_matrix_control);
 	WriteLog("F1A1%02X    (D_MTXA): $%04X\n", 0x08, dsp_pointer_to_matrix);
 	WriteLog("F1A1%02X     (D_END): $%02X\n", 0x0C, dsp_data_organization);
@@ -1354,6 +1281,13 @@ void DSPDumpState(void)
 void DSPDone(void)
 {
 	DSPDumpState();
+	WriteLog("DSP: Skipped %llu idle cycles\n", (unsigned long long)DSPRISC::IdleCycles());
+
+	if (vjs.dspEngine == DSP_ENGINE_LOCKSTEP)
+		WriteLog("DSP: Lockstep checked %llu instructions, %llu failed\n",
+			(unsigned long long)dspLockstepChecked, (unsigned long long)dspDivergences);
+
+	DSPTraceStop();
 
 	static char buffer[512];
 	int j = DSP_WORK_RAM_BASE;
@@ -1377,203 +1311,49 @@ void DSPDone(void)
 
 
 //
-// DSP comparison core...
+// See STATE.CPP. The pipelined core's pipeline goes in too, but not anything
+// that only lasts as long as a trace or a lockstep check.
 //
-#ifdef DSP_DEBUG_CC
-static uint16_t lastExec;
-void DSPExecComp(int32_t cycles)
-{
-	while (cycles > 0 && DSP_RUNNING)
-	{
-		// Load up vars for non-pipelined core
-		memcpy(dsp_ram_8, ram1, 0x2000);
-		memcpy(dsp_reg_bank_0, regs1, 32 * 4);
-		memcpy(dsp_reg_bank_1, &regs1[32], 32 * 4);
-		dsp_pc					= ctrl1[0];
-		dsp_acc					= ctrl1[1];
-		dsp_remain				= ctrl1[2];
-		dsp_modulo				= ctrl1[3];
-		dsp_flags				= ctrl1[4];
-		dsp_matrix_control		= ctrl1[5];
-		dsp_pointer_to_matrix	= ctrl1[6];
-		dsp_data_organization	= ctrl1[7];
-		dsp_control				= ctrl1[8];
-		dsp_div_control			= ctrl1[9];
-		IMASKCleared			= ctrl1[10];
-		dsp_flag_z				= ctrl1[11];
-		dsp_flag_n				= ctrl1[12];
-		dsp_flag_c				= ctrl1[13];
-DSPUpdateRegisterBanks();
-
-		// Decrement cycles based on non-pipelined core...
-		uint16_t instr1 = DSPReadWord(dsp_pc, DSP);
-		cycles -= dsp_opcode_cycles[instr1 >> 10];
-
-//WriteLog("\tAbout to execute non-pipelined core on tick #%u (DSP_PC=%08X)...\n", (uint32_t)count, dsp_pc);
-		DSPExec(1);									// Do *one* instruction
-
-		// Save vars
-		memcpy(ram1, dsp_ram_8, 0x2000);
-		memcpy(regs1, dsp_reg_bank_0, 32 * 4);
-		memcpy(&regs1[32], dsp_reg_bank_1, 32 * 4);
-		ctrl1[0]  = dsp_pc;
-		ctrl1[1]  = dsp_acc;
-		ctrl1[2]  = dsp_remain;
-		ctrl1[3]  = dsp_modulo;
-		ctrl1[4]  = dsp_flags;
-		ctrl1[5]  = dsp_matrix_control;
-		ctrl1[6]  = dsp_pointer_to_matrix;
-		ctrl1[7]  = dsp_data_organization;
-		ctrl1[8]  = dsp_control;
-		ctrl1[9]  = dsp_div_control;
-		ctrl1[10] = IMASKCleared;
-		ctrl1[11] = dsp_flag_z;
-		ctrl1[12] = dsp_flag_n;
-		ctrl1[13] = dsp_flag_c;
-
-		// Load up vars for pipelined core
-		memcpy(dsp_ram_8, ram2, 0x2000);
-		memcpy(dsp_reg_bank_0, regs2, 32 * 4);
-		memcpy(dsp_reg_bank_1, &regs2[32], 32 * 4);
-		dsp_pc					= ctrl2[0];
-		dsp_acc					= ctrl2[1];
-		dsp_remain				= ctrl2[2];
-		dsp_modulo				= ctrl2[3];
-		dsp_flags				= ctrl2[4];
-		dsp_matrix_control		= ctrl2[5];
-		dsp_pointer_to_matrix	= ctrl2[6];
-		dsp_data_organization	= ctrl2[7];
-		dsp_control				= ctrl2[8];
-		dsp_div_control			= ctrl2[9];
-		IMASKCleared			= ctrl2[10];
-		dsp_flag_z				= ctrl2[11];
-		dsp_flag_n				= ctrl2[12];
-		dsp_flag_c				= ctrl2[13];
-DSPUpdateRegisterBanks();
-
-//WriteLog("\tAbout to execute pipelined core on tick #%u (DSP_PC=%08X)...\n", (uint32_t)count, dsp_pc);
-		DSPExecP2(1);								// Do *one* instruction
-
-		// Save vars
-		memcpy(ram2, dsp_ram_8, 0x2000);
-		memcpy(regs2, dsp_reg_bank_0, 32 * 4);
-		memcpy(&regs2[32], dsp_reg_bank_1, 32 * 4);
-		ctrl2[0]  = dsp_pc;
-		ctrl2[1]  = dsp_acc;
-		ctrl2[2]  = dsp_remain;
-		ctrl2[3]  = dsp_modulo;
-		ctrl2[4]  = dsp_flags;
-		ctrl2[5]  = dsp_matrix_control;
-		ctrl2[6]  = dsp_pointer_to_matrix;
-		ctrl2[7]  = dsp_data_organization;
-		ctrl2[8]  = dsp_control;
-		ctrl2[9]  = dsp_div_control;
-		ctrl2[10] = IMASKCleared;
-		ctrl2[11] = dsp_flag_z;
-		ctrl2[12] = dsp_flag_n;
-		ctrl2[13] = dsp_flag_c;
-
-		if (instr1 != lastExec)
-		{
-//			WriteLog("\nCores diverged at instruction tick #%u!\nAttemping to synchronize...\n\n", count);
-
-//			uint32_t ppc = ctrl2[0] - (pipeline[plPtrExec].opcode == 38 ? 6 : (pipeline[plPtrExec].opcode == PIPELINE_STALL ? 0 : 2)) - (pipeline[plPtrWrite].opcode == 38 ? 6 : (pipeline[plPtrWrite].opcode == PIPELINE_STALL ? 0 : 2));
-//WriteLog("[DSP_PC1=%08X, DSP_PC2=%08X]\n", ctrl1[0], ppc);
-//			if (ctrl1[0] < ppc)						// P ran ahead of NP
-//How to test this crap???
-//			if (1)
-			{
-		DSPExecP2(1);								// Do one more instruction
-
-		// Save vars
-		memcpy(ram2, dsp_ram_8, 0x2000);
-		memcpy(regs2, dsp_reg_bank_0, 32 * 4);
-		memcpy(&regs2[32], dsp_reg_bank_1, 32 * 4);
-		ctrl2[0]  = dsp_pc;
-		ctrl2[1]  = dsp_acc;
-		ctrl2[2]  = dsp_remain;
-		ctrl2[3]  = dsp_modulo;
-		ctrl2[4]  = dsp_flags;
-		ctrl2[5]  = dsp_matrix_control;
-		ctrl2[6]  = dsp_pointer_to_matrix;
-		ctrl2[7]  = dsp_data_organization;
-		ctrl2[8]  = dsp_control;
-		ctrl2[9]  = dsp_div_control;
-		ctrl2[10] = IMASKCleared;
-		ctrl2[11] = dsp_flag_z;
-		ctrl2[12] = dsp_flag_n;
-		ctrl2[13] = dsp_flag_c;
-			}
-//			else									// NP ran ahead of P
-		if (instr1 != lastExec)						// Must be the other way...
-
-			{
-		// Load up vars for non-pipelined core
-		memcpy(dsp_ram_8, ram1, 0x2000);
-		memcpy(dsp_reg_bank_0, regs1, 32 * 4);
-		memcpy(dsp_reg_bank_1, &regs1[32], 32 * 4);
-		dsp_pc					= ctrl1[0];
-		dsp_acc					= ctrl1[1];
-		dsp_remain				= ctrl1[2];
-		dsp_modulo				= ctrl1[3];
-		dsp_flags				= ctrl1[4];
-		dsp_matrix_control		= ctrl1[5];
-		dsp_pointer_to_matrix	= ctrl1[6];
-		dsp_data_organization	= ctrl1[7];
-		dsp_control				= ctrl1[8];
-		dsp_div_control			= ctrl1[9];
-		IMASKCleared			= ctrl1[10];
-		dsp_flag_z				= ctrl1[11];
-		dsp_flag_n				= ctrl1[12];
-		dsp_flag_c				= ctrl1[13];
-DSPUpdateRegisterBanks();
-
-for(int k=0; k<2; k++)
-{
-		// Decrement cycles based on non-pipelined core...
-		instr1 = DSPReadWord(dsp_pc, DSP);
-		cycles -= dsp_opcode_cycles[instr1 >> 10];
-
-//WriteLog("\tAbout to execute non-pipelined core on tick #%u (DSP_PC=%08X)...\n", (uint32_t)count, dsp_pc);
-		DSPExec(1);									// Do *one* instruction
-}
-
-		// Save vars
-		memcpy(ram1, dsp_ram_8, 0x2000);
-		memcpy(regs1, dsp_reg_bank_0, 32 * 4);
-		memcpy(&regs1[32], dsp_reg_bank_1, 32 * 4);
-		ctrl1[0]  = dsp_pc;
-		ctrl1[1]  = dsp_acc;
-		ctrl1[2]  = dsp_remain;
-		ctrl1[3]  = dsp_modulo;
-		ctrl1[4]  = dsp_flags;
-		ctrl1[5]  = dsp_matrix_control;
-		ctrl1[6]  = dsp_pointer_to_matrix;
-		ctrl1[7]  = dsp_data_organization;
-		ctrl1[8]  = dsp_control;
-		ctrl1[9]  = dsp_div_control;
-		ctrl1[10] = IMASKCleared;
-		ctrl1[11] = dsp_flag_z;
-		ctrl1[12] = dsp_flag_n;
-		ctrl1[13] = dsp_flag_c;
-			}
-		}
-
-		if (instr1 != lastExec)
-		{
-			WriteLog("\nCores diverged at instruction tick #%u!\nStopped!\n\n", count);
-
-			WriteLog("Instruction for non-pipelined core: %04X\n", instr1);
-			WriteLog("Instruction for pipelined core: %04X\n", lastExec);
-
-			log_done();
-			exit(1);
-		}
-
-		count++;
-	}
+void DSPSnapshot(void)
+{
+	DSPRISC::IdleTracker idle;
+	DSPRISC::SaveIdleTracker(idle);
+
+	SNAPSHOT(dsp_ram_8);
+	SNAPSHOT(dsp_reg_bank_0);
+	SNAPSHOT(dsp_reg_bank_1);
+	SNAPSHOT(dsp_pc);
+	SNAPSHOT(dsp_acc);
+	SNAPSHOT(dsp_remain);
+	SNAPSHOT(dsp_modulo);
+	SNAPSHOT(dsp_flags);
+	SNAPSHOT(dsp_matrix_control);
+	SNAPSHOT(dsp_pointer_to_matrix);
+	SNAPSHOT(dsp_data_organization);
+	SNAPSHOT(dsp_control);
+	SNAPSHOT(dsp_div_control);
+	SNAPSHOT(dsp_flag_z);
+	SNAPSHOT(dsp_flag_n);
+	SNAPSHOT(dsp_flag_c);
+	SNAPSHOT(dsp_flag_result);
+	SNAPSHOT(dsp_flags_pending);
+	SNAPSHOT(dsp_opcode_first_parameter);
+	SNAPSHOT(dsp_opcode_second_parameter);
+	SNAPSHOT(dsp_opcode_use);
+	SNAPSHOT(dsp_releaseTimeSlice_flag);
+	SNAPSHOT(dsp_instructions);
+	SNAPSHOT(scoreboard);
+	SNAPSHOT(plPtrFetch);
+	SNAPSHOT(plPtrRead);
+	SNAPSHOT(plPtrExec);
+	SNAPSHOT(plPtrWrite);
+	SNAPSHOT(pipeline);
+	SNAPSHOT(IMASKCleared);
+	SNAPSHOT(idle);
+
+	DSPRISC::RestoreIdleTracker(idle);
+	DSPUpdateRegisterBanks();
 }
-#endif
 
 
 //
@@ -1585,22 +1365,11 @@ for(int k=0; k<2; k++)
 static bool inLoop = false;
 uint32_t loopExitAddr;
 #endif
-void DSPExec(int32_t cycles)
+//
+// Run before each instruction by the RISC core's execution loop
+//
+void DSPChip::PreInstruction(void)
 {
-#ifdef DSP_SINGLE_STEPPING
-	if (dsp_control & 0x18)
-	{
-		cycles = 1;
-		dsp_control &= ~0x10;
-	}
-#endif
-//There is *no* good reason to do this here!
-//	DSPHandleIRQs();
-	dsp_releaseTimeSlice_flag = 0;
-	dsp_in_exec++;
-
-	while (cycles > 0 && DSP_RUNNING)
-	{
 #ifdef DSP_DEBUG_CDROM
 if (startCDROMDebug)
 {
@@ -1613,16 +1382,12 @@ if (startCDROMDebug)
 
 	uint16_t opcode = DSPReadWord(dsp_pc, DSP);
 	uint16_t index = opcode >> 10;
-	dsp_opcode_first_parameter = (opcode >> 5) & 0x1F;
-	dsp_opcode_second_parameter = opcode & 0x1F;
 
 	if (index == 53)	// JR
 	{
-		uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
-
-		if (BRANCH_CONDITION(IMM_2))
+		if (DSPRISC::BranchCondition(opcode & 0x1F))
 		{
-			if (IMM_1 & 0x10)	// We're branching backward...
+			if (opcode & 0x200)	// We're branching backward...
 				inLoop = true;
 		}
 		else
@@ -1630,1439 +1395,987 @@ if (startCDROMDebug)
 	}
 }
 #endif
-/*extern uint32_t totalFrames;
-//F1B2F6: LOAD   (R14+$04), R24 [NCZ:001, R14+$04=00F20018, R24=FFFFFFFF] -> Jaguar: Unknown word read at 00F20018 by DSP (M68K PC=00E32E)
-//-> 43 + 1 + 24 -> $2B + $01 + $18 -> 101011 00001 11000 -> 1010 1100 0011 1000 -> AC38
-//C470 -> 1100 0100 0111 0000 -> 110001 00011 10000 -> 49, 3, 16 -> STORE R16, (R14+$0C)
-//F1B140:
-if (totalFrames >= 377 && GET16(dsp_ram_8, 0x0002F6) == 0xAC38 && dsp_pc == 0xF1B140)
-{
-	doDSPDis = true;
-	WriteLog("Starting disassembly at frame #%u...\n", totalFrames);
-}
-if (dsp_pc == 0xF1B092)
-	doDSPDis = false;//*/
-/*if (dsp_pc == 0xF1B140)
-	doDSPDis = true;//*/
 
-		if (IMASKCleared)						// If IMASK was cleared,
-		{
+	if (IMASKCleared)						// If IMASK was cleared,
+	{
 #ifdef DSP_DEBUG_IRQ
-			WriteLog("DSP: Finished interrupt. PC=$%06X\n", dsp_pc);
+		WriteLog("DSP: Finished interrupt. PC=$%06X\n", dsp_pc);
 #endif
-			DSPHandleIRQsNP();					// See if any other interrupts are pending!
-			IMASKCleared = false;
-		}
+		DSPHandleIRQsNP();					// See if any other interrupts are pending!
+		IMASKCleared = false;
+	}
+}
 
-/*if (badWrite)
-{
-	WriteLog("\nDSP: Encountered bad write in Atari Synth module. PC=%08X, R15=%08X\n", dsp_pc, dsp_reg[15]);
-	for(int i=0; i<80; i+=4)
-		WriteLog("     %08X: %08X\n", dsp_reg[15]+i, JaguarReadLong(dsp_reg[15]+i));
-	WriteLog("\n");
-}//*/
-/*if (dsp_pc == 0xF1B55E)
+
+uint64_t DSPGetIdleCycles(void)
 {
-	WriteLog("DSP: At $F1B55E--R15 = %08X at %u ms%s...\n", dsp_reg[15], SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-}//*/
-/*if (dsp_pc == 0xF1B7D2)	// Start here???
-	doDSPDis = true;
-pcQueue[ptrPCQ++] = dsp_pc;
-ptrPCQ %= 32;*/
-		uint16_t opcode = DSPReadWord(dsp_pc, DSP);
-		uint32_t index = opcode >> 10;
-		dsp_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		dsp_opcode_second_parameter = opcode & 0x1F;
-		dsp_pc += 2;
-		dsp_opcode[index]();
-		dsp_opcode_use[index]++;
-		cycles -= dsp_opcode_cycles[index];
-/*if (dsp_reg_bank_0[20] == 0xF1A100 & !R20Set)
-{
-	WriteLog("DSP: R20 set to $F1A100 at %u ms%s...\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-	R20Set = true;
-}
-if (dsp_reg_bank_0[20] != 0xF1A100 && R20Set)
-{
-	WriteLog("DSP: R20 corrupted at %u ms from starting%s!\nAborting!\n", SDL_GetTicks(), (dsp_flags & IMASK ? " (inside interrupt)" : ""));
-	DSPDumpRegisters();
-	DSPDumpDisassembly();
-	exit(1);
+	return DSPRISC::IdleCycles();
 }
-if ((dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFE) && !tripwire)
+
+
+void DSPExec(int32_t cycles)
 {
-	char buffer[512];
-	WriteLog("DSP: Jumping outside of DSP RAM at %u ms. Register dump:\n", SDL_GetTicks());
-	DSPDumpRegisters();
-	tripwire = true;
-	WriteLog("\nBacktrace:\n");
-	for(int i=0; i<32; i++)
-	{
-		dasmjag(JAGUAR_DSP, buffer, pcQueue[(ptrPCQ + i) % 32]);
-		WriteLog("\t%08X: %s\n", pcQueue[(ptrPCQ + i) % 32], buffer);
-	}
-	WriteLog("\n");
-}*/
-	}
+	// Traces start each (outermost) timeslice with a snapshot of the DSP.
+	// Frames that are only looked ahead at (see JAGUAR.CPP) are left out.
+	bool traced = (dspTraceFile != NULL) && (dsp_in_exec == 0) && DSP_RUNNING
+		&& !jaguarRunningAhead;
 
-	dsp_in_exec--;
+	if (traced)
+		DSPTraceBeginSlice();
+
+	if (vjs.dspEngine == DSP_ENGINE_PIPELINED)
+		DSPExecPipelined(cycles);
+	else if (vjs.dspEngine == DSP_ENGINE_LOCKSTEP)
+		DSPExecLockstep(cycles);
+	else
+		DSPRISC::Exec(cycles);
+
+	if (traced)
+		DSPTraceEndSlice();
 }
 
 
 //
-// DSP opcode handlers
+// DSP opcode handlers (just the ones the GPU doesn't have; the rest are
+// shared with it, in JAGRISC.H)
 //
 
-// There is a problem here with interrupt handlers the JUMP and JR instructions that
-// can cause trouble because an interrupt can occur *before* the instruction following the
-// jump can execute... !!! FIX !!!
-static void dsp_opcode_jump(void)
+void dsp_opcode_addqmod(void)
 {
-#ifdef DSP_DIS_JUMP
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
+#ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", dsp_pc-2, condition[IMM_2], IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM);
+		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN, dsp_modulo);
 #endif
-	// normalize flags
-/*	dsp_flag_c=dsp_flag_c?1:0;
-	dsp_flag_z=dsp_flag_z?1:0;
-	dsp_flag_n=dsp_flag_n?1:0;*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
-	{
-#ifdef DSP_DIS_JUMP
+	uint32_t r1 = dsp_convert_zero[IMM_1];
+	uint32_t r2 = RN;
+	uint32_t res = r2 + r1;
+	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
+	RN = res;
+	SET_ZNC_ADD(r2, r1, res);
+#ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("Branched!\n");
-#endif
-		uint32_t delayed_pc = RM;
-		DSPExec(1);
-		dsp_pc = delayed_pc;
-	}
-#ifdef DSP_DIS_JUMP
-	else
-		if (doDSPDis)
-			WriteLog("Branch NOT taken.\n");
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN);
 #endif
 }
 
+void dsp_opcode_subqmod(void)
+{
+	uint32_t r1 = dsp_convert_zero[IMM_1];
+	uint32_t r2 = RN;
+	uint32_t res = r2 - r1;
+	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
+	RN = res;
+
+	SET_ZNC_SUB(r2, r1, res);
+}
 
-static void dsp_opcode_jr(void)
+void dsp_opcode_mirror(void)
 {
-#ifdef DSP_DIS_JR
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doDSPDis)
-		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", dsp_pc-2, condition[IMM_2], dsp_pc+((IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1) * 2), dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-	// normalize flags
-/*	dsp_flag_c=dsp_flag_c?1:0;
-	dsp_flag_z=dsp_flag_z?1:0;
-	dsp_flag_n=dsp_flag_n?1:0;*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
-	{
-#ifdef DSP_DIS_JR
-	if (doDSPDis)
-		WriteLog("Branched!\n");
-#endif
-		int32_t offset = (IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1);		// Sign extend IMM_1
-		int32_t delayed_pc = dsp_pc + (offset * 2);
-		DSPExec(1);
-		dsp_pc = delayed_pc;
-	}
-#ifdef DSP_DIS_JR
-	else
-		if (doDSPDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
-}
-
-
-static void dsp_opcode_add(void)
-{
-#ifdef DSP_DIS_ADD
-	if (doDSPDis)
-		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM;
-	SET_ZNC_ADD(RN, RM, res);
-	RN = res;
-#ifdef DSP_DIS_ADD
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_addc(void)
-{
-#ifdef DSP_DIS_ADDC
-	if (doDSPDis)
-		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM + dsp_flag_c;
-	uint32_t carry = dsp_flag_c;
-//	SET_ZNC_ADD(RN, RM, res); //???BUG??? Yes!
-	SET_ZNC_ADD(RN + carry, RM, res);
-//	SET_ZNC_ADD(RN, RM + carry, res);
-	RN = res;
-#ifdef DSP_DIS_ADDC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_addq(void)
-{
-#ifdef DSP_DIS_ADDQ
-	if (doDSPDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN + r1;
-	CLR_ZNC; SET_ZNC_ADD(RN, r1, res);
-	RN = res;
-#ifdef DSP_DIS_ADDQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_sub(void)
-{
-#ifdef DSP_DIS_SUB
-	if (doDSPDis)
-		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-	RN = res;
-#ifdef DSP_DIS_SUB
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_subc(void)
-{
-#ifdef DSP_DIS_SUBC
-	if (doDSPDis)
-		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	// This is how the DSP ALU does it--Two's complement with inverted carry
-	uint64_t res = (uint64_t)RN + (uint64_t)(RM ^ 0xFFFFFFFF) + (dsp_flag_c ^ 1);
-	// Carry out of the result is inverted too
-	dsp_flag_c = ((res >> 32) & 0x01) ^ 1;
-	RN = (res & 0xFFFFFFFF);
+	uint32_t r1 = RN;
+	RN = (mirror_table[r1 & 0xFFFF] << 16) | mirror_table[r1 >> 16];
 	SET_ZN(RN);
-#ifdef DSP_DIS_SUBC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
 }
 
-
-static void dsp_opcode_subq(void)
+void dsp_opcode_sat32s(void)
 {
-#ifdef DSP_DIS_SUBQ
-	if (doDSPDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
+	int32_t r2 = (uint32_t)RN;
+	int32_t temp = dsp_acc >> 32;
+	uint32_t res = (temp < -1) ? (int32_t)0x80000000 : (temp > 0) ? (int32_t)0x7FFFFFFF : r2;
 	RN = res;
-#ifdef DSP_DIS_SUBQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_cmp(void)
-{
-#ifdef DSP_DIS_CMP
-	if (doDSPDis)
-		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-#ifdef DSP_DIS_CMP
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-}
-
-
-static void dsp_opcode_cmpq(void)
-{
-	static int32_t sqtable[32] =
-		{ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1 };
-#ifdef DSP_DIS_CMPQ
-	if (doDSPDis)
-		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, sqtable[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = sqtable[IMM_1 & 0x1F]; // I like this better -> (INT8)(jaguar.op >> 2) >> 3;
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-#ifdef DSP_DIS_CMPQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-}
-
-
-static void dsp_opcode_and(void)
-{
-#ifdef DSP_DIS_AND
-	if (doDSPDis)
-		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN & RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_AND
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_or(void)
-{
-#ifdef DSP_DIS_OR
-	if (doDSPDis)
-		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN | RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_OR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_xor(void)
-{
-#ifdef DSP_DIS_XOR
-	if (doDSPDis)
-		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN ^ RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_XOR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_not(void)
-{
-#ifdef DSP_DIS_NOT
-	if (doDSPDis)
-		WriteLog("%06X: NOT    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN = ~RN;
-	SET_ZN(RN);
-#ifdef DSP_DIS_NOT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void dsp_opcode_move_pc(void)
-{
-	RN = dsp_pc - 2;
-}
-
-
-static void dsp_opcode_store_r14_indexed(void)
-{
-#ifdef DSP_DIS_STORE14I
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", dsp_pc-2, IMM_2, dsp_convert_zero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_convert_zero[IMM_1] << 2, dsp_reg[14]+(dsp_convert_zero[IMM_1] << 2));
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#else
-	DSPWriteLong(dsp_reg[14] + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#endif
-}
-
-
-static void dsp_opcode_store_r15_indexed(void)
-{
-#ifdef DSP_DIS_STORE15I
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", dsp_pc-2, IMM_2, dsp_convert_zero[IMM_1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_convert_zero[IMM_1] << 2, dsp_reg[15]+(dsp_convert_zero[IMM_1] << 2));
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong((dsp_reg[15] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#else
-	DSPWriteLong(dsp_reg[15] + (dsp_convert_zero[IMM_1] << 2), RN, DSP);
-#endif
+	SET_ZN(res);
 }
 
-
-static void dsp_opcode_load_r14_ri(void)
+void dsp_opcode_sat16s(void)
 {
-#ifdef DSP_DIS_LOAD14R
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[14], IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[14] + RM) & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(dsp_reg[14] + RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD14R
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	int32_t r2 = RN;
+	uint32_t res = (r2 < -32768) ? -32768 : (r2 > 32767) ? 32767 : r2;
+	RN = res;
+	SET_ZN(res);
 }
 
-
-static void dsp_opcode_load_r15_ri(void)
+void dsp_opcode_illegal(void)
 {
-#ifdef DSP_DIS_LOAD15R
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM+dsp_reg[15], IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[15] + RM) & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(dsp_reg[15] + RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD15R
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	// Don't know what it does, but it does *something*...
+	WriteLog("%06X: illegal %u, %u [NCZ:%u%u%u]\n", dsp_pc-2, IMM_1, IMM_2, FLAG_N, FLAG_C, FLAG_Z);
 }
 
+//
+// New pipelined DSP core
+//
 
-static void dsp_opcode_store_r14_ri(void)
-{
-	DSPWriteLong(dsp_reg[14] + RM, RN, DSP);
-}
-
+static void DSP_abs(void);
+static void DSP_add(void);
+static void DSP_addc(void);
+static void DSP_addq(void);
+static void DSP_addqmod(void);
+static void DSP_addqt(void);
+static void DSP_and(void);
+static void DSP_bclr(void);
+static void DSP_bset(void);
+static void DSP_btst(void);
+static void DSP_cmp(void);
+static void DSP_cmpq(void);
+static void DSP_div(void);
+static void DSP_imacn(void);
+static void DSP_imult(void);
+static void DSP_imultn(void);
+static void DSP_illegal(void);
+static void DSP_jr(void);
+static void DSP_jump(void);
+static void DSP_load(void);
+static void DSP_loadb(void);
+static void DSP_loadw(void);
+static void DSP_load_r14_i(void);
+static void DSP_load_r14_r(void);
+static void DSP_load_r15_i(void);
+static void DSP_load_r15_r(void);
+static void DSP_mirror(void);
+static void DSP_mmult(void);
+static void DSP_move(void);
+static void DSP_movefa(void);
+static void DSP_movei(void);
+static void DSP_movepc(void);
+static void DSP_moveq(void);
+static void DSP_moveta(void);
+static void DSP_mtoi(void);
+static void DSP_mult(void);
+static void DSP_neg(void);
+static void DSP_nop(void);
+static void DSP_normi(void);
+static void DSP_not(void);
+static void DSP_or(void);
+static void DSP_resmac(void);
+static void DSP_ror(void);
+static void DSP_rorq(void);
+static void DSP_sat16s(void);
+static void DSP_sat32s(void);
+static void DSP_sh(void);
+static void DSP_sha(void);
+static void DSP_sharq(void);
+static void DSP_shlq(void);
+static void DSP_shrq(void);
+static void DSP_store(void);
+static void DSP_storeb(void);
+static void DSP_storew(void);
+static void DSP_store_r14_i(void);
+static void DSP_store_r14_r(void);
+static void DSP_store_r15_i(void);
+static void DSP_store_r15_r(void);
+static void DSP_sub(void);
+static void DSP_subc(void);
+static void DSP_subq(void);
+static void DSP_subqmod(void);
+static void DSP_subqt(void);
+static void DSP_xor(void);
 
-static void dsp_opcode_store_r15_ri(void)
+void (* DSPOpcode[64])() =
 {
-	DSPWriteLong(dsp_reg[15] + RM, RN, DSP);
-}
+	DSP_add,			DSP_addc,			DSP_addq,			DSP_addqt,
+	DSP_sub,			DSP_subc,			DSP_subq,			DSP_subqt,
+	DSP_neg,			DSP_and,			DSP_or,				DSP_xor,
+	DSP_not,			DSP_btst,			DSP_bset,			DSP_bclr,
 
+	DSP_mult,			DSP_imult,			DSP_imultn,			DSP_resmac,
+	DSP_imacn,			DSP_div,			DSP_abs,			DSP_sh,
+	DSP_shlq,			DSP_shrq,			DSP_sha,			DSP_sharq,
+	DSP_ror,			DSP_rorq,			DSP_cmp,			DSP_cmpq,
 
-static void dsp_opcode_nop(void)
-{
-#ifdef DSP_DIS_NOP
-	if (doDSPDis)
-		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", dsp_pc-2, dsp_flag_n, dsp_flag_c, dsp_flag_z);
-#endif
-}
+	DSP_subqmod,		DSP_sat16s,			DSP_move,			DSP_moveq,
+	DSP_moveta,			DSP_movefa,			DSP_movei,			DSP_loadb,
+	DSP_loadw,			DSP_load,			DSP_sat32s,			DSP_load_r14_i,
+	DSP_load_r15_i,		DSP_storeb,			DSP_storew,			DSP_store,
 
+	DSP_mirror,			DSP_store_r14_i,	DSP_store_r15_i,	DSP_movepc,
+	DSP_jump,			DSP_jr,				DSP_mmult,			DSP_mtoi,
+	DSP_normi,			DSP_nop,			DSP_load_r14_r,		DSP_load_r15_r,
+	DSP_store_r14_r,	DSP_store_r15_r,	DSP_illegal,		DSP_addqmod
+};
 
-static void dsp_opcode_storeb(void)
+bool readAffected[64][2] =
 {
-#ifdef DSP_DIS_STOREB
-	if (doDSPDis)
-		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM, RN & 0xFF, DSP);
-	else
-		JaguarWriteByte(RM, RN, DSP);
-}
+	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
+	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
+	{false,  true}, { true,  true}, { true,  true}, { true,  true},
+	{false,  true}, {false,  true}, {false,  true}, {false,  true},
 
+	{ true,  true}, { true,  true}, { true,  true}, {false,  true},
+	{ true,  true}, { true,  true}, {false,  true}, { true,  true},
+	{false,  true}, {false,  true}, { true,  true}, {false,  true},
+	{ true,  true}, {false,  true}, { true,  true}, {false,  true},
 
-static void dsp_opcode_storew(void)
-{
-#ifdef DSP_DIS_STOREW
-	if (doDSPDis)
-		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF, DSP);
-	else
-		JaguarWriteWord(RM & 0xFFFFFFFE, RN, DSP);
-#else
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		DSPWriteLong(RM, RN & 0xFFFF, DSP);
-	else
-		JaguarWriteWord(RM, RN, DSP);
-#endif
-}
+	{false,  true}, {false,  true}, { true, false}, {false, false},
+	{ true, false}, {false, false}, {false, false}, { true, false},
+	{ true, false}, { true, false}, {false,  true}, { true, false},
+	{ true, false}, { true,  true}, { true,  true}, { true,  true},
 
+	{false,  true}, { true,  true}, { true,  true}, {false,  true},
+	{ true, false}, { true, false}, { true,  true}, { true, false},
+	{ true, false}, {false, false}, { true, false}, { true, false},
+	{ true,  true}, { true,  true}, {false, false}, {false,  true}
+};
 
-static void dsp_opcode_store(void)
+bool isLoadStore[65] =
 {
-#ifdef DSP_DIS_STORE
-	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_pc-2, IMM_2, IMM_1, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT_STORE
-	DSPWriteLong(RM & 0xFFFFFFFC, RN, DSP);
-#else
-	DSPWriteLong(RM, RN, DSP);
-#endif
-}
+	false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false,
 
+	false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false,
 
-static void dsp_opcode_loadb(void)
-{
-#ifdef DSP_DIS_LOADB
-	if (doDSPDis)
-		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM, DSP) & 0xFF;
-	else
-		RN = JaguarReadByte(RM, DSP);
-#ifdef DSP_DIS_LOADB
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	false, false, false, false, false, false, false,  true,
+	 true,  true, false,  true,  true,  true,  true,  true,
 
+	false,  true,  true, false, false, false, false, false,
+	false, false,  true,  true,  true,  true, false, false, false
+};
 
-static void dsp_opcode_loadw(void)
+void FlushDSPPipeline(void)
 {
-#ifdef DSP_DIS_LOADW
-	if (doDSPDis)
-		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM & 0xFFFFFFFE, DSP) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM & 0xFFFFFFFE, DSP);
-#else
-	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
-		RN = DSPReadLong(RM, DSP) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM, DSP);
-#endif
-#ifdef DSP_DIS_LOADW
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	plPtrFetch = 3, plPtrRead = 2, plPtrExec = 1, plPtrWrite = 0;
 
+	for(int i=0; i<4; i++)
+		pipeline[i].opcode = PIPELINE_STALL;
 
-static void dsp_opcode_load(void)
-{
-#ifdef DSP_DIS_LOAD
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong(RM & 0xFFFFFFFC, DSP);
-#else
-	RN = DSPReadLong(RM, DSP);
-#endif
-#ifdef DSP_DIS_LOAD
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	for(int i=0; i<32; i++)
+		scoreboard[i] = 0;
 }
 
 
-static void dsp_opcode_load_r14_indexed(void)
+//
+// Stage 3 of the pipeline: write back a register or memory
+//
+static void DSPPipelineWriteback(PipelineStage & stage)
 {
-#ifdef DSP_DIS_LOAD14I
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[IMM_1] << 2, dsp_reg[14]+(dsp_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), DSP);
-#else
-	RN = DSPReadLong(dsp_reg[14] + (dsp_convert_zero[IMM_1] << 2), DSP);
-#endif
-#ifdef DSP_DIS_LOAD14I
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	if (stage.opcode == PIPELINE_STALL)
+		return;
 
+	if (stage.writebackRegister != 0xFF)
+	{
+		if (stage.writebackRegister != 0xFE)
+			dsp_reg[stage.writebackRegister] = stage.result;
+		else if (stage.type == TYPE_BYTE)
+			DSPWriteByte(stage.address, stage.value, DSP);
+		else if (stage.type == TYPE_WORD)
+			DSPWriteWord(stage.address, stage.value, DSP);
+		else
+			DSPWriteLong(stage.address, stage.value, DSP);
+	}
 
-static void dsp_opcode_load_r15_indexed(void)
-{
-#ifdef DSP_DIS_LOAD15I
-	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1] << 2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[IMM_1] << 2, dsp_reg[15]+(dsp_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef DSP_CORRECT_ALIGNMENT
-	RN = DSPReadLong((dsp_reg[15] & 0xFFFFFFFC) + (dsp_convert_zero[IMM_1] << 2), DSP);
+#ifndef NEW_SCOREBOARD
+	if (affectsScoreboard[stage.opcode])
+		scoreboard[stage.operand2] = false;
 #else
-	RN = DSPReadLong(dsp_reg[15] + (dsp_convert_zero[IMM_1] << 2), DSP);
-#endif
-#ifdef DSP_DIS_LOAD15I
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
+//Yup, sequential MOVEQ # problem fixing (I hope!)...
+	if (affectsScoreboard[stage.opcode])
+		if (scoreboard[stage.operand2])
+			scoreboard[stage.operand2]--;
 #endif
 }
 
 
-static void dsp_opcode_movei(void)
-{
-#ifdef DSP_DIS_MOVEI
-	if (doDSPDis)
-		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, (uint32_t)DSPReadWord(dsp_pc) | ((uint32_t)DSPReadWord(dsp_pc + 2) << 16), IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	// This instruction is followed by 32-bit value in LSW / MSW format...
-	RN = (uint32_t)DSPReadWord(dsp_pc, DSP) | ((uint32_t)DSPReadWord(dsp_pc + 2, DSP) << 16);
-	dsp_pc += 4;
-#ifdef DSP_DIS_MOVEI
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+//
+// Lockstep checking
+//
+// The lockstep engine runs every instruction twice from the same state: once
+// through the pipelined core (the reference pass), which then gets undone, &
+// once through the interpreter (the checked pass), which is the one that
+// counts. Anything they disagree on afterwards--registers, flags, or what
+// they read & wrote outside of the register file--goes in the log. Only the
+// first failure gets the full story; after that, it's one line each (up to
+// a point), and a count.
+//
+// The reference pass never makes it outside the DSP: its writes outside of
+// local RAM are dropped (its local RAM writes are put back afterwards), and
+// whatever it read from outside is handed to the checked pass, so reads with
+// side effects only happen once.
+//
 
+#define DSP_MAX_ACCESSES		16				// An instruction & its delay slot make a handful, at most
+#define DSP_MAX_REPORTS			32
 
-static void dsp_opcode_moveta(void)
+struct DSPRegisterState
 {
-#ifdef DSP_DIS_MOVETA
-	if (doDSPDis)
-		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-	ALTERNATE_RN = RM;
-#ifdef DSP_DIS_MOVETA
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-}
-
+	uint32_t reg0[32], reg1[32];
+	uint64_t acc;
+	uint32_t pc, flags, control, remain, modulo, matrixControl, pointerToMatrix,
+		dataOrganization, divControl;
+	uint8_t flagZ, flagN, flagC, imaskCleared;
+};
 
-static void dsp_opcode_movefa(void)
+struct DSPAccess
 {
-#ifdef DSP_DIS_MOVEFA
-	if (doDSPDis)
-		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-	RN = ALTERNATE_RM;
-#ifdef DSP_DIS_MOVEFA
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-}
+	uint8_t type;									// 'R'ead or 'W'rite
+	uint8_t size;									// In bytes
+	uint32_t address, data;
+	uint32_t undo;									// Local RAM long before a write
+};
 
+const char * dspEngineName[3] = { "interpreter", "pipelined", "lockstep" };
 
-static void dsp_opcode_move(void)
-{
-#ifdef DSP_DIS_MOVE
-	if (doDSPDis)
-		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RM;
-#ifdef DSP_DIS_MOVE
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+static MACHINE_STATE DSPAccess dspPassLog[2][DSP_MAX_ACCESSES];
+static MACHINE_STATE uint32_t dspPassLogCount[2];
+static MACHINE_STATE uint32_t dspPassNextRead;		// Next reference read for the checked pass
 
 
-static void dsp_opcode_moveq(void)
+static void DSPSaveRegisters(DSPRegisterState & state)
 {
-#ifdef DSP_DIS_MOVEQ
-	if (doDSPDis)
-		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN = IMM_1;
-#ifdef DSP_DIS_MOVEQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	DSPRISC::UpdateFlags();
+	memset(&state, 0, sizeof(state));
+	memcpy(state.reg0, dsp_reg_bank_0, sizeof(state.reg0));
+	memcpy(state.reg1, dsp_reg_bank_1, sizeof(state.reg1));
+	state.acc = dsp_acc;
+	state.pc = dsp_pc, state.flags = dsp_flags & 0xFFFFFFF8, state.control = dsp_control;
+	state.remain = dsp_remain, state.modulo = dsp_modulo;
+	state.matrixControl = dsp_matrix_control, state.pointerToMatrix = dsp_pointer_to_matrix;
+	state.dataOrganization = dsp_data_organization, state.divControl = dsp_div_control;
+	state.flagZ = dsp_flag_z, state.flagN = dsp_flag_n, state.flagC = dsp_flag_c;
+	state.imaskCleared = IMASKCleared;
 }
 
 
-static void dsp_opcode_resmac(void)
+static void DSPLoadRegisters(const DSPRegisterState & state)
 {
-#ifdef DSP_DIS_RESMAC
-	if (doDSPDis)
-		WriteLog("%06X: RESMAC R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_ACC=%02X%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
-#endif
-	RN = (uint32_t)dsp_acc;
-#ifdef DSP_DIS_RESMAC
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	memcpy(dsp_reg_bank_0, state.reg0, sizeof(state.reg0));
+	memcpy(dsp_reg_bank_1, state.reg1, sizeof(state.reg1));
+	dsp_acc = state.acc;
+	dsp_pc = state.pc, dsp_flags = state.flags, dsp_control = state.control;
+	dsp_remain = state.remain, dsp_modulo = state.modulo;
+	dsp_matrix_control = state.matrixControl, dsp_pointer_to_matrix = state.pointerToMatrix;
+	dsp_data_organization = state.dataOrganization, dsp_div_control = state.divControl;
+	dsp_flag_z = state.flagZ, dsp_flag_n = state.flagN, dsp_flag_c = state.flagC;
+	dsp_flags_pending = false;
+	IMASKCleared = state.imaskCleared;
+	DSPUpdateRegisterBanks();
 }
 
 
-static void dsp_opcode_imult(void)
+//
+// Note down a memory access made during one of the lockstep passes
+//
+static void DSPLogAccess(uint8_t type, uint32_t offset, uint32_t data, uint32_t size)
 {
-#ifdef DSP_DIS_IMULT
-	if (doDSPDis)
-		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (int16_t)RN * (int16_t)RM;
-	SET_ZN(RN);
-#ifdef DSP_DIS_IMULT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	uint32_t & count = dspPassLogCount[dspPass];
 
+	if (count == DSP_MAX_ACCESSES)
+		return;
 
-static void dsp_opcode_mult(void)
-{
-#ifdef DSP_DIS_MULT
-	if (doDSPDis)
-		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (uint16_t)RM * (uint16_t)RN;
-	SET_ZN(RN);
-#ifdef DSP_DIS_MULT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+	DSPAccess & access = dspPassLog[dspPass][count++];
+	access.type = type, access.size = size, access.address = offset, access.data = data;
+
+	if (type == 'W' && offset >= DSP_WORK_RAM_BASE && offset < DSP_WORK_RAM_BASE + 0x2000)
+		access.undo = GET32(dsp_ram_8, (offset - DSP_WORK_RAM_BASE) & 0x1FFC);
 }
 
 
-static void dsp_opcode_bclr(void)
+//
+// Hand the checked pass the next thing the reference pass read, if it's
+// reading the same thing
+//
+static bool DSPReferenceRead(uint32_t offset, uint32_t size, uint32_t & data)
 {
-#ifdef DSP_DIS_BCLR
-	if (doDSPDis)
-		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN & ~(1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef DSP_DIS_BCLR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	const DSPAccess * log = dspPassLog[DSP_PASS_REFERENCE];
 
+	while (dspPassNextRead < dspPassLogCount[DSP_PASS_REFERENCE] && log[dspPassNextRead].type != 'R')
+		dspPassNextRead++;
 
-static void dsp_opcode_btst(void)
-{
-#ifdef DSP_DIS_BTST
-	if (doDSPDis)
-		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	dsp_flag_z = (~RN >> IMM_1) & 1;
-#ifdef DSP_DIS_BTST
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	if (dspPassNextRead == dspPassLogCount[DSP_PASS_REFERENCE])
+		return false;
 
+	const DSPAccess & access = log[dspPassNextRead++];
 
-static void dsp_opcode_bset(void)
-{
-#ifdef DSP_DIS_BSET
-	if (doDSPDis)
-		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN | (1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef DSP_DIS_BSET
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	if (access.address != offset || access.size != size)
+		return false;
+
+	data = access.data;
+	return true;
 }
 
 
-static void dsp_opcode_subqt(void)
+//
+// Push one instruction through an empty pipeline, & out the other end (the
+// reference pass). Returns the opcode.
+//
+static uint32_t DSPPipelineStep(void)
 {
-#ifdef DSP_DIS_SUBQT
-	if (doDSPDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN -= dsp_convert_zero[IMM_1];
-#ifdef DSP_DIS_SUBQT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	FlushDSPPipeline();
 
+	if (IMASKCleared)
+	{
+		DSPHandleIRQs();
+		IMASKCleared = false;
+	}
 
-static void dsp_opcode_addqt(void)
-{
-#ifdef DSP_DIS_ADDQT
-	if (doDSPDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	RN += dsp_convert_zero[IMM_1];
-#ifdef DSP_DIS_ADDQT
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+	PipelineStage & stage = pipeline[plPtrExec];
+	stage.instruction = DSPReadWord(dsp_pc, DSP);
+	stage.opcode = stage.instruction >> 10;
+	stage.operand1 = (stage.instruction >> 5) & 0x1F;
+	stage.operand2 = stage.instruction & 0x1F;
 
+	if (stage.opcode == 38)
+		stage.result = (uint32_t)DSPReadWord(dsp_pc + 2, DSP)
+			| ((uint32_t)DSPReadWord(dsp_pc + 4, DSP) << 16);
 
-static void dsp_opcode_imacn(void)
-{
-#ifdef DSP_DIS_IMACN
-	if (doDSPDis)
-		WriteLog("%06X: IMACN  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	int32_t res = (int16_t)RM * (int16_t)RN;
-	dsp_acc += (int64_t)res;
-//Should we AND the result to fit into 40 bits here???
-#ifdef DSP_DIS_IMACN
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
-#endif
-}
+	stage.reg1 = dsp_reg[stage.operand1];
+	stage.reg2 = dsp_reg[stage.operand2];
+	stage.writebackRegister = stage.operand2;
+	dsp_pc += (stage.opcode == 38 ? 6 : 2);
 
+	uint32_t opcode = stage.opcode;
+	DSPOpcode[opcode]();
 
-static void dsp_opcode_mtoi(void)
-{
-	RN = (((int32_t)RM >> 8) & 0xFF800000) | (RM & 0x007FFFFF);
-	SET_ZN(RN);
+	// A taken JUMP or JR leaves its delay slot in the writeback stage
+	DSPPipelineWriteback(pipeline[plPtrWrite]);
+	DSPPipelineWriteback(pipeline[plPtrExec]);
+	FlushDSPPipeline();
+
+	return opcode;
 }
 
 
-static void dsp_opcode_normi(void)
+static bool DSPSameAccesses(void)
 {
-	uint32_t _Rm = RM;
-	uint32_t res = 0;
+	if (dspPassLogCount[DSP_PASS_REFERENCE] != dspPassLogCount[DSP_PASS_CHECKED])
+		return false;
 
-	if (_Rm)
+	for(uint32_t i=0; i<dspPassLogCount[DSP_PASS_REFERENCE]; i++)
 	{
-		while ((_Rm & 0xffc00000) == 0)
-		{
-			_Rm <<= 1;
-			res--;
-		}
-		while ((_Rm & 0xff800000) != 0)
-		{
-			_Rm >>= 1;
-			res++;
-		}
+		const DSPAccess & a = dspPassLog[DSP_PASS_REFERENCE][i], & b = dspPassLog[DSP_PASS_CHECKED][i];
+
+		if (a.type != b.type || a.size != b.size || a.address != b.address || a.data != b.data)
+			return false;
 	}
-	RN = res;
-	SET_ZN(RN);
+
+	return true;
 }
 
 
-static void dsp_opcode_mmult(void)
+static void DSPLogAccesses(const char * who, uint32_t pass)
 {
-	int count	= dsp_matrix_control&0x0f;
-	uint32_t addr = dsp_pointer_to_matrix; // in the dsp ram
-	int64_t accum = 0;
-	uint32_t res;
+	WriteLog("DSP:   Accesses by the %s:%s\n", who, (dspPassLogCount[pass] ? "" : " none"));
 
-	if (!(dsp_matrix_control & 0x10))
-	{
-		for (int i = 0; i < count; i++)
-		{
-			int16_t a;
-			if (i&0x01)
-				a=(int16_t)((dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]>>16)&0xffff);
-			else
-				a=(int16_t)(dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]&0xffff);
-			int16_t b=((int16_t)DSPReadWord(addr + 2, DSP));
-			accum += a*b;
-			addr += 4;
-		}
-	}
-	else
+	for(uint32_t i=0; i<dspPassLogCount[pass]; i++)
 	{
-		for (int i = 0; i < count; i++)
-		{
-			int16_t a;
-			if (i&0x01)
-				a=(int16_t)((dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]>>16)&0xffff);
-			else
-				a=(int16_t)(dsp_alternate_reg[dsp_opcode_first_parameter + (i>>1)]&0xffff);
-			int16_t b=((int16_t)DSPReadWord(addr + 2, DSP));
-			accum += a*b;
-			addr += 4 * count;
-		}
+		const DSPAccess & access = dspPassLog[pass][i];
+		WriteLog("DSP:     %s.%c $%06X %s $%0*X\n", (access.type == 'R' ? "Read " : "Write"),
+			(access.size == 1 ? 'B' : (access.size == 2 ? 'W' : 'L')), access.address,
+			(access.type == 'R' ? "->" : "<-"), access.size * 2, access.data);
 	}
-	RN = res = (int32_t)accum;
-	// carry flag to do
-//NOTE: The flags are set based upon the last add/multiply done...
-	SET_ZN(RN);
 }
 
 
-static void dsp_opcode_abs(void)
+#define DSP_REPORT(name, field) \
+	if (reference.field != checked.field) \
+		WriteLog("DSP:   %-8s $%08X -> $%08X (pipelined), $%08X (interpreter)\n", name, \
+			before.field, reference.field, checked.field)
+
+static void DSPLockstepFailed(uint64_t instruction, uint32_t pc, const DSPRegisterState & before,
+	const DSPRegisterState & reference, const DSPRegisterState & checked)
 {
-#ifdef DSP_DIS_ABS
-	if (doDSPDis)
-		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t _Rn = RN;
-	uint32_t res;
+	dspDivergences++;
 
-	if (_Rn == 0x80000000)
-		dsp_flag_n = 1;
-	else
+	if (dspDivergences > DSP_MAX_REPORTS)
+		return;
+
+	char buffer[512];
+	dasmjag(JAGUAR_DSP, buffer, pc);
+
+	if (dspDivergences > 1)
 	{
-		dsp_flag_c = ((_Rn & 0x80000000) >> 31);
-		res = RN = (_Rn & 0x80000000 ? -_Rn : _Rn);
-		CLR_ZN; SET_Z(res);
+		WriteLog("DSP: Lockstep check failed again at instruction #%llu, PC=$%06X: %s%s\n",
+			(unsigned long long)instruction, pc, buffer,
+			(dspDivergences == DSP_MAX_REPORTS ? " (no more of these will be logged)" : ""));
+		return;
 	}
-#ifdef DSP_DIS_ABS
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
 
+	WriteLog("DSP: Lockstep check failed at instruction #%llu, PC=$%06X: %s\n",
+		(unsigned long long)instruction, pc, buffer);
 
-static void dsp_opcode_div(void)
-{
-#if 0
-	if (RM)
+	for(int i=0; i<32; i++)
 	{
-		if (dsp_div_control & 0x01)		// 16.16 division
-		{
-			dsp_remain = ((uint64_t)RN << 16) % RM;
-			RN = ((uint64_t)RN << 16) / RM;
-		}
-		else
-		{
-			// We calculate the remainder first because we destroy RN after
-			// this by assigning it to itself.
-			dsp_remain = RN % RM;
-			RN = RN / RM;
-		}
-
+		if (reference.reg0[i] != checked.reg0[i])
+			WriteLog("DSP:   R%02i/0    $%08X -> $%08X (pipelined), $%08X (interpreter)\n", i,
+				before.reg0[i], reference.reg0[i], checked.reg0[i]);
 	}
-	else
+
+	for(int i=0; i<32; i++)
 	{
-		// This is what happens according to SCPCD. NYAN!
-		RN = 0xFFFFFFFF;
-		dsp_remain = 0;
+		if (reference.reg1[i] != checked.reg1[i])
+			WriteLog("DSP:   R%02i/1    $%08X -> $%08X (pipelined), $%08X (interpreter)\n", i,
+				before.reg1[i], reference.reg1[i], checked.reg1[i]);
 	}
-#else
-	// Real algorithm, courtesy of SCPCD: NYAN!
-	uint32_t q = RN;
-	uint32_t r = 0;
 
-	// If 16.16 division, stuff top 16 bits of RN into remainder and put the
-	// bottom 16 of RN in top 16 of quotient
-	if (dsp_div_control & 0x01)
-		q <<= 16, r = RN >> 16;
+	if (reference.acc != checked.acc)
+		WriteLog("DSP:   ACC      $%010llX -> $%010llX (pipelined), $%010llX (interpreter)\n",
+			(unsigned long long)before.acc, (unsigned long long)reference.acc,
+			(unsigned long long)checked.acc);
+
+	DSP_REPORT("PC", pc);
+	DSP_REPORT("D_FLAGS", flags);
+	DSP_REPORT("D_CTRL", control);
+	DSP_REPORT("D_REMAIN", remain);
+	DSP_REPORT("D_MOD", modulo);
+	DSP_REPORT("D_MTXC", matrixControl);
+	DSP_REPORT("D_MTXA", pointerToMatrix);
+	DSP_REPORT("D_END", dataOrganization);
+	DSP_REPORT("D_DIVCTL", divControl);
+	DSP_REPORT("Z", flagZ);
+	DSP_REPORT("N", flagN);
+	DSP_REPORT("C", flagC);
+	DSP_REPORT("IMASKClr", imaskCleared);
+
+	DSPLogAccesses("pipelined core", DSP_PASS_REFERENCE);
+	DSPLogAccesses("interpreter", DSP_PASS_CHECKED);
+}
+
+
+//
+// Run one instruction (& its delay slot, if it has one) through both engines.
+// Returns the number of cycles it took.
+//
+static int32_t DSPLockstepStep(void)
+{
+	DSPRegisterState before, reference, checked;
+	uint64_t instruction = dsp_instructions;
+	uint32_t pc = dsp_pc;
+
+	DSPSaveRegisters(before);
+	dspPassLogCount[DSP_PASS_REFERENCE] = dspPassLogCount[DSP_PASS_CHECKED] = 0;
+	dspPassNextRead = 0;
 
-	for(int i=0; i<32; i++)
+	dspPass = DSP_PASS_REFERENCE;
+	uint32_t opcode = DSPPipelineStep();
+	DSPSaveRegisters(reference);
+
+	// Put local RAM back the way it was (last write first)
+	for(int32_t i=dspPassLogCount[DSP_PASS_REFERENCE]-1; i>=0; i--)
 	{
-//		uint32_t sign = (r >> 31) & 0x01;
-		uint32_t sign = r & 0x80000000;
-		r = (r << 1) | ((q >> 31) & 0x01);
-		r += (sign ? RM : -RM);
-		q = (q << 1) | (((~r) >> 31) & 0x01);
-	}
+		const DSPAccess & access = dspPassLog[DSP_PASS_REFERENCE][i];
 
-	RN = q;
-	dsp_remain = r;
-#endif
-}
+		if (access.type == 'W' && access.address >= DSP_WORK_RAM_BASE
+			&& access.address < DSP_WORK_RAM_BASE + 0x2000)
+			SET32(dsp_ram_8, (access.address - DSP_WORK_RAM_BASE) & 0x1FFC, access.undo);
+	}
 
+	DSPLoadRegisters(before);
 
-static void dsp_opcode_imultn(void)
-{
-#ifdef DSP_DIS_IMULTN
-	if (doDSPDis)
-		WriteLog("%06X: IMULTN R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	// This is OK, since this multiply won't overflow 32 bits...
-	int32_t res = (int32_t)((int16_t)RN * (int16_t)RM);
-	dsp_acc = (int64_t)res;
-	SET_ZN(res);
-#ifdef DSP_DIS_IMULTN
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
-#endif
-}
+	dspPass = DSP_PASS_CHECKED;
+	DSPRISC::Exec(1);
+	dspPass = DSP_PASS_NONE;
+	DSPSaveRegisters(checked);
+	dspLockstepChecked++;
 
+	if (memcmp(&reference, &checked, sizeof(checked)) != 0 || !DSPSameAccesses())
+		DSPLockstepFailed(instruction, pc, before, reference, checked);
 
-static void dsp_opcode_neg(void)
-{
-#ifdef DSP_DIS_NEG
-	if (doDSPDis)
-		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = -RN;
-	SET_ZNC_SUB(0, RN, res);
-	RN = res;
-#ifdef DSP_DIS_NEG
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	return dsp_opcode_cycles[opcode];
 }
 
 
-static void dsp_opcode_shlq(void)
+static void DSPExecLockstep(int32_t cycles)
 {
-#ifdef DSP_DIS_SHLQ
-	if (doDSPDis)
-		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, 32 - IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	// NB: This instruction is the *only* one that does (32 - immediate data).
-	int32_t r1 = 32 - IMM_1;
-	uint32_t res = RN << r1;
-	SET_ZN(res); dsp_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef DSP_DIS_SHLQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	dsp_releaseTimeSlice_flag = 0;
+
+	while (cycles > 0 && DSP_RUNNING)
+		cycles -= DSPLockstepStep();
 }
 
 
-static void dsp_opcode_shrq(void)
+uint64_t DSPGetDivergences(void)
 {
-#ifdef DSP_DIS_SHRQ
-	if (doDSPDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	int32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t res = RN >> r1;
-	SET_ZN(res); dsp_flag_c = RN & 1;
-	RN = res;
-#ifdef DSP_DIS_SHRQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	return dspDivergences;
 }
 
 
-static void dsp_opcode_ror(void)
-{
-#ifdef DSP_DIS_ROR
-	if (doDSPDis)
-		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t r1 = RM & 0x1F;
-	uint32_t res = (RN >> r1) | (RN << (32 - r1));
-	SET_ZN(res); dsp_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef DSP_DIS_ROR
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+//
+// DSP traces
+//
+// A trace is everything the DSP saw of the outside world while it was being
+// recorded: its state at the start of each timeslice (which is where the 68K,
+// the GPU & the interrupts get to it), what it read from outside of its local
+// RAM & registers, & what it wrote out there. DSPTraceReplay() can then run
+// the DSP over it on its own, with nothing else of the Jaguar around, and
+// check that it reads & writes the same things.
+//
+// The file is gzipped, in host byte order:
+//
+//   "VJDSPTRC" <version (uint32)> <sizeof(DSPRegisterState) (uint32)>, then
+//   'S' <DSPRegisterState> <count (uint8)> [<block # (uint8)> <64 bytes>]...
+//       Start of a timeslice: the registers, & the 64 byte blocks of local RAM
+//       that changed since the end of the last one (all of them, at first)
+//   'R' <size (uint8)> <address (uint32)> <data (uint32)>
+//       Read from outside
+//   'W' <size (uint8)> <address (uint32)> <data (uint32)>
+//       Write to outside
+//   'E' <# of instructions (uint32)>
+//       End of the timeslice
+//
 
+#define DSP_TRACE_VERSION		1
+#define DSP_TRACE_BLOCK			64
+#define DSP_TRACE_BLOCKS		(0x2000 / DSP_TRACE_BLOCK)
 
-static void dsp_opcode_rorq(void)
-{
-#ifdef DSP_DIS_RORQ
-	if (doDSPDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1 & 0x1F];
-	uint32_t r2 = RN;
-	uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
-	RN = res;
-	SET_ZN(res); dsp_flag_c = (r2 >> 31) & 0x01;
-#ifdef DSP_DIS_RORQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-}
+static MACHINE_STATE uint8_t dspTraceRAM[0x2000];	// Local RAM at the end of the last slice
+static MACHINE_STATE bool dspTraceFirst;
+static MACHINE_STATE uint64_t dspTraceSliceStart;
+
+static MACHINE_STATE DSPAccess * dspReplayAccess = NULL;
+static MACHINE_STATE uint32_t dspReplayCount, dspReplaySize;
+static MACHINE_STATE uint32_t dspReplayNextRead, dspReplayNextWrite;
+static MACHINE_STATE uint32_t dspReplayInstructions, dspReplayPC;
+static MACHINE_STATE uint64_t dspReplayMismatches;
 
 
-static void dsp_opcode_sha(void)
+bool DSPTraceStart(const char * filename)
 {
-	int32_t sRm=(int32_t)RM;
-	uint32_t _Rn=RN;
+	DSPTraceStop();
 
-	if (sRm<0)
+	if (vjs.dspEngine == DSP_ENGINE_PIPELINED)
 	{
-		uint32_t shift=-sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=(_Rn&0x80000000)>>31;
-		while (shift)
-		{
-			_Rn<<=1;
-			shift--;
-		}
+		WriteLog("DSP: Traces can't be recorded from the pipelined core.\n");
+		return false;
 	}
-	else
+
+	dspTraceFile = gzopen(filename, "wb");
+
+	if (dspTraceFile == NULL)
 	{
-		uint32_t shift=sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=_Rn&0x1;
-		while (shift)
-		{
-			_Rn=((int32_t)_Rn)>>1;
-			shift--;
-		}
+		WriteLog("DSP: Could not create trace \"%s\"!\n", filename);
+		return false;
 	}
-	RN = _Rn;
-	SET_ZN(RN);
+
+	uint32_t header[2] = { DSP_TRACE_VERSION, sizeof(DSPRegisterState) };
+	gzwrite(dspTraceFile, "VJDSPTRC", 8);
+	gzwrite(dspTraceFile, header, sizeof(header));
+	dspTraceFirst = true;
+	WriteLog("DSP: Recording trace \"%s\"...\n", filename);
+
+	return true;
 }
 
 
-static void dsp_opcode_sharq(void)
+void DSPTraceStop(void)
 {
-#ifdef DSP_DIS_SHARQ
-	if (doDSPDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = (int32_t)RN >> dsp_convert_zero[IMM_1];
-	SET_ZN(res); dsp_flag_c = RN & 0x01;
-	RN = res;
-#ifdef DSP_DIS_SHARQ
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	if (dspTraceFile == NULL)
+		return;
+
+	gzclose(dspTraceFile);
+	dspTraceFile = NULL;
 }
 
 
-static void dsp_opcode_sh(void)
+static void DSPTraceBeginSlice(void)
 {
-	int32_t sRm=(int32_t)RM;
-	uint32_t _Rn=RN;
+	DSPRegisterState state;
+	uint8_t blocks[DSP_TRACE_BLOCKS];
+	uint32_t count = 0;
+
+	DSPSaveRegisters(state);
 
-	if (sRm<0)
+	for(uint32_t i=0; i<DSP_TRACE_BLOCKS; i++)
 	{
-		uint32_t shift=(-sRm);
-		if (shift>=32) shift=32;
-		dsp_flag_c=(_Rn&0x80000000)>>31;
-		while (shift)
-		{
-			_Rn<<=1;
-			shift--;
-		}
+		if (dspTraceFirst || memcmp(&dsp_ram_8[i * DSP_TRACE_BLOCK], &dspTraceRAM[i * DSP_TRACE_BLOCK], DSP_TRACE_BLOCK) != 0)
+			blocks[count++] = i;
 	}
-	else
+
+	gzputc(dspTraceFile, 'S');
+	gzwrite(dspTraceFile, &state, sizeof(state));
+	gzputc(dspTraceFile, count);
+
+	for(uint32_t i=0; i<count; i++)
 	{
-		uint32_t shift=sRm;
-		if (shift>=32) shift=32;
-		dsp_flag_c=_Rn&0x1;
-		while (shift)
-		{
-			_Rn>>=1;
-			shift--;
-		}
+		gzputc(dspTraceFile, blocks[i]);
+		gzwrite(dspTraceFile, &dsp_ram_8[blocks[i] * DSP_TRACE_BLOCK], DSP_TRACE_BLOCK);
 	}
-	RN = _Rn;
-	SET_ZN(RN);
+
+	dspTraceFirst = false;
+	dspTraceSliceStart = dsp_instructions;
 }
 
-void dsp_opcode_addqmod(void)
+
+static void DSPTraceEndSlice(void)
 {
-#ifdef DSP_DIS_ADDQMOD
-	if (doDSPDis)
-		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", dsp_pc-2, dsp_convert_zero[IMM_1], IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN, dsp_modulo);
-#endif
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t r2 = RN;
-	uint32_t res = r2 + r1;
-	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
-	RN = res;
-	SET_ZNC_ADD(r2, r1, res);
-#ifdef DSP_DIS_ADDQMOD
-	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, IMM_2, RN);
-#endif
+	uint32_t count = dsp_instructions - dspTraceSliceStart;
+
+	gzputc(dspTraceFile, 'E');
+	gzwrite(dspTraceFile, &count, 4);
+	memcpy(dspTraceRAM, dsp_ram_8, 0x2000);
 }
 
-void dsp_opcode_subqmod(void)
+
+static void DSPTraceAccess(uint8_t type, uint32_t offset, uint32_t data, uint32_t size)
 {
-	uint32_t r1 = dsp_convert_zero[IMM_1];
-	uint32_t r2 = RN;
-	uint32_t res = r2 - r1;
-	res = (res & (~dsp_modulo)) | (r2 & dsp_modulo);
-	RN = res;
+	uint8_t record[10];
 
-	SET_ZNC_SUB(r2, r1, res);
+	record[0] = type, record[1] = size;
+	memcpy(&record[2], &offset, 4);
+	memcpy(&record[6], &data, 4);
+	gzwrite(dspTraceFile, record, sizeof(record));
 }
 
-void dsp_opcode_mirror(void)
+
+static void DSPReplayMismatch(const char * text, ...)
 {
-	uint32_t r1 = RN;
-	RN = (mirror_table[r1 & 0xFFFF] << 16) | mirror_table[r1 >> 16];
-	SET_ZN(RN);
+	dspReplayMismatches++;
+
+	if (dspReplayMismatches > DSP_MAX_REPORTS)
+		return;
+
+	char buffer[256];
+	va_list arg;
+	va_start(arg, text);
+	vsnprintf(buffer, sizeof(buffer), text, arg);
+	va_end(arg);
+
+	WriteLog("DSP: Trace mismatch at instruction #%llu, PC=$%06X: %s\n",
+		(unsigned long long)dsp_instructions, dspReplayPC, buffer);
 }
 
-void dsp_opcode_sat32s(void)
+
+static uint32_t DSPReplayRead(uint32_t offset, uint32_t size)
 {
-	int32_t r2 = (uint32_t)RN;
-	int32_t temp = dsp_acc >> 32;
-	uint32_t res = (temp < -1) ? (int32_t)0x80000000 : (temp > 0) ? (int32_t)0x7FFFFFFF : r2;
-	RN = res;
-	SET_ZN(res);
+	while (dspReplayNextRead < dspReplayCount && dspReplayAccess[dspReplayNextRead].type != 'R')
+		dspReplayNextRead++;
+
+	if (dspReplayNextRead == dspReplayCount)
+	{
+		DSPReplayMismatch("%u byte read from $%06X, past the end of the slice", size, offset);
+		return 0;
+	}
+
+	const DSPAccess & access = dspReplayAccess[dspReplayNextRead++];
+
+	if (access.address != offset || access.size != size)
+		DSPReplayMismatch("%u byte read from $%06X, trace has %u bytes from $%06X", size,
+			offset, access.size, access.address);
+
+	return access.data;
 }
 
-void dsp_opcode_sat16s(void)
+
+static void DSPReplayWrite(uint32_t offset, uint32_t data, uint32_t size)
 {
-	int32_t r2 = RN;
-	uint32_t res = (r2 < -32768) ? -32768 : (r2 > 32767) ? 32767 : r2;
-	RN = res;
-	SET_ZN(res);
+	while (dspReplayNextWrite < dspReplayCount && dspReplayAccess[dspReplayNextWrite].type != 'W')
+		dspReplayNextWrite++;
+
+	if (dspReplayNextWrite == dspReplayCount)
+	{
+		DSPReplayMismatch("%u byte write of $%X to $%06X, past the end of the slice", size,
+			data, offset);
+		return;
+	}
+
+	const DSPAccess & access = dspReplayAccess[dspReplayNextWrite++];
+
+	if (access.address != offset || access.size != size || access.data != data)
+		DSPReplayMismatch("%u byte write of $%X to $%06X, trace has %u bytes of $%X to $%06X",
+			size, data, offset, access.size, access.data, access.address);
 }
 
-void dsp_opcode_illegal(void)
+
+//
+// Read a timeslice from a trace (its 'S' is already gone), & set the DSP up
+// for it
+//
+static bool DSPReplayLoadSlice(gzFile fp)
 {
-	// Don't know what it does, but it does *something*...
-	WriteLog("%06X: illegal %u, %u [NCZ:%u%u%u]\n", dsp_pc-2, IMM_1, IMM_2, dsp_flag_n, dsp_flag_c, dsp_flag_z);
+	DSPRegisterState state;
+	int count;
+
+	if (gzread(fp, &state, sizeof(state)) != sizeof(state) || (count = gzgetc(fp)) < 0
+		|| count > DSP_TRACE_BLOCKS)
+		return false;
+
+	for(int i=0; i<count; i++)
+	{
+		int block = gzgetc(fp);
+
+		if (block < 0 || block >= DSP_TRACE_BLOCKS
+			|| gzread(fp, &dsp_ram_8[block * DSP_TRACE_BLOCK], DSP_TRACE_BLOCK) != DSP_TRACE_BLOCK)
+			return false;
+	}
+
+	DSPLoadRegisters(state);
+	dspReplayCount = dspReplayNextRead = dspReplayNextWrite = 0;
+
+	while (true)
+	{
+		int type = gzgetc(fp);
+
+		if (type == 'E')
+			return gzread(fp, &dspReplayInstructions, 4) == 4;
+
+		uint8_t record[9];
+
+		if ((type != 'R' && type != 'W') || gzread(fp, record, sizeof(record)) != sizeof(record))
+			return false;
+
+		if (dspReplayCount == dspReplaySize)
+		{
+			dspReplaySize = (dspReplaySize ? dspReplaySize * 2 : 1024);
+			dspReplayAccess = (DSPAccess *)realloc(dspReplayAccess, dspReplaySize * sizeof(DSPAccess));
+		}
+
+		DSPAccess & access = dspReplayAccess[dspReplayCount++];
+		access.type = type, access.size = record[0];
+		memcpy(&access.address, &record[1], 4);
+		memcpy(&access.data, &record[5], 4);
+	}
 }
 
+
 //
-// New pipelined DSP core
+// Run the DSP over a trace from DSPTraceStart(), with vjs.dspEngine (except
+// for the pipelined core, which can't count instructions, so it gets the
+// interpreter). Reads & writes that don't match the trace, along with any
+// lockstep check failures, go in the log & the stats. Returns false if the
+// trace couldn't be read.
 //
+bool DSPTraceReplay(const char * filename, DSPReplayStats & stats)
+{
+	memset(&stats, 0, sizeof(stats));
 
-static void DSP_abs(void);
-static void DSP_add(void);
-static void DSP_addc(void);
-static void DSP_addq(void);
-static void DSP_addqmod(void);
-static void DSP_addqt(void);
-static void DSP_and(void);
-static void DSP_bclr(void);
-static void DSP_bset(void);
-static void DSP_btst(void);
-static void DSP_cmp(void);
-static void DSP_cmpq(void);
-static void DSP_div(void);
-static void DSP_imacn(void);
-static void DSP_imult(void);
-static void DSP_imultn(void);
-static void DSP_illegal(void);
-static void DSP_jr(void);
-static void DSP_jump(void);
-static void DSP_load(void);
-static void DSP_loadb(void);
-static void DSP_loadw(void);
-static void DSP_load_r14_i(void);
-static void DSP_load_r14_r(void);
-static void DSP_load_r15_i(void);
-static void DSP_load_r15_r(void);
-static void DSP_mirror(void);
-static void DSP_mmult(void);
-static void DSP_move(void);
-static void DSP_movefa(void);
-static void DSP_movei(void);
-static void DSP_movepc(void);
-static void DSP_moveq(void);
-static void DSP_moveta(void);
-static void DSP_mtoi(void);
-static void DSP_mult(void);
-static void DSP_neg(void);
-static void DSP_nop(void);
-static void DSP_normi(void);
-static void DSP_not(void);
-static void DSP_or(void);
-static void DSP_resmac(void);
-static void DSP_ror(void);
-static void DSP_rorq(void);
-static void DSP_sat16s(void);
-static void DSP_sat32s(void);
-static void DSP_sh(void);
-static void DSP_sha(void);
-static void DSP_sharq(void);
-static void DSP_shlq(void);
-static void DSP_shrq(void);
-static void DSP_store(void);
-static void DSP_storeb(void);
-static void DSP_storew(void);
-static void DSP_store_r14_i(void);
-static void DSP_store_r14_r(void);
-static void DSP_store_r15_i(void);
-static void DSP_store_r15_r(void);
-static void DSP_sub(void);
-static void DSP_subc(void);
-static void DSP_subq(void);
-static void DSP_subqmod(void);
-static void DSP_subqt(void);
-static void DSP_xor(void);
+	if (dspTraceFile)
+	{
+		WriteLog("DSP: Can't replay a trace while recording one!\n");
+		return false;
+	}
 
-void (* DSPOpcode[64])() =
-{
-	DSP_add,			DSP_addc,			DSP_addq,			DSP_addqt,
-	DSP_sub,			DSP_subc,			DSP_subq,			DSP_subqt,
-	DSP_neg,			DSP_and,			DSP_or,				DSP_xor,
-	DSP_not,			DSP_btst,			DSP_bset,			DSP_bclr,
+	gzFile fp = gzopen(filename, "rb");
 
-	DSP_mult,			DSP_imult,			DSP_imultn,			DSP_resmac,
-	DSP_imacn,			DSP_div,			DSP_abs,			DSP_sh,
-	DSP_shlq,			DSP_shrq,			DSP_sha,			DSP_sharq,
-	DSP_ror,			DSP_rorq,			DSP_cmp,			DSP_cmpq,
+	if (fp == NULL)
+	{
+		WriteLog("DSP: Could not open trace \"%s\"!\n", filename);
+		return false;
+	}
 
-	DSP_subqmod,		DSP_sat16s,			DSP_move,			DSP_moveq,
-	DSP_moveta,			DSP_movefa,			DSP_movei,			DSP_loadb,
-	DSP_loadw,			DSP_load,			DSP_sat32s,			DSP_load_r14_i,
-	DSP_load_r15_i,		DSP_storeb,			DSP_storew,			DSP_store,
+	char magic[8];
+	uint32_t header[2];
 
-	DSP_mirror,			DSP_store_r14_i,	DSP_store_r15_i,	DSP_movepc,
-	DSP_jump,			DSP_jr,				DSP_mmult,			DSP_mtoi,
-	DSP_normi,			DSP_nop,			DSP_load_r14_r,		DSP_load_r15_r,
-	DSP_store_r14_r,	DSP_store_r15_r,	DSP_illegal,		DSP_addqmod
-};
+	if (gzread(fp, magic, 8) != 8 || memcmp(magic, "VJDSPTRC", 8) != 0
+		|| gzread(fp, header, sizeof(header)) != sizeof(header)
+		|| header[0] != DSP_TRACE_VERSION || header[1] != sizeof(DSPRegisterState))
+	{
+		WriteLog("DSP: \"%s\" is not a DSP trace (or not one we know)!\n", filename);
+		gzclose(fp);
+		return false;
+	}
 
-bool readAffected[64][2] =
-{
-	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
-	{ true,  true}, { true,  true}, {false,  true}, {false,  true},
-	{false,  true}, { true,  true}, { true,  true}, { true,  true},
-	{false,  true}, {false,  true}, {false,  true}, {false,  true},
+	bool lockstep = (vjs.dspEngine == DSP_ENGINE_LOCKSTEP), ok = true;
+	uint64_t divergences = dspDivergences;
+	int type;
+	dspReplaying = true;
+	dspReplayMismatches = 0;
 
-	{ true,  true}, { true,  true}, { true,  true}, {false,  true},
-	{ true,  true}, { true,  true}, {false,  true}, { true,  true},
-	{false,  true}, {false,  true}, { true,  true}, {false,  true},
-	{ true,  true}, {false,  true}, { true,  true}, {false,  true},
+	while ((type = gzgetc(fp)) != -1)
+	{
+		if (type != 'S' || !DSPReplayLoadSlice(fp))
+		{
+			WriteLog("DSP: Trace \"%s\" is damaged after %llu slices!\n", filename,
+				(unsigned long long)stats.slices);
+			ok = false;
+			break;
+		}
 
-	{false,  true}, {false,  true}, { true, false}, {false, false},
-	{ true, false}, {false, false}, {false, false}, { true, false},
-	{ true, false}, { true, false}, {false,  true}, { true, false},
-	{ true, false}, { true,  true}, { true,  true}, { true,  true},
+		uint64_t start = dsp_instructions, end = start + dspReplayInstructions;
 
-	{false,  true}, { true,  true}, { true,  true}, {false,  true},
-	{ true, false}, { true, false}, { true,  true}, { true, false},
-	{ true, false}, {false, false}, { true, false}, { true, false},
-	{ true,  true}, { true,  true}, {false, false}, {false,  true}
-};
+		while (dsp_instructions < end && DSP_RUNNING)
+		{
+			dspReplayPC = dsp_pc;
 
-bool isLoadStore[65] =
-{
-	false, false, false, false, false, false, false, false,
-	false, false, false, false, false, false, false, false,
+			if (lockstep)
+				DSPLockstepStep();
+			else
+				DSPRISC::Exec(1);
+		}
 
-	false, false, false, false, false, false, false, false,
-	false, false, false, false, false, false, false, false,
+		if (dsp_instructions < end)
+			DSPReplayMismatch("DSP stopped %llu instructions early",
+				(unsigned long long)(end - dsp_instructions));
 
-	false, false, false, false, false, false, false,  true,
-	 true,  true, false,  true,  true,  true,  true,  true,
+		uint32_t reads = 0, writes = 0;
 
-	false,  true,  true, false, false, false, false, false,
-	false, false,  true,  true,  true,  true, false, false, false
-};
+		for(uint32_t i=dspReplayNextRead; i<dspReplayCount; i++)
+			reads += (dspReplayAccess[i].type == 'R' ? 1 : 0);
 
-void FlushDSPPipeline(void)
-{
-	plPtrFetch = 3, plPtrRead = 2, plPtrExec = 1, plPtrWrite = 0;
+		for(uint32_t i=dspReplayNextWrite; i<dspReplayCount; i++)
+			writes += (dspReplayAccess[i].type == 'W' ? 1 : 0);
 
-	for(int i=0; i<4; i++)
-		pipeline[i].opcode = PIPELINE_STALL;
+		if (reads || writes)
+			DSPReplayMismatch("%u reads & %u writes in the trace never happened", reads, writes);
 
-	for(int i=0; i<32; i++)
-		scoreboard[i] = 0;
+		stats.slices++;
+		stats.instructions += dsp_instructions - start;
+	}
+
+	dspReplaying = false;
+	gzclose(fp);
+	stats.mismatches = dspReplayMismatches;
+	stats.divergences = dspDivergences - divergences;
+
+	return ok;
 }
 
+
 //
-// New pipelined DSP execution core
+// All of the DSP's own accesses outside of its local RAM & registers end up
+// here, so they can be checked, recorded & replayed
 //
-/*void DSPExecP(int32_t cycles)
+static uint32_t DSPExternalRead(uint32_t offset, uint32_t size)
 {
-//	bool inhibitFetch = false;
+	uint32_t data;
 
-	dsp_releaseTimeSlice_flag = 0;
-	dsp_in_exec++;
-
-	while (cycles > 0 && DSP_RUNNING)
+	if (dspPass != DSP_PASS_CHECKED || !DSPReferenceRead(offset, size, data))
 	{
-WriteLog("DSPExecP: Pipeline status...\n");
-WriteLog("\tF -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrFetch].opcode, pipeline[plPtrFetch].operand1, pipeline[plPtrFetch].operand2, pipeline[plPtrFetch].reg1, pipeline[plPtrFetch].reg2, pipeline[plPtrFetch].result, pipeline[plPtrFetch].writebackRegister);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister);
-WriteLog("  --> Scoreboard: ");
-for(int i=0; i<32; i++)
-	WriteLog("%s ", scoreboard[i] ? "T" : "F");
-WriteLog("\n");
-		// Stage 1: Instruction fetch
-//		if (!inhibitFetch)
-//		{
-		pipeline[plPtrFetch].instruction = DSPReadWord(dsp_pc, DSP);
-		pipeline[plPtrFetch].opcode = pipeline[plPtrFetch].instruction >> 10;
-		pipeline[plPtrFetch].operand1 = (pipeline[plPtrFetch].instruction >> 5) & 0x1F;
-		pipeline[plPtrFetch].operand2 = pipeline[plPtrFetch].instruction & 0x1F;
-		if (pipeline[plPtrFetch].opcode == 38)
-			pipeline[plPtrFetch].result = (uint32_t)DSPReadWord(dsp_pc + 2, DSP)
-				| ((uint32_t)DSPReadWord(dsp_pc + 4, DSP) << 16);
-//		}
-//		else
-//			inhibitFetch = false;
-WriteLog("DSPExecP: Fetching instruction (%04X) from DSP_PC = %08X...\n", pipeline[plPtrFetch].instruction, dsp_pc);
-
-WriteLog("DSPExecP: Pipeline status (after stage 1)...\n");
-WriteLog("\tF -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrFetch].opcode, pipeline[plPtrFetch].operand1, pipeline[plPtrFetch].operand2, pipeline[plPtrFetch].reg1, pipeline[plPtrFetch].reg2, pipeline[plPtrFetch].result, pipeline[plPtrFetch].writebackRegister);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister);
-		// Stage 2: Read registers
-//Ok, stalls here depend on whether or not the instruction reads two registers or not
-//and *which* register (1 or 2) is the one being read... !!! FIX !!!
-		if (scoreboard[pipeline[plPtrRead].operand2])
-			&& pipeline[plPtrRead].opcode != PIPELINE_STALL)
-			// We have a hit in the scoreboard, so we have to stall the pipeline...
-{
-//This is crappy, crappy CRAPPY! And it doesn't work! !!! FIX !!!
-//			dsp_pc -= (pipeline[plPtrRead].opcode == 38 ? 6 : 2);
-WriteLog("  --> Stalling pipeline: scoreboard = %s\n", scoreboard[pipeline[plPtrRead].operand2] ? "true" : "false");
-			pipeline[plPtrFetch] = pipeline[plPtrRead];
-			pipeline[plPtrRead].opcode = PIPELINE_STALL;
-}
+		if (dspReplaying)
+			data = DSPReplayRead(offset, size);
+		else if (size == 1)
+			data = JaguarReadByte(offset, DSP);
+		else if (size == 2)
+			data = JaguarReadWord(offset, DSP);
 		else
-		{
-			pipeline[plPtrRead].reg1 = dsp_reg[pipeline[plPtrRead].operand1];
-			pipeline[plPtrRead].reg2 = dsp_reg[pipeline[plPtrRead].operand2];
-			pipeline[plPtrRead].writebackRegister = pipeline[plPtrRead].operand2;	// Set it to RN
+			data = JaguarReadLong(offset, DSP);
+	}
 
-			if (pipeline[plPtrRead].opcode != PIPELINE_STALL)
-			// Shouldn't we be more selective with the register scoreboarding?
-			// Yes, we should. !!! FIX !!!
-			scoreboard[pipeline[plPtrRead].operand2] = true;
-//Advance PC here??? Yes.
-//			dsp_pc += (pipeline[plPtrRead].opcode == 38 ? 6 : 2);
-//This is a mangling of the pipeline stages, but what else to do???
-			dsp_pc += (pipeline[plPtrFetch].opcode == 38 ? 6 : 2);
-		}
+	if (dspPass != DSP_PASS_NONE)
+		DSPLogAccess('R', offset, data, size);
 
-WriteLog("DSPExecP: Pipeline status (after stage 2)...\n");
-WriteLog("\tF -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrFetch].opcode, pipeline[plPtrFetch].operand1, pipeline[plPtrFetch].operand2, pipeline[plPtrFetch].reg1, pipeline[plPtrFetch].reg2, pipeline[plPtrFetch].result, pipeline[plPtrFetch].writebackRegister);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister);
-		// Stage 3: Execute
-		if (pipeline[plPtrExec].opcode != PIPELINE_STALL)
-		{
-WriteLog("DSPExecP: About to execute opcode %s...\n", dsp_opcode_str[pipeline[plPtrExec].opcode]);
-			DSPOpcode[pipeline[plPtrExec].opcode]();
-			dsp_opcode_use[pipeline[plPtrExec].opcode]++;
-			cycles -= dsp_opcode_cycles[pipeline[plPtrExec].opcode];
-		}
-		else
-			cycles--;
-
-WriteLog("DSPExecP: Pipeline status (after stage 3)...\n");
-WriteLog("\tF -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrFetch].opcode, pipeline[plPtrFetch].operand1, pipeline[plPtrFetch].operand2, pipeline[plPtrFetch].reg1, pipeline[plPtrFetch].reg2, pipeline[plPtrFetch].result, pipeline[plPtrFetch].writebackRegister);
-WriteLog("\tR -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister);
-WriteLog("\tE -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister);
-WriteLog("\tW -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u \n", pipeline[plPtrWrite].opcode, pipeline[plPtrWrite].operand1, pipeline[plPtrWrite].operand2, pipeline[plPtrWrite].reg1, pipeline[plPtrWrite].reg2, pipeline[plPtrWrite].result, pipeline[plPtrWrite].writebackRegister);
-		// Stage 4: Write back register
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-				dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
+	if (dspTraceFile && !jaguarRunningAhead && dspPass != DSP_PASS_REFERENCE)
+		DSPTraceAccess('R', offset, data, size);
 
-			scoreboard[pipeline[plPtrWrite].operand1]
-				= scoreboard[pipeline[plPtrWrite].operand2] = false;
-		}
+	return data;
+}
 
-		// Push instructions through the pipeline...
-		plPtrFetch = (++plPtrFetch) & 0x03;
-		plPtrRead = (++plPtrRead) & 0x03;
-		plPtrExec = (++plPtrExec) & 0x03;
-		plPtrWrite = (++plPtrWrite) & 0x03;
+
+static void DSPExternalWrite(uint32_t offset, uint32_t data, uint32_t size)
+{
+	if (dspPass == DSP_PASS_REFERENCE)
+		return;
+
+	if (dspTraceFile && !jaguarRunningAhead)
+		DSPTraceAccess('W', offset, data, size);
+
+	if (dspReplaying)
+	{
+		DSPReplayWrite(offset, data, size);
+		return;
 	}
 
-	dsp_in_exec--;
-}*/
+	// Same as the 68K's writes, if the GPU is running ahead (see GPU.CPP)
+	if (gpuSpeculating && ((offset & 0xFFFFFF) < 0x800000))
+		GPUSpecOtherWrite(offset, size);
+
+	if (size == 1)
+		JaguarWriteByte(offset, data, DSP);
+	else if (size == 2)
+		JaguarWriteWord(offset, data, DSP);
+	else
+		JaguarWriteLong(offset, data, DSP);
+}
+
+
+//
+// New pipelined DSP execution core
+//
 
 
 //Problems: JR and any other instruction that relies on DSP_PC is getting WRONG values!
@@ -3222,7 +2535,7 @@ uint32_t pcQPtr1 = 0;
 static uint32_t prevR1;
 //Let's try a 3 stage pipeline....
 //Looks like 3 stage is correct, otherwise bad things happen...
-void DSPExecP2(int32_t cycles)
+static void DSPExecPipelined(int32_t cycles)
 {
 	dsp_releaseTimeSlice_flag = 0;
 	dsp_in_exec++;
@@ -3388,11 +2701,6 @@ if (doDSPDis)
 {
 WriteLog("DSPExecP: About to execute opcode %s...\n", dsp_opcode_str[pipeline[plPtrExec].opcode]);
 }
-#endif
-//CC only!
-#ifdef DSP_DEBUG_CC
-lastExec = pipeline[plPtrExec].instruction;
-//WriteLog("[lastExec = %04X]\n", lastExec);
 #endif
 			cycles -= dsp_opcode_cycles[pipeline[plPtrExec].opcode];
 			dsp_opcode_use[pipeline[plPtrExec].opcode]++;
@@ -3426,40 +2734,7 @@ WriteLog("\n");
 }
 #endif
 		// Stage 3: Write back register/memory address
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-/*if (pipeline[plPtrWrite].writebackRegister == 3
-	&& (pipeline[plPtrWrite].result < 0xF14000 || pipeline[plPtrWrite].result > 0xF1CFFF)
-	&& !doDSPDis)
-{
-	WriteLog("DSP: Register R03 has stepped out of bounds...\n\n");
-	doDSPDis = true;
-}//*/
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
-
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
+		DSPPipelineWriteback(pipeline[plPtrWrite]);
 
 		// Push instructions through the pipeline...
 		plPtrRead = (++plPtrRead) & 0x03;
@@ -3472,113 +2747,6 @@ WriteLog("\n");
 
 
 
-/*
-//#define DSP_DEBUG_PL3
-//Let's try a 2 stage pipeline....
-void DSPExecP3(int32_t cycles)
-{
-	dsp_releaseTimeSlice_flag = 0;
-	dsp_in_exec++;
-
-	while (cycles > 0 && DSP_RUNNING)
-	{
-//if (dsp_pc < 0xF1B000 || dsp_pc > 0xF1CFFF)
-//	doDSPDis = true;
-#ifdef DSP_DEBUG_PL3
-WriteLog("DSPExecP: Pipeline status...\n");
-WriteLog("\tF/R -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE/W -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("  --> Scoreboard: ");
-for(int i=0; i<32; i++)
-	WriteLog("%s ", scoreboard[i] ? "T" : "F");
-WriteLog("\n");
-#endif
-		// Stage 1a: Instruction fetch
-		pipeline[plPtrRead].instruction = DSPReadWord(dsp_pc, DSP);
-		pipeline[plPtrRead].opcode = pipeline[plPtrRead].instruction >> 10;
-		pipeline[plPtrRead].operand1 = (pipeline[plPtrRead].instruction >> 5) & 0x1F;
-		pipeline[plPtrRead].operand2 = pipeline[plPtrRead].instruction & 0x1F;
-		if (pipeline[plPtrRead].opcode == 38)
-			pipeline[plPtrRead].result = (uint32_t)DSPReadWord(dsp_pc + 2, DSP)
-				| ((uint32_t)DSPReadWord(dsp_pc + 4, DSP) << 16);
-#ifdef DSP_DEBUG_PL3
-WriteLog("DSPExecP: Fetching instruction (%04X) from DSP_PC = %08X...\n", pipeline[plPtrRead].instruction, dsp_pc);
-WriteLog("DSPExecP: Pipeline status (after stage 1a)...\n");
-WriteLog("\tF/R -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE/W -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-#endif
-		// Stage 1b: Read registers
-		if ((scoreboard[pipeline[plPtrRead].operand1] && readAffected[pipeline[plPtrRead].opcode][0])
-			|| (scoreboard[pipeline[plPtrRead].operand2] && readAffected[pipeline[plPtrRead].opcode][1]))
-			// We have a hit in the scoreboard, so we have to stall the pipeline...
-#ifdef DSP_DEBUG_PL3
-{
-WriteLog("  --> Stalling pipeline: ");
-if (readAffected[pipeline[plPtrRead].opcode][0])
-	WriteLog("scoreboard[%u] = %s (reg 1) ", pipeline[plPtrRead].operand1, scoreboard[pipeline[plPtrRead].operand1] ? "true" : "false");
-if (readAffected[pipeline[plPtrRead].opcode][1])
-	WriteLog("scoreboard[%u] = %s (reg 2)", pipeline[plPtrRead].operand2, scoreboard[pipeline[plPtrRead].operand2] ? "true" : "false");
-WriteLog("\n");
-#endif
-			pipeline[plPtrRead].opcode = PIPELINE_STALL;
-#ifdef DSP_DEBUG_PL3
-}
-#endif
-		else
-		{
-			pipeline[plPtrRead].reg1 = dsp_reg[pipeline[plPtrRead].operand1];
-			pipeline[plPtrRead].reg2 = dsp_reg[pipeline[plPtrRead].operand2];
-			pipeline[plPtrRead].writebackRegister = pipeline[plPtrRead].operand2;	// Set it to RN
-
-			// Shouldn't we be more selective with the register scoreboarding?
-			// Yes, we should. !!! FIX !!! [Kinda DONE]
-			scoreboard[pipeline[plPtrRead].operand2] = affectsScoreboard[pipeline[plPtrRead].opcode];
-
-//Advance PC here??? Yes.
-			dsp_pc += (pipeline[plPtrRead].opcode == 38 ? 6 : 2);
-		}
-
-#ifdef DSP_DEBUG_PL3
-WriteLog("DSPExecP: Pipeline status (after stage 1b)...\n");
-WriteLog("\tF/R -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE/W -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-#endif
-		// Stage 2a: Execute
-		if (pipeline[plPtrExec].opcode != PIPELINE_STALL)
-		{
-#ifdef DSP_DEBUG_PL3
-WriteLog("DSPExecP: About to execute opcode %s...\n", dsp_opcode_str[pipeline[plPtrExec].opcode]);
-#endif
-			DSPOpcode[pipeline[plPtrExec].opcode]();
-			dsp_opcode_use[pipeline[plPtrExec].opcode]++;
-			cycles -= dsp_opcode_cycles[pipeline[plPtrExec].opcode];
-		}
-		else
-			cycles--;
-
-#ifdef DSP_DEBUG_PL3
-WriteLog("DSPExecP: Pipeline status (after stage 2a)...\n");
-WriteLog("\tF/R -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrRead].opcode, pipeline[plPtrRead].operand1, pipeline[plPtrRead].operand2, pipeline[plPtrRead].reg1, pipeline[plPtrRead].reg2, pipeline[plPtrRead].result, pipeline[plPtrRead].writebackRegister, dsp_opcode_str[pipeline[plPtrRead].opcode]);
-WriteLog("\tE/W -> %02u, %02u, %02u; r1=%08X, r2= %08X, res=%08X, wb=%u (%s)\n", pipeline[plPtrExec].opcode, pipeline[plPtrExec].operand1, pipeline[plPtrExec].operand2, pipeline[plPtrExec].reg1, pipeline[plPtrExec].reg2, pipeline[plPtrExec].result, pipeline[plPtrExec].writebackRegister, dsp_opcode_str[pipeline[plPtrExec].opcode]);
-WriteLog("\n");
-#endif
-		// Stage 2b: Write back register
-		if (pipeline[plPtrExec].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrExec].writebackRegister != 0xFF)
-				dsp_reg[pipeline[plPtrExec].writebackRegister] = pipeline[plPtrExec].result;
-
-			if (affectsScoreboard[pipeline[plPtrExec].opcode])
-				scoreboard[pipeline[plPtrExec].operand2] = false;
-		}
-
-		// Push instructions through the pipeline...
-		plPtrRead = (++plPtrRead) & 0x03;
-		plPtrExec = (++plPtrExec) & 0x03;
-	}
-
-	dsp_in_exec--;
-}*/
 
 //
 // DSP pipelined opcode handlers
@@ -3599,21 +2767,17 @@ static void DSP_abs(void)
 {
 #ifdef DSP_DIS_ABS
 	if (doDSPDis)
-		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t _Rn = PRN;
 
-	if (_Rn == 0x80000000)
-		dsp_flag_n = 1;
-	else
-	{
-		dsp_flag_c = ((_Rn & 0x80000000) >> 31);
-		PRES = (_Rn & 0x80000000 ? -_Rn : _Rn);
-		CLR_ZN; SET_Z(PRES);
-	}
+	// Same as the interpreter: 0x80000000 stays as it is (C = 1, N = 1, Z = 0)
+	dsp_flag_c = ((_Rn & 0x80000000) >> 31);
+	PRES = (_Rn & 0x80000000 ? -_Rn : _Rn);
+	SET_ZN(PRES);
 #ifdef DSP_DIS_ABS
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3621,14 +2785,14 @@ static void DSP_add(void)
 {
 #ifdef DSP_DIS_ADD
 	if (doDSPDis)
-		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t res = PRN + PRM;
 	SET_ZNC_ADD(PRN, PRM, res);
 	PRES = res;
 #ifdef DSP_DIS_ADD
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -3636,7 +2800,7 @@ static void DSP_addc(void)
 {
 #ifdef DSP_DIS_ADDC
 	if (doDSPDis)
-		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t res = PRN + PRM + dsp_flag_c;
 	uint32_t carry = dsp_flag_c;
@@ -3646,7 +2810,7 @@ static void DSP_addc(void)
 	PRES = res;
 #ifdef DSP_DIS_ADDC
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -3654,15 +2818,15 @@ static void DSP_addq(void)
 {
 #ifdef DSP_DIS_ADDQ
 	if (doDSPDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t r1 = dsp_convert_zero[PIMM1];
 	uint32_t res = PRN + r1;
-	CLR_ZNC; SET_ZNC_ADD(PRN, r1, res);
+	SET_ZNC_ADD(PRN, r1, res);
 	PRES = res;
 #ifdef DSP_DIS_ADDQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3670,7 +2834,7 @@ static void DSP_addqmod(void)
 {
 #ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_modulo);
+		WriteLog("%06X: ADDQMOD #%u, R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_MOD=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, dsp_modulo);
 #endif
 	uint32_t r1 = dsp_convert_zero[PIMM1];
 	uint32_t r2 = PRN;
@@ -3680,7 +2844,7 @@ static void DSP_addqmod(void)
 	SET_ZNC_ADD(r2, r1, res);
 #ifdef DSP_DIS_ADDQMOD
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3688,12 +2852,12 @@ static void DSP_addqt(void)
 {
 #ifdef DSP_DIS_ADDQT
 	if (doDSPDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = PRN + dsp_convert_zero[PIMM1];
 #ifdef DSP_DIS_ADDQT
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3701,13 +2865,13 @@ static void DSP_and(void)
 {
 #ifdef DSP_DIS_AND
 	if (doDSPDis)
-		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = PRN & PRM;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_AND
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -3715,13 +2879,13 @@ static void DSP_bclr(void)
 {
 #ifdef DSP_DIS_BCLR
 	if (doDSPDis)
-		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = PRN & ~(1 << PIMM1);
 	SET_ZN(PRES);
 #ifdef DSP_DIS_BCLR
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3729,13 +2893,13 @@ static void DSP_bset(void)
 {
 #ifdef DSP_DIS_BSET
 	if (doDSPDis)
-		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = PRN | (1 << PIMM1);
 	SET_ZN(PRES);
 #ifdef DSP_DIS_BSET
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -3743,13 +2907,14 @@ static void DSP_btst(void)
 {
 #ifdef DSP_DIS_BTST
 	if (doDSPDis)
-		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
+	DSPRISC::UpdateFlags();
 	dsp_flag_z = (~PRN >> PIMM1) & 1;
 	NO_WRITEBACK;
 #ifdef DSP_DIS_BTST
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 }
 
@@ -3757,14 +2922,14 @@ static void DSP_cmp(void)
 {
 #ifdef DSP_DIS_CMP
 	if (doDSPDis)
-		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t res = PRN - PRM;
 	SET_ZNC_SUB(PRN, PRM, res);
 	NO_WRITEBACK;
 #ifdef DSP_DIS_CMP
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
+		WriteLog("[NCZ:%u%u%u]\n", FLAG_N, FLAG_C, FLAG_Z);
 #endif
 }
 
@@ -3774,7 +2939,7 @@ static void DSP_cmpq(void)
 		{ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1 };
 #ifdef DSP_DIS_CMPQ
 	if (doDSPDis)
-		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, sqtable[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, sqtable[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t r1 = sqtable[PIMM1 & 0x1F]; // I like this better -> (INT8)(jaguar.op >> 2) >> 3;
 	uint32_t res = PRN - r1;
@@ -3782,7 +2947,7 @@ static void DSP_cmpq(void)
 	NO_WRITEBACK;
 #ifdef DSP_DIS_CMPQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z);
+		WriteLog("[NCZ:%u%u%u]\n", FLAG_N, FLAG_C, FLAG_Z);
 #endif
 }
 
@@ -3815,7 +2980,7 @@ static void DSP_imacn(void)
 {
 #ifdef DSP_DIS_IMACN
 	if (doDSPDis)
-		WriteLog("%06X: IMACN  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: IMACN  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	int32_t res = (int16_t)PRM * (int16_t)PRN;
 	dsp_acc += (int64_t)res;
@@ -3823,7 +2988,7 @@ static void DSP_imacn(void)
 	NO_WRITEBACK;
 #ifdef DSP_DIS_IMACN
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
+		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", FLAG_N, FLAG_C, FLAG_Z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
 #endif
 }
 
@@ -3831,13 +2996,13 @@ static void DSP_imult(void)
 {
 #ifdef DSP_DIS_IMULT
 	if (doDSPDis)
-		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = (int16_t)PRN * (int16_t)PRM;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_IMULT
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -3845,7 +3010,7 @@ static void DSP_imultn(void)
 {
 #ifdef DSP_DIS_IMULTN
 	if (doDSPDis)
-		WriteLog("%06X: IMULTN R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: IMULTN R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	// This is OK, since this multiply won't overflow 32 bits...
 	int32_t res = (int32_t)((int16_t)PRN * (int16_t)PRM);
@@ -3854,7 +3019,7 @@ static void DSP_imultn(void)
 	NO_WRITEBACK;
 #ifdef DSP_DIS_IMULTN
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
+		WriteLog("[NCZ:%u%u%u, DSP_ACC=%02X%08X]\n", FLAG_N, FLAG_C, FLAG_Z, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
 #endif
 }
 
@@ -3862,7 +3027,7 @@ static void DSP_illegal(void)
 {
 #ifdef DSP_DIS_ILLEGAL
 	if (doDSPDis)
-		WriteLog("%06X: ILLEGAL [NCZ:%u%u%u]\n", DSP_PPC, dsp_flag_n, dsp_flag_c, dsp_flag_z);
+		WriteLog("%06X: ILLEGAL [NCZ:%u%u%u]\n", DSP_PPC, FLAG_N, FLAG_C, FLAG_Z);
 #endif
 	NO_WRITEBACK;
 }
@@ -3882,9 +3047,12 @@ const char * condition[32] =
 	"???", "???", "???", "F" };
 	if (doDSPDis)
 //How come this is always off by 2???
-		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", DSP_PPC, condition[PIMM2], DSP_PPC+((PIMM1 & 0x10 ? 0xFFFFFFF0 | PIMM1 : PIMM1) * 2)+2, dsp_flag_n, dsp_flag_c, dsp_flag_z);
+		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", DSP_PPC, condition[PIMM2], DSP_PPC+((PIMM1 & 0x10 ? 0xFFFFFFF0 | PIMM1 : PIMM1) * 2)+2, FLAG_N, FLAG_C, FLAG_Z);
 #endif
 	// KLUDGE: Used by BRANCH_CONDITION macro
+	if (PIMM2)
+		DSPRISC::UpdateFlags();
+
 	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
 
 	if (BRANCH_CONDITION(PIMM2))
@@ -3911,33 +3079,7 @@ const char * condition[32] =
 			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
 				scoreboard[pipeline[plPtrWrite].operand2] = false;
 		}//*/
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
-
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
+		DSPPipelineWriteback(pipeline[plPtrWrite]);
 
 		// Step 2: Push instruction through pipeline & execute following instruction
 		// NOTE: By putting our following instruction at stage 3 of the pipeline,
@@ -3991,9 +3133,12 @@ const char * condition[32] =
 	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
 	"???", "???", "???", "F" };
 	if (doDSPDis)
-		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", DSP_PPC, condition[PIMM2], PIMM1, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM);
+		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", DSP_PPC, condition[PIMM2], PIMM1, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM);
 #endif
 	// KLUDGE: Used by BRANCH_CONDITION macro
+	if (PIMM2)
+		DSPRISC::UpdateFlags();
+
 	uint32_t jaguar_flags = (dsp_flag_n << 2) | (dsp_flag_c << 1) | dsp_flag_z;
 
 	if (BRANCH_CONDITION(PIMM2))
@@ -4016,33 +3161,7 @@ const char * condition[32] =
 			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
 				scoreboard[pipeline[plPtrWrite].operand2] = false;
 		}//*/
-		if (pipeline[plPtrWrite].opcode != PIPELINE_STALL)
-		{
-			if (pipeline[plPtrWrite].writebackRegister != 0xFF)
-			{
-				if (pipeline[plPtrWrite].writebackRegister != 0xFE)
-					dsp_reg[pipeline[plPtrWrite].writebackRegister] = pipeline[plPtrWrite].result;
-				else
-				{
-					if (pipeline[plPtrWrite].type == TYPE_BYTE)
-						JaguarWriteByte(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else if (pipeline[plPtrWrite].type == TYPE_WORD)
-						JaguarWriteWord(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-					else
-						JaguarWriteLong(pipeline[plPtrWrite].address, pipeline[plPtrWrite].value);
-				}
-			}
-
-#ifndef NEW_SCOREBOARD
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				scoreboard[pipeline[plPtrWrite].operand2] = false;
-#else
-//Yup, sequential MOVEQ # problem fixing (I hope!)...
-			if (affectsScoreboard[pipeline[plPtrWrite].opcode])
-				if (scoreboard[pipeline[plPtrWrite].operand2])
-					scoreboard[pipeline[plPtrWrite].operand2]--;
-#endif
-		}
+		DSPPipelineWriteback(pipeline[plPtrWrite]);
 
 		// Step 2: Push instruction through pipeline & execute following instruction
 		// NOTE: By putting our following instruction at stage 3 of the pipeline,
@@ -4091,7 +3210,7 @@ static void DSP_load(void)
 {
 #ifdef DSP_DIS_LOAD
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	PRES = DSPReadLong(PRM & 0xFFFFFFFC, DSP);
@@ -4100,7 +3219,7 @@ static void DSP_load(void)
 #endif
 #ifdef DSP_DIS_LOAD
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4108,15 +3227,15 @@ static void DSP_loadb(void)
 {
 #ifdef DSP_DIS_LOADB
 	if (doDSPDis)
-		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		PRES = DSPReadLong(PRM, DSP) & 0xFF;
 	else
-		PRES = JaguarReadByte(PRM, DSP);
+		PRES = DSPReadByte(PRM, DSP);
 #ifdef DSP_DIS_LOADB
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4124,22 +3243,22 @@ static void DSP_loadw(void)
 {
 #ifdef DSP_DIS_LOADW
 	if (doDSPDis)
-		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		PRES = DSPReadLong(PRM & 0xFFFFFFFE, DSP) & 0xFFFF;
 	else
-		PRES = JaguarReadWord(PRM & 0xFFFFFFFE, DSP);
+		PRES = DSPReadWord(PRM & 0xFFFFFFFE, DSP);
 #else
 	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		PRES = DSPReadLong(PRM, DSP) & 0xFFFF;
 	else
-		PRES = JaguarReadWord(PRM, DSP);
+		PRES = DSPReadWord(PRM, DSP);
 #endif
 #ifdef DSP_DIS_LOADW
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4147,7 +3266,7 @@ static void DSP_load_r14_i(void)
 {
 #ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, FLAG_N, FLAG_C, FLAG_Z, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	PRES = DSPReadLong((dsp_reg[14] & 0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2), DSP);
@@ -4156,7 +3275,7 @@ static void DSP_load_r14_i(void)
 #endif
 #ifdef DSP_DIS_LOAD14I
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4164,7 +3283,7 @@ static void DSP_load_r14_r(void)
 {
 #ifdef DSP_DIS_LOAD14R
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM+dsp_reg[14], PIMM2, PRES);
+		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM+dsp_reg[14], PIMM2, PRES);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	PRES = DSPReadLong((dsp_reg[14] + PRM) & 0xFFFFFFFC, DSP);
@@ -4173,7 +3292,7 @@ static void DSP_load_r14_r(void)
 #endif
 #ifdef DSP_DIS_LOAD14R
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4181,7 +3300,7 @@ static void DSP_load_r15_i(void)
 {
 #ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1] << 2, PIMM2, FLAG_N, FLAG_C, FLAG_Z, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2), PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	PRES = DSPReadLong((dsp_reg[15] &0xFFFFFFFC) + (dsp_convert_zero[PIMM1] << 2), DSP);
@@ -4190,7 +3309,7 @@ static void DSP_load_r15_i(void)
 #endif
 #ifdef DSP_DIS_LOAD15I
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4198,7 +3317,7 @@ static void DSP_load_r15_r(void)
 {
 #ifdef DSP_DIS_LOAD15R
 	if (doDSPDis)
-		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM+dsp_reg[15], PIMM2, PRN);
+		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM+dsp_reg[15], PIMM2, PRN);
 #endif
 #ifdef DSP_CORRECT_ALIGNMENT
 	PRES = DSPReadLong((dsp_reg[15] + PRM) & 0xFFFFFFFC, DSP);
@@ -4207,7 +3326,7 @@ static void DSP_load_r15_r(void)
 #endif
 #ifdef DSP_DIS_LOAD15R
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4264,12 +3383,12 @@ static void DSP_move(void)
 {
 #ifdef DSP_DIS_MOVE
 	if (doDSPDis)
-		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = PRM;
 #ifdef DSP_DIS_MOVE
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4277,15 +3396,15 @@ static void DSP_movefa(void)
 {
 #ifdef DSP_DIS_MOVEFA
 	if (doDSPDis)
-//		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, ALTERNATE_RM, PIMM2, PRN);
-		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, dsp_alternate_reg[PIMM1], PIMM2, PRN);
+//		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, ALTERNATE_RM, PIMM2, PRN);
+		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, dsp_alternate_reg[PIMM1], PIMM2, PRN);
 #endif
 //	PRES = ALTERNATE_RM;
 	PRES = dsp_alternate_reg[PIMM1];
 #ifdef DSP_DIS_MOVEFA
 	if (doDSPDis)
-//		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, ALTERNATE_RM, PIMM2, PRN);
-		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, dsp_alternate_reg[PIMM1], PIMM2, PRES);
+//		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, ALTERNATE_RM, PIMM2, PRN);
+		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, dsp_alternate_reg[PIMM1], PIMM2, PRES);
 #endif
 }
 
@@ -4293,14 +3412,14 @@ static void DSP_movei(void)
 {
 #ifdef DSP_DIS_MOVEI
 	if (doDSPDis)
-		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PRES, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PRES, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 //	// This instruction is followed by 32-bit value in LSW / MSW format...
 //	PRES = (uint32_t)DSPReadWord(dsp_pc, DSP) | ((uint32_t)DSPReadWord(dsp_pc + 2, DSP) << 16);
 //	dsp_pc += 4;
 #ifdef DSP_DIS_MOVEI
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4308,7 +3427,7 @@ static void DSP_movepc(void)
 {
 #ifdef DSP_DIS_MOVEPC
 	if (doDSPDis)
-		WriteLog("%06X: MOVE   PC, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: MOVE   PC, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 //Need to fix this to take into account pipelining effects... !!! FIX !!! [DONE]
 //	PRES = dsp_pc - 2;
@@ -4316,7 +3435,7 @@ static void DSP_movepc(void)
 	PRES = dsp_pc - 2 - (pipeline[plPtrRead].opcode == 38 ? 6 : (pipeline[plPtrRead].opcode == PIPELINE_STALL ? 0 : 2));
 #ifdef DSP_DIS_MOVEPC
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4324,12 +3443,12 @@ static void DSP_moveq(void)
 {
 #ifdef DSP_DIS_MOVEQ
 	if (doDSPDis)
-		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = PIMM1;
 #ifdef DSP_DIS_MOVEQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4337,16 +3456,16 @@ static void DSP_moveta(void)
 {
 #ifdef DSP_DIS_MOVETA
 	if (doDSPDis)
-//		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, ALTERNATE_RN);
-		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, dsp_alternate_reg[PIMM2]);
+//		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, ALTERNATE_RN);
+		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, dsp_alternate_reg[PIMM2]);
 #endif
 //	ALTERNATE_RN = PRM;
 	dsp_alternate_reg[PIMM2] = PRM;
 	NO_WRITEBACK;
 #ifdef DSP_DIS_MOVETA
 	if (doDSPDis)
-//		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, ALTERNATE_RN);
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, dsp_alternate_reg[PIMM2]);
+//		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, ALTERNATE_RN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, dsp_alternate_reg[PIMM2]);
 #endif
 }
 
@@ -4360,13 +3479,13 @@ static void DSP_mult(void)
 {
 #ifdef DSP_DIS_MULT
 	if (doDSPDis)
-		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = (uint16_t)PRM * (uint16_t)PRN;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_MULT
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4374,14 +3493,14 @@ static void DSP_neg(void)
 {
 #ifdef DSP_DIS_NEG
 	if (doDSPDis)
-		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t res = -PRN;
 	SET_ZNC_SUB(0, PRN, res);
 	PRES = res;
 #ifdef DSP_DIS_NEG
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4389,7 +3508,7 @@ static void DSP_nop(void)
 {
 #ifdef DSP_DIS_NOP
 	if (doDSPDis)
-		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", DSP_PPC, dsp_flag_n, dsp_flag_c, dsp_flag_z);
+		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", DSP_PPC, FLAG_N, FLAG_C, FLAG_Z);
 #endif
 	NO_WRITEBACK;
 }
@@ -4420,13 +3539,13 @@ static void DSP_not(void)
 {
 #ifdef DSP_DIS_NOT
 	if (doDSPDis)
-		WriteLog("%06X: NOT    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: NOT    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = ~PRN;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_NOT
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4434,13 +3553,13 @@ static void DSP_or(void)
 {
 #ifdef DSP_DIS_OR
 	if (doDSPDis)
-		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = PRN | PRM;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_OR
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4448,12 +3567,12 @@ static void DSP_resmac(void)
 {
 #ifdef DSP_DIS_RESMAC
 	if (doDSPDis)
-		WriteLog("%06X: RESMAC R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_ACC=%02X%08X] -> ", DSP_PPC, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
+		WriteLog("%06X: RESMAC R%02u [NCZ:%u%u%u, R%02u=%08X, DSP_ACC=%02X%08X] -> ", DSP_PPC, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, (uint8_t)(dsp_acc >> 32), (uint32_t)(dsp_acc & 0xFFFFFFFF));
 #endif
 	PRES = (uint32_t)dsp_acc;
 #ifdef DSP_DIS_RESMAC
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 }
 
@@ -4461,7 +3580,7 @@ static void DSP_ror(void)
 {
 #ifdef DSP_DIS_ROR
 	if (doDSPDis)
-		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t r1 = PRM & 0x1F;
 	uint32_t res = (PRN >> r1) | (PRN << (32 - r1));
@@ -4469,7 +3588,7 @@ static void DSP_ror(void)
 	PRES = res;
 #ifdef DSP_DIS_ROR
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4477,7 +3596,7 @@ static void DSP_rorq(void)
 {
 #ifdef DSP_DIS_RORQ
 	if (doDSPDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t r1 = dsp_convert_zero[PIMM1 & 0x1F];
 	uint32_t r2 = PRN;
@@ -4486,7 +3605,7 @@ static void DSP_rorq(void)
 	SET_ZN(res); dsp_flag_c = (r2 >> 31) & 0x01;
 #ifdef DSP_DIS_RORQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4591,14 +3710,14 @@ static void DSP_sharq(void)
 {
 #ifdef DSP_DIS_SHARQ
 	if (doDSPDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t res = (int32_t)PRN >> dsp_convert_zero[PIMM1];
 	SET_ZN(res); dsp_flag_c = PRN & 0x01;
 	PRES = res;
 #ifdef DSP_DIS_SHARQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4606,7 +3725,7 @@ static void DSP_shlq(void)
 {
 #ifdef DSP_DIS_SHLQ
 	if (doDSPDis)
-		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, 32 - PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, 32 - PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	int32_t r1 = 32 - PIMM1;
 	uint32_t res = PRN << r1;
@@ -4614,7 +3733,7 @@ static void DSP_shlq(void)
 	PRES = res;
 #ifdef DSP_DIS_SHLQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4622,7 +3741,7 @@ static void DSP_shrq(void)
 {
 #ifdef DSP_DIS_SHRQ
 	if (doDSPDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	int32_t r1 = dsp_convert_zero[PIMM1];
 	uint32_t res = PRN >> r1;
@@ -4630,7 +3749,7 @@ static void DSP_shrq(void)
 	PRES = res;
 #ifdef DSP_DIS_SHRQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4638,7 +3757,7 @@ static void DSP_store(void)
 {
 #ifdef DSP_DIS_STORE
 	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, PIMM1, PRM);
+		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, PIMM1, PRM);
 #endif
 //	DSPWriteLong(PRM, PRN, DSP);
 //	NO_WRITEBACK;
@@ -4656,7 +3775,7 @@ static void DSP_storeb(void)
 {
 #ifdef DSP_DIS_STOREB
 	if (doDSPDis)
-		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, PIMM1, PRM);
+		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, PIMM1, PRM);
 #endif
 //	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 //		DSPWriteLong(PRM, PRN & 0xFF, DSP);
@@ -4684,7 +3803,7 @@ static void DSP_storew(void)
 {
 #ifdef DSP_DIS_STOREW
 	if (doDSPDis)
-		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, PIMM1, PRM);
+		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", DSP_PPC, PIMM2, PIMM1, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, PIMM1, PRM);
 #endif
 //	if (PRM >= DSP_WORK_RAM_BASE && PRM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 //		DSPWriteLong(PRM, PRN & 0xFFFF, DSP);
@@ -4715,7 +3834,7 @@ static void DSP_store_r14_i(void)
 {
 #ifdef DSP_DIS_STORE14I
 	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[14]+(dsp_convert_zero[PIMM1] << 2));
 #endif
 //	DSPWriteLong(dsp_reg[14] + (dsp_convert_zero[PIMM1] << 2), PRN, DSP);
 //	NO_WRITEBACK;
@@ -4747,7 +3866,7 @@ static void DSP_store_r15_i(void)
 {
 #ifdef DSP_DIS_STORE15I
 	if (doDSPDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2));
+		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", DSP_PPC, PIMM2, dsp_convert_zero[PIMM1] << 2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN, dsp_convert_zero[PIMM1] << 2, dsp_reg[15]+(dsp_convert_zero[PIMM1] << 2));
 #endif
 //	DSPWriteLong(dsp_reg[15] + (dsp_convert_zero[PIMM1] << 2), PRN, DSP);
 //	NO_WRITEBACK;
@@ -4779,14 +3898,14 @@ static void DSP_sub(void)
 {
 #ifdef DSP_DIS_SUB
 	if (doDSPDis)
-		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t res = PRN - PRM;
 	SET_ZNC_SUB(PRN, PRM, res);
 	PRES = res;
 #ifdef DSP_DIS_SUB
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4794,7 +3913,7 @@ static void DSP_subc(void)
 {
 #ifdef DSP_DIS_SUBC
 	if (doDSPDis)
-		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	uint32_t res = PRN - PRM - dsp_flag_c;
 	uint32_t borrow = dsp_flag_c;
@@ -4802,7 +3921,7 @@ static void DSP_subc(void)
 	PRES = res;
 #ifdef DSP_DIS_SUBC
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
 
@@ -4810,7 +3929,7 @@ static void DSP_subq(void)
 {
 #ifdef DSP_DIS_SUBQ
 	if (doDSPDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	uint32_t r1 = dsp_convert_zero[PIMM1];
 	uint32_t res = PRN - r1;
@@ -4818,7 +3937,7 @@ static void DSP_subq(void)
 	PRES = res;
 #ifdef DSP_DIS_SUBQ
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4836,12 +3955,12 @@ static void DSP_subqt(void)
 {
 #ifdef DSP_DIS_SUBQT
 	if (doDSPDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRN);
+		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", DSP_PPC, dsp_convert_zero[PIMM1], PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRN);
 #endif
 	PRES = PRN - dsp_convert_zero[PIMM1];
 #ifdef DSP_DIS_SUBQT
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM2, PRES);
 #endif
 }
 
@@ -4849,12 +3968,12 @@ static void DSP_xor(void)
 {
 #ifdef DSP_DIS_XOR
 	if (doDSPDis)
-		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRN);
+		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", DSP_PPC, PIMM1, PIMM2, FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRN);
 #endif
 	PRES = PRN ^ PRM;
 	SET_ZN(PRES);
 #ifdef DSP_DIS_XOR
 	if (doDSPDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", dsp_flag_n, dsp_flag_c, dsp_flag_z, PIMM1, PRM, PIMM2, PRES);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, PIMM1, PRM, PIMM2, PRES);
 #endif
 }
@@ -13,7 +13,9 @@
 void DSPInit(void);
 void DSPReset(void);
 void DSPExec(int32_t);
+uint64_t DSPGetIdleCycles(void);
 void DSPDone(void);
+void DSPSnapshot(void);
 void DSPUpdateRegisterBanks(void);
 void DSPHandleIRQs(void);
 void DSPSetIRQLine(int irqline, int state);
@@ -26,15 +28,33 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who = UNKNOWN);
 void DSPReleaseTimeslice(void);
 bool DSPIsRunning(void);
 
-void DSPExecP(int32_t cycles);
-void DSPExecP2(int32_t cycles);
-//void DSPExecP3(int32_t cycles);
-void DSPExecComp(int32_t cycles);
+// DSP engines (vjs.dspEngine): the interpreter (JAGRISC.H), the old pipelined
+// core, or both in lockstep, checking each instruction of the one against
+// the other
+
+enum { DSP_ENGINE_INTERPRETER = 0, DSP_ENGINE_PIPELINED, DSP_ENGINE_LOCKSTEP };
+
+uint64_t DSPGetDivergences(void);
+
+// DSP traces (see DSP.CPP)
+
+struct DSPReplayStats
+{
+	uint64_t slices;						// Timeslices in the trace
+	uint64_t instructions;					// Instructions run
+	uint64_t mismatches;					// Reads & writes that didn't match
+	uint64_t divergences;					// Lockstep check failures
+};
+
+bool DSPTraceStart(const char * filename);
+void DSPTraceStop(void);
+bool DSPTraceReplay(const char * filename, DSPReplayStats & stats);
 
 // Exported vars
 
 extern bool doDSPDis;
-extern uint32_t dsp_reg_bank_0[], dsp_reg_bank_1[];
+extern const char * dspEngineName[3];
+extern MACHINE_STATE uint32_t dsp_reg_bank_0[], dsp_reg_bank_1[];
 
 // DSP interrupt numbers (in $F1A100, bits 4-8 & 16)
 
@@ -17,14 +17,16 @@
 
 #include <stdlib.h>
 #include <string.h>								// For memset
+#include "crc32.h"
 #include "jaguar.h"
 #include "log.h"
 #include "settings.h"
+#include "state.h"
 
 //#define eeprom_LOG
 
-static uint16_t eeprom_ram[64];
-static uint16_t cdromEEPROM[64];
+static MACHINE_STATE uint16_t eeprom_ram[64];
+static MACHINE_STATE uint16_t cdromEEPROM[64];
 
 //
 // Private function prototypes
@@ -50,39 +52,40 @@ enum { EENOP, EEWRITEALL, EEWRITE, EEREAD };
 
 // Local global variables
 
-static uint16_t jerry_ee_state = EE_STATE_START;
-static uint16_t jerry_ee_op = 0;
-static uint16_t jerry_ee_rstate = 0;
-static uint16_t jerry_ee_address_data = 0;
-static uint16_t jerry_ee_address_cnt = 6;
-static uint16_t jerry_ee_data = 0;
-static uint16_t jerry_ee_data_cnt = 16;
-static uint16_t jerry_writes_enabled = 0;
-static uint16_t jerry_ee_direct_jump = 0;
-
-static uint16_t butchEEState = EE_STATE_START;
-static uint16_t butchEEOp = 0;
-static uint16_t butchEERState = 0;
-static uint16_t butchEEAddressData = 0;
-static uint16_t butchEEAddressCnt = 6;
+static MACHINE_STATE uint16_t jerry_ee_state = EE_STATE_START;
+static MACHINE_STATE uint16_t jerry_ee_op = 0;
+static MACHINE_STATE uint16_t jerry_ee_rstate = 0;
+static MACHINE_STATE uint16_t jerry_ee_address_data = 0;
+static MACHINE_STATE uint16_t jerry_ee_address_cnt = 6;
+static MACHINE_STATE uint16_t jerry_ee_data = 0;
+static MACHINE_STATE uint16_t jerry_ee_data_cnt = 16;
+static MACHINE_STATE uint16_t jerry_writes_enabled = 0;
+static MACHINE_STATE uint16_t jerry_ee_direct_jump = 0;
+
+static MACHINE_STATE uint16_t butchEEState = EE_STATE_START;
+static MACHINE_STATE uint16_t butchEEOp = 0;
+static MACHINE_STATE uint16_t butchEERState = 0;
+static MACHINE_STATE uint16_t butchEEAddressData = 0;
+static MACHINE_STATE uint16_t butchEEAddressCnt = 6;
 //static uint16_t butchEEData = 0;
 //static uint16_t butchEEDataCnt = 16;
-static uint16_t butchWritesEnabled = 0;
-static uint16_t butchEEDirectJump = 0;
+static MACHINE_STATE uint16_t butchWritesEnabled = 0;
+static MACHINE_STATE uint16_t butchEEDirectJump = 0;
 
-static uint16_t butchCmd;
-static uint16_t butchCmdCnt;
-static uint16_t butchReady;
-static uint16_t butchEECmd;
-static uint16_t butchEEReg;
-static uint16_t butchEEWriteEnable;
-static uint32_t butchEEData;
-static uint16_t butchEEDataCnt;
+static MACHINE_STATE uint16_t butchCmd;
+static MACHINE_STATE uint16_t butchCmdCnt;
+static MACHINE_STATE uint16_t butchReady;
+static MACHINE_STATE uint16_t butchEECmd;
+static MACHINE_STATE uint16_t butchEEReg;
+static MACHINE_STATE uint16_t butchEEWriteEnable;
+static MACHINE_STATE uint32_t butchEEData;
+static MACHINE_STATE uint16_t butchEEDataCnt;
 
-static char eeprom_filename[MAX_PATH];
-static char cdromEEPROMFilename[MAX_PATH];
-static bool haveEEPROM = false;
-static bool haveCDROMEEPROM = false;
+static MACHINE_STATE char eeprom_filename[MAX_PATH];
+static MACHINE_STATE char cdromEEPROMFilename[MAX_PATH];
+static MACHINE_STATE bool haveEEPROM = false;
+static MACHINE_STATE bool haveCDROMEEPROM = false;
+static MACHINE_STATE uint32_t eepromActivity;		// Bits sent to either EEPROM
 
 
 void EepromInit(void)
@@ -140,8 +143,81 @@ void EepromDone(void)
 }
 
 
+// See STATE.CPP
+void EepromSnapshot(void)
+{
+	// What's in the EEPROMs came from the save files, and the boot cache's
+	// snapshot gets put back long after it was taken, so it mustn't take them
+	// back to how they were then. (Run-ahead has to undo what the frames it
+	// ran did, though.)
+	if (SnapshotSlot() != SNAPSHOT_BOOT)
+	{
+		SNAPSHOT(eeprom_ram);
+		SNAPSHOT(cdromEEPROM);
+	}
+
+	SNAPSHOT(jerry_ee_state);
+	SNAPSHOT(jerry_ee_op);
+	SNAPSHOT(jerry_ee_rstate);
+	SNAPSHOT(jerry_ee_address_data);
+	SNAPSHOT(jerry_ee_address_cnt);
+	SNAPSHOT(jerry_ee_data);
+	SNAPSHOT(jerry_ee_data_cnt);
+	SNAPSHOT(jerry_writes_enabled);
+	SNAPSHOT(jerry_ee_direct_jump);
+	SNAPSHOT(butchEEState);
+	SNAPSHOT(butchEEOp);
+	SNAPSHOT(butchEERState);
+	SNAPSHOT(butchEEAddressData);
+	SNAPSHOT(butchEEAddressCnt);
+	SNAPSHOT(butchWritesEnabled);
+	SNAPSHOT(butchEEDirectJump);
+	SNAPSHOT(butchCmd);
+	SNAPSHOT(butchCmdCnt);
+	SNAPSHOT(butchReady);
+	SNAPSHOT(butchEECmd);
+	SNAPSHOT(butchEEReg);
+	SNAPSHOT(butchEEWriteEnable);
+	SNAPSHOT(butchEEData);
+	SNAPSHOT(butchEEDataCnt);
+}
+
+
+//
+// How many bits the software has sent to the EEPROMs so far; if this hasn't
+// moved, nothing has read or written them
+//
+uint32_t EepromGetActivity(void)
+{
+	return eepromActivity;
+}
+
+
+//
+// CRC of what's in both EEPROMs
+//
+uint32_t EepromGetCRC(void)
+{
+	uint8_t buffer[256];
+
+	for(int i=0; i<64; i++)
+	{
+		buffer[(i * 2) + 0] = eeprom_ram[i] >> 8;
+		buffer[(i * 2) + 1] = eeprom_ram[i] & 0xFF;
+		buffer[128 + (i * 2) + 0] = cdromEEPROM[i] >> 8;
+		buffer[128 + (i * 2) + 1] = cdromEEPROM[i] & 0xFF;
+	}
+
+	return crc32_calcCheckSum(buffer, 256);
+}
+
+
 static void EEPROMSave(void)
 {
+	// A frame that's only being looked ahead at gets run again for real
+	if (jaguarRunningAhead)
+		return;
+
 	// Write out regular cartridge EEPROM data
 	FILE * fp = fopen(eeprom_filename, "wb");
 
@@ -157,6 +233,9 @@ static void EEPROMSave(void)
 
 static void CDEEPROMSave(void)
 {
+	if (jaguarRunningAhead)
+		return;
+
 	// Write out JagCD EEPROM data
 	FILE * fp = fopen(cdromEEPROMFilename, "wb");
 
@@ -274,6 +353,8 @@ void ButchEEWriteLong(uint32_t data)
 
 static void eeprom_set_di(uint32_t data)
 {
+	eepromActivity++;
+
 //	WriteLog("eeprom: di=%i\n",data);
 //	WriteLog("eeprom: state %i\n",jerry_ee_state);
 	switch (jerry_ee_state)
@@ -501,6 +582,8 @@ static uint32_t eeprom_get_do(void)
 //
 static void ButchEESetDI(uint32_t data)
 {
+	eepromActivity++;
+
 	if (data & 0x01)
 	{
 WriteLog("EEPROM: Butch CS strobed...\n");
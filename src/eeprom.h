@@ -6,10 +6,14 @@
 #define __EEPROM_H__
 
 #include <stdint.h>
+#include "machine.h"
 
 void EepromInit(void);
 void EepromReset(void);
 void EepromDone(void);
+void EepromSnapshot(void);
+uint32_t EepromGetActivity(void);
+uint32_t EepromGetCRC(void);
 
 uint8_t EepromReadByte(uint32_t offset);
 uint16_t EepromReadWord(uint32_t offset);
@@ -20,7 +20,9 @@
 #include "event.h"
 
 #include <stdint.h>
+#include "machine.h"
 #include "log.h"
+#include "state.h"
 
 
 //#define EVENT_LIST_SIZE       512
@@ -49,11 +51,11 @@ struct Event
 };
 
 
-static Event eventList[EVENT_LIST_SIZE];
-static Event eventListJERRY[EVENT_LIST_SIZE];
-static uint32_t nextEvent;
-static uint32_t nextEventJERRY;
-static uint32_t numberOfEvents;
+static MACHINE_STATE Event eventList[EVENT_LIST_SIZE];
+static MACHINE_STATE Event eventListJERRY[EVENT_LIST_SIZE];
+static MACHINE_STATE uint32_t nextEvent;
+static MACHINE_STATE uint32_t nextEventJERRY;
+static MACHINE_STATE uint32_t numberOfEvents;
 
 
 void InitializeEventList(void)
@@ -262,6 +264,62 @@ void HandleNextEvent(int type/*= EVENT_MAIN*/)
 }
 
 
+//
+// Everything that can be in the lists. A snapshot has the callbacks in it by
+// where they are in here instead of where they are in memory, so it's still
+// good in another run (see STATE.CPP).
+//
+void HalflineCallback(void);
+void TOMPITCallback(void);
+void JERRYPIT1Callback(void);
+void JERRYPIT2Callback(void);
+void JERRYI2SCallback(void);
+void DSPBufferCallback(void);
+
+static void (* const eventCallbacks[])(void) = {
+	HalflineCallback, TOMPITCallback, JERRYPIT1Callback, JERRYPIT2Callback,
+	JERRYI2SCallback, DSPBufferCallback
+};
+
+#define NUM_EVENT_CALLBACKS		(sizeof(eventCallbacks) / sizeof(eventCallbacks[0]))
+
+
+static void SnapshotEvent(Event & event)
+{
+	SNAPSHOT(event.valid);
+	SNAPSHOT(event.eventType);
+	SNAPSHOT(event.eventTime);
+
+	uint8_t callback = 0xFF;
+
+	for(uint32_t i=0; i<NUM_EVENT_CALLBACKS; i++)
+		if (event.timerCallback == eventCallbacks[i])
+			callback = i;
+
+	if (event.valid && (callback == 0xFF))
+		WriteLog("EVENT: Snapshot of an event with an unknown callback!\n");
+
+	// Taking a snapshot, this puts back what was there; putting one back, it
+	// fills in the callback
+	SNAPSHOT(callback);
+	event.timerCallback = (callback < NUM_EVENT_CALLBACKS ? eventCallbacks[callback] : NULL);
+}
+
+
+void EventSnapshot(void)
+{
+	for(uint32_t i=0; i<EVENT_LIST_SIZE; i++)
+	{
+		SnapshotEvent(eventList[i]);
+		SnapshotEvent(eventListJERRY[i]);
+	}
+
+	SNAPSHOT(nextEvent);
+	SNAPSHOT(nextEventJERRY);
+	SNAPSHOT(numberOfEvents);
+}
+
+
 /*
 void OPCallback(void)
 {
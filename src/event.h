@@ -28,5 +28,6 @@ void RemoveCallback(void (* callback)(void));
 void AdjustCallbackTime(void (* callback)(void), double time);
 double GetTimeToNextEvent(int type = EVENT_MAIN);
 void HandleNextEvent(int type = EVENT_MAIN);
+void EventSnapshot(void);
 
 #endif	// __EVENT_H__
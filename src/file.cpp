@@ -29,9 +29,24 @@
 #include "unzip.h"
 #include "zlib.h"
 
+#ifdef __GCCUNIX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 // Private function prototypes
 
-static int gzfilelength(gzFile gd);
+static bool IsGzippedFile(const char * path, uint32_t & sizeHint);
+static uint32_t LoadGzippedFile(const char * path, uint32_t sizeHint, uint8_t * &rom);
+#ifdef __GCCUNIX__
+static uint32_t MapPlainFile(const char * path, uint8_t * &rom);
+#else
+static uint32_t LoadPlainFile(const char * path, uint8_t * &rom);
+#endif
+static uint32_t LoadROM(uint8_t * &rom, char * path, bool & mapped);
+static void FreeROM(uint8_t * rom, uint32_t size, bool mapped);
 static bool CheckExtension(const char * filename, const char * ext);
 //static int ParseFileType(uint8_t header1, uint8_t header2, uint32_t size);
 
@@ -42,11 +57,36 @@ static bool CheckExtension(const char * filename, const char * ext);
 // Generic ROM loading
 //
 uint32_t JaguarLoadROM(uint8_t * &rom, char * path)
+{
+	bool mapped;
+	uint32_t romSize = LoadROM(rom, path, mapped);
+
+	// The caller gets a buffer of its own, to delete[]
+	if (mapped)
+	{
+		uint8_t * buffer = new uint8_t[romSize];
+		memcpy(buffer, rom, romSize);
+		FreeROM(rom, romSize, true);
+		rom = buffer;
+	}
+
+	return romSize;
+}
+
+
+//
+// Load a ROM image into <rom>. Plain files (on POSIX systems) come back as a
+// read only mapping of the file, so the image can be set up straight out of
+// the page cache; <mapped> says which it is. Either way, FreeROM() gets rid of
+// it.
+//
+static uint32_t LoadROM(uint8_t * &rom, char * path, bool & mapped)
 {
 // We really should have some kind of sanity checking for the ROM size here to prevent
 // a buffer overflow... !!! FIX !!!
 #warning "!!! FIX !!! Should have sanity checking for ROM size to prevent buffer overflow!"
 	uint32_t romSize = 0;
+	mapped = false;
 
 	WriteLog("FILE: JaguarLoadROM attempting to load file '%s'...", path);
 	char * ext = strrchr(path, '.');
@@ -84,20 +124,30 @@ uint32_t JaguarLoadROM(uint8_t * &rom, char * path)
 	else
 	{
 		// Handle gzipped files transparently [Adam Green]...
+		// N.B.: Everything else is used straight out of the file, since
+		//       there's no point in running plain data through zlib.
+		uint32_t sizeHint = 0;
 
-		gzFile fp = gzopen(path, "rb");
+		if (IsGzippedFile(path, sizeHint))
+		{
+			WriteLog("(gzipped)...");
+			romSize = LoadGzippedFile(path, sizeHint, rom);
+		}
+		else
+		{
+#ifdef __GCCUNIX__
+			romSize = MapPlainFile(path, rom);
+			mapped = (romSize > 0);
+#else
+			romSize = LoadPlainFile(path, rom);
+#endif
+		}
 
-		if (fp == NULL)
+		if (romSize == 0)
 		{
 			WriteLog("Failed!\n");
 			return 0;
 		}
-
-		romSize = gzfilelength(fp);
-		rom = new uint8_t[romSize];
-		gzseek(fp, 0, SEEK_SET);
-		gzread(fp, rom, romSize);
-		gzclose(fp);
 	}
 
 	WriteLog("OK (%i bytes)\n", romSize);
@@ -106,6 +156,23 @@ uint32_t JaguarLoadROM(uint8_t * &rom, char * path)
 }
 
 
+//
+// Get rid of a ROM image from LoadROM()
+//
+static void FreeROM(uint8_t * rom, uint32_t size, bool mapped)
+{
+#ifdef __GCCUNIX__
+	if (mapped)
+	{
+		munmap(rom, size);
+		return;
+	}
+#endif
+
+	delete[] rom;
+}
+
+
 //
 // Jaguar file loading
 // We do a more intelligent file analysis here instead of relying on (possible
@@ -115,7 +182,8 @@ uint32_t JaguarLoadROM(uint8_t * &rom, char * path)
 bool JaguarLoadFile(char * path)
 {
 	uint8_t * buffer = NULL;
-	jaguarROMSize = JaguarLoadROM(buffer, path);
+	bool mapped;
+	jaguarROMSize = LoadROM(buffer, path, mapped);
 
 	if (jaguarROMSize == 0)
 	{
@@ -140,7 +208,7 @@ bool JaguarLoadFile(char * path)
 // Checking something...
 jaguarRunAddress = GET32(jagMemSpace, 0x800404);
 WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress);
-		delete[] buffer;
+		FreeROM(buffer, jaguarROMSize, mapped);
 		return true;
 	}
 	else if (fileType == JST_ALPINE)
@@ -149,7 +217,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 		WriteLog("FILE: Setting up Alpine ROM... Run address: 00802000, length: %08X\n", jaguarROMSize);
 		memset(jagMemSpace + 0x800000, 0xFF, 0x2000);
 		memcpy(jagMemSpace + 0x802000, buffer, jaguarROMSize);
-		delete[] buffer;
+		FreeROM(buffer, jaguarROMSize, mapped);
 
 // Maybe instead of this, we could try requiring the STUBULATOR ROM? Just a thought...
 		// Try setting the vector to say, $1000 and putting an instruction there that loops forever:
@@ -165,7 +233,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 			codeSize = GET32(buffer, 0x02) + GET32(buffer, 0x06);
 		WriteLog("FILE: Setting up homebrew (ABS-1)... Run address: %08X, length: %08X\n", loadAddress, codeSize);
 		memcpy(jagMemSpace + loadAddress, buffer + 0x24, codeSize);
-		delete[] buffer;
+		FreeROM(buffer, jaguarROMSize, mapped);
 		jaguarRunAddress = loadAddress;
 		return true;
 	}
@@ -175,7 +243,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 			codeSize = GET32(buffer, 0x18) + GET32(buffer, 0x1C);
 		WriteLog("FILE: Setting up homebrew (ABS-2)... Run address: %08X, length: %08X\n", runAddress, codeSize);
 		memcpy(jagMemSpace + loadAddress, buffer + 0xA8, codeSize);
-		delete[] buffer;
+		FreeROM(buffer, jaguarROMSize, mapped);
 		jaguarRunAddress = runAddress;
 		return true;
 	}
@@ -223,7 +291,7 @@ WriteLog("FILE: Cartridge run address is reported as $%X...\n", jaguarRunAddress
 			uint32_t loadAddress = GET32(buffer, 0x22), runAddress = GET32(buffer, 0x2A);
 			WriteLog("FILE: Setting up homebrew (Jag Server)... Run address: $%X, length: $%X\n", runAddress, jaguarROMSize - 0x2E);
 			memcpy(jagMemSpace + loadAddress, buffer + 0x2E, jaguarROMSize - 0x2E);
-			delete[] buffer;
+			FreeROM(buffer, jaguarROMSize, mapped);
 			jaguarRunAddress = runAddress;
 
 // Hmm. Is this kludge necessary?
@@ -247,13 +315,14 @@ SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 		uint32_t loadAddress = (buffer[0x1F] << 24) | (buffer[0x1E] << 16) | (buffer[0x1D] << 8) | buffer[0x1C];
 		WriteLog("FILE: Setting up homebrew (GEMDOS WTFOMGBBQ type)... Run address: $%X, length: $%X\n", loadAddress, jaguarROMSize - 0x20);
 		memcpy(jagMemSpace + loadAddress, buffer + 0x20, jaguarROMSize - 0x20);
-		delete[] buffer;
+		FreeROM(buffer, jaguarROMSize, mapped);
 		jaguarRunAddress = loadAddress;
 		return true;
 	}
 
 	// We can assume we have JST_NONE at this point. :-P
 	WriteLog("FILE: Failed to load headerless file.\n");
+	FreeROM(buffer, jaguarROMSize, mapped);
 	return false;
 }
 
@@ -267,7 +336,8 @@ SET16(jaguarMainRAM, 0x1000, 0x60FE);		// Here: bra Here
 bool AlpineLoadFile(char * path)
 {
 	uint8_t * buffer = NULL;
-	jaguarROMSize = JaguarLoadROM(buffer, path);
+	bool mapped;
+	jaguarROMSize = LoadROM(buffer, path, mapped);
 
 	if (jaguarROMSize == 0)
 	{
@@ -286,7 +356,7 @@ bool AlpineLoadFile(char * path)
 
 	memset(jagMemSpace + 0x800000, 0xFF, 0x2000);
 	memcpy(jagMemSpace + 0x802000, buffer, jaguarROMSize);
-	delete[] buffer;
+	FreeROM(buffer, jaguarROMSize, mapped);
 
 // Maybe instead of this, we could try requiring the STUBULATOR ROM? Just a thought...
 	// Try setting the vector to say, $1000 and putting an instruction there
@@ -300,32 +370,163 @@ bool AlpineLoadFile(char * path)
 
 
 //
-// Get the length of a (possibly) gzipped file
+// Check for the gzip magic number. If it's there, also pull the uncompressed
+// size (modulo 2^32) out of the gzip trailer so we can size the buffer up
+// front instead of inflating the whole thing twice.
 //
-static int gzfilelength(gzFile gd)
+static bool IsGzippedFile(const char * path, uint32_t & sizeHint)
 {
-   int size = 0, length = 0;
-   unsigned char buffer[0x10000];
+	sizeHint = 0;
+	FILE * fp = fopen(path, "rb");
 
-   gzrewind(gd);
+	if (fp == NULL)
+		return false;
 
-   do
-   {
-      // Read in chunks until EOF
-      size = gzread(gd, buffer, 0x10000);
+	uint8_t header[2] = { 0, 0 };
+	bool gzipped = (fread(header, 1, 2, fp) == 2)
+		&& (header[0] == 0x1F) && (header[1] == 0x8B);
 
-      if (size <= 0)
-      	break;
+	if (gzipped && (fseek(fp, -4, SEEK_END) == 0))
+	{
+		uint8_t trailer[4];
 
-      length += size;
-   }
-   while (!gzeof(gd));
+		// ISIZE is stored little endian
+		if (fread(trailer, 1, 4, fp) == 4)
+			sizeHint = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16)
+				| ((uint32_t)trailer[3] << 24);
+	}
 
-   gzrewind(gd);
-   return length;
+	fclose(fp);
+	return gzipped;
 }
 
 
+//
+// Inflate a gzipped file in one pass. We trust the size hint from the trailer
+// as a starting point, but grow the buffer if the stream turns out to be
+// bigger than advertised (concatenated gzip members can do this).
+//
+static uint32_t LoadGzippedFile(const char * path, uint32_t sizeHint, uint8_t * &rom)
+{
+	gzFile fp = gzopen(path, "rb");
+
+	if (fp == NULL)
+		return 0;
+
+	// Sanity check the hint; a bogus trailer shouldn't make us allocate the
+	// moon. Anything bigger than the Jaguar's address space is nonsense anyway.
+	uint32_t capacity = ((sizeHint > 0) && (sizeHint <= 0x1000000) ? sizeHint : 0x100000);
+	uint8_t * buffer = new uint8_t[capacity];
+	uint32_t length = 0;
+
+	while (true)
+	{
+		if (length == capacity)
+		{
+			// Peek to see if there's anything left before growing the buffer
+			int c = gzgetc(fp);
+
+			if (c == -1)
+				break;
+
+			uint8_t * newBuffer = new uint8_t[capacity * 2];
+			memcpy(newBuffer, buffer, length);
+			delete[] buffer;
+			buffer = newBuffer;
+			capacity *= 2;
+			buffer[length++] = (uint8_t)c;
+		}
+
+		int size = gzread(fp, buffer + length, capacity - length);
+
+		if (size <= 0)
+			break;
+
+		length += size;
+	}
+
+	gzclose(fp);
+
+	if (length == 0)
+	{
+		delete[] buffer;
+		return 0;
+	}
+
+	rom = buffer;
+	return length;
+}
+
+
+#ifdef __GCCUNIX__
+//
+// Map an uncompressed file, read only. What's in it only gets copied once,
+// when it's set up in jagMemSpace; munmap() it when done.
+//
+static uint32_t MapPlainFile(const char * path, uint8_t * &rom)
+{
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0) || (st.st_size > 0x1000000))
+	{
+		close(fd);
+		return 0;
+	}
+
+	uint32_t length = (uint32_t)st.st_size;
+	void * map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED)
+		return 0;
+
+	madvise(map, length, MADV_SEQUENTIAL);
+	rom = (uint8_t *)map;
+
+	return length;
+}
+#else
+//
+// Load an uncompressed file
+//
+static uint32_t LoadPlainFile(const char * path, uint8_t * &rom)
+{
+	FILE * fp = fopen(path, "rb");
+
+	if (fp == NULL)
+		return 0;
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if ((size <= 0) || (size > 0x1000000))
+	{
+		fclose(fp);
+		return 0;
+	}
+
+	uint32_t length = (uint32_t)size;
+	rom = new uint8_t[length];
+
+	if (fread(rom, 1, length, fp) != length)
+	{
+		delete[] rom;
+		rom = NULL;
+		length = 0;
+	}
+
+	fclose(fp);
+	return length;
+}
+#endif
+
+
 //
 // Compare extension to passed in filename. If equal, return true; otherwise false.
 //
@@ -454,18 +655,13 @@ uint32_t GetFileDBIdentityFromZIP(const char * zipFile)
 	// Loop through all files in the zip file under consideration
 	while (GetZIPHeader(zip, ze))
 	{
-		// & loop through all known CRC32s in our file DB to see if it's there!
-		uint32_t index = 0;
+		// & see if it's in our file DB!
+		uint32_t index = FileDBFindCRC(ze.crc32);
 
-		while (romList[index].crc32 != 0xFFFFFF)
+		if (index != FILEDB_NOT_FOUND)
 		{
-			if (romList[index].crc32 == ze.crc32)
-			{
-				fclose(zip);
-				return index;
-			}
-
-			index++;
+			fclose(zip);
+			return index;
 		}
 
 		// We didn't find it, so skip the compressed data...
@@ -13,6 +13,18 @@
 
 #include "filedb.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "log.h"
+
+#ifdef __GCCUNIX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 #if 0
 struct RomIdentifier
@@ -135,3 +147,267 @@ RomIdentifier romList[] = {
 	{ 0xF7756A03, "Tripper Getem (World)", FF_ROM | FF_VERIFIED },
 	{ 0xFFFFFFFF, "***END***", 0 }
 };
+
+
+//
+// Everything below here deals with finding things in the DB. The built-in
+// table gets an open addressed hash index built for it at startup; an external
+// DB (if there is one) carries its own.
+//
+
+#define BUILTIN_HASH_SLOTS	1024					// Must be a power of 2
+
+static uint16_t builtInHash[BUILTIN_HASH_SLOTS];	// index + 1, 0 == empty
+static bool useBuiltInDB = true;
+
+// External DB
+static const uint8_t * dbBase = NULL;
+static uint32_t dbSize = 0;
+static uint32_t dbCount = 0;
+static uint32_t dbHashSlots = 0;
+static const uint8_t * dbEntries = NULL;
+static const uint8_t * dbHash = NULL;
+static bool dbMapped = false;
+
+static struct BuiltInHashInit
+{
+	BuiltInHashInit()
+	{
+		for(uint32_t i=0; romList[i].crc32!=0xFFFFFFFF; i++)
+		{
+			uint32_t slot = romList[i].crc32 & (BUILTIN_HASH_SLOTS - 1);
+
+			while (builtInHash[slot] != 0)
+			{
+				// Duplicate CRCs: first one wins, same as the old linear search
+				if (romList[builtInHash[slot] - 1].crc32 == romList[i].crc32)
+					break;
+
+				slot = (slot + 1) & (BUILTIN_HASH_SLOTS - 1);
+			}
+
+			if (builtInHash[slot] == 0)
+				builtInHash[slot] = i + 1;
+		}
+	}
+} builtInHashInit;
+
+
+static inline uint32_t GetLE32(const uint8_t * p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)
+		| ((uint32_t)p[3] << 24);
+}
+
+
+static uint32_t FindCRCInBuiltIn(uint32_t crc)
+{
+	uint32_t slot = crc & (BUILTIN_HASH_SLOTS - 1);
+
+	while (builtInHash[slot] != 0)
+	{
+		uint32_t index = builtInHash[slot] - 1;
+
+		if (romList[index].crc32 == crc)
+			return index;
+
+		slot = (slot + 1) & (BUILTIN_HASH_SLOTS - 1);
+	}
+
+	return FILEDB_NOT_FOUND;
+}
+
+
+static uint32_t FindCRCInExternal(uint32_t crc)
+{
+	uint32_t slot = crc & (dbHashSlots - 1);
+
+	// The table is never full (the builder sees to that) so this terminates
+	for(uint32_t i=0; i<dbHashSlots; i++)
+	{
+		uint32_t index = GetLE32(dbHash + (slot * 4));
+
+		if (index == 0)
+			break;
+
+		if (GetLE32(dbEntries + ((index - 1) * FILEDB_ENTRY_SIZE)) == crc)
+			return index - 1;
+
+		slot = (slot + 1) & (dbHashSlots - 1);
+	}
+
+	return FILEDB_NOT_FOUND;
+}
+
+
+//
+// Load an external file DB. If useBuiltIn is true, CRCs that aren't in the
+// external DB are looked up in the built-in one as well. If the DB can't be
+// loaded, we carry on with the built-in DB only.
+//
+bool FileDBLoad(const char * path, bool useBuiltIn/*= true*/)
+{
+	FileDBUnload();
+	useBuiltInDB = useBuiltIn;
+
+	if ((path == NULL) || (path[0] == 0))
+		return false;
+
+#ifdef __GCCUNIX__
+	int fd = open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size < FILEDB_HEADER_SIZE)
+		|| ((uint64_t)st.st_size > 0xFFFFFFFF))
+	{
+		close(fd);
+		return false;
+	}
+
+	void * map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED)
+		return false;
+
+	dbBase = (const uint8_t *)map;
+	dbSize = st.st_size;
+	dbMapped = true;
+#else
+	FILE * fp = fopen(path, "rb");
+
+	if (fp == NULL)
+		return false;
+
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	if ((size < FILEDB_HEADER_SIZE) || ((uint64_t)size > 0xFFFFFFFF))
+	{
+		fclose(fp);
+		return false;
+	}
+
+	uint8_t * buffer = (uint8_t *)malloc(size);
+
+	if ((buffer == NULL) || (fread(buffer, 1, size, fp) != (size_t)size))
+	{
+		free(buffer);
+		fclose(fp);
+		return false;
+	}
+
+	fclose(fp);
+	dbBase = buffer;
+	dbSize = size;
+#endif
+
+	dbCount = GetLE32(dbBase + 8);
+	dbHashSlots = GetLE32(dbBase + 12);
+	dbEntries = dbBase + FILEDB_HEADER_SIZE;
+
+	// Sanity check what we were handed before we go trusting any of it. (The
+	// size is worked out in 64 bits, so a huge header can't wrap it around.)
+	if ((GetLE32(dbBase) != FILEDB_MAGIC) || (GetLE32(dbBase + 4) != FILEDB_VERSION)
+		|| (dbHashSlots == 0) || ((dbHashSlots & (dbHashSlots - 1)) != 0)
+		|| (dbCount >= dbHashSlots)
+		|| ((uint64_t)dbSize < (uint64_t)FILEDB_HEADER_SIZE
+			+ ((uint64_t)dbCount * FILEDB_ENTRY_SIZE) + ((uint64_t)dbHashSlots * 4)))
+	{
+		WriteLog("FILEDB: \"%s\" is not a valid file DB.\n", path);
+		FileDBUnload();
+		return false;
+	}
+
+	dbHash = dbEntries + (dbCount * FILEDB_ENTRY_SIZE);
+
+	// Every slot has to be empty or point at an entry, so lookups don't have
+	// to check
+	for(uint32_t i=0; i<dbHashSlots; i++)
+	{
+		if (GetLE32(dbHash + (i * 4)) > dbCount)
+		{
+			WriteLog("FILEDB: \"%s\" has a bad hash slot (#%u).\n", path, i);
+			FileDBUnload();
+			return false;
+		}
+	}
+
+	// Names have to be NUL terminated, or we'll go wandering off the end
+	for(uint32_t i=0; i<dbCount; i++)
+	{
+		if (dbEntries[(i * FILEDB_ENTRY_SIZE) + FILEDB_ENTRY_SIZE - 1] != 0)
+		{
+			WriteLog("FILEDB: \"%s\" has a bad entry (#%u).\n", path, i);
+			FileDBUnload();
+			return false;
+		}
+	}
+
+	WriteLog("FILEDB: Loaded %u entries from \"%s\".\n", dbCount, path);
+	return true;
+}
+
+
+void FileDBUnload(void)
+{
+	if (dbBase != NULL)
+	{
+#ifdef __GCCUNIX__
+		if (dbMapped)
+			munmap((void *)dbBase, dbSize);
+#endif
+		if (!dbMapped)
+			free((void *)dbBase);
+	}
+
+	dbBase = dbEntries = dbHash = NULL;
+	dbSize = dbCount = dbHashSlots = 0;
+	dbMapped = false;
+}
+
+
+//
+// Find a CRC in the file DB. If it's there, return the index, otherwise
+// return FILEDB_NOT_FOUND ($FFFFFFFF).
+//
+uint32_t FileDBFindCRC(uint32_t crc)
+{
+	if (dbBase == NULL)
+		return FindCRCInBuiltIn(crc);
+
+	uint32_t index = FindCRCInExternal(crc);
+
+	if ((index == FILEDB_NOT_FOUND) && useBuiltInDB)
+	{
+		index = FindCRCInBuiltIn(crc);
+
+		if (index != FILEDB_NOT_FOUND)
+			index |= FILEDB_BUILTIN;
+	}
+
+	return index;
+}
+
+
+const char * FileDBName(uint32_t index)
+{
+	if ((dbBase == NULL) || (index & FILEDB_BUILTIN))
+		return romList[index & ~FILEDB_BUILTIN].name;
+
+	return (const char *)(dbEntries + (index * FILEDB_ENTRY_SIZE) + 8);
+}
+
+
+uint32_t FileDBFlags(uint32_t index)
+{
+	if ((dbBase == NULL) || (index & FILEDB_BUILTIN))
+		return romList[index & ~FILEDB_BUILTIN].flags;
+
+	return GetLE32(dbEntries + (index * FILEDB_ENTRY_SIZE) + 4);
+}
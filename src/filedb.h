@@ -25,4 +25,32 @@ struct RomIdentifier
 
 extern RomIdentifier romList[];
 
+// External file DB. The layout (all values little endian) is:
+//
+//   $00  'VJDB'
+//   $04  version (FILEDB_VERSION)
+//   $08  number of entries
+//   $0C  number of hash slots (power of 2)
+//   $10  entries, sorted by CRC32: CRC32 (4), flags (4), name (128, NUL
+//        terminated)
+//   ...  hash slots: index of entry + 1 (0 == empty), linear probing from
+//        (CRC32 & (slots - 1))
+//
+// Indices handed back for entries that came from the built-in table (when the
+// external DB is loaded but doesn't know about a file) have FILEDB_BUILTIN set.
+
+#define FILEDB_MAGIC		0x42444A56			// 'VJDB'
+#define FILEDB_VERSION		1
+#define FILEDB_HEADER_SIZE	16
+#define FILEDB_NAME_LENGTH	128
+#define FILEDB_ENTRY_SIZE	(8 + FILEDB_NAME_LENGTH)
+#define FILEDB_BUILTIN		0x80000000
+#define FILEDB_NOT_FOUND	0xFFFFFFFF
+
+bool FileDBLoad(const char * path, bool useBuiltIn = true);
+void FileDBUnload(void);
+uint32_t FileDBFindCRC(uint32_t crc);
+const char * FileDBName(uint32_t index);
+uint32_t FileDBFlags(uint32_t index);
+
 #endif	// __FILEDB_H__
@@ -28,12 +28,18 @@
 
 #include <stdlib.h>
 #include <string.h>								// For memset
+#include <atomic>
+#include <thread>
+#include "SDL.h"
 #include "dsp.h"
 #include "jagdasm.h"
+#include "jagrisc.h"
 #include "jaguar.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
 //#include "memory.h"
+#include "settings.h"
+#include "state.h"
 #include "tom.h"
 
 
@@ -41,63 +47,12 @@
 #define GPU_CORRECT_ALIGNMENT
 //#define GPU_DEBUG
 
-// For GPU dissasembly...
+// For GPU dissasembly... (The opcodes shared with the DSP are traced by the
+// RISC core instead; see gpu_start_log.)
 
 #if 0
-#define GPU_DIS_ABS
-#define GPU_DIS_ADD
-#define GPU_DIS_ADDC
-#define GPU_DIS_ADDQ
-#define GPU_DIS_ADDQT
-#define GPU_DIS_AND
-#define GPU_DIS_BCLR
-#define GPU_DIS_BSET
-#define GPU_DIS_BTST
-#define GPU_DIS_CMP
-#define GPU_DIS_CMPQ
-#define GPU_DIS_DIV
-#define GPU_DIS_IMULT
-#define GPU_DIS_JUMP
-#define GPU_DIS_JR
-#define GPU_DIS_LOAD
-#define GPU_DIS_LOADB
-#define GPU_DIS_LOADW
-#define GPU_DIS_LOAD14I
-#define GPU_DIS_LOAD14R
-#define GPU_DIS_LOAD15I
-#define GPU_DIS_LOAD15R
-#define GPU_DIS_MOVE
-#define GPU_DIS_MOVEFA
-#define GPU_DIS_MOVEI
-#define GPU_DIS_MOVEPC
-#define GPU_DIS_MOVETA
-#define GPU_DIS_MOVEQ
-#define GPU_DIS_MULT
-#define GPU_DIS_NEG
-#define GPU_DIS_NOP
-#define GPU_DIS_NOT
-#define GPU_DIS_OR
 #define GPU_DIS_PACK
-#define GPU_DIS_ROR
-#define GPU_DIS_RORQ
 #define GPU_DIS_SAT8
-#define GPU_DIS_SH
-#define GPU_DIS_SHA
-#define GPU_DIS_SHARQ
-#define GPU_DIS_SHLQ
-#define GPU_DIS_SHRQ
-#define GPU_DIS_STORE
-#define GPU_DIS_STOREB
-#define GPU_DIS_STOREW
-#define GPU_DIS_STORE14I
-#define GPU_DIS_STORE14R
-#define GPU_DIS_STORE15I
-#define GPU_DIS_STORE15R
-#define GPU_DIS_SUB
-#define GPU_DIS_SUBC
-#define GPU_DIS_SUBQ
-#define GPU_DIS_SUBQT
-#define GPU_DIS_XOR
 
 bool doGPUDis = false;
 //bool doGPUDis = true;
@@ -184,70 +139,12 @@ void GPUDumpDisassembly(void);
 void GPUDumpRegisters(void);
 void GPUDumpMemory(void);
 
-static void gpu_opcode_add(void);
-static void gpu_opcode_addc(void);
-static void gpu_opcode_addq(void);
-static void gpu_opcode_addqt(void);
-static void gpu_opcode_sub(void);
-static void gpu_opcode_subc(void);
-static void gpu_opcode_subq(void);
-static void gpu_opcode_subqt(void);
-static void gpu_opcode_neg(void);
-static void gpu_opcode_and(void);
-static void gpu_opcode_or(void);
-static void gpu_opcode_xor(void);
-static void gpu_opcode_not(void);
-static void gpu_opcode_btst(void);
-static void gpu_opcode_bset(void);
-static void gpu_opcode_bclr(void);
-static void gpu_opcode_mult(void);
-static void gpu_opcode_imult(void);
-static void gpu_opcode_imultn(void);
-static void gpu_opcode_resmac(void);
-static void gpu_opcode_imacn(void);
-static void gpu_opcode_div(void);
-static void gpu_opcode_abs(void);
-static void gpu_opcode_sh(void);
-static void gpu_opcode_shlq(void);
-static void gpu_opcode_shrq(void);
-static void gpu_opcode_sha(void);
-static void gpu_opcode_sharq(void);
-static void gpu_opcode_ror(void);
-static void gpu_opcode_rorq(void);
-static void gpu_opcode_cmp(void);
-static void gpu_opcode_cmpq(void);
 static void gpu_opcode_sat8(void);
 static void gpu_opcode_sat16(void);
-static void gpu_opcode_move(void);
-static void gpu_opcode_moveq(void);
-static void gpu_opcode_moveta(void);
-static void gpu_opcode_movefa(void);
-static void gpu_opcode_movei(void);
-static void gpu_opcode_loadb(void);
-static void gpu_opcode_loadw(void);
-static void gpu_opcode_load(void);
-static void gpu_opcode_loadp(void);
-static void gpu_opcode_load_r14_indexed(void);
-static void gpu_opcode_load_r15_indexed(void);
-static void gpu_opcode_storeb(void);
-static void gpu_opcode_storew(void);
-static void gpu_opcode_store(void);
-static void gpu_opcode_storep(void);
-static void gpu_opcode_store_r14_indexed(void);
-static void gpu_opcode_store_r15_indexed(void);
-static void gpu_opcode_move_pc(void);
-static void gpu_opcode_jump(void);
-static void gpu_opcode_jr(void);
-static void gpu_opcode_mmult(void);
-static void gpu_opcode_mtoi(void);
-static void gpu_opcode_normi(void);
-static void gpu_opcode_nop(void);
-static void gpu_opcode_load_r14_ri(void);
-static void gpu_opcode_load_r15_ri(void);
-static void gpu_opcode_store_r14_ri(void);
-static void gpu_opcode_store_r15_ri(void);
 static void gpu_opcode_sat24(void);
 static void gpu_opcode_pack(void);
+static void gpu_opcode_loadp(void);
+static void gpu_opcode_storep(void);
 
 // This is wrong, since it doesn't take pipeline effects into account. !!! FIX !!!
 /*uint8_t gpu_opcode_cycles[64] =
@@ -288,50 +185,42 @@ uint8_t gpu_opcode_cycles[64] =
 	1,  1,  1,  1,  1,  1,  1,  1
 };//*/
 
-void (*gpu_opcode[64])()=
-{
-	gpu_opcode_add,					gpu_opcode_addc,				gpu_opcode_addq,				gpu_opcode_addqt,
-	gpu_opcode_sub,					gpu_opcode_subc,				gpu_opcode_subq,				gpu_opcode_subqt,
-	gpu_opcode_neg,					gpu_opcode_and,					gpu_opcode_or,					gpu_opcode_xor,
-	gpu_opcode_not,					gpu_opcode_btst,				gpu_opcode_bset,				gpu_opcode_bclr,
-	gpu_opcode_mult,				gpu_opcode_imult,				gpu_opcode_imultn,				gpu_opcode_resmac,
-	gpu_opcode_imacn,				gpu_opcode_div,					gpu_opcode_abs,					gpu_opcode_sh,
-	gpu_opcode_shlq,				gpu_opcode_shrq,				gpu_opcode_sha,					gpu_opcode_sharq,
-	gpu_opcode_ror,					gpu_opcode_rorq,				gpu_opcode_cmp,					gpu_opcode_cmpq,
-	gpu_opcode_sat8,				gpu_opcode_sat16,				gpu_opcode_move,				gpu_opcode_moveq,
-	gpu_opcode_moveta,				gpu_opcode_movefa,				gpu_opcode_movei,				gpu_opcode_loadb,
-	gpu_opcode_loadw,				gpu_opcode_load,				gpu_opcode_loadp,				gpu_opcode_load_r14_indexed,
-	gpu_opcode_load_r15_indexed,	gpu_opcode_storeb,				gpu_opcode_storew,				gpu_opcode_store,
-	gpu_opcode_storep,				gpu_opcode_store_r14_indexed,	gpu_opcode_store_r15_indexed,	gpu_opcode_move_pc,
-	gpu_opcode_jump,				gpu_opcode_jr,					gpu_opcode_mmult,				gpu_opcode_mtoi,
-	gpu_opcode_normi,				gpu_opcode_nop,					gpu_opcode_load_r14_ri,			gpu_opcode_load_r15_ri,
-	gpu_opcode_store_r14_ri,		gpu_opcode_store_r15_ri,		gpu_opcode_sat24,				gpu_opcode_pack,
-};
-
-static uint8_t gpu_ram_8[0x1000];
-uint32_t gpu_pc;
-static uint32_t gpu_acc;
-static uint32_t gpu_remain;
-static uint32_t gpu_hidata;
-static uint32_t gpu_flags;
-static uint32_t gpu_matrix_control;
-static uint32_t gpu_pointer_to_matrix;
-static uint32_t gpu_data_organization;
-static uint32_t gpu_control;
-static uint32_t gpu_div_control;
+static MACHINE_STATE uint8_t gpu_ram_8[0x1000];
+MACHINE_STATE uint32_t gpu_pc;
+static MACHINE_STATE uint32_t gpu_acc;
+static MACHINE_STATE uint32_t gpu_remain;
+static MACHINE_STATE uint32_t gpu_hidata;
+static MACHINE_STATE uint32_t gpu_flags;
+static MACHINE_STATE uint32_t gpu_matrix_control;
+static MACHINE_STATE uint32_t gpu_pointer_to_matrix;
+static MACHINE_STATE uint32_t gpu_data_organization;
+static MACHINE_STATE uint32_t gpu_control;
+static MACHINE_STATE uint32_t gpu_div_control;
 // There is a distinct advantage to having these separated out--there's no need
 // to clear a bit before writing a result. I.e., if the result of an operation
 // leaves a zero in the carry flag, you don't have to zero gpu_flag_c before
 // you can write that zero!
-static uint8_t gpu_flag_z, gpu_flag_n, gpu_flag_c;
-uint32_t gpu_reg_bank_0[32];
-uint32_t gpu_reg_bank_1[32];
-static uint32_t * gpu_reg;
-static uint32_t * gpu_alternate_reg;
-
-static uint32_t gpu_instruction;
-static uint32_t gpu_opcode_first_parameter;
-static uint32_t gpu_opcode_second_parameter;
+static MACHINE_STATE uint8_t gpu_flag_z, gpu_flag_n, gpu_flag_c;
+// Z & N are worked out lazily, from the last ALU result (see
+// JaguarRISC::UpdateFlags())
+static MACHINE_STATE uint32_t gpu_flag_result;
+static MACHINE_STATE bool gpu_flags_pending = false;
+MACHINE_STATE uint32_t gpu_reg_bank_0[32];
+MACHINE_STATE uint32_t gpu_reg_bank_1[32];
+static MACHINE_STATE uint32_t * gpu_reg;
+static MACHINE_STATE uint32_t * gpu_alternate_reg;
+
+static MACHINE_STATE uint32_t gpu_opcode_first_parameter;
+static MACHINE_STATE uint32_t gpu_opcode_second_parameter;
+
+// Idle loop detection: what the GPU looked like the last time it came around
+// a short backward branch
+struct GPUIdleState
+{
+	uint32_t reg0[32], reg1[32];
+	uint32_t acc, remain, hidata, flags;
+	uint32_t flag_z, flag_n, flag_c;
+};
 
 #define GPU_RUNNING		(gpu_control & 0x01)
 
@@ -342,31 +231,17 @@ static uint32_t gpu_opcode_second_parameter;
 #define IMM_1			gpu_opcode_first_parameter
 #define IMM_2			gpu_opcode_second_parameter
 
-#define SET_FLAG_Z(r)	(gpu_flag_z = ((r) == 0));
-#define SET_FLAG_N(r)	(gpu_flag_n = (((uint32_t)(r) >> 31) & 0x01));
-
-#define RESET_FLAG_Z()	gpu_flag_z = 0;
-#define RESET_FLAG_N()	gpu_flag_n = 0;
-#define RESET_FLAG_C()	gpu_flag_c = 0;
-
-#define CLR_Z				(gpu_flag_z = 0)
-#define CLR_ZN				(gpu_flag_z = gpu_flag_n = 0)
-#define CLR_ZNC				(gpu_flag_z = gpu_flag_n = gpu_flag_c = 0)
-#define SET_Z(r)			(gpu_flag_z = ((r) == 0))
-#define SET_N(r)			(gpu_flag_n = (((uint32_t)(r) >> 31) & 0x01))
-#define SET_C_ADD(a,b)		(gpu_flag_c = ((uint32_t)(b) > (uint32_t)(~(a))))
-#define SET_C_SUB(a,b)		(gpu_flag_c = ((uint32_t)(b) > (uint32_t)(a)))
-#define SET_ZN(r)			SET_N(r); SET_Z(r)
-#define SET_ZNC_ADD(a,b,r)	SET_N(r); SET_Z(r); SET_C_ADD(a,b)
-#define SET_ZNC_SUB(a,b,r)	SET_N(r); SET_Z(r); SET_C_SUB(a,b)
+#define CLR_ZNC				(gpu_flag_z = gpu_flag_n = gpu_flag_c = 0, gpu_flags_pending = false)
+#define SET_ZN(r)			(gpu_flag_result = (r), gpu_flags_pending = true)
 
-uint32_t gpu_convert_zero[32] =
-	{ 32,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31 };
+// The flags as they stand right now (for the disassembly logs & the like)
+#define FLAG_Z				(GPURISC::UpdateFlags(), gpu_flag_z)
+#define FLAG_N				(GPURISC::UpdateFlags(), gpu_flag_n)
+#define FLAG_C				gpu_flag_c
 
-uint8_t * branch_condition_table = 0;
-#define BRANCH_CONDITION(x)	branch_condition_table[(x) + ((jaguar_flags & 7) << 5)]
+MACHINE_STATE uint8_t * branch_condition_table = 0;
 
-uint32_t gpu_opcode_use[64];
+MACHINE_STATE uint32_t gpu_opcode_use[64];
 
 const char * gpu_opcode_str[64]=
 {
@@ -388,8 +263,170 @@ const char * gpu_opcode_str[64]=
 	"store_r14_ri",		"store_r15_ri",		"sat24",			"pack",
 };
 
-static uint32_t gpu_in_exec = 0;
-static uint32_t gpu_releaseTimeSlice_flag = 0;
+static MACHINE_STATE uint32_t gpu_in_exec = 0;
+static MACHINE_STATE uint32_t gpu_releaseTimeSlice_flag = 0;
+static MACHINE_STATE uint64_t gpu_clock = 0;		// RISC cycles we've been run up to
+static bool tripwire = false;
+
+// Running the GPU ahead on a thread of its own (see GPUSpeculate())
+std::atomic<bool> gpuSpeculating(false);
+static bool GPUSpecMayExecute(void);
+static void GPUSpecLocalWrite(uint32_t offset, uint32_t size);
+static uint32_t GPUSpecRead(uint32_t offset, uint32_t size);
+static void GPUSpecWrite(uint32_t offset, uint32_t size, uint32_t data);
+static void GPUFinishSpeculation(uint64_t clock);
+#ifndef JAGUAR_MULTI_MACHINE
+static void GPUSpecStopThread(void);
+#endif
+static bool specIdle, specFailed;
+static MACHINE_STATE GPUSpecStats specStats;
+
+//
+// The GPU, as far as the RISC core (JAGRISC.H) is concerned
+//
+struct GPUChip
+{
+	enum { WHO = GPU, DASM_TYPE = JAGUAR_GPU, RAM_BASE = GPU_WORK_RAM_BASE, RAM_SIZE = 0x1000,
+		IRQ_SOURCES = 5, HAS_STOREP = 1 };
+	typedef uint32_t MAC;
+	typedef GPUIdleState IdleState;
+
+	static inline const char * Name(void) { return "GPU"; }
+	static inline uint32_t * Reg(void) { return gpu_reg; }
+	static inline uint32_t * AltReg(void) { return gpu_alternate_reg; }
+	static inline uint32_t & Op1(void) { return gpu_opcode_first_parameter; }
+	static inline uint32_t & Op2(void) { return gpu_opcode_second_parameter; }
+	static inline uint32_t & PC(void) { return gpu_pc; }
+	static inline MAC & Acc(void) { return gpu_acc; }
+	static inline uint32_t & Remain(void) { return gpu_remain; }
+	static inline uint32_t & DivControl(void) { return gpu_div_control; }
+	static inline uint32_t & MatrixControl(void) { return gpu_matrix_control; }
+	static inline uint32_t & PointerToMatrix(void) { return gpu_pointer_to_matrix; }
+	static inline uint32_t & Flags(void) { return gpu_flags; }
+	static inline uint32_t & Control(void) { return gpu_control; }
+	static inline uint8_t & FlagZ(void) { return gpu_flag_z; }
+	static inline uint8_t & FlagN(void) { return gpu_flag_n; }
+	static inline uint8_t & FlagC(void) { return gpu_flag_c; }
+	static inline uint32_t & FlagResult(void) { return gpu_flag_result; }
+	static inline bool & FlagsPending(void) { return gpu_flags_pending; }
+	static inline uint32_t & InExec(void) { return gpu_in_exec; }
+	static inline const uint8_t * BranchTable(void) { return branch_condition_table; }
+
+	static inline uint16_t ReadWord(uint32_t offset) { return GPUReadWord(offset, GPU); }
+	static inline uint32_t ReadLong(uint32_t offset) { return GPUReadLong(offset, GPU); }
+	static inline void WriteLong(uint32_t offset, uint32_t data) { GPUWriteLong(offset, data, GPU); }
+	static inline uint8_t ExternalReadByte(uint32_t offset)
+		{ return (gpuSpeculating ? GPUSpecRead(offset, 1) : JaguarReadByte(offset, GPU)); }
+	static inline uint16_t ExternalReadWord(uint32_t offset)
+		{ return (gpuSpeculating ? GPUSpecRead(offset, 2) : JaguarReadWord(offset, GPU)); }
+	static inline void ExternalWriteByte(uint32_t offset, uint8_t data)
+		{ if (gpuSpeculating) GPUSpecWrite(offset, 1, data); else JaguarWriteByte(offset, data, GPU); }
+	static inline void ExternalWriteWord(uint32_t offset, uint16_t data)
+		{ if (gpuSpeculating) GPUSpecWrite(offset, 2, data); else JaguarWriteWord(offset, data, GPU); }
+	static inline void UpdateRegisterBanks(void) { GPUUpdateRegisterBanks(); }
+
+	static inline uint32_t PendingIRQs(void)
+	{
+		// Interrupt latch & enable bits
+		return ((gpu_control >> 6) & 0x1F) & ((gpu_flags >> 4) & 0x1F);
+	}
+
+	static inline bool Tracing(void) { return gpu_start_log; }
+
+	static inline bool BeginExec(int32_t & cycles)
+	{
+		if (!GPU_RUNNING)
+			return false;
+
+#ifdef GPU_SINGLE_STEPPING
+		if (gpu_control & 0x18)
+		{
+			cycles = 1;
+			gpu_control &= ~0x10;
+		}
+#endif
+		GPUHandleIRQs();
+		gpu_releaseTimeSlice_flag = 0;
+		return true;
+	}
+
+	static inline bool MayExecute(void)
+	{
+		return !gpuSpeculating || GPUSpecMayExecute();
+	}
+
+	static inline void PreInstruction(void)
+	{
+		// The BIOS starfield generator is starting up...
+		if (gpu_pc == 0xF03000 && gpu_ram_8[0x054] == 0x98 && gpu_ram_8[0x055] == 0x0A
+			&& gpu_ram_8[0x056] == 0x03 && gpu_ram_8[0x057] == 0x00
+			&& gpu_ram_8[0x058] == 0x00 && gpu_ram_8[0x059] == 0x00)
+		{
+			extern uint32_t starCount;
+			starCount = 0;
+		}
+	}
+
+	static inline void PostInstruction(void)
+	{
+		if ((gpu_pc < 0xF03000 || gpu_pc > 0xF03FFF) && !tripwire)
+		{
+			WriteLog("GPU: Executing outside local RAM! GPU_PC: %08X\n", gpu_pc);
+			tripwire = true;
+		}
+	}
+
+	// Running ahead, we don't know where the rest of the slice is going to
+	// end yet, so we stop & let GPUFinishSpeculation() decide
+	static inline bool SkipIdleLoop(void)
+	{
+		if (!gpuSpeculating)
+			return true;
+
+		specIdle = true;
+		return false;
+	}
+
+	static void Dispatch(uint32_t index);
+	static inline uint8_t Cycles(uint32_t index) { return gpu_opcode_cycles[index]; }
+	static inline uint32_t & OpcodeUse(uint32_t index) { return gpu_opcode_use[index]; }
+
+	static inline void SaveIdleState(IdleState & state)
+	{
+		memcpy(state.reg0, gpu_reg_bank_0, sizeof(state.reg0));
+		memcpy(state.reg1, gpu_reg_bank_1, sizeof(state.reg1));
+		state.acc = gpu_acc, state.remain = gpu_remain, state.hidata = gpu_hidata;
+		state.flags = gpu_flags;
+		state.flag_z = gpu_flag_z, state.flag_n = gpu_flag_n, state.flag_c = gpu_flag_c;
+	}
+};
+
+typedef JaguarRISC<GPUChip> GPURISC;
+
+void (*gpu_opcode[64])()=
+{
+	GPURISC::opcode_add,				GPURISC::opcode_addc,				GPURISC::opcode_addq,				GPURISC::opcode_addqt,
+	GPURISC::opcode_sub,				GPURISC::opcode_subc,				GPURISC::opcode_subq,				GPURISC::opcode_subqt,
+	GPURISC::opcode_neg,				GPURISC::opcode_and,				GPURISC::opcode_or,					GPURISC::opcode_xor,
+	GPURISC::opcode_not,				GPURISC::opcode_btst,				GPURISC::opcode_bset,				GPURISC::opcode_bclr,
+	GPURISC::opcode_mult,				GPURISC::opcode_imult,				GPURISC::opcode_imultn,				GPURISC::opcode_resmac,
+	GPURISC::opcode_imacn,				GPURISC::opcode_div,				GPURISC::opcode_abs,				GPURISC::opcode_sh,
+	GPURISC::opcode_shlq,				GPURISC::opcode_shrq,				GPURISC::opcode_sha,				GPURISC::opcode_sharq,
+	GPURISC::opcode_ror,				GPURISC::opcode_rorq,				GPURISC::opcode_cmp,				GPURISC::opcode_cmpq,
+	gpu_opcode_sat8,					gpu_opcode_sat16,					GPURISC::opcode_move,				GPURISC::opcode_moveq,
+	GPURISC::opcode_moveta,				GPURISC::opcode_movefa,				GPURISC::opcode_movei,				GPURISC::opcode_loadb,
+	GPURISC::opcode_loadw,				GPURISC::opcode_load,				gpu_opcode_loadp,					GPURISC::opcode_load_r14_indexed,
+	GPURISC::opcode_load_r15_indexed,	GPURISC::opcode_storeb,				GPURISC::opcode_storew,				GPURISC::opcode_store,
+	gpu_opcode_storep,					GPURISC::opcode_store_r14_indexed,	GPURISC::opcode_store_r15_indexed,	GPURISC::opcode_move_pc,
+	GPURISC::opcode_jump,				GPURISC::opcode_jr,					GPURISC::opcode_mmult,				GPURISC::opcode_mtoi,
+	GPURISC::opcode_normi,				GPURISC::opcode_nop,				GPURISC::opcode_load_r14_ri,		GPURISC::opcode_load_r15_ri,
+	GPURISC::opcode_store_r14_ri,		GPURISC::opcode_store_r15_ri,		gpu_opcode_sat24,					gpu_opcode_pack,
+};
+
+inline void GPUChip::Dispatch(uint32_t index)
+{
+	gpu_opcode[index]();
+}
 
 void GPUReleaseTimeslice(void)
 {
@@ -457,6 +494,9 @@ uint8_t GPUReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return data & 0xFF;
 	}
 
+	if (gpuSpeculating && (who == GPU))
+		return GPUSpecRead(offset, 1);
+
 	return JaguarReadByte(offset, who);
 }
 
@@ -471,8 +511,7 @@ uint16_t GPUReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 	if ((offset >= GPU_WORK_RAM_BASE) && (offset < GPU_WORK_RAM_BASE+0x1000))
 	{
 		offset &= 0xFFF;
-		uint16_t data = ((uint16_t)gpu_ram_8[offset] << 8) | (uint16_t)gpu_ram_8[offset+1];
-		return data;
+		return GET16(gpu_ram_8, offset);
 	}
 	else if ((offset >= GPU_CONTROL_RAM_BASE) && (offset < GPU_CONTROL_RAM_BASE+0x20))
 	{
@@ -493,6 +532,9 @@ uint16_t GPUReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 //if (offset >= 0xF0B000 && offset <= 0xF0BFFF)
 //WriteLog("[GPUR16] --> Possible GPU RAM mirror access by %s!", whoName[who]);
 
+	if (gpuSpeculating && (who == GPU))
+		return GPUSpecRead(offset, 2);
+
 	return JaguarReadWord(offset, who);
 }
 
@@ -512,9 +554,7 @@ uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 	if ((offset >= GPU_WORK_RAM_BASE) && (offset <= GPU_WORK_RAM_BASE + 0x0FFC))
 	{
 		offset &= 0xFFF;
-		return ((uint32_t)gpu_ram_8[offset] << 24) | ((uint32_t)gpu_ram_8[offset+1] << 16)
-			| ((uint32_t)gpu_ram_8[offset+2] << 8) | (uint32_t)gpu_ram_8[offset+3];//*/
-//		return GET32(gpu_ram_8, offset);
+		return GET32(gpu_ram_8, offset);
 	}
 //	else if ((offset >= GPU_CONTROL_RAM_BASE) && (offset < GPU_CONTROL_RAM_BASE+0x20))
 	else if ((offset >= GPU_CONTROL_RAM_BASE) && (offset <= GPU_CONTROL_RAM_BASE + 0x1C))
@@ -523,6 +563,7 @@ uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 		switch (offset)
 		{
 		case 0x00:
+			GPURISC::UpdateFlags();
 			gpu_flag_c = (gpu_flag_c ? 1 : 0);
 			gpu_flag_z = (gpu_flag_z ? 1 : 0);
 			gpu_flag_n = (gpu_flag_n ? 1 : 0);
@@ -557,6 +598,9 @@ uint32_t GPUReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 /*if (offset >= 0xF1D000 && offset <= 0xF1DFFF)
 	WriteLog("[GPUR32] --> Reading from Wavetable ROM!\n");//*/
 
+	if (gpuSpeculating && (who == GPU))
+		return GPUSpecRead(offset, 4);
+
 	return (JaguarReadWord(offset, who) << 16) | JaguarReadWord(offset + 2, who);
 }
 
@@ -570,6 +614,9 @@ void GPUWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 
 	if ((offset >= GPU_WORK_RAM_BASE) && (offset <= GPU_WORK_RAM_BASE + 0x0FFF))
 	{
+		if (gpuSpeculating && (who == GPU))
+			GPUSpecLocalWrite(offset, 1);
+
 		gpu_ram_8[offset & 0xFFF] = data;
 
 //This is the same stupid worthless code that was in the DSP!!! AARRRGGGGHHHHH!!!!!!
@@ -598,6 +645,12 @@ void GPUWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 		return;
 	}
 //	WriteLog("gpu: writing %.2x at 0x%.8x\n",data,offset);
+	if (gpuSpeculating && (who == GPU))
+	{
+		GPUSpecWrite(offset, 1, data);
+		return;
+	}
+
 	JaguarWriteByte(offset, data, who);
 }
 
@@ -611,10 +664,11 @@ void GPUWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 
 	if ((offset >= GPU_WORK_RAM_BASE) && (offset <= GPU_WORK_RAM_BASE + 0x0FFE))
 	{
-		gpu_ram_8[offset & 0xFFF] = (data>>8) & 0xFF;
-		gpu_ram_8[(offset+1) & 0xFFF] = data & 0xFF;//*/
-/*		offset &= 0xFFF;
-		SET16(gpu_ram_8, offset, data);//*/
+		if (gpuSpeculating && (who == GPU))
+			GPUSpecLocalWrite(offset, 2);
+
+		offset &= 0xFFF;
+		SET16(gpu_ram_8, offset, data);
 
 /*if (offset >= 0xF03214 && offset < 0xF0321F)
 	WriteLog("GPU: Writing WORD (%04X) to GPU RAM (%08X)...\n", data, offset);//*/
@@ -695,6 +749,9 @@ void GPUWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 		}
 #endif	// GPU_DEBUG
 
+		if (gpuSpeculating && (who == GPU))
+			GPUSpecLocalWrite(offset, 4);
+
 		offset &= 0xFFF;
 		SET32(gpu_ram_8, offset, data);
 		return;
@@ -711,6 +768,7 @@ void GPUWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 			// NOTE: According to the JTRM, writing a 1 to IMASK has no effect; only the
 			//       IRQ logic can set it. So we mask it out here to prevent problems...
 			gpu_flags = data & (~IMASK);
+			gpu_flags_pending = false;
 			gpu_flag_z = gpu_flags & ZERO_FLAG;
 			gpu_flag_c = (gpu_flags & CARRY_FLAG) >> 1;
 			gpu_flag_n = (gpu_flags & NEGA_FLAG) >> 2;
@@ -746,6 +804,14 @@ WriteLog("GPU: %s setting GPU PC to %08X %s\n", whoName[who], gpu_pc, (GPU_RUNNI
 			break;
 		case 0x14:
 		{
+			// Nothing that happens from here on could be taken back (see
+			// GPUSpecMayExecute())
+			if (gpuSpeculating && (who == GPU))
+			{
+				specFailed = true;
+				break;
+			}
+
 //			uint32_t gpu_was_running = GPU_RUNNING;
 			data &= ~0xF7C0;		// Disable writes to INT_LAT0-4 & TOM version number
 
@@ -919,6 +985,12 @@ if (GPU_RUNNING && effect_start5 && gpu_pc == 0xF035D8)
 //	JaguarWriteWord(offset, (data >> 16) & 0xFFFF, who);
 //	JaguarWriteWord(offset+2, data & 0xFFFF, who);
 // We're a 32-bit processor, we can do a long write...!
+	if (gpuSpeculating && (who == GPU))
+	{
+		GPUSpecWrite(offset, 4, data);
+		return;
+	}
+
 	JaguarWriteLong(offset, data, who);
 }
 
@@ -940,48 +1012,7 @@ void GPUUpdateRegisterBanks(void)
 
 void GPUHandleIRQs(void)
 {
-	// Bail out if we're already in an interrupt!
-	if (gpu_flags & IMASK)
-		return;
-
-	// Get the interrupt latch & enable bits
-	uint32_t bits = (gpu_control >> 6) & 0x1F, mask = (gpu_flags >> 4) & 0x1F;
-
-	// Bail out if latched interrupts aren't enabled
-	bits &= mask;
-	if (!bits)
-		return;
-
-	// Determine which interrupt to service
-	uint32_t which = 0; //Isn't there a #pragma to disable this warning???
-	if (bits & 0x01)
-		which = 0;
-	if (bits & 0x02)
-		which = 1;
-	if (bits & 0x04)
-		which = 2;
-	if (bits & 0x08)
-		which = 3;
-	if (bits & 0x10)
-		which = 4;
-
-	if (start_logging)
-		WriteLog("GPU: Generating IRQ #%i\n", which);
-
-	// set the interrupt flag
-	gpu_flags |= IMASK;
-	GPUUpdateRegisterBanks();
-
-	// subqt  #4,r31		; pre-decrement stack pointer
-	// move  pc,r30			; address of interrupted code
-	// store  r30,(r31)     ; store return address
-	gpu_reg[31] -= 4;
-	GPUWriteLong(gpu_reg[31], gpu_pc - 2, GPU);
-
-	// movei  #service_address,r30  ; pointer to ISR entry
-	// jump  (r30)					; jump to ISR
-	// nop
-	gpu_pc = gpu_reg[30] = GPU_WORK_RAM_BASE + (which * 0x10);
+	GPURISC::HandleIRQs();
 }
 
 void GPUSetIRQLine(int irqline, int state)
@@ -1043,8 +1074,10 @@ void GPUReset(void)
 	CLR_ZNC;
 	memset(gpu_ram_8, 0xFF, 0x1000);
 	gpu_in_exec = 0;
+	gpu_clock = 0;
 //not needed	GPUInterruptPending = false;
 	GPUResetStats();
+	memset(&specStats, 0, sizeof(specStats));
 
 	// Contents of local RAM are quasi-stable; we simulate this by randomizing RAM contents
 	for(uint32_t i=0; i<4096; i+=4)
@@ -1083,7 +1116,7 @@ void GPUDumpDisassembly(void)
 
 void GPUDumpRegisters(void)
 {
-	WriteLog("\n---[GPU flags: NCZ %d%d%d]-----------------------\n", gpu_flag_n, gpu_flag_c, gpu_flag_z);
+	WriteLog("\n---[GPU flags: NCZ %d%d%d]-----------------------\n", FLAG_N, FLAG_C, FLAG_Z);
 	WriteLog("\nRegisters bank 0\n");
 	for(int j=0; j<8; j++)
 	{
@@ -1119,7 +1152,7 @@ void GPUDone(void)
 	WriteLog("\n\n---------------------------------------------------------------------\n");
 	WriteLog("GPU I/O Registers\n");
 	WriteLog("---------------------------------------------------------------------\n");
-	WriteLog("F0%04X   (G_FLAGS): $%06X\n", 0x2100, (gpu_flags & 0xFFFFFFF8) | (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z);
+	WriteLog("F0%04X   (G_FLAGS): $%06X\n", 0x2100, (gpu_flags & 0xFFFFFFF8) | (FLAG_N << 2) | (FLAG_C << 1) | FLAG_Z);
 	WriteLog("F0%04X    (G_MTXC): $%04X\n", 0x2104, gpu_matrix_control);
 	WriteLog("F0%04X    (G_MTXA): $%04X\n", 0x2108, gpu_pointer_to_matrix);
 	WriteLog("F0%04X     (G_END): $%02X\n", 0x210C, gpu_data_organization);
@@ -1139,6 +1172,19 @@ void GPUDone(void)
 	GPUDumpRegisters();
 	GPUDumpDisassembly();
 
+	WriteLog("\nGPU: Skipped %llu idle cycles\n", (unsigned long long)GPURISC::IdleCycles());
+
+	if (specStats.runs)
+		WriteLog("GPU: Ran ahead %llu times: %llu kept (%llu stopped short), %llu rolled back (%llu conflicts, %llu overruns, %llu failures); %llu cycles kept, %llu thrown away\n",
+			(unsigned long long)specStats.runs, (unsigned long long)specStats.commits,
+			(unsigned long long)specStats.stoppedShort, (unsigned long long)specStats.rollbacks,
+			(unsigned long long)specStats.conflicts, (unsigned long long)specStats.overruns,
+			(unsigned long long)specStats.failures, (unsigned long long)specStats.cyclesKept,
+			(unsigned long long)specStats.cyclesDiscarded);
+
+#ifndef JAGUAR_MULTI_MACHINE
+	GPUSpecStopThread();
+#endif
 	WriteLog("\nGPU opcodes use:\n");
 	for(int i=0; i<64; i++)
 	{
@@ -1149,1524 +1195,795 @@ void GPUDone(void)
 }
 
 
+uint64_t GPUGetIdleCycles(void)
+{
+	return GPURISC::IdleCycles();
+}
+
+
 //
 // Main GPU execution core
 //
-static int testCount = 1;
-static int len = 0;
-static bool tripwire = false;
 void GPUExec(int32_t cycles)
 {
-	if (!GPU_RUNNING)
-		return;
-
-#ifdef GPU_SINGLE_STEPPING
-	if (gpu_control & 0x18)
-	{
-		cycles = 1;
-		gpu_control &= ~0x10;
-	}
-#endif
-	GPUHandleIRQs();
-	gpu_releaseTimeSlice_flag = 0;
-	gpu_in_exec++;
+	GPURISC::Exec(cycles);
+}
 
-	while (cycles > 0 && GPU_RUNNING)
-	{
-if (gpu_ram_8[0x054] == 0x98 && gpu_ram_8[0x055] == 0x0A && gpu_ram_8[0x056] == 0x03
-	&& gpu_ram_8[0x057] == 0x00 && gpu_ram_8[0x058] == 0x00 && gpu_ram_8[0x059] == 0x00)
-{
-	if (gpu_pc == 0xF03000)
-	{
-		extern uint32_t starCount;
-		starCount = 0;
-/*		WriteLog("GPU: Starting starfield generator... Dump of [R03=%08X]:\n", gpu_reg_bank_0[03]);
-		uint32_t base = gpu_reg_bank_0[3];
-		for(uint32_t i=0; i<0x100; i+=16)
-		{
-			WriteLog("%02X: ", i);
-			for(uint32_t j=0; j<16; j++)
-			{
-				WriteLog("%02X ", JaguarReadByte(base + i + j));
-			}
-			WriteLog("\n");
-		}*/
-	}
-//	if (gpu_pc == 0xF03)
-	{
-	}
-}//*/
-/*if (gpu_pc == 0xF03B9E && gpu_reg_bank_0[01] == 0)
-{
-	GPUDumpRegisters();
-	WriteLog("GPU: Starting disassembly log...\n");
-	doGPUDis = true;
-}//*/
-/*if (gpu_pc == 0xF0359A)
-{
-	doGPUDis = true;
-	GPUDumpRegisters();
-}*/
-/*		gpu_flag_c = (gpu_flag_c ? 1 : 0);
-		gpu_flag_z = (gpu_flag_z ? 1 : 0);
-		gpu_flag_n = (gpu_flag_n ? 1 : 0);*/
-#if 0
-if (gpu_pc == 0xF03200)
-	doGPUDis = true;
-#endif
 
-		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		uint32_t index = opcode >> 10;
-		gpu_instruction = opcode;				// Added for GPU #3...
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
-/*if (gpu_pc == 0xF03BE8)
-WriteLog("Start of OP frame write...\n");
-if (gpu_pc == 0xF03EEE)
-WriteLog("--> Writing BRANCH object ---\n");
-if (gpu_pc == 0xF03F62)
-WriteLog("--> Writing BITMAP object ***\n");//*/
-/*if (gpu_pc == 0xF03546)
-{
-	WriteLog("\n--> GPU PC: F03546\n");
-	GPUDumpRegisters();
-	GPUDumpDisassembly();
-}//*/
-/*if (gpu_pc == 0xF033F6)
-{
-	WriteLog("\n--> GPU PC: F033F6\n");
-	GPUDumpRegisters();
-	GPUDumpDisassembly();
-}//*/
-/*if (gpu_pc == 0xF033CC)
-{
-	WriteLog("\n--> GPU PC: F033CC\n");
-	GPUDumpRegisters();
-	GPUDumpDisassembly();
-}//*/
-/*if (gpu_pc == 0xF033D6)
-{
-	WriteLog("\n--> GPU PC: F033D6 (#%d)\n", testCount++);
-	GPUDumpRegisters();
-	GPUDumpMemory();
-}//*/
-/*if (gpu_pc == 0xF033D8)
-{
-	WriteLog("\n--> GPU PC: F033D8 (#%d)\n", testCount++);
-	GPUDumpRegisters();
-	GPUDumpMemory();
-}//*/
-/*if (gpu_pc == 0xF0358E)
-{
-	WriteLog("\n--> GPU PC: F0358E (#%d)\n", testCount++);
-	GPUDumpRegisters();
-	GPUDumpMemory();
-}//*/
-/*if (gpu_pc == 0xF034CA)
-{
-	WriteLog("\n--> GPU PC: F034CA (#%d)\n", testCount++);
-	GPUDumpRegisters();
-}//*/
-/*if (gpu_pc == 0xF034CA)
-{
-	len = gpu_reg[1] + 4;//, r9save = gpu_reg[9];
-	WriteLog("\nAbout to subtract [#%d] (R14=%08X, R15=%08X, R9=%08X):\n   ", testCount++, gpu_reg[14], gpu_reg[15], gpu_reg[9]);
-	for(int i=0; i<len; i+=4)
-		WriteLog(" %08X", GPUReadLong(gpu_reg[15]+i));
-	WriteLog("\n   ");
-	for(int i=0; i<len; i+=4)
-		WriteLog(" %08X", GPUReadLong(gpu_reg[14]+i));
-	WriteLog("\n\n");
+//
+// See STATE.CPP. Snapshots are only taken between timeslices, so it's never
+// running ahead then (it was caught up at the end of the last one).
+//
+void GPUSnapshot(void)
+{
+	GPURISC::IdleTracker idle;
+	GPURISC::SaveIdleTracker(idle);
+
+	SNAPSHOT(gpu_ram_8);
+	SNAPSHOT(gpu_reg_bank_0);
+	SNAPSHOT(gpu_reg_bank_1);
+	SNAPSHOT(gpu_pc);
+	SNAPSHOT(gpu_acc);
+	SNAPSHOT(gpu_remain);
+	SNAPSHOT(gpu_hidata);
+	SNAPSHOT(gpu_flags);
+	SNAPSHOT(gpu_matrix_control);
+	SNAPSHOT(gpu_pointer_to_matrix);
+	SNAPSHOT(gpu_data_organization);
+	SNAPSHOT(gpu_control);
+	SNAPSHOT(gpu_div_control);
+	SNAPSHOT(gpu_flag_z);
+	SNAPSHOT(gpu_flag_n);
+	SNAPSHOT(gpu_flag_c);
+	SNAPSHOT(gpu_flag_result);
+	SNAPSHOT(gpu_flags_pending);
+	SNAPSHOT(gpu_opcode_first_parameter);
+	SNAPSHOT(gpu_opcode_second_parameter);
+	SNAPSHOT(gpu_opcode_use);
+	SNAPSHOT(gpu_releaseTimeSlice_flag);
+	SNAPSHOT(gpu_clock);
+	SNAPSHOT(idle);
+
+	GPURISC::RestoreIdleTracker(idle);
+	GPUUpdateRegisterBanks();
 }
-if (gpu_pc == 0xF034DE)
-{
-	WriteLog("\nSubtracted! (R14=%08X, R15=%08X):\n   ", gpu_reg[14], gpu_reg[15]);
-	for(int i=0; i<len; i+=4)
-		WriteLog(" %08X", GPUReadLong(gpu_reg[15]+i));
-	WriteLog("\n   ");
-	for(int i=0; i<len; i+=4)
-		WriteLog(" %08X", GPUReadLong(gpu_reg[14]+i));
-	WriteLog("\n   ");
-	for(int i=0; i<len; i+=4)
-		WriteLog(" --------");
-	WriteLog("\n   ");
-	for(int i=0; i<len; i+=4)
-		WriteLog(" %08X", GPUReadLong(gpu_reg[9]+4+i));
-	WriteLog("\n\n");
-}//*/
-/*if (gpu_pc == 0xF035C8)
-{
-	WriteLog("\n--> GPU PC: F035C8 (#%d)\n", testCount++);
-	GPUDumpRegisters();
-	GPUDumpDisassembly();
-}//*/
 
-if (gpu_start_log)
-{
-//	gpu_reset_stats();
-static char buffer[512];
-dasmjag(JAGUAR_GPU, buffer, gpu_pc);
-WriteLog("GPU: [%08X] %s (RM=%08X, RN=%08X) -> ", gpu_pc, buffer, RM, RN);
-}//*/
-//$E400 -> 1110 01 -> $39 -> 57
-//GPU #1
-		gpu_pc += 2;
-		gpu_opcode[index]();
-//GPU #2
-//		gpu2_opcode[index]();
-//		gpu_pc += 2;
-//GPU #3				(Doesn't show ATARI logo! #1 & #2 do...)
-//		gpu_pc += 2;
-//		gpu3_opcode[index]();
-
-// BIOS hacking
-//GPU: [00F03548] jr      nz,00F03560 (0xd561) (RM=00F03114, RN=00000004) ->     --> JR: Branch taken.
-/*static bool firstTime = true;
-if (gpu_pc == 0xF03548 && firstTime)
-{
-	gpu_flag_z = 1;
-//	firstTime = false;
-
-//static char buffer[512];
-//int k=0xF03548;
-//while (k<0xF0356C)
-//{
-//int oldk = k;
-//k += dasmjag(JAGUAR_GPU, buffer, k);
-//WriteLog("GPU: [%08X] %s\n", oldk, buffer);
-//}
-//	gpu_start_log = 1;
-}//*/
-//GPU: [00F0354C] jump    nz,(r29) (0xd3a1) (RM=00F03314, RN=00000004) -> (RM=00F03314, RN=00000004)
-/*if (gpu_pc == 0xF0354C)
-	gpu_flag_z = 0;//, gpu_start_log = 1;//*/
-
-		cycles -= gpu_opcode_cycles[index];
-		gpu_opcode_use[index]++;
-if (gpu_start_log)
-	WriteLog("(RM=%08X, RN=%08X)\n", RM, RN);//*/
-if ((gpu_pc < 0xF03000 || gpu_pc > 0xF03FFF) && !tripwire)
+
+//
+// Bring the GPU up to <clock> (in RISC cycles since reset), from wherever it
+// was left the last time. If the last instruction runs past it, we start that
+// much later the next time. We don't do anything if we're asked from inside
+// the GPU, or something it set off (the blitter, say): it's already there.
+//
+void GPUCatchUp(uint64_t clock)
 {
-	WriteLog("GPU: Executing outside local RAM! GPU_PC: %08X\n", gpu_pc);
-	tripwire = true;
-}
-	}
+	if (gpuSpeculating)
+		GPUFinishSpeculation(clock);
+
+	if ((clock <= gpu_clock) || gpu_in_exec)
+		return;
+
+	int32_t cycles = (int32_t)(clock - gpu_clock);
+
+	if (vjs.GPUEnabled)
+		cycles = GPURISC::Exec(cycles);
 
-	gpu_in_exec--;
+	gpu_clock = clock + (cycles < 0 ? -cycles : 0);
 }
 
+
 //
-// GPU opcodes
+// Running the GPU ahead
+//
+// With vjs.parallelGPU on, the GPU doesn't have to wait for the 68K to look at
+// it before it's run: at the start of each slice, it's sent off towards the
+// end of the slice on a thread of its own, while the 68K runs on this one. The
+// first time it's wanted (the 68K going into TOM, or the slice ending),
+// GPUCatchUp() stops it & takes stock:
+//
+// - What it wrote to main RAM went into copies of the pages it wrote to, and
+//   the pages it read & wrote are noted, as are the ones the 68K (or the DSP)
+//   wrote to in the meantime. If they overlap, it might have seen (or written
+//   over) something it wouldn't have, run in turn.
+// - If it got past where it was wanted, it went too far.
+// - If it did something it can't take back, that's that.
+//
+// In any of those cases, it's put back the way it was (registers, what it
+// wrote to its local RAM & the idle loop detector) & run again, in turn.
+// Otherwise, the copies go into main RAM, and it carries on from where it got
+// to. Either way, it ends up exactly where it would have without any of this.
+// To keep from doing things it can't take back, it stops short of getting at
+// anything other than its own RAM & registers (except for G_CTRL), main RAM &
+// ROM--the blitter, say--and at idle loops.
+//
+// The DSP can get at all of that too, so the two are kept apart: the 68K going
+// into JERRY (where it can set the DSP going on this thread) calls the GPU
+// back to where it started, and the audio thread waits for it to come back
+// before running the DSP, which keeps it from being sent off in the meantime
+// (see GPULockOutSpeculation()).
+//
+// N.B.: This needs the GPU's state to be shared between threads, so it's not
+//       available with JAGUAR_MULTI_MACHINE.
 //
 
-/*
-GPU opcodes use (offset punch--vertically below bad guy):
-	              add 18686
-	             addq 32621
-	              sub 7483
-	             subq 10252
-	              and 21229
-	               or 15003
-	             btst 1822
-	             bset 2072
-	             mult 141
-	              div 2392
-	             shlq 13449
-	             shrq 10297
-	            sharq 11104
-	              cmp 6775
-	             cmpq 5944
-	             move 31259
-	            moveq 4473
-	            movei 23277
-	            loadb 46
-	            loadw 4201
-	             load 28580
-	 load_r14_indexed 1183
-	 load_r15_indexed 1125
-	           storew 178
-	            store 10144
-	store_r14_indexed 320
-	store_r15_indexed 1
-	          move_pc 1742
-	             jump 24467
-	               jr 18090
-	              nop 41362
-*/
+#define SPEC_PAGE_SHIFT		10
+#define SPEC_PAGE_SIZE		(1 << SPEC_PAGE_SHIFT)
+#define SPEC_PAGES			(0x200000 >> SPEC_PAGE_SHIFT)
+#define SPEC_SHADOW_PAGES	512				// Most pages we can write to in one go
+#define SPEC_SPIN			1000			// Times to look for the next slice before sleeping
+
+// What to put the GPU back to
+struct GPUCheckpoint
+{
+	uint32_t reg0[32], reg1[32];
+	uint32_t pc, acc, remain, hidata, flags, flagResult;
+	uint32_t matrixControl, pointerToMatrix, dataOrganization, control, divControl;
+	uint8_t flagZ, flagN, flagC;
+	bool flagsPending;
+	uint32_t opcodeUse[64];
+	uint8_t ram[0x1000];
+	GPURISC::IdleTracker idle;
+};
+
+#ifndef JAGUAR_MULTI_MACHINE
+static SDL_Thread * specThread = NULL;
+static SDL_mutex * specMutex = NULL;
+static SDL_cond * specCond = NULL;
+static bool specThreadFailed = false;
+static bool specQuit = false;				// Under specMutex
+static std::atomic<bool> specGo(false);
+static std::atomic<bool> specLockedOut(false);	// The DSP is running on the audio thread
+#endif
+static std::atomic<bool> specStop(false), specDone(false);
+
+static uint64_t specStart, specTarget;		// Where the run started & was headed
+static int32_t specLeft;					// What it had left when it stopped
+static bool specBlocked;					// Stopped short of something
+static GPUCheckpoint specCheckpoint;
+
+// Main RAM pages the GPU read & wrote, and the 68K or DSP wrote, while it was
+// running
+static uint64_t specGPURead[SPEC_PAGES / 64], specGPUWrite[SPEC_PAGES / 64];
+static uint64_t specOtherWrite[SPEC_PAGES / 64];
+// Longs of its local RAM the GPU wrote (all a rollback has to put back)
+static uint64_t specGPULocal[0x1000 / 4 / 64];
+
+// Copies of the pages the GPU wrote to
+static uint8_t specShadow[SPEC_SHADOW_PAGES][SPEC_PAGE_SIZE];
+static uint16_t specShadowPage[SPEC_SHADOW_PAGES];
+static int16_t specShadowOf[SPEC_PAGES];
+static uint32_t specShadows = 0;
+
+
+#ifndef JAGUAR_MULTI_MACHINE
+static void GPUSaveCheckpoint(GPUCheckpoint & c)
+{
+	memcpy(c.reg0, gpu_reg_bank_0, sizeof(c.reg0));
+	memcpy(c.reg1, gpu_reg_bank_1, sizeof(c.reg1));
+	c.pc = gpu_pc, c.acc = gpu_acc, c.remain = gpu_remain, c.hidata = gpu_hidata;
+	c.flags = gpu_flags, c.flagResult = gpu_flag_result;
+	c.matrixControl = gpu_matrix_control, c.pointerToMatrix = gpu_pointer_to_matrix;
+	c.dataOrganization = gpu_data_organization, c.control = gpu_control;
+	c.divControl = gpu_div_control;
+	c.flagZ = gpu_flag_z, c.flagN = gpu_flag_n, c.flagC = gpu_flag_c;
+	c.flagsPending = gpu_flags_pending;
+	memcpy(c.opcodeUse, gpu_opcode_use, sizeof(c.opcodeUse));
+	memcpy(c.ram, gpu_ram_8, sizeof(c.ram));
+	GPURISC::SaveIdleTracker(c.idle);
+}
+#endif
+
+
+static void GPURestoreCheckpoint(const GPUCheckpoint & c)
+{
+	memcpy(gpu_reg_bank_0, c.reg0, sizeof(c.reg0));
+	memcpy(gpu_reg_bank_1, c.reg1, sizeof(c.reg1));
+	gpu_pc = c.pc, gpu_acc = c.acc, gpu_remain = c.remain, gpu_hidata = c.hidata;
+	gpu_flags = c.flags, gpu_flag_result = c.flagResult;
+	gpu_matrix_control = c.matrixControl, gpu_pointer_to_matrix = c.pointerToMatrix;
+	gpu_data_organization = c.dataOrganization, gpu_control = c.control;
+	gpu_div_control = c.divControl;
+	gpu_flag_z = c.flagZ, gpu_flag_n = c.flagN, gpu_flag_c = c.flagC;
+	gpu_flags_pending = c.flagsPending;
+	memcpy(gpu_opcode_use, c.opcodeUse, sizeof(c.opcodeUse));
+	GPURISC::RestoreIdleTracker(c.idle);
+
+	// Only what it wrote to its RAM goes back; the rest is left as it is
+	for(uint32_t i=0; i<0x1000/4; i++)
+		if (specGPULocal[i >> 6] & ((uint64_t)1 << (i & 0x3F)))
+			memcpy(gpu_ram_8 + (i << 2), c.ram + (i << 2), 4);
+
+	GPUUpdateRegisterBanks();
+}
 
 
-static void gpu_opcode_jump(void)
+//
+// Says whether the GPU can read (or write) <size> bytes at <address> without
+// doing anything that can't be taken back. <viaGPU> is for the accesses that
+// go through GPURead/WriteLong(), which can see the GPU's own registers.
+//
+static bool GPUSpecSafe(uint32_t address, uint32_t size, bool write, bool viaGPU = false)
 {
-#ifdef GPU_DIS_JUMP
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doGPUDis)
-		WriteLog("%06X: JUMP   %s, (R%02u) [NCZ:%u%u%u, R%02u=%08X] ", gpu_pc-2, condition[IMM_2], IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM);
-#endif
-	// normalize flags
-/*	gpu_flag_c = (gpu_flag_c ? 1 : 0);
-	gpu_flag_z = (gpu_flag_z ? 1 : 0);
-	gpu_flag_n = (gpu_flag_n ? 1 : 0);*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
+	if ((address - GPU_WORK_RAM_BASE) <= (0x1000 - size))
+		return true;
+
+	if (viaGPU && ((address - GPU_CONTROL_RAM_BASE) <= (0x20 - size)))
 	{
-#ifdef GPU_DIS_JUMP
-	if (doGPUDis)
-		WriteLog("Branched!\n");
-#endif
-if (gpu_start_log)
-	WriteLog("    --> JUMP: Branch taken.\n");
-		uint32_t delayed_pc = RM;
-		GPUExec(1);
-		gpu_pc = delayed_pc;
-/*		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
-
-		gpu_pc = delayed_pc;
-		gpu_opcode[opcode>>10]();//*/
+		uint32_t reg = address - GPU_CONTROL_RAM_BASE;
+		// Stopping & starting it, and interrupting the 68K, can't be undone
+		return !write || (reg + size <= 0x14) || (reg >= 0x18);
 	}
-#ifdef GPU_DIS_JUMP
-	else
-		if (doGPUDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
+
+	address &= 0xFFFFFF;
+
+	// Every write could need a copy of up to 3 pages (STOREP)
+	if (address + size <= 0x800000)
+		return !write || (specShadows + 3 <= SPEC_SHADOW_PAGES);
+
+	if (write)
+		return false;
+
+	return ((address >= 0x800000) && (address + size <= 0xDFFF00))
+		|| ((address >= 0xE00000) && (address + size <= 0xE40000));
 }
 
 
-static void gpu_opcode_jr(void)
+//
+// Says whether the instruction at <pc> can be run without doing anything that
+// can't be taken back. (Along with its delay slot, if it's a branch.)
+//
+static bool GPUSpecSafeAt(uint32_t pc, bool canBranch)
 {
-#ifdef GPU_DIS_JR
-const char * condition[32] =
-{	"T", "nz", "z", "???", "nc", "nc nz", "nc z", "???", "c", "c nz",
-	"c z", "???", "???", "???", "???", "???", "???", "???", "???",
-	"???", "nn", "nn nz", "nn z", "???", "n", "n nz", "n z", "???",
-	"???", "???", "???", "F" };
-	if (doGPUDis)
-		WriteLog("%06X: JR     %s, %06X [NCZ:%u%u%u] ", gpu_pc-2, condition[IMM_2], gpu_pc+((IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1) * 2), gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-/*	if (CONDITION(jaguar.op & 31))
-	{
-		int32_t r1 = (INT8)((jaguar.op >> 2) & 0xF8) >> 2;
-		uint32_t newpc = jaguar.PC + r1;
-		CALL_MAME_DEBUG;
-		jaguar.op = ROPCODE(jaguar.PC);
-		jaguar.PC = newpc;
-		(*jaguar.table[jaguar.op >> 10])();
-
-		jaguar_icount -= 3;	// 3 wait states guaranteed
-	}*/
-	// normalize flags
-/*	gpu_flag_n = (gpu_flag_n ? 1 : 0);
-	gpu_flag_c = (gpu_flag_c ? 1 : 0);
-	gpu_flag_z = (gpu_flag_z ? 1 : 0);*/
-	// KLUDGE: Used by BRANCH_CONDITION
-	uint32_t jaguar_flags = (gpu_flag_n << 2) | (gpu_flag_c << 1) | gpu_flag_z;
-
-	if (BRANCH_CONDITION(IMM_2))
+	if ((pc - GPU_WORK_RAM_BASE) > 0x0FFE)
+		return false;
+
+	uint16_t opcode = GET16(gpu_ram_8, pc & 0xFFF);
+	uint32_t index = opcode >> 10, imm1 = (opcode >> 5) & 0x1F;
+	uint32_t rm = gpu_reg[imm1];
+	uint32_t quick = (((imm1 - 1) & 0x1F) + 1) << 2;
+
+	switch (index)
 	{
-#ifdef GPU_DIS_JR
-	if (doGPUDis)
-		WriteLog("Branched!\n");
-#endif
-if (gpu_start_log)
-	WriteLog("    --> JR: Branch taken.\n");
-		int32_t offset = (IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1);		// Sign extend IMM_1
-		int32_t delayed_pc = gpu_pc + (offset * 2);
-		GPUExec(1);
-		gpu_pc = delayed_pc;
-/*		uint16_t opcode = GPUReadWord(gpu_pc, GPU);
-		gpu_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		gpu_opcode_second_parameter = opcode & 0x1F;
-
-		gpu_pc = delayed_pc;
-		gpu_opcode[opcode>>10]();//*/
+	case 39:								// LOADB
+		return GPUSpecSafe(rm, 1, false);
+	case 40:								// LOADW
+		return GPUSpecSafe(rm & 0xFFFFFFFE, 2, false);
+	case 41:								// LOAD
+		return GPUSpecSafe(rm & 0xFFFFFFFC, 4, false, true);
+	case 42:								// LOADP
+		return GPUSpecSafe(rm, 4, false, true) && GPUSpecSafe(rm + 4, 4, false, true);
+	case 43:								// LOAD (R14+n)
+	case 44:								// LOAD (R15+n)
+		return GPUSpecSafe((gpu_reg[index - 29] + quick) & 0xFFFFFFFC, 4, false, true);
+	case 45:								// STOREB
+		return GPUSpecSafe(rm, 1, true);
+	case 46:								// STOREW
+		return GPUSpecSafe(rm, 2, true);
+	case 47:								// STORE
+		return GPUSpecSafe(rm, 4, true, true);
+	case 48:								// STOREP
+		return GPUSpecSafe(rm, 4, true, true) && GPUSpecSafe(rm + 4, 4, true, true);
+	case 49:								// STORE (R14+n)
+	case 50:								// STORE (R15+n)
+		return GPUSpecSafe(gpu_reg[index - 35] + quick, 4, true, true);
+	case 52:								// JUMP
+	case 53:								// JR
+		return canBranch && GPUSpecSafeAt(pc + 2, false);
+	case 54:								// MMULT
+		return GPUSpecSafe(gpu_pointer_to_matrix, 2, false);
+	case 58:								// LOAD (R14+Rn)
+	case 59:								// LOAD (R15+Rn)
+		return GPUSpecSafe((gpu_reg[index - 44] + rm) & 0xFFFFFFFC, 4, false, true);
+	case 60:								// STORE (R14+Rn)
+	case 61:								// STORE (R15+Rn)
+		return GPUSpecSafe(gpu_reg[index - 46] + rm, 4, true, true);
 	}
-#ifdef GPU_DIS_JR
-	else
-		if (doGPUDis)
-			WriteLog("Branch NOT taken.\n");
-#endif
+
+	return true;
 }
 
 
-static void gpu_opcode_add(void)
+//
+// Whether the GPU, running ahead, should go on to its next instruction
+//
+static bool GPUSpecMayExecute(void)
 {
-#ifdef GPU_DIS_ADD
-	if (doGPUDis)
-		WriteLog("%06X: ADD    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN + RM;
-	CLR_ZNC; SET_ZNC_ADD(RN, RM, res);
-	RN = res;
-#ifdef GPU_DIS_ADD
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	// A delay slot has to go with its branch
+	if (gpu_in_exec > 1)
+		return true;
 
+	if (specStop.load(std::memory_order_relaxed))
+		return false;
 
-static void gpu_opcode_addc(void)
-{
-#ifdef GPU_DIS_ADDC
-	if (doGPUDis)
-		WriteLog("%06X: ADDC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-/*	int dreg = jaguar.op & 31;
-	uint32_t r1 = jaguar.r[(jaguar.op >> 5) & 31];
-	uint32_t r2 = jaguar.r[dreg];
-	uint32_t res = r2 + r1 + ((jaguar.FLAGS >> 1) & 1);
-	jaguar.r[dreg] = res;
-	CLR_ZNC; SET_ZNC_ADD(r2,r1,res);*/
-
-	uint32_t res = RN + RM + gpu_flag_c;
-	uint32_t carry = gpu_flag_c;
-//	SET_ZNC_ADD(RN, RM, res); //???BUG??? Yes!
-	SET_ZNC_ADD(RN + carry, RM, res);
-//	SET_ZNC_ADD(RN, RM + carry, res);
-	RN = res;
-#ifdef GPU_DIS_ADDC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_addq(void)
-{
-#ifdef GPU_DIS_ADDQ
-	if (doGPUDis)
-		WriteLog("%06X: ADDQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN + r1;
-	CLR_ZNC; SET_ZNC_ADD(RN, r1, res);
-	RN = res;
-#ifdef GPU_DIS_ADDQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_addqt(void)
-{
-#ifdef GPU_DIS_ADDQT
-	if (doGPUDis)
-		WriteLog("%06X: ADDQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN += gpu_convert_zero[IMM_1];
-#ifdef GPU_DIS_ADDQT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_sub(void)
-{
-#ifdef GPU_DIS_SUB
-	if (doGPUDis)
-		WriteLog("%06X: SUB    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-	RN = res;
-#ifdef GPU_DIS_SUB
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_subc(void)
-{
-#ifdef GPU_DIS_SUBC
-	if (doGPUDis)
-		WriteLog("%06X: SUBC   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	// This is how the GPU ALU does it--Two's complement with inverted carry
-	uint64_t res = (uint64_t)RN + (uint64_t)(RM ^ 0xFFFFFFFF) + (gpu_flag_c ^ 1);
-	// Carry out of the result is inverted too
-	gpu_flag_c = ((res >> 32) & 0x01) ^ 1;
-	RN = (res & 0xFFFFFFFF);
-	SET_ZN(RN);
-#ifdef GPU_DIS_SUBC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_subq(void)
-{
-#ifdef GPU_DIS_SUBQ
-	if (doGPUDis)
-		WriteLog("%06X: SUBQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-	RN = res;
-#ifdef GPU_DIS_SUBQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_subqt(void)
-{
-#ifdef GPU_DIS_SUBQT
-	if (doGPUDis)
-		WriteLog("%06X: SUBQT  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN -= gpu_convert_zero[IMM_1];
-#ifdef GPU_DIS_SUBQT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_cmp(void)
-{
-#ifdef GPU_DIS_CMP
-	if (doGPUDis)
-		WriteLog("%06X: CMP    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t res = RN - RM;
-	SET_ZNC_SUB(RN, RM, res);
-#ifdef GPU_DIS_CMP
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-}
-
-
-static void gpu_opcode_cmpq(void)
-{
-	static int32_t sqtable[32] =
-		{ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,-16,-15,-14,-13,-12,-11,-10,-9,-8,-7,-6,-5,-4,-3,-2,-1 };
-#ifdef GPU_DIS_CMPQ
-	if (doGPUDis)
-		WriteLog("%06X: CMPQ   #%d, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, sqtable[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = sqtable[IMM_1 & 0x1F]; // I like this better -> (INT8)(jaguar.op >> 2) >> 3;
-	uint32_t res = RN - r1;
-	SET_ZNC_SUB(RN, r1, res);
-#ifdef GPU_DIS_CMPQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-}
-
-
-static void gpu_opcode_and(void)
-{
-#ifdef GPU_DIS_AND
-	if (doGPUDis)
-		WriteLog("%06X: AND    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN & RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_AND
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_or(void)
-{
-#ifdef GPU_DIS_OR
-	if (doGPUDis)
-		WriteLog("%06X: OR     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN | RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_OR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_xor(void)
-{
-#ifdef GPU_DIS_XOR
-	if (doGPUDis)
-		WriteLog("%06X: XOR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RN ^ RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_XOR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_not(void)
-{
-#ifdef GPU_DIS_NOT
-	if (doGPUDis)
-		WriteLog("%06X: NOT    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = ~RN;
-	SET_ZN(RN);
-#ifdef GPU_DIS_NOT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_move_pc(void)
-{
-#ifdef GPU_DIS_MOVEPC
-	if (doGPUDis)
-		WriteLog("%06X: MOVE   PC, R%02u [NCZ:%u%u%u, PC=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_pc-2, IMM_2, RN);
-#endif
-	// Should be previous PC--this might not always be previous instruction!
-	// Then again, this will point right at the *current* instruction, i.e., MOVE PC,R!
-	RN = gpu_pc - 2;
-#ifdef GPU_DIS_MOVEPC
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_sat8(void)
-{
-#ifdef GPU_DIS_SAT8
-	if (doGPUDis)
-		WriteLog("%06X: SAT8   R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFF ? 0xFF : RN));
-	SET_ZN(RN);
-#ifdef GPU_DIS_SAT8
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_sat16(void)
-{
-	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFFFF ? 0xFFFF : RN));
-	SET_ZN(RN);
-}
-
-static void gpu_opcode_sat24(void)
-{
-	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFFFFFF ? 0xFFFFFF : RN));
-	SET_ZN(RN);
-}
-
-
-static void gpu_opcode_store_r14_indexed(void)
-{
-#ifdef GPU_DIS_STORE14I
-	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R14+$%02X) [NCZ:%u%u%u, R%02u=%08X, R14+$%02X=%08X]\n", gpu_pc-2, IMM_2, gpu_convert_zero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, gpu_convert_zero[IMM_1] << 2, gpu_reg[14]+(gpu_convert_zero[IMM_1] << 2));
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2);
-	
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
-	else
-		GPUWriteLong(address, RN, GPU);
-#else
-	GPUWriteLong(gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2), RN, GPU);
-#endif
-}
-
-
-static void gpu_opcode_store_r15_indexed(void)
-{
-#ifdef GPU_DIS_STORE15I
-	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R15+$%02X) [NCZ:%u%u%u, R%02u=%08X, R15+$%02X=%08X]\n", gpu_pc-2, IMM_2, gpu_convert_zero[IMM_1] << 2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, gpu_convert_zero[IMM_1] << 2, gpu_reg[15]+(gpu_convert_zero[IMM_1] << 2));
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2);
-
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
-	else
-		GPUWriteLong(address, RN, GPU);
-#else
-	GPUWriteLong(gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2), RN, GPU);
-#endif
-}
-
-
-static void gpu_opcode_load_r14_ri(void)
-{
-#ifdef GPU_DIS_LOAD14R
-	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R14+R%02u), R%02u [NCZ:%u%u%u, R14+R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM+gpu_reg[14], IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + RM;
-
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
-	else
-		RN = GPUReadLong(address, GPU);
-#else
-	RN = GPUReadLong(gpu_reg[14] + RM, GPU);
-#endif
-#ifdef GPU_DIS_LOAD14R
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
-
-static void gpu_opcode_load_r15_ri(void)
-{
-#ifdef GPU_DIS_LOAD15R
-	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R15+R%02u), R%02u [NCZ:%u%u%u, R15+R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM+gpu_reg[15], IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[15] + RM;
+	if (!GPUSpecSafeAt(gpu_pc, true))
+	{
+		specBlocked = true;
+		return false;
+	}
 
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
-	else
-		RN = GPUReadLong(address, GPU);
-#else
-	RN = GPUReadLong(gpu_reg[15] + RM, GPU);
-#endif
-#ifdef GPU_DIS_LOAD15R
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	return true;
 }
 
 
-static void gpu_opcode_store_r14_ri(void)
+static inline void GPUSpecMark(uint64_t * pages, uint32_t page)
 {
-#ifdef GPU_DIS_STORE14R
-	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R14+R%02u) [NCZ:%u%u%u, R%02u=%08X, R14+R%02u=%08X]\n", gpu_pc-2, IMM_2, IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, IMM_1, RM+gpu_reg[14]);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + RM;
-
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
-	else
-		GPUWriteLong(address, RN, GPU);
-#else
-	GPUWriteLong(gpu_reg[14] + RM, RN, GPU);
-#endif
+	pages[page >> 6] |= (uint64_t)1 << (page & 0x3F);
 }
 
 
-static void gpu_opcode_store_r15_ri(void)
+//
+// Where the GPU sees main RAM page <page> right now
+//
+static inline const uint8_t * GPUSpecPage(uint32_t page)
 {
-#ifdef GPU_DIS_STORE15R
-	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R15+R%02u) [NCZ:%u%u%u, R%02u=%08X, R15+R%02u=%08X]\n", gpu_pc-2, IMM_2, IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, IMM_1, RM+gpu_reg[15]);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT_STORE
-	uint32_t address = gpu_reg[15] + RM;
+	if (specShadowOf[page] >= 0)
+		return specShadow[specShadowOf[page]];
 
-	if (address >= 0xF03000 && address <= 0xF03FFF)
-		GPUWriteLong(address & 0xFFFFFFFC, RN, GPU);
-	else
-		GPUWriteLong(address, RN, GPU);
-#else
-	GPUWriteLong(gpu_reg[15] + RM, RN, GPU);
-#endif
+	return jaguarMainRAM + (page << SPEC_PAGE_SHIFT);
 }
 
 
-static void gpu_opcode_nop(void)
+//
+// Where the GPU can write to main RAM page <page> (NULL if we're out of room)
+//
+static uint8_t * GPUSpecShadow(uint32_t page)
 {
-#ifdef GPU_DIS_NOP
-	if (doGPUDis)
-		WriteLog("%06X: NOP    [NCZ:%u%u%u]\n", gpu_pc-2, gpu_flag_n, gpu_flag_c, gpu_flag_z);
-#endif
-}
-
+	if (specShadowOf[page] < 0)
+	{
+		if (specShadows == SPEC_SHADOW_PAGES)
+			return NULL;
 
-static void gpu_opcode_pack(void)
-{
-#ifdef GPU_DIS_PACK
-	if (doGPUDis)
-		WriteLog("%06X: %s R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, (!IMM_1 ? "PACK  " : "UNPACK"), IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t val = RN;
+		memcpy(specShadow[specShadows], jaguarMainRAM + (page << SPEC_PAGE_SHIFT), SPEC_PAGE_SIZE);
+		specShadowPage[specShadows] = page;
+		specShadowOf[page] = specShadows++;
+	}
 
-//BUG!	if (RM == 0)				// Pack
-	if (IMM_1 == 0)				// Pack
-		RN = ((val >> 10) & 0x0000F000) | ((val >> 5) & 0x00000F00) | (val & 0x000000FF);
-	else						// Unpack
-		RN = ((val & 0x0000F000) << 10) | ((val & 0x00000F00) << 5) | (val & 0x000000FF);
-#ifdef GPU_DIS_PACK
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	return specShadow[specShadowOf[page]];
 }
 
 
-static void gpu_opcode_storeb(void)
+//
+// GPU reads outside of its own RAM & registers, while it's running ahead.
+// (Same as JaguarReadByte(), etc., for main RAM & ROM.)
+//
+static uint32_t GPUSpecRead(uint32_t offset, uint32_t size)
 {
-#ifdef GPU_DIS_STOREB
-	if (doGPUDis)
-		WriteLog("%06X: STOREB R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_pc-2, IMM_2, IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-//Is this right???
-// Would appear to be so...!
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		GPUWriteLong(RM, RN & 0xFF, GPU);
-	else
-		JaguarWriteByte(RM, RN, GPU);
-}
-
+	uint32_t address = offset & 0xFFFFFF, data = 0;
 
-static void gpu_opcode_storew(void)
-{
-#ifdef GPU_DIS_STOREW
-	if (doGPUDis)
-		WriteLog("%06X: STOREW R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_pc-2, IMM_2, IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		GPUWriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF, GPU);
-	else
-		JaguarWriteWord(RM, RN, GPU);
-#else
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		GPUWriteLong(RM, RN & 0xFFFF, GPU);
-	else
-		JaguarWriteWord(RM, RN, GPU);
-#endif
-}
+	if (address + size > 0x800000)
+	{
+		if (!GPUSpecSafe(address, size, false))
+		{
+			specFailed = true;
+			return 0;
+		}
 
+		for(uint32_t i=0; i<size; i++)
+			data = (data << 8) | JaguarReadByte(address + i, GPU);
 
-static void gpu_opcode_store(void)
-{
-#ifdef GPU_DIS_STORE
-	if (doGPUDis)
-		WriteLog("%06X: STORE  R%02u, (R%02u) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_pc-2, IMM_2, IMM_1, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN, IMM_1, RM);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		GPUWriteLong(RM & 0xFFFFFFFC, RN, GPU);
-	else
-		GPUWriteLong(RM, RN, GPU);
-#else
-	GPUWriteLong(RM, RN, GPU);
-#endif
-}
+		return data;
+	}
 
+	address &= 0x1FFFFF;
+	uint32_t page = address >> SPEC_PAGE_SHIFT;
 
-static void gpu_opcode_storep(void)
-{
-#ifdef GPU_CORRECT_ALIGNMENT
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
+	if (((address + size - 1) >> SPEC_PAGE_SHIFT) == page)
 	{
-		GPUWriteLong((RM & 0xFFFFFFF8) + 0, gpu_hidata, GPU);
-		GPUWriteLong((RM & 0xFFFFFFF8) + 4, RN, GPU);
+		GPUSpecMark(specGPURead, page);
+		const uint8_t * p = GPUSpecPage(page) + (address & (SPEC_PAGE_SIZE - 1));
+		return (size == 4 ? GET32(p, 0) : (size == 2 ? GET16(p, 0) : p[0]));
 	}
-	else
+
+	// Straddles two pages (or the end of RAM)
+	for(uint32_t i=0; i<size; i++)
 	{
-		GPUWriteLong(RM + 0, gpu_hidata, GPU);
-		GPUWriteLong(RM + 4, RN, GPU);
+		uint32_t a = (address + i) & 0x1FFFFF;
+		GPUSpecMark(specGPURead, a >> SPEC_PAGE_SHIFT);
+		data = (data << 8) | GPUSpecPage(a >> SPEC_PAGE_SHIFT)[a & (SPEC_PAGE_SIZE - 1)];
 	}
-#else
-	GPUWriteLong(RM + 0, gpu_hidata, GPU);
-	GPUWriteLong(RM + 4, RN, GPU);
-#endif
-}
-
-static void gpu_opcode_loadb(void)
-{
-#ifdef GPU_DIS_LOADB
-	if (doGPUDis)
-		WriteLog("%06X: LOADB  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(RM, GPU) & 0xFF;
-	else
-		RN = JaguarReadByte(RM, GPU);
-#ifdef GPU_DIS_LOADB
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
 
-static void gpu_opcode_loadw(void)
-{
-#ifdef GPU_DIS_LOADW
-	if (doGPUDis)
-		WriteLog("%06X: LOADW  (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(RM & 0xFFFFFFFE, GPU) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM, GPU);
-#else
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(RM, GPU) & 0xFFFF;
-	else
-		RN = JaguarReadWord(RM, GPU);
-#endif
-#ifdef GPU_DIS_LOADW
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	return data;
 }
 
 
-// According to the docs, & "Do The Same", this address is long aligned...
-// So let's try it:
-// And it works!!! Need to fix all instances...
-// Also, Power Drive Rally seems to contradict the idea that only LOADs in
-// the $F03000-$F03FFF range are aligned...
-#warning "!!! Alignment issues, need to find definitive final word on this !!!"
-/*
-Preliminary testing on real hardware seems to confirm that something strange goes on
-with unaligned reads in main memory. When the address is off by 1, the result is the
-same as the long address with the top byte replaced by something. So if the read is
-from $401, and $400 has 12 34 56 78, the value read will be $nn345678, where nn is a currently unknown vlaue.
-When the address is off by 2, the result would be $nnnn5678, where nnnn is unknown.
-When the address is off by 3, the result would be $nnnnnn78, where nnnnnn is unknown.
-It may be that the "unknown" values come from the prefetch queue, but not sure how
-to test that. They seem to be stable, though, which would indicate such a mechanism.
-Sometimes, however, the off by 2 case returns $12345678!
-*/
-static void gpu_opcode_load(void)
+//
+// GPU writes outside of its own RAM & registers, while it's running ahead
+//
+static void GPUSpecWrite(uint32_t offset, uint32_t size, uint32_t data)
 {
-#ifdef GPU_DIS_LOAD
-	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R%02u), R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t mask[4] = { 0x00000000, 0xFF000000, 0xFFFF0000, 0xFFFFFF00 };
-//	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(RM & 0xFFFFFFFC, GPU);
-//		RN = GPUReadLong(RM & 0x00FFFFFC, GPU);
-//	else
-//		RN = GPUReadLong(RM, GPU);
-	// Simulate garbage in unaligned reads...
-//seems that this behavior is different in GPU mem vs. main mem...
-//	if ((RM < 0xF03000) || (RM > 0xF0BFFF))
-//		RN |= mask[RM & 0x03];
-#else
-	RN = GPUReadLong(RM, GPU);
-#endif
-#ifdef GPU_DIS_LOAD
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
+	uint32_t address = offset & 0xFFFFFF;
 
-static void gpu_opcode_loadp(void)
-{
-#ifdef GPU_CORRECT_ALIGNMENT
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-	{
-		gpu_hidata = GPUReadLong((RM & 0xFFFFFFF8) + 0, GPU);
-		RN		   = GPUReadLong((RM & 0xFFFFFFF8) + 4, GPU);
-	}
-	else
+	if (address + size > 0x800000)
 	{
-		gpu_hidata = GPUReadLong(RM + 0, GPU);
-		RN		   = GPUReadLong(RM + 4, GPU);
+		specFailed = true;
+		return;
 	}
-#else
-	gpu_hidata = GPUReadLong(RM + 0, GPU);
-	RN		   = GPUReadLong(RM + 4, GPU);
-#endif
-}
-
-
-static void gpu_opcode_load_r14_indexed(void)
-{
-#ifdef GPU_DIS_LOAD14I
-	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R14+$%02X), R%02u [NCZ:%u%u%u, R14+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_convert_zero[IMM_1] << 2, gpu_reg[14]+(gpu_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2);
-
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
-	else
-		RN = GPUReadLong(address, GPU);
-#else
-	RN = GPUReadLong(gpu_reg[14] + (gpu_convert_zero[IMM_1] << 2), GPU);
-#endif
-#ifdef GPU_DIS_LOAD14I
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
 
-static void gpu_opcode_load_r15_indexed(void)
-{
-#ifdef GPU_DIS_LOAD15I
-	if (doGPUDis)
-		WriteLog("%06X: LOAD   (R15+$%02X), R%02u [NCZ:%u%u%u, R15+$%02X=%08X, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1] << 2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, gpu_convert_zero[IMM_1] << 2, gpu_reg[15]+(gpu_convert_zero[IMM_1] << 2), IMM_2, RN);
-#endif
-#ifdef GPU_CORRECT_ALIGNMENT
-	uint32_t address = gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2);
-
-	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
-		RN = GPUReadLong(address & 0xFFFFFFFC, GPU);
-	else
-		RN = GPUReadLong(address, GPU);
-#else
-	RN = GPUReadLong(gpu_reg[15] + (gpu_convert_zero[IMM_1] << 2), GPU);
-#endif
-#ifdef GPU_DIS_LOAD15I
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+	for(uint32_t i=0; i<size; i++)
+	{
+		uint32_t a = (address + i) & 0x1FFFFF;
+		uint8_t * p = GPUSpecShadow(a >> SPEC_PAGE_SHIFT);
 
+		if (p == NULL)
+		{
+			specFailed = true;
+			return;
+		}
 
-static void gpu_opcode_movei(void)
-{
-#ifdef GPU_DIS_MOVEI
-	if (doGPUDis)
-		WriteLog("%06X: MOVEI  #$%08X, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, (uint32_t)GPUReadWord(gpu_pc) | ((uint32_t)GPUReadWord(gpu_pc + 2) << 16), IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	// This instruction is followed by 32-bit value in LSW / MSW format...
-	RN = (uint32_t)GPUReadWord(gpu_pc, GPU) | ((uint32_t)GPUReadWord(gpu_pc + 2, GPU) << 16);
-	gpu_pc += 4;
-#ifdef GPU_DIS_MOVEI
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+		GPUSpecMark(specGPUWrite, a >> SPEC_PAGE_SHIFT);
+		p[a & (SPEC_PAGE_SIZE - 1)] = data >> ((size - 1 - i) * 8);
+	}
 }
 
 
-static void gpu_opcode_moveta(void)
+//
+// The GPU wrote <size> bytes of its local RAM at <offset> while it was running
+// ahead
+//
+static void GPUSpecLocalWrite(uint32_t offset, uint32_t size)
 {
-#ifdef GPU_DIS_MOVETA
-	if (doGPUDis)
-		WriteLog("%06X: MOVETA R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
-	ALTERNATE_RN = RM;
-#ifdef GPU_DIS_MOVETA
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u(alt)=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, ALTERNATE_RN);
-#endif
+	GPUSpecMark(specGPULocal, (offset & 0xFFF) >> 2);
+	GPUSpecMark(specGPULocal, ((offset + size - 1) & 0xFFF) >> 2);
 }
 
 
-static void gpu_opcode_movefa(void)
+//
+// The 68K (or the DSP) wrote to main RAM while the GPU was running ahead
+//
+void GPUSpecOtherWrite(uint32_t address, uint32_t size)
 {
-#ifdef GPU_DIS_MOVEFA
-	if (doGPUDis)
-		WriteLog("%06X: MOVEFA R%02u, R%02u [NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
-	RN = ALTERNATE_RM;
-#ifdef GPU_DIS_MOVEFA
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u(alt)=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, ALTERNATE_RM, IMM_2, RN);
-#endif
+	GPUSpecMark(specOtherWrite, (address & 0x1FFFFF) >> SPEC_PAGE_SHIFT);
+	GPUSpecMark(specOtherWrite, ((address + size - 1) & 0x1FFFFF) >> SPEC_PAGE_SHIFT);
 }
 
 
-static void gpu_opcode_move(void)
+#ifndef JAGUAR_MULTI_MACHINE
+static int GPUSpecThread(void * /*data*/)
 {
-#ifdef GPU_DIS_MOVE
-	if (doGPUDis)
-		WriteLog("%06X: MOVE   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = RM;
-#ifdef GPU_DIS_MOVE
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	while (true)
+	{
+		// The next slice is usually along in a moment, so we don't go to
+		// sleep right away
+		for(int i=0; (i<SPEC_SPIN) && !specGo.load(std::memory_order_acquire); i++)
+			std::this_thread::yield();
 
+		SDL_mutexP(specMutex);
 
-static void gpu_opcode_moveq(void)
-{
-#ifdef GPU_DIS_MOVEQ
-	if (doGPUDis)
-		WriteLog("%06X: MOVEQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	RN = IMM_1;
-#ifdef GPU_DIS_MOVEQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+		while (!specGo.load(std::memory_order_acquire) && !specQuit)
+			SDL_CondWait(specCond, specMutex);
 
+		bool quit = specQuit;
+		SDL_mutexV(specMutex);
 
-static void gpu_opcode_resmac(void)
-{
-	RN = gpu_acc;
-}
+		if (quit)
+			break;
 
+		specGo.store(false, std::memory_order_relaxed);
+		GPUSaveCheckpoint(specCheckpoint);
+		specLeft = GPURISC::Exec((int32_t)(specTarget - specStart));
+		specDone.store(true, std::memory_order_release);
+	}
 
-static void gpu_opcode_imult(void)
-{
-#ifdef GPU_DIS_IMULT
-	if (doGPUDis)
-		WriteLog("%06X: IMULT  R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (int16_t)RN * (int16_t)RM;
-	SET_ZN(RN);
-#ifdef GPU_DIS_IMULT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+	return 0;
 }
 
 
-static void gpu_opcode_mult(void)
+static bool GPUSpecStartThread(void)
 {
-#ifdef GPU_DIS_MULT
-	if (doGPUDis)
-		WriteLog("%06X: MULT   R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	RN = (uint16_t)RM * (uint16_t)RN;
-//	RN = (RM & 0xFFFF) * (RN & 0xFFFF);
-	SET_ZN(RN);
-#ifdef GPU_DIS_MULT
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-}
+	if (specThread)
+		return true;
 
+	if (specThreadFailed)
+		return false;
 
-static void gpu_opcode_bclr(void)
-{
-#ifdef GPU_DIS_BCLR
-	if (doGPUDis)
-		WriteLog("%06X: BCLR   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN & ~(1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_BCLR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
+	memset(specShadowOf, 0xFF, sizeof(specShadowOf));
+	specMutex = SDL_CreateMutex();
+	specCond = SDL_CreateCond();
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	specThread = SDL_CreateThread(GPUSpecThread, "GPU", NULL);
+#else
+	specThread = SDL_CreateThread(GPUSpecThread, NULL);
 #endif
-}
 
+	if (specThread == NULL)
+	{
+		WriteLog("GPU: Could not start a thread to run ahead on, running in turn.\n");
+		specThreadFailed = true;
+		SDL_DestroyCond(specCond);
+		SDL_DestroyMutex(specMutex);
+		return false;
+	}
 
-static void gpu_opcode_btst(void)
-{
-#ifdef GPU_DIS_BTST
-	if (doGPUDis)
-		WriteLog("%06X: BTST   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	gpu_flag_z = (~RN >> IMM_1) & 1;
-#ifdef GPU_DIS_BTST
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	return true;
 }
 
 
-static void gpu_opcode_bset(void)
+static void GPUSpecStopThread(void)
 {
-#ifdef GPU_DIS_BSET
-	if (doGPUDis)
-		WriteLog("%06X: BSET   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = RN | (1 << IMM_1);
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_BSET
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	if (specThread == NULL)
+		return;
+
+	SDL_mutexP(specMutex);
+	specQuit = true;
+	SDL_CondSignal(specCond);
+	SDL_mutexV(specMutex);
+	SDL_WaitThread(specThread, NULL);
+	SDL_DestroyCond(specCond);
+	SDL_DestroyMutex(specMutex);
+	specThread = NULL;
+	specQuit = false;
 }
+#endif
 
 
-static void gpu_opcode_imacn(void)
+//
+// Send the GPU off towards <clock> (the end of the 68K's slice), if it's on
+//
+void GPUSpeculate(uint64_t clock)
 {
-	uint32_t res = (int16_t)RM * (int16_t)(RN);
-	gpu_acc += res;
+#ifdef JAGUAR_MULTI_MACHINE
+	// The GPU's state belongs to this thread (see MACHINE.H)
+	(void)clock;
+#else
+	if (!vjs.parallelGPU || !vjs.GPUEnabled || !GPU_RUNNING || gpu_in_exec || gpu_start_log
+		|| gpuSpeculating || (clock <= gpu_clock) || !GPUSpecStartThread())
+		return;
+
+	specStart = gpu_clock;
+	specTarget = clock;
+	specIdle = specFailed = specBlocked = false;
+	specStop.store(false, std::memory_order_relaxed);
+	specDone.store(false, std::memory_order_relaxed);
+
+	// Either this sees the audio thread about to run the DSP, or the audio
+	// thread sees this & waits for the GPU to come back
+	gpuSpeculating = true;
+
+	if (specLockedOut)
+	{
+		gpuSpeculating = false;
+		return;
+	}
+
+	SDL_mutexP(specMutex);
+	specGo.store(true, std::memory_order_release);
+	SDL_CondSignal(specCond);
+	SDL_mutexV(specMutex);
+#endif
 }
 
 
-static void gpu_opcode_mtoi(void)
+//
+// Put the GPU back where it was sent off from, if it's running ahead (without
+// running it on from there)
+//
+void GPUAbandonSpeculation(void)
 {
-	uint32_t _RM = RM;
-	uint32_t res = RN = (((int32_t)_RM >> 8) & 0xFF800000) | (_RM & 0x007FFFFF);
-	SET_ZN(res);
+	if (gpuSpeculating)
+		GPUFinishSpeculation(gpu_clock);
 }
 
 
-static void gpu_opcode_normi(void)
+//
+// Keep the GPU from running ahead while the DSP runs on the audio thread
+// (waiting for it to come back, if it's out), or let it run ahead again
+//
+void GPULockOutSpeculation(bool state/*= true*/)
 {
-	uint32_t _RM = RM;
-	uint32_t res = 0;
+#ifndef JAGUAR_MULTI_MACHINE
+	specLockedOut = state;
 
-	if (_RM)
-	{
-		while ((_RM & 0xFFC00000) == 0)
-		{
-			_RM <<= 1;
-			res--;
-		}
-		while ((_RM & 0xFF800000) != 0)
-		{
-			_RM >>= 1;
-			res++;
-		}
-	}
-	RN = res;
-	SET_ZN(res);
+	if (state)
+		while (gpuSpeculating)
+			std::this_thread::yield();
+#else
+	(void)state;
+#endif
 }
 
-static void gpu_opcode_mmult(void)
+
+//
+// Stop the GPU running ahead, now that it's wanted at <clock>, and keep what
+// it did or put it back
+//
+static void GPUFinishSpeculation(uint64_t clock)
 {
-	int count	= gpu_matrix_control & 0x0F;	// Matrix width
-	uint32_t addr = gpu_pointer_to_matrix;		// In the GPU's RAM
-	int64_t accum = 0;
-	uint32_t res;
+	specStop.store(true, std::memory_order_relaxed);
 
-	if (gpu_matrix_control & 0x10)				// Column stepping
-	{
-		for(int i=0; i<count; i++)
-		{
-			int16_t a;
-			if (i & 0x01)
-				a = (int16_t)((gpu_alternate_reg[IMM_1 + (i >> 1)] >> 16) & 0xFFFF);
-			else
-				a = (int16_t)(gpu_alternate_reg[IMM_1 + (i >> 1)] & 0xFFFF);
+	while (!specDone.load(std::memory_order_acquire))
+		std::this_thread::yield();
 
-			int16_t b = ((int16_t)GPUReadWord(addr + 2, GPU));
-			accum += a * b;
-			addr += 4 * count;
-		}
-	}
-	else										// Row stepping
-	{
-		for(int i=0; i<count; i++)
-		{
-			int16_t a;
-			if (i & 0x01)
-				a = (int16_t)((gpu_alternate_reg[IMM_1 + (i >> 1)] >> 16) & 0xFFFF);
-			else
-				a = (int16_t)(gpu_alternate_reg[IMM_1 + (i >> 1)] & 0xFFFF);
+	gpuSpeculating = false;
 
-			int16_t b = ((int16_t)GPUReadWord(addr + 2, GPU));
-			accum += a * b;
-			addr += 4;
-		}
-	}
-	RN = res = (int32_t)accum;
-	// carry flag to do (out of the last add)
-	SET_ZN(res);
-}
+	uint64_t reached = specTarget - specLeft;
+	bool ranOut = (specLeft <= 0);
+	bool conflict = false;
 
+	for(uint32_t i=0; i<SPEC_PAGES/64; i++)
+		if (specOtherWrite[i] & (specGPURead[i] | specGPUWrite[i]))
+			conflict = true;
 
-static void gpu_opcode_abs(void)
-{
-#ifdef GPU_DIS_ABS
-	if (doGPUDis)
-		WriteLog("%06X: ABS    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	gpu_flag_c = RN >> 31;
-	if (RN == 0x80000000)
-	//Is 0x80000000 a positive number? If so, then we need to set C to 0 as well!
-		gpu_flag_n = 1, gpu_flag_z = 0;
-	else
-	{
-		if (gpu_flag_c)
-			RN = -RN;
-		gpu_flag_n = 0; SET_FLAG_Z(RN);
-	}
-#ifdef GPU_DIS_ABS
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+	// Had it run in turn, it would have stopped at the same place only if it
+	// had the same # of cycles to go on (or if it stopped early & it's wanted
+	// later than that)
+	bool overran = (ranOut ? clock != specTarget : reached >= clock);
 
+	specStats.runs++;
 
-static void gpu_opcode_div(void)	// RN / RM
-{
-#ifdef GPU_DIS_DIV
-	if (doGPUDis)
-		WriteLog("%06X: DIV    R%02u, R%02u (%s) [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, (gpu_div_control & 0x01 ? "16.16" : "32"), gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-#if 0
-	if (RM)
+	if (specFailed || conflict || overran)
 	{
-		if (gpu_div_control & 0x01)		// 16.16 division
-		{
-			gpu_remain = ((uint64_t)RN << 16) % RM;
-			RN = ((uint64_t)RN << 16) / RM;
-		}
+		GPURestoreCheckpoint(specCheckpoint);
+		specStats.rollbacks++;
+		specStats.cyclesDiscarded += reached - specStart;
+
+		if (specFailed)
+			specStats.failures++;
+		else if (conflict)
+			specStats.conflicts++;
 		else
-		{
-			// We calculate the remainder first because we destroy RN after
-			// this by assigning it to itself.
-			gpu_remain = RN % RM;
-			RN = RN / RM;
-		}
+			specStats.overruns++;
 	}
 	else
 	{
-		// This is what happens according to SCPCD. NYAN!
-		RN = 0xFFFFFFFF;
-		gpu_remain = 0;
-	}
-#else
-	// Real algorithm, courtesy of SCPCD: NYAN!
-	uint32_t q = RN;
-	uint32_t r = 0;
+		for(uint32_t i=0; i<specShadows; i++)
+			memcpy(jaguarMainRAM + (specShadowPage[i] << SPEC_PAGE_SHIFT), specShadow[i], SPEC_PAGE_SIZE);
 
-	// If 16.16 division, stuff top 16 bits of RN into remainder and put the
-	// bottom 16 of RN in top 16 of quotient
-	if (gpu_div_control & 0x01)
-		q <<= 16, r = RN >> 16;
+		specStats.commits++;
+		specStats.cyclesKept += reached - specStart;
+		gpu_clock = reached;
 
-	for(int i=0; i<32; i++)
-	{
-//		uint32_t sign = (r >> 31) & 0x01;
-		uint32_t sign = r & 0x80000000;
-		r = (r << 1) | ((q >> 31) & 0x01);
-		r += (sign ? RM : -RM);
-		q = (q << 1) | (((~r) >> 31) & 0x01);
+		if (specBlocked)
+			specStats.stoppedShort++;
+
+		// It would have skipped the rest of the way
+		if (specIdle)
+		{
+			GPURISC::SkipIdleCycles((uint32_t)(clock - reached));
+			gpu_clock = clock;
+		}
 	}
 
-	RN = q;
-	gpu_remain = r;
-#endif
+	for(uint32_t i=0; i<specShadows; i++)
+		specShadowOf[specShadowPage[i]] = -1;
 
-#ifdef GPU_DIS_DIV
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] Remainder: %08X\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN, gpu_remain);
-#endif
+	specShadows = 0;
+	memset(specGPURead, 0, sizeof(specGPURead));
+	memset(specGPUWrite, 0, sizeof(specGPUWrite));
+	memset(specOtherWrite, 0, sizeof(specOtherWrite));
+	memset(specGPULocal, 0, sizeof(specGPULocal));
 }
 
 
-static void gpu_opcode_imultn(void)
+void GPUGetSpecStats(GPUSpecStats & stats)
 {
-	uint32_t res = (int32_t)((int16_t)RN * (int16_t)RM);
-	gpu_acc = (int32_t)res;
-	SET_FLAG_Z(res);
-	SET_FLAG_N(res);
+	stats = specStats;
 }
 
 
-static void gpu_opcode_neg(void)
-{
-#ifdef GPU_DIS_NEG
-	if (doGPUDis)
-		WriteLog("%06X: NEG    R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = -RN;
-	SET_ZNC_SUB(0, RN, res);
-	RN = res;
-#ifdef GPU_DIS_NEG
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
-
+//
+// GPU opcodes
+//
 
-static void gpu_opcode_shlq(void)
-{
-#ifdef GPU_DIS_SHLQ
-	if (doGPUDis)
-		WriteLog("%06X: SHLQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, 32 - IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-// Was a bug here...
-// (Look at Aaron's code: If r1 = 32, then 32 - 32 = 0 which is wrong!)
-	int32_t r1 = 32 - IMM_1;
-	uint32_t res = RN << r1;
-	SET_ZN(res); gpu_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef GPU_DIS_SHLQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-}
+/*
+GPU opcodes use (offset punch--vertically below bad guy):
+	              add 18686
+	             addq 32621
+	              sub 7483
+	             subq 10252
+	              and 21229
+	               or 15003
+	             btst 1822
+	             bset 2072
+	             mult 141
+	              div 2392
+	             shlq 13449
+	             shrq 10297
+	            sharq 11104
+	              cmp 6775
+	             cmpq 5944
+	             move 31259
+	            moveq 4473
+	            movei 23277
+	            loadb 46
+	            loadw 4201
+	             load 28580
+	 load_r14_indexed 1183
+	 load_r15_indexed 1125
+	           storew 178
+	            store 10144
+	store_r14_indexed 320
+	store_r15_indexed 1
+	          move_pc 1742
+	             jump 24467
+	               jr 18090
+	              nop 41362
+*/
 
 
-static void gpu_opcode_shrq(void)
+static void gpu_opcode_sat8(void)
 {
-#ifdef GPU_DIS_SHRQ
+#ifdef GPU_DIS_SAT8
 	if (doGPUDis)
-		WriteLog("%06X: SHRQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
+		WriteLog("%06X: SAT8   R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, IMM_2, FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN);
 #endif
-	int32_t r1 = gpu_convert_zero[IMM_1];
-	uint32_t res = RN >> r1;
-	SET_ZN(res); gpu_flag_c = RN & 1;
-	RN = res;
-#ifdef GPU_DIS_SHRQ
+	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFF ? 0xFF : RN));
+	SET_ZN(RN);
+#ifdef GPU_DIS_SAT8
 	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN);
 #endif
 }
 
 
-static void gpu_opcode_ror(void)
+static void gpu_opcode_sat16(void)
 {
-#ifdef GPU_DIS_ROR
-	if (doGPUDis)
-		WriteLog("%06X: ROR    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	uint32_t r1 = RM & 0x1F;
-	uint32_t res = (RN >> r1) | (RN << (32 - r1));
-	SET_ZN(res); gpu_flag_c = (RN >> 31) & 1;
-	RN = res;
-#ifdef GPU_DIS_ROR
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
+	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFFFF ? 0xFFFF : RN));
+	SET_ZN(RN);
 }
 
-
-static void gpu_opcode_rorq(void)
+static void gpu_opcode_sat24(void)
 {
-#ifdef GPU_DIS_RORQ
-	if (doGPUDis)
-		WriteLog("%06X: RORQ   #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t r1 = gpu_convert_zero[IMM_1 & 0x1F];
-	uint32_t r2 = RN;
-	uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
-	RN = res;
-	SET_ZN(res); gpu_flag_c = (r2 >> 31) & 0x01;
-#ifdef GPU_DIS_RORQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
+	RN = ((int32_t)RN < 0 ? 0 : (RN > 0xFFFFFF ? 0xFFFFFF : RN));
+	SET_ZN(RN);
 }
 
 
-static void gpu_opcode_sha(void)
+static void gpu_opcode_pack(void)
 {
-/*	int dreg = jaguar.op & 31;
-	int32_t r1 = (int32_t)jaguar.r[(jaguar.op >> 5) & 31];
-	uint32_t r2 = jaguar.r[dreg];
-	uint32_t res;
-
-	CLR_ZNC;
-	if (r1 < 0)
-	{
-		res = (r1 <= -32) ? 0 : (r2 << -r1);
-		jaguar.FLAGS |= (r2 >> 30) & 2;
-	}
-	else
-	{
-		res = (r1 >= 32) ? ((int32_t)r2 >> 31) : ((int32_t)r2 >> r1);
-		jaguar.FLAGS |= (r2 << 1) & 2;
-	}
-	jaguar.r[dreg] = res;
-	SET_ZN(res);*/
-
-#ifdef GPU_DIS_SHA
+#ifdef GPU_DIS_PACK
 	if (doGPUDis)
-		WriteLog("%06X: SHA    R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("%06X: %s R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, (!IMM_1 ? "PACK  " : "UNPACK"), IMM_2, FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN);
 #endif
-	uint32_t res;
+	uint32_t val = RN;
 
-	if ((int32_t)RM < 0)
-	{
-		res = ((int32_t)RM <= -32) ? 0 : (RN << -(int32_t)RM);
-		gpu_flag_c = RN >> 31;
-	}
-	else
-	{
-		res = ((int32_t)RM >= 32) ? ((int32_t)RN >> 31) : ((int32_t)RN >> (int32_t)RM);
-		gpu_flag_c = RN & 0x01;
-	}
-	RN = res;
-	SET_ZN(res);
-#ifdef GPU_DIS_SHA
+//BUG!	if (RM == 0)				// Pack
+	if (IMM_1 == 0)				// Pack
+		RN = ((val >> 10) & 0x0000F000) | ((val >> 5) & 0x00000F00) | (val & 0x000000FF);
+	else						// Unpack
+		RN = ((val & 0x0000F000) << 10) | ((val & 0x00000F00) << 5) | (val & 0x000000FF);
+#ifdef GPU_DIS_PACK
 	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
+		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", FLAG_N, FLAG_C, FLAG_Z, IMM_2, RN);
 #endif
+}
 
-/*	int32_t sRM=(int32_t)RM;
-	uint32_t _RN=RN;
 
-	if (sRM<0)
+static void gpu_opcode_storep(void)
+{
+#ifdef GPU_CORRECT_ALIGNMENT
+	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
 	{
-		uint32_t shift=-sRM;
-		if (shift>=32) shift=32;
-		gpu_flag_c=(_RN&0x80000000)>>31;
-		while (shift)
-		{
-			_RN<<=1;
-			shift--;
-		}
+		GPUWriteLong((RM & 0xFFFFFFF8) + 0, gpu_hidata, GPU);
+		GPUWriteLong((RM & 0xFFFFFFF8) + 4, RN, GPU);
 	}
 	else
 	{
-		uint32_t shift=sRM;
-		if (shift>=32) shift=32;
-		gpu_flag_c=_RN&0x1;
-		while (shift)
-		{
-			_RN=((int32_t)_RN)>>1;
-			shift--;
-		}
+		GPUWriteLong(RM + 0, gpu_hidata, GPU);
+		GPUWriteLong(RM + 4, RN, GPU);
 	}
-	RN=_RN;
-	SET_FLAG_Z(_RN);
-	SET_FLAG_N(_RN);*/
-}
-
-
-static void gpu_opcode_sharq(void)
-{
-#ifdef GPU_DIS_SHARQ
-	if (doGPUDis)
-		WriteLog("%06X: SHARQ  #%u, R%02u [NCZ:%u%u%u, R%02u=%08X] -> ", gpu_pc-2, gpu_convert_zero[IMM_1], IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
-#endif
-	uint32_t res = (int32_t)RN >> gpu_convert_zero[IMM_1];
-	SET_ZN(res); gpu_flag_c = RN & 0x01;
-	RN = res;
-#ifdef GPU_DIS_SHARQ
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_2, RN);
+#else
+	GPUWriteLong(RM + 0, gpu_hidata, GPU);
+	GPUWriteLong(RM + 4, RN, GPU);
 #endif
 }
 
 
-static void gpu_opcode_sh(void)
+static void gpu_opcode_loadp(void)
 {
-#ifdef GPU_DIS_SH
-	if (doGPUDis)
-		WriteLog("%06X: SH     R%02u, R%02u [NCZ:%u%u%u, R%02u=%08X, R%02u=%08X] -> ", gpu_pc-2, IMM_1, IMM_2, gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
-#endif
-	if (RM & 0x80000000)		// Shift left
+#ifdef GPU_CORRECT_ALIGNMENT
+	if ((RM >= 0xF03000) && (RM <= 0xF03FFF))
 	{
-		gpu_flag_c = RN >> 31;
-		RN = ((int32_t)RM <= -32 ? 0 : RN << -(int32_t)RM);
+		gpu_hidata = GPUReadLong((RM & 0xFFFFFFF8) + 0, GPU);
+		RN		   = GPUReadLong((RM & 0xFFFFFFF8) + 4, GPU);
 	}
-	else						// Shift right
+	else
 	{
-		gpu_flag_c = RN & 0x01;
-		RN = (RM >= 32 ? 0 : RN >> RM);
+		gpu_hidata = GPUReadLong(RM + 0, GPU);
+		RN		   = GPUReadLong(RM + 4, GPU);
 	}
-	SET_ZN(RN);
-#ifdef GPU_DIS_SH
-	if (doGPUDis)
-		WriteLog("[NCZ:%u%u%u, R%02u=%08X, R%02u=%08X]\n", gpu_flag_n, gpu_flag_c, gpu_flag_z, IMM_1, RM, IMM_2, RN);
+#else
+	gpu_hidata = GPUReadLong(RM + 0, GPU);
+	RN		   = GPUReadLong(RM + 4, GPU);
 #endif
 }
 
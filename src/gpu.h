@@ -6,6 +6,7 @@
 #define __GPU_H__
 
 //#include "types.h"
+#include <atomic>
 #include "memory.h"
 
 #define GPU_CONTROL_RAM_BASE    0x00F02100
@@ -14,7 +15,14 @@
 void GPUInit(void);
 void GPUReset(void);
 void GPUExec(int32_t);
+void GPUCatchUp(uint64_t clock);
+void GPUSpeculate(uint64_t clock);
+void GPUAbandonSpeculation(void);
+void GPULockOutSpeculation(bool state = true);
+void GPUSpecOtherWrite(uint32_t address, uint32_t size);
+uint64_t GPUGetIdleCycles(void);
 void GPUDone(void);
+void GPUSnapshot(void);
 void GPUUpdateRegisterBanks(void);
 void GPUHandleIRQs(void);
 void GPUSetIRQLine(int irqline, int state);
@@ -31,12 +39,29 @@ void GPUReleaseTimeslice(void);
 void GPUResetStats(void);
 uint32_t GPUReadPC(void);
 
+// Running ahead on another thread (see GPU.CPP)
+
+struct GPUSpecStats
+{
+	uint64_t runs;							// Times the GPU was sent off ahead
+	uint64_t commits;						// Runs that were kept...
+	uint64_t stoppedShort;					// (...that stopped short of something)
+	uint64_t rollbacks;						// ...and ones that were run again, because:
+	uint64_t conflicts;						// The 68K (or DSP) wrote where the GPU had been
+	uint64_t overruns;						// The GPU went past where it was wanted
+	uint64_t failures;						// The GPU did something it can't take back
+	uint64_t cyclesKept, cyclesDiscarded;
+};
+
+void GPUGetSpecStats(GPUSpecStats & stats);
+
 // GPU interrupt numbers (from $F00100, bits 4-8)
 
 enum { GPUIRQ_CPU = 0, GPUIRQ_DSP, GPUIRQ_TIMER, GPUIRQ_OBJECT, GPUIRQ_BLITTER };
 
 // Exported vars
 
-extern uint32_t gpu_reg_bank_0[], gpu_reg_bank_1[];
+extern MACHINE_STATE uint32_t gpu_reg_bank_0[], gpu_reg_bank_1[];
+extern std::atomic<bool> gpuSpeculating;
 
 #endif	// __GPU_H__
@@ -19,6 +19,7 @@
 
 #include <SDL.h>
 #include <QApplication>
+#include "capture.h"
 #include "gamepad.h"
 #include "log.h"
 #include "mainwin.h"
@@ -187,6 +188,8 @@ bool ParseCommandLine(int argc, char * argv[])
 				"   --dsp         -d  Enable DSP\n"
 				"   --no-dsp          Disable DSP\n"
 				"   --fullscreen  -f  Start in full screen mode\n"
+				"   --cd-image <file> Use CUE/BIN or ISO image as the CD\n"
+				"   --record <file>   Record audio & video to <file> (.y4m or .vjc)\n"
 				"   --blur        -B  Enable GL bilinear filter\n"
 				"   --no-blur         Disable GL bilinear filtering\n"
 				"   --log         -l  Create and use log file\n"
@@ -232,6 +235,15 @@ bool ParseCommandLine(int argc, char * argv[])
 			useLogfile = false;
 		}
 
+		// Skip over the disc image & capture names, so they're not taken for
+		// a filename
+		if (((strcmp(argv[i], "--cd-image") == 0)
+			|| (strcmp(argv[i], "--record") == 0)) && (i + 1 < argc))
+		{
+			i++;
+			continue;
+		}
+
 		// Check for filename
 		if (argv[i][0] != '-')
 		{
@@ -252,6 +264,8 @@ bool ParseCommandLine(int argc, char * argv[])
 //
 void ParseOptions(int argc, char * argv[])
 {
+	const char * recordFile = NULL;
+
 	for(int i=1; i<argc; i++)
 	{
 		if ((strcmp(argv[i], "--pal") == 0) || (strcmp(argv[i], "-p") == 0))
@@ -310,7 +324,20 @@ void ParseOptions(int argc, char * argv[])
 		{
 			vjs.glFilter = 0;
 		}
+
+		if ((strcmp(argv[i], "--cd-image") == 0) && (i + 1 < argc))
+		{
+			strncpy(vjs.CDImagePath, argv[++i], MAX_PATH - 1);
+			vjs.CDImagePath[MAX_PATH - 1] = 0;
+		}
+
+		if ((strcmp(argv[i], "--record") == 0) && (i + 1 < argc))
+			recordFile = argv[++i];
 	}
+
+	// Wait until we know whether it's PAL or NTSC before we start this
+	if (recordFile)
+		CaptureStart(recordFile);
 }
 
 #if 0
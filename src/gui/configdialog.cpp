@@ -78,6 +78,8 @@ void ConfigDialog::LoadDialogFromSettings(void)
 	generalTab->useFullScreen->setChecked(vjs.fullscreen);
 //	generalTab->useHostAudio->setChecked(vjs.audioEnabled);
 	generalTab->useFastBlitter->setChecked(vjs.useFastBlitter);
+	generalTab->useAudioSync->setChecked(vjs.audioSync);
+	generalTab->useIdleSkip->setChecked(vjs.idleSkip);
 
 	if (vjs.hardwareTypeAlpine)
 	{
@@ -114,6 +116,8 @@ void ConfigDialog::UpdateVJSettings(void)
 	vjs.fullscreen     = generalTab->useFullScreen->isChecked();
 //	vjs.audioEnabled   = generalTab->useHostAudio->isChecked();
 	vjs.useFastBlitter = generalTab->useFastBlitter->isChecked();
+	vjs.audioSync      = generalTab->useAudioSync->isChecked();
+	vjs.idleSkip       = generalTab->useIdleSkip->isChecked();
 
 	if (vjs.hardwareTypeAlpine)
 	{
@@ -60,7 +60,7 @@ QVariant FileListModel::data(const QModelIndex & index, int role) const
 
 		// Pull name from file DB, otherwise, use the filename...
 		if (dbIndex != 0xFFFFFFFF)
-			nameToMatch = romList[dbIndex].name;
+			nameToMatch = FileDBName(dbIndex);
 		else
 		{
 			int lastSlashPos = filename.lastIndexOf('/');
@@ -117,6 +117,20 @@ void FileListModel::AddData(unsigned long index, QString str, QImage img, unsign
 	endInsertRows();
 }
 
+//
+// Add a whole batch of files at once, so the view only has to deal with one
+// insertion instead of one per file
+//
+void FileListModel::AddData(const QVector<FileListData> & files)
+{
+	if (files.isEmpty())
+		return;
+
+	beginInsertRows(QModelIndex(), list.size(), list.size() + files.size() - 1);
+	list.insert(list.end(), files.begin(), files.end());
+	endInsertRows();
+}
+
 void FileListModel::ClearData(void)
 {
 	if (list.size() == 0)
@@ -26,6 +26,8 @@ struct FileListData
 	uint32_t crc;
 };
 
+Q_DECLARE_METATYPE(FileListData)
+
 //hm.
 #define FLM_INDEX			(Qt::UserRole + 1)
 #define FLM_FILESIZE		(Qt::UserRole + 2)
@@ -48,6 +50,7 @@ class FileListModel: public QAbstractListModel
 //		void AddData(unsigned long);
 		void AddData(unsigned long, QString, QImage, unsigned long);
 		void AddData(unsigned long, QString, QImage, unsigned long, bool, uint32_t, uint32_t);
+		void AddData(const QVector<FileListData> &);
 		void ClearData(void);
 
 //		FileListData GetData(const QModelIndex & index) const;
@@ -177,10 +177,12 @@ printf("VSB size: %u, %u\n", sbSize3.width(), sbSize3.height());
 	fileThread = new FileThread(this);
 //	connect(fileThread, SIGNAL(FoundAFile(unsigned long)), this, SLOT(AddFileToList(unsigned long)));
 //	connect(fileThread, SIGNAL(FoundAFile2(unsigned long, QString, QImage *, unsigned long)), this, SLOT(AddFileToList2(unsigned long, QString, QImage *, unsigned long)));
-	connect(fileThread, SIGNAL(FoundAFile3(unsigned long, QString, QImage *,
-		unsigned long, bool, unsigned long, unsigned long)), this,
-		SLOT(AddFileToList3(unsigned long, QString, QImage *, unsigned long,
-		bool, unsigned long, unsigned long)));
+//	connect(fileThread, SIGNAL(FoundAFile3(unsigned long, QString, QImage *,
+//		unsigned long, bool, unsigned long, unsigned long)), this,
+//		SLOT(AddFileToList3(unsigned long, QString, QImage *, unsigned long,
+//		bool, unsigned long, unsigned long)));
+	connect(fileThread, SIGNAL(FoundFiles(QVector<FileListData>)), this,
+		SLOT(AddFilesToList(QVector<FileListData>)));
 
 // Let's defer this to the main window, so we can have some control over when this is done.
 //	fileThread->Go();
@@ -237,7 +239,7 @@ void FilePickerWindow::ScanSoftwareFolder(bool allow/*= false*/)
 //
 void FilePickerWindow::AddFileToList(unsigned long index)
 {
-printf("FilePickerWindow: Found match [%s]...\n", romList[index].name);
+printf("FilePickerWindow: Found match [%s]...\n", FileDBName(index));
 	// NOTE: The model *ignores* what you send it, so this is crap. !!! FIX !!! [DONE, somewhat]
 //	model->AddData(QIcon(":/res/generic.png"));
 //	model->AddData(index);
@@ -246,7 +248,7 @@ printf("FilePickerWindow: Found match [%s]...\n", romList[index].name);
 void FilePickerWindow::AddFileToList2(unsigned long index, QString str, QImage * img, unsigned long size)
 {
 if (index != 0xFFFFFFFF)
-	printf("FilePickerWindow(2): Found match [%s]...\n", romList[index].name);
+	printf("FilePickerWindow(2): Found match [%s]...\n", FileDBName(index));
 
 	if (img)
 	{
@@ -273,6 +275,14 @@ void FilePickerWindow::AddFileToList3(unsigned long index, QString str, QImage *
 		model->AddData(index, str, QImage(), size, haveUniversalHeader, fileType, crc);
 }
 
+//
+// This slot gets called by the FileThread with a batch of files at a time
+//
+void FilePickerWindow::AddFilesToList(QVector<FileListData> files)
+{
+	model->AddData(files);
+}
+
 void FilePickerWindow::LoadButtonPressed(void)
 {
 	// TODO: Get the text of the current selection, call the MainWin slot for loading
@@ -352,7 +362,7 @@ void FilePickerWindow::UpdateSelection(const QModelIndex & current, const QModel
 // We can assume that if it wasn't found in the DB, then the fileType
 // should be valid.
 // The DB takes precedence over the fileType.
-		if ((!haveUnknown && (romList[i].flags & FF_ROM))
+		if ((!haveUnknown && (FileDBFlags(i) & FF_ROM))
 			|| (haveUnknown && (fileType == JST_ROM) && !haveUniversalHeader))
 		{
 			cart = QImage(":/res/cart-blank.png");
@@ -360,7 +370,7 @@ void FilePickerWindow::UpdateSelection(const QModelIndex & current, const QModel
 			painter.drawPixmap(27, 89, QPixmap::fromImage(QImage(":/res/label-blank.png")));
 			painter.end();
 		}
-		else if ((!haveUnknown && (romList[i].flags & FF_ALPINE))
+		else if ((!haveUnknown && (FileDBFlags(i) & FF_ALPINE))
 			|| (haveUnknown
 				&& ((fileType == JST_ALPINE) || ((fileType == JST_ROM) && haveUniversalHeader))))
 		{
@@ -384,7 +394,7 @@ void FilePickerWindow::UpdateSelection(const QModelIndex & current, const QModel
 //2097152
 //4194304
 	if (!haveUnknown)
-		prettyFilename = romList[i].name;
+		prettyFilename = FileDBName(i);
 	else
 	{
 		int lastSlashPos = currentFile.lastIndexOf('/');
@@ -408,18 +418,18 @@ void FilePickerWindow::UpdateSelection(const QModelIndex & current, const QModel
 #if 0
 	if (!haveUnknown)
 	{
-		if (romList[i].flags & FF_ROM)
+		if (FileDBFlags(i) & FF_ROM)
 			fileTypeString = QString(tr("%1MB Cartridge")).arg(fileSize / 1048576);
-		else if (romList[i].flags & FF_ALPINE)
+		else if (FileDBFlags(i) & FF_ALPINE)
 			fileTypeString = QString(tr("%1MB Alpine ROM")).arg(fileSize / 1048576);
 		else
 			fileTypeString = QString(tr("*** UNKNOWN *** (%1 bytes)")).arg(fileSize);
 	}
 #else
-	if ((!haveUnknown && (romList[i].flags & FF_ROM))
+	if ((!haveUnknown && (FileDBFlags(i) & FF_ROM))
 		|| (haveUnknown && (fileType == JST_ROM) && !haveUniversalHeader))
 		fileTypeString = QString(tr("%1MB Cartridge")).arg(fileSize / 1048576);
-	else if ((!haveUnknown && (romList[i].flags & FF_ALPINE))
+	else if ((!haveUnknown && (FileDBFlags(i) & FF_ALPINE))
 		|| (haveUnknown
 				&& ((fileType == JST_ALPINE) || ((fileType == JST_ROM) && haveUniversalHeader))))
 	{
@@ -441,25 +451,25 @@ void FilePickerWindow::UpdateSelection(const QModelIndex & current, const QModel
 //	crcString = QString("%1").arg(romList[i].crc32, 8, 16, QChar('0')).toUpper();
 	crcString = QString("%1").arg(crc, 8, 16, QChar('0')).toUpper();
 
-	if (!haveUnknown && (romList[i].flags & FF_NON_WORKING))
+	if (!haveUnknown && (FileDBFlags(i) & FF_NON_WORKING))
 		compatibility = "DOES NOT WORK";
 	else
 		compatibility = "Unknown";
 
 	// This is going to need some formatting love before long...
-	if (!haveUnknown && (romList[i].flags & FF_BAD_DUMP))
+	if (!haveUnknown && (FileDBFlags(i) & FF_BAD_DUMP))
 		notes = "<b>BAD DUMP</b>";
 
 //	if (haveUniversalHeader)
 //		notes += " Universal Header detected";
 
-	if (!haveUnknown && (romList[i].flags & FF_REQ_BIOS))
+	if (!haveUnknown && (FileDBFlags(i) & FF_REQ_BIOS))
 		notes += " Requires BIOS";
 
-	if (!haveUnknown && (romList[i].flags & FF_REQ_DSP))
+	if (!haveUnknown && (FileDBFlags(i) & FF_REQ_DSP))
 		notes += " Requires DSP";
 
-	if (!haveUnknown && (romList[i].flags & FF_VERIFIED))
+	if (!haveUnknown && (FileDBFlags(i) & FF_VERIFIED))
 		notes += " <i>(Verified)</i>";
 
 	data->setText(QString("%1<br>%2<br>%3<br>%4")
@@ -25,8 +25,33 @@
 
 #define VERBOSE_LOGGING
 
-FileThread::FileThread(QObject * parent/*= 0*/): QThread(parent), abort(false)
+// Number of files we collect before handing them off to the model
+#define FILE_BATCH_SIZE		32
+// Bump this whenever the layout of the cache file changes
+#define FILE_CACHE_VERSION	1
+
+
+//
+// One of these gets queued on the thread pool for each file in the ROM dir
+//
+class FileScanTask: public QRunnable
 {
+	public:
+		FileScanTask(FileThread * t, QFileInfo fi): thread(t), fileInfo(fi) {}
+		void run(void) { thread->ScanFile(fileInfo); }
+
+	private:
+		FileThread * thread;
+		QFileInfo fileInfo;
+};
+
+
+FileThread::FileThread(QObject * parent/*= 0*/): QThread(parent), abort(false),
+	cacheLoaded(false)
+{
+	qRegisterMetaType<FileListData>("FileListData");
+	qRegisterMetaType<QVector<FileListData> >("QVector<FileListData>");
+	cacheFilename = QStandardPaths::writableLocation(QStandardPaths::CacheLocation).append("/filecache.dat");
 }
 
 FileThread::~FileThread()
@@ -60,6 +85,12 @@ Ideally, the label will go into the archive along with the ROM image, but that's
 for the future...
 Maybe box art, screenshots will go as well...
 The future is NOW! :-)
+
+Since hashing a couple thousand files one at a time takes forever, the files
+are now farmed out to a thread pool, and the results are handed to the model
+in batches. What we learn about each file is kept in a cache on disk (keyed
+by path, size and modification time) so files we've already seen don't have
+to be opened at all the next time around.
 */
 
 //
@@ -67,101 +98,183 @@ The future is NOW! :-)
 //
 void FileThread::run(void)
 {
+	if (!cacheLoaded)
+	{
+		LoadCache();
+		cacheLoaded = true;
+	}
+
 	QDir romDir(vjs.ROMPath);
-	QFileInfoList list = romDir.entryInfoList();
+	QFileInfoList list = romDir.entryInfoList(QDir::Files | QDir::Readable);
+	newCache.clear();
 
 	for(int i=0; i<list.size(); i++)
 	{
 		if (abort)
+			break;
+
+		pool.start(new FileScanTask(this, list.at(i)));
+	}
+
+	// Hand off whatever has accumulated while the pool chews through the list
+	while (!pool.waitForDone(100))
+	{
+		if (abort)
+			pool.clear();
+
+		FlushBatch();
+	}
+
+	if (abort)
 #ifdef VERBOSE_LOGGING
 {
 printf("FileThread: Aborting!!!\n");
 #endif
-			return;
+		return;
 #ifdef VERBOSE_LOGGING
 }
 #endif
 
-		HandleFile(list.at(i));
-	}
+	FlushBatch();
+
+	// Only what we saw this time goes back out, so stale entries get pruned
+	cache = newCache;
+	SaveCache();
+}
+
+
+//
+// Called from the thread pool. Works out what the file is & queues it up for
+// the model.
+//
+void FileThread::ScanFile(QFileInfo fileInfo)
+{
+	if (abort)
+		return;
+
+	FileListData data;
+	FileCacheEntry entry;
+
+	if (!HandleFile(fileInfo, data, entry))
+		return;
+
+	QMutexLocker locker(&batchMutex);
+	newCache.insert(fileInfo.filePath(), entry);
+
+	if (data.dbIndex != 0xFFFFFFFE)
+		batch.push_back(data);
 }
 
 
 //
-// This handles file identification and ZIP extraction.
+// Send the files found so far off to the model in one go, instead of one
+// signal per file.
 //
-void FileThread::HandleFile(QFileInfo fileInfo)
+void FileThread::FlushBatch(void)
+{
+	QVector<FileListData> files;
+
+	batchMutex.lock();
+
+	if (batch.size() >= FILE_BATCH_SIZE || pool.activeThreadCount() == 0)
+		files.swap(batch);
+
+	batchMutex.unlock();
+
+	if (!files.isEmpty())
+		emit FoundFiles(files);
+}
+
+
+//
+// This handles file identification and ZIP extraction. Returns false if the
+// file couldn't be read at all; files that were read but should not be shown
+// come back with a dbIndex of $FFFFFFFE, so they still get cached.
+//
+bool FileThread::HandleFile(QFileInfo fileInfo, FileListData & data, FileCacheEntry & entry)
 {
-	// Really, need to come up with some kind of cacheing scheme here, so we
-	// don't fish through these files every time we run VJ :-P
-#warning "!!! Need to come up with some kind of cacheing scheme here !!!"
 	bool haveZIPFile = (fileInfo.suffix().compare("zip", Qt::CaseInsensitive) == 0 ? true : false);
 	uint32_t fileSize = 0;
 	uint8_t * buffer = NULL;
 
-	if (haveZIPFile)
+	entry.size = fileInfo.size();
+	entry.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+	// The cache is only written by run() after the pool is done, so it's safe
+	// to read it from here without locking.
+	QHash<QString, FileCacheEntry>::const_iterator cached = cache.constFind(fileInfo.filePath());
+
+	if ((cached != cache.constEnd()) && (cached->size == entry.size)
+		&& (cached->modified == entry.modified))
 	{
-		// ZIP files are special: They contain more than just the software
-		// now... ;-)
-		// So now we fish around inside them to pull out the stuff we want.
-		// Probably also need more stringent error checking as well... :-O
-		fileSize = GetFileFromZIP(fileInfo.filePath().toUtf8(), FT_SOFTWARE, buffer);
-
-		if (fileSize == 0)
-			return;
+		entry = *cached;
+		fileSize = entry.romSize;
 	}
 	else
 	{
-		QFile file(fileInfo.filePath());
+		if (haveZIPFile)
+		{
+			// ZIP files are special: They contain more than just the software
+			// now... ;-)
+			// So now we fish around inside them to pull out the stuff we want.
+			// Probably also need more stringent error checking as well... :-O
+			fileSize = GetFileFromZIP(fileInfo.filePath().toUtf8(), FT_SOFTWARE, buffer);
+
+			if (fileSize == 0)
+				return false;
+		}
+		else
+		{
+			QFile file(fileInfo.filePath());
 
-		if (!file.open(QIODevice::ReadOnly))
-			return;
+			if (!file.open(QIODevice::ReadOnly))
+				return false;
 
-		fileSize = fileInfo.size();
+			fileSize = fileInfo.size();
 
-		if (fileSize == 0)
-			return;
+			if (fileSize == 0)
+				return false;
 
-		buffer = new uint8_t[fileSize];
-		file.read((char *)buffer, fileSize);
-		file.close();
-	}
+			buffer = new uint8_t[fileSize];
+			file.read((char *)buffer, fileSize);
+			file.close();
+		}
 
-	// Try to divine the file type by size & header
-	int fileType = ParseFileType(buffer, fileSize);
+		// Try to divine the file type by size & header
+		entry.romSize = fileSize;
+		entry.fileType = ParseFileType(buffer, fileSize);
 
-	// Check for Alpine ROM w/Universal Header
-	bool foundUniversalHeader = HasUniversalHeader(buffer, fileSize);
-	uint32_t crc;
+		// Check for Alpine ROM w/Universal Header
+		entry.hasUniversalHeader = HasUniversalHeader(buffer, fileSize);
 
 //printf("FileThread: About to calc checksum on file with size %u... (buffer=%08X)\n", size, buffer);
-	if (foundUniversalHeader)
-		crc = crc32_calcCheckSum(buffer + 8192, fileSize - 8192);
-	else
-		crc = crc32_calcCheckSum(buffer, fileSize);
+		if (entry.hasUniversalHeader)
+			entry.crc = crc32_calcCheckSum(buffer + 8192, fileSize - 8192);
+		else
+			entry.crc = crc32_calcCheckSum(buffer, fileSize);
+
+		delete[] buffer;
+		buffer = NULL;
+		// We'll find out below if there's one in there...
+		entry.hasLabel = haveZIPFile;
+	}
 
-	uint32_t index = FindCRCIndexInFileList(crc);
-	delete[] buffer;
+	uint32_t index = FindCRCIndexInFileList(entry.crc);
+	data.dbIndex = 0xFFFFFFFE;
 
 	// Here we filter out files that are *not* in the DB and of unknown type,
 	// and BIOS files. If desired, this can be overriden with a config option.
-	if ((index == 0xFFFFFFFF) && (fileType == JST_NONE))
+	if ((index == 0xFFFFFFFF) && (entry.fileType == JST_NONE))
 	{
 		// If we allow unknown software, we pass the (-1) index on, otherwise...
 		if (!allowUnknownSoftware)
-			return;								// CRC wasn't found, so bail...
+			return true;						// CRC wasn't found, so bail...
 	}
-	else if ((index != 0xFFFFFFFF) && romList[index].flags & FF_BIOS)
-		return;
-
-//Here's a little problem. When we create the image here and pass it off to
-//FilePicker, we can clobber this image before we have a chance to copy it out
-//in the FilePicker function because we can be back here before FilePicker can
-//respond. So now we create the image on the heap, problem solved. :-)
-	QImage * img = NULL;
+	else if ((index != 0xFFFFFFFF) && FileDBFlags(index) & FF_BIOS)
+		return true;
 
 	// See if we can fish out a label. :-)
-	if (haveZIPFile)
+	if (entry.hasLabel)
 	{
 		uint32_t size = GetFileFromZIP(fileInfo.filePath().toUtf8(), FT_LABEL, buffer);
 //printf("FT: Label size = %u bytes.\n", size);
@@ -169,35 +282,90 @@ void FileThread::HandleFile(QFileInfo fileInfo)
 		if (size > 0)
 		{
 			QImage label;
-			bool successful = label.loadFromData(buffer, size);
-			img = new QImage;
-			*img = label.scaled(365, 168, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-//printf("FT: Label %s: %ux%u.\n", (successful ? "succeeded" : "did not succeed"), img->width(), img->height());
+			label.loadFromData(buffer, size);
+			data.label = label.scaled(365, 168, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 			delete[] buffer;
 		}
-//printf("FileThread: Attempted to load image. Size: %u x %u...\n", img.width(), img.height());
+		else
+			entry.hasLabel = false;
 	}
 
-//	emit FoundAFile2(index, fileInfo.canonicalFilePath(), img, fileSize);
-	emit FoundAFile3(index, fileInfo.canonicalFilePath(), img, fileSize, foundUniversalHeader, fileType, crc);
+	data.dbIndex = index;
+	data.fileSize = fileSize;
+	data.filename = fileInfo.canonicalFilePath();
+	data.hasUniversalHeader = entry.hasUniversalHeader;
+	data.fileType = entry.fileType;
+	data.crc = entry.crc;
+
+	return true;
 }
 
 
 //
-// Find a CRC in the ROM list (simple brute force algorithm).
-// If it's there, return the index, otherwise return $FFFFFFFF
+// Find a CRC in the ROM list. If it's there, return the index, otherwise
+// return $FFFFFFFF
 //
 uint32_t FileThread::FindCRCIndexInFileList(uint32_t crc)
 {
-	// Instead of a simple brute-force search, we should probably do a binary
-	// partition search instead, since the CRCs are sorted numerically.
-#warning "!!! Should do binary partition search here !!!"
-	for(int i=0; romList[i].crc32!=0xFFFFFFFF; i++)
+	return FileDBFindCRC(crc);
+}
+
+
+//
+// Read in the file cache from the last run (if any)
+//
+void FileThread::LoadCache(void)
+{
+	QFile file(cacheFilename);
+
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	QDataStream in(&file);
+	quint32 magic, version, count;
+	in >> magic >> version >> count;
+
+	// If it's not ours, or it's from a different version, just toss it
+	if ((magic != 0x564A4643) || (version != FILE_CACHE_VERSION))
+		return;
+
+	for(quint32 i=0; i<count && in.status()==QDataStream::Ok; i++)
+	{
+		QString path;
+		FileCacheEntry entry;
+		quint32 romSize, crc, fileType;
+		in >> path >> entry.size >> entry.modified >> romSize >> crc >> fileType
+			>> entry.hasUniversalHeader >> entry.hasLabel;
+		entry.romSize = romSize;
+		entry.crc = crc;
+		entry.fileType = fileType;
+
+		if (in.status() == QDataStream::Ok)
+			cache.insert(path, entry);
+	}
+}
+
+
+//
+// Write the file cache out so we don't have to do this all over again
+//
+void FileThread::SaveCache(void)
+{
+	QDir().mkpath(QFileInfo(cacheFilename).absolutePath());
+	QSaveFile file(cacheFilename);
+
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+
+	QDataStream out(&file);
+	out << (quint32)0x564A4643 << (quint32)FILE_CACHE_VERSION << (quint32)cache.size();
+
+	for(QHash<QString, FileCacheEntry>::const_iterator i=cache.constBegin(); i!=cache.constEnd(); i++)
 	{
-		if (romList[i].crc32 == crc)
-			return i;
+		out << i.key() << i->size << i->modified << (quint32)i->romSize << (quint32)i->crc
+			<< (quint32)i->fileType << i->hasUniversalHeader << i->hasLabel;
 	}
 
-	return 0xFFFFFFFF;
+	file.commit();
 }
 
@@ -8,6 +8,19 @@
 #include <QtCore>
 #include <QImage>
 #include <stdint.h>
+#include "filelistmodel.h"
+
+// What we remember about a file between runs, so we don't have to hash it again
+struct FileCacheEntry
+{
+	qint64 size;
+	qint64 modified;
+	uint32_t romSize;
+	uint32_t crc;
+	uint32_t fileType;
+	bool hasUniversalHeader;
+	bool hasLabel;
+};
 
 class FileThread: public QThread
 {
@@ -17,22 +30,35 @@ class FileThread: public QThread
 		FileThread(QObject * parent = 0);
 		~FileThread();
 		void Go(bool allowUnknown = false);
+		void ScanFile(QFileInfo);
 
 	signals:
 		void FoundAFile(unsigned long index);
 		void FoundAFile2(unsigned long index, QString filename, QImage * label, unsigned long);
 		void FoundAFile3(unsigned long index, QString filename, QImage * label, unsigned long, bool, unsigned long, unsigned long);
+		void FoundFiles(QVector<FileListData> files);
 
 	protected:
 		void run(void);
-		void HandleFile(QFileInfo);
+		bool HandleFile(QFileInfo, FileListData &, FileCacheEntry &);
 		uint32_t FindCRCIndexInFileList(uint32_t);
+		void FlushBatch(void);
+		void LoadCache(void);
+		void SaveCache(void);
 
 	private:
 		QMutex mutex;
 		QWaitCondition condition;
 		bool abort;
 		bool allowUnknownSoftware;
+
+		QThreadPool pool;
+		QMutex batchMutex;
+		QVector<FileListData> batch;
+		QHash<QString, FileCacheEntry> cache;
+		QHash<QString, FileCacheEntry> newCache;
+		QString cacheFilename;
+		bool cacheLoaded;
 };
 
 #endif	// __FILETHREAD_H__
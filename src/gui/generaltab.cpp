@@ -60,6 +60,8 @@ GeneralTab::GeneralTab(QWidget * parent/*= 0*/): QWidget(parent)
 //	useHostAudio       = new QCheckBox(tr("Enable audio playback (requires DSP)"));
 	useUnknownSoftware = new QCheckBox(tr("Show all files in file chooser"));
 	useFastBlitter     = new QCheckBox(tr("Use fast blitter"));
+	useAudioSync       = new QCheckBox(tr("Sync emulation to audio (low latency)"));
+	useIdleSkip        = new QCheckBox(tr("Skip idle loops (faster)"));
 
 	layout4->addWidget(useBIOS);
 	layout4->addWidget(useGPU);
@@ -68,6 +70,8 @@ GeneralTab::GeneralTab(QWidget * parent/*= 0*/): QWidget(parent)
 //	layout4->addWidget(useHostAudio);
 	layout4->addWidget(useUnknownSoftware);
 	layout4->addWidget(useFastBlitter);
+	layout4->addWidget(useAudioSync);
+	layout4->addWidget(useIdleSkip);
 
 	setLayout(layout4);
 }
@@ -24,6 +24,8 @@ class GeneralTab: public QWidget
 		QCheckBox * useFullScreen;
 		QCheckBox * useUnknownSoftware;
 		QCheckBox * useFastBlitter;
+		QCheckBox * useAudioSync;
+		QCheckBox * useIdleSkip;
 };
 
 #endif	// __GENERALTAB_H__
@@ -102,7 +102,7 @@ The foreground of the item (the circle representing a pixel) must be rendered us
 		nameToDraw = "\"" + filename.mid(lastSlashPos + 1) + "\"";
 	}
 	else
-		nameToDraw = romList[i].name;
+		nameToDraw = FileDBName(i);
 
 	if (label.isNull())
 	{
@@ -55,11 +55,15 @@
 #include "debug/opbrowser.h"
 #include "debug/riscdasmbrowser.h"
 
+#include "capture.h"
 #include "dac.h"
+#include "dsp.h"
 #include "eeprom.h"
+#include "event.h"
 #include "jaguar.h"
 #include "log.h"
 #include "file.h"
+#include "filedb.h"
 #include "jagbios.h"
 #include "jagbios2.h"
 #include "jagcdbios.h"
@@ -72,6 +76,11 @@
 // Apparently on win32, usleep() is not pulled in by the usual suspects.
 #include <unistd.h>
 //#endif
+#include <math.h>
+
+// Most we'll speed up or slow down the frame rate to keep in step with the
+// audio (0.5%, which nobody will hear or see)
+#define MAX_RATE_ADJUST		0.005
 
 // The way BSNES controls things is by setting a timer with a zero
 // timeout, sleeping if not emulating anything. Seems there has to be a
@@ -87,13 +96,17 @@
 
 MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	showUntunedTankCircuit(true), cartridgeLoaded(false), CDActive(false),
-	pauseForFileSelector(false), loadAndGo(autoRun), scannedSoftwareFolder(false), plzDontKillMyComputer(false)
+	pauseForFileSelector(false), loadAndGo(autoRun), scannedSoftwareFolder(false), plzDontKillMyComputer(false),
+	nextFrameTime(0), emulatedTime(0), averageLead(0), lastPresentTime(0), fastForward(false)
 {
 	debugbar = NULL;
 
 	for(int i=0; i<8; i++)
 		keyHeld[i] = false;
 
+	// Gamepads get looked at again whenever the joypads are read
+	JoystickSetHostPoll(HandleGamepads);
+
 	// FPS management
 	for(int i=0; i<RING_BUFFER_SIZE; i++)
 		ringBuffer[i] = 0;
@@ -226,6 +239,28 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	frameAdvanceAct->setDisabled(true);
 	connect(frameAdvanceAct, SIGNAL(triggered()), this, SLOT(FrameAdvance()));
 
+	fastForwardAct = new QAction(tr("Fast F&orward"), this);
+	fastForwardAct->setStatusTip(tr("Run the emulation as fast as it will go"));
+	fastForwardAct->setShortcut(QKeySequence(tr("F6")));
+	fastForwardAct->setShortcutContext(Qt::ApplicationShortcut);
+	fastForwardAct->setCheckable(true);
+	connect(fastForwardAct, SIGNAL(triggered()), this, SLOT(ToggleFastForward()));
+
+	recordAct = new QAction(tr("&Record Audio/Video..."), this);
+	recordAct->setStatusTip(tr("Record what the Jaguar is doing to disk"));
+	recordAct->setCheckable(true);
+	connect(recordAct, SIGNAL(triggered()), this, SLOT(ToggleRecording()));
+
+	movieRecordAct = new QAction(tr("Record &Input Movie..."), this);
+	movieRecordAct->setStatusTip(tr("Reset the Jaguar & record what the joypads do from then on"));
+	movieRecordAct->setCheckable(true);
+	connect(movieRecordAct, SIGNAL(triggered()), this, SLOT(ToggleMovieRecording()));
+
+	moviePlayAct = new QAction(tr("&Play Input Movie..."), this);
+	moviePlayAct->setStatusTip(tr("Reset the Jaguar & play back a recorded input movie"));
+	moviePlayAct->setCheckable(true);
+	connect(moviePlayAct, SIGNAL(triggered()), this, SLOT(ToggleMoviePlayback()));
+
 	fullScreenAct = new QAction(QIcon(":/res/fullscreen.png"), tr("F&ull Screen"), this);
 	fullScreenAct->setShortcut(QKeySequence(tr("F9")));
 	fullScreenAct->setShortcutContext(Qt::ApplicationShortcut);
@@ -268,6 +303,10 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	fileMenu->addAction(powerAct);
 	fileMenu->addAction(pauseAct);
 //	fileMenu->addAction(frameAdvanceAct);
+	fileMenu->addAction(fastForwardAct);
+	fileMenu->addAction(recordAct);
+	fileMenu->addAction(movieRecordAct);
+	fileMenu->addAction(moviePlayAct);
 	fileMenu->addAction(filePickAct);
 	fileMenu->addAction(useCDAct);
 	fileMenu->addAction(configAct);
@@ -322,6 +361,7 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 	addAction(pauseAct);
 	addAction(filePickAct);
 	addAction(frameAdvanceAct);
+	addAction(fastForwardAct);
 
 	//	Create status bar
 	indicator = new QLabel(tr("DSP: <b>ON</>"));
@@ -363,7 +403,9 @@ MainWin::MainWin(bool autoRun): running(true), powerButtonOn(false),
 
 	// Set up timer based loop for animation...
 	timer = new QTimer(this);
+	timer->setTimerType(Qt::PreciseTimer);
 	connect(timer, SIGNAL(timeout()), this, SLOT(Timer()));
+	pacingClock.start();
 
 	// This isn't very accurate for NTSC: This is early by 40 msec per frame.
 	// This is because it's discarding the 0.6666... on the end of the fraction.
@@ -436,6 +478,7 @@ void MainWin::SyncUI(void)
 //	running = powerAct->isChecked();
 	ntscAct->setChecked(vjs.hardwareTypeNTSC);
 	palAct->setChecked(!vjs.hardwareTypeNTSC);
+	recordAct->setChecked(CaptureIsRunning());
 	powerAct->setIcon(vjs.hardwareTypeNTSC ? powerRed : powerGreen);
 
 	fullScreenAct->setChecked(vjs.fullscreen);
@@ -446,7 +489,23 @@ void MainWin::SyncUI(void)
 	UpdateIndicator();
 
 	// Reset the timer to be what was set in the command line (if any):
-	timer->start(vjs.hardwareTypeNTSC ? 16 : 20);
+	SetTimerInterval();
+}
+
+
+//
+// Normally the timer ticks once per frame. In audio sync mode it ticks every
+// millisecond and FrameIsDue() decides when to run the next frame; in fast
+// forward, it ticks as fast as it can.
+//
+void MainWin::SetTimerInterval(void)
+{
+	if (fastForward)
+		timer->start(0);
+	else if (vjs.audioSync)
+		timer->start(1);
+	else
+		timer->start(vjs.hardwareTypeNTSC ? 16 : 20);
 }
 
 
@@ -588,16 +647,18 @@ void MainWin::HandleKeys(QKeyEvent * e, bool state)
 	for(int i=BUTTON_FIRST; i<=BUTTON_LAST; i++)
 	{
 		if (e->key() == (int)vjs.p1KeyBindings[i])
-			joypad0Buttons[i] = (state ? 0x01 : 0x00);
+			JoystickHostSetButton(0, i, state);
 
 		if (e->key() == (int)vjs.p2KeyBindings[i])
-			joypad1Buttons[i] = (state ? 0x01 : 0x00);
+			JoystickHostSetButton(1, i, state);
 	}
 }
 
 
 //
 // N.B.: The profile system AutoConnect functionality sets the gamepad IDs here.
+//       This is also called from inside the emulation, whenever the Jaguar
+//       reads the joypads (see joystick.cpp).
 //
 void MainWin::HandleGamepads(void)
 {
@@ -606,10 +667,10 @@ void MainWin::HandleGamepads(void)
 	for(int i=BUTTON_FIRST; i<=BUTTON_LAST; i++)
 	{
 		if (vjs.p1KeyBindings[i] & (JOY_BUTTON | JOY_HAT | JOY_AXIS))
-			joypad0Buttons[i] = (Gamepad::GetState(gamepadIDSlot1, vjs.p1KeyBindings[i]) ? 0x01 : 0x00);
+			JoystickHostSetButton(0, i, Gamepad::GetState(gamepadIDSlot1, vjs.p1KeyBindings[i]));
 
 		if (vjs.p2KeyBindings[i] & (JOY_BUTTON | JOY_HAT | JOY_AXIS))
-			joypad1Buttons[i] = (Gamepad::GetState(gamepadIDSlot2, vjs.p2KeyBindings[i]) ? 0x01 : 0x00);
+			JoystickHostSetButton(1, i, Gamepad::GetState(gamepadIDSlot2, vjs.p2KeyBindings[i]));
 	}
 }
 
@@ -642,12 +703,14 @@ void MainWin::Configure(void)
 	QString absBefore = vjs.absROMPath;
 //	bool audioBefore = vjs.audioEnabled;
 	bool audioBefore = vjs.DSPEnabled;
+	bool syncBefore = vjs.audioSync;
 	dlg.UpdateVJSettings();
 	QString after = vjs.ROMPath;
 	QString alpineAfter = vjs.alpineROMPath;
 	QString absAfter = vjs.absROMPath;
 //	bool audioAfter = vjs.audioEnabled;
 	bool audioAfter = vjs.DSPEnabled;
+	bool syncAfter = vjs.audioSync;
 
 	bool allowOld = allowUnknownSoftware;
 	//ick.
@@ -687,14 +750,19 @@ void MainWin::Configure(void)
 	}
 
 	// If the "Enable DSP" checkbox changed, then we have to re-init the DAC,
-	// since it's running in the host audio IRQ...
-	if (audioBefore != audioAfter)
+	// since it's running in the host audio IRQ... Same goes for audio sync,
+	// since that changes the size of the host's audio buffer.
+	if ((audioBefore != audioAfter) || (syncBefore != syncAfter))
 	{
 		DACDone();
 		DACInit();
 		UpdateIndicator();
+		SetTimerInterval();
 	}
 
+	// The GPU & DSP look at this as they go, the 68K has to be told
+	m68k_set_idle_skip(vjs.idleSkip);
+
 	// Just in case we crash before a clean exit...
 	WriteSettings();
 }
@@ -718,6 +786,9 @@ static uint32_t ntscTickCount;
 	if (!running)
 		return;
 
+	if (!FrameIsDue())
+		return;
+
 	if (showUntunedTankCircuit)
 	{
 		// Some machines can't handle this, so we give them the option to disable it. :-)
@@ -739,7 +810,7 @@ static uint32_t ntscTickCount;
 	{
 		// Otherwise, run the Jaguar simulation
 		HandleGamepads();
-		JaguarExecuteNew();
+		JaguarExecuteRunAhead(vjs.runAhead);
 		videoWidget->HandleMouseHiding();
 
 static uint32_t refresh = 0;
@@ -758,12 +829,20 @@ static uint32_t refresh = 0;
 		}
 	}
 
-	videoWidget->updateGL();
+	uint64_t now = pacingClock.nsecsElapsed() / 1000;
+
+	// When fast forwarding, there's no point in drawing more frames than the
+	// host can show
+	if (!fastForward || ((now - lastPresentTime) >= 16667))
+	{
+		videoWidget->updateGL();
+		lastPresentTime = now;
+	}
 
 	// FPS handling
-	// Approach: We use a ring buffer to store times (in ms) over a given
+	// Approach: We use a ring buffer to store times (in usec) over a given
 	// amount of frames, then sum them to figure out the FPS.
-	uint32_t timestamp = SDL_GetTicks();
+	uint32_t timestamp = (uint32_t)now;
 	// This assumes the ring buffer size is a power of 2
 //	ringBufferPointer = (ringBufferPointer + 1) & (RING_BUFFER_SIZE - 1);
 	// Doing it this way is better. Ring buffer size can be arbitrary then.
@@ -779,16 +858,109 @@ static uint32_t refresh = 0;
 		elapsedTime = 1;
 
 	// This is in frames per 10 seconds, so we can have 1 decimal
-	uint32_t framesPerSecond = (uint32_t)(((float)RING_BUFFER_SIZE / (float)elapsedTime) * 10000.0);
+	uint32_t framesPerSecond = (uint32_t)(((float)RING_BUFFER_SIZE / (float)elapsedTime) * 10000000.0);
 	uint32_t fpsIntegerPart = framesPerSecond / 10;
 	uint32_t fpsDecimalPart = framesPerSecond % 10;
+	QString status = QString("%1.%2 FPS").arg(fpsIntegerPart).arg(fpsDecimalPart);
+
+	if (fastForward)
+	{
+		// Run the DSP as fast as everything else, so they stay in step
+		double speed = (double)framesPerSecond / (vjs.hardwareTypeNTSC ? 599.4 : 500.0);
+		DACSetSpeed(speed < 1.0 ? 1.0 : (speed > 8.0 ? 8.0 : speed));
+		status += tr(" (fast forward)");
+	}
+	else if (vjs.audioSync)
+	{
+		// Frame time jitter is the standard deviation of the frame times
+		double mean = (double)elapsedTime / RING_BUFFER_SIZE, variance = 0;
+
+		for(uint32_t i=0; i<RING_BUFFER_SIZE; i++)
+			variance += (ringBuffer[i] - mean) * (ringBuffer[i] - mean);
+
+		double jitter = sqrt(variance / RING_BUFFER_SIZE) / 1000.0;
+		double latency = (averageLead + DACGetBufferLatency()) / 1000.0;
+		status += QString(tr(" - Audio latency: %1 ms, jitter: %2 ms, underruns: %3"))
+			.arg(latency, 0, 'f', 1).arg(jitter, 0, 'f', 2).arg(DACGetUnderruns());
+	}
+
+	if (vjs.runAhead)
+	{
+		JaguarRunAheadStats stats;
+		JaguarGetRunAheadStats(stats);
+		status += QString(tr(" - Run-ahead: %1 frames, %2 ms"))
+			.arg(vjs.runAhead).arg(stats.lastUsec / 1000.0, 0, 'f', 1);
+	}
+
 	// If this is updated too frequently to be useful, we can throttle it down
 	// so that it only updates every 10th frame or so
-	statusBar()->showMessage(QString("%1.%2 FPS").arg(fpsIntegerPart).arg(fpsDecimalPart));
+	statusBar()->showMessage(status);
 	oldTimestamp = timestamp;
 }
 
 
+//
+// In audio sync mode, this decides when the next frame should go. Frames are
+// spaced out at the Jaguar's frame rate, but nudged a little (no more than
+// MAX_RATE_ADJUST) to keep the emulation the right distance ahead of the
+// audio thread. Nudging instead of jumping means the audio doesn't underrun
+// and the video doesn't stutter.
+//
+bool MainWin::FrameIsDue(void)
+{
+	if (fastForward || !vjs.audioSync)
+		return true;
+
+	double now = (double)(pacingClock.nsecsElapsed() / 1000);
+
+	if (now < nextFrameTime)
+		return false;
+
+	// Half lines are half of a scanline, and there are 525 (or 625) of those
+	// in one field
+	double framePeriod = (vjs.hardwareTypeNTSC ? 525.0 * HORIZ_PERIOD_IN_USEC_NTSC
+		: 625.0 * HORIZ_PERIOD_IN_USEC_PAL) / 2.0;
+	double adjust = 1.0;
+
+	if (DACIsActive())
+	{
+		double audioTime = (double)DACGetAudioTime();
+		double target = ((double)vjs.audioLatency * 1000.0) - DACGetBufferLatency();
+
+		if (target < 0)
+			target = 0;
+
+		// If we're way off (just started, back from the file picker, etc.),
+		// just start over from where the audio is
+		if (fabs((emulatedTime - audioTime) - target) > 100000.0)
+			emulatedTime = audioTime + target, averageLead = target;
+
+		// The lead bounces around by up to a frame or an audio buffer each
+		// time, so we steer by the average
+		averageLead = (averageLead * 0.95) + ((emulatedTime - audioTime) * 0.05);
+		double error = (averageLead - target) / framePeriod;
+
+		if (error > 1.0)
+			error = 1.0;
+		else if (error < -1.0)
+			error = -1.0;
+
+		// Too far ahead of the audio means longer frames, and vice versa
+		adjust = 1.0 + (error * MAX_RATE_ADJUST);
+	}
+
+	emulatedTime += framePeriod;
+	nextFrameTime += framePeriod * adjust;
+
+	// If we fell way behind (window being dragged around, etc.), don't try to
+	// make it all up at once
+	if ((now - nextFrameTime) > (framePeriod * 4.0))
+		nextFrameTime = now;
+
+	return true;
+}
+
+
 void MainWin::TogglePowerState(void)
 {
 	powerButtonOn = !powerButtonOn;
@@ -910,8 +1082,8 @@ void MainWin::SetZoom300(void)
 void MainWin::SetNTSC(void)
 {
 	powerAct->setIcon(powerRed);
-	timer->setInterval(16);
 	vjs.hardwareTypeNTSC = true;
+	SetTimerInterval();
 	ResizeMainWindow();
 	WriteSettings();
 }
@@ -920,8 +1092,8 @@ void MainWin::SetNTSC(void)
 void MainWin::SetPAL(void)
 {
 	powerAct->setIcon(powerGreen);
-	timer->setInterval(20);
 	vjs.hardwareTypeNTSC = false;
+	SetTimerInterval();
 	ResizeMainWindow();
 	WriteSettings();
 }
@@ -1032,6 +1204,103 @@ void MainWin::ToggleCDUsage(void)
 }
 
 
+void MainWin::ToggleFastForward(void)
+{
+	fastForward = fastForwardAct->isChecked();
+
+	if (!fastForward)
+	{
+		DACSetSpeed(1.0);
+		nextFrameTime = (double)(pacingClock.nsecsElapsed() / 1000);
+	}
+
+	SetTimerInterval();
+}
+
+
+void MainWin::ToggleRecording(void)
+{
+	if (!recordAct->isChecked())
+	{
+		CaptureStop();
+		CaptureStats stats;
+		CaptureGetStats(stats);
+		statusBar()->showMessage(QString(tr("Recording stopped (%1 frames, %2 dropped)"))
+			.arg(stats.frames).arg(stats.droppedFrames));
+		return;
+	}
+
+	QString filename = QFileDialog::getSaveFileName(this, tr("Record Audio/Video"),
+		QString(), tr("YUV4MPEG2 + WAV (*.y4m);;Compressed capture (*.vjc)"));
+
+	if (filename.isEmpty() || !CaptureStart(filename.toUtf8().data()))
+		recordAct->setChecked(false);
+}
+
+
+//
+// Movies are only any use if they start from the same place they're played
+// back from, so both of these reset the Jaguar first.
+//
+void MainWin::ToggleMovieRecording(void)
+{
+	moviePlayAct->setChecked(false);
+
+	if (!movieRecordAct->isChecked())
+	{
+		JoystickMovieStop();
+		statusBar()->showMessage(tr("Input movie stopped"));
+		return;
+	}
+
+	QString filename = QFileDialog::getSaveFileName(this, tr("Record Input Movie"),
+		QString(), tr("Input movie (*.vjm)"));
+
+	if (filename.isEmpty() || !powerButtonOn)
+	{
+		movieRecordAct->setChecked(false);
+		return;
+	}
+
+	JaguarReset();
+
+	if (!JoystickMovieRecord(filename.toUtf8().data()))
+		movieRecordAct->setChecked(false);
+}
+
+
+void MainWin::ToggleMoviePlayback(void)
+{
+	movieRecordAct->setChecked(false);
+
+	if (!moviePlayAct->isChecked())
+	{
+		JoystickMovieStop();
+		statusBar()->showMessage(tr("Input movie stopped"));
+		return;
+	}
+
+	QString filename = QFileDialog::getOpenFileName(this, tr("Play Input Movie"),
+		QString(), tr("Input movie (*.vjm)"));
+	JoystickMovieInfo info;
+
+	if (filename.isEmpty() || !powerButtonOn
+		|| !JoystickMovieReadInfo(filename.toUtf8().data(), info))
+	{
+		moviePlayAct->setChecked(false);
+		return;
+	}
+
+	if (info.romCRC != jaguarMainROMCRC32)
+		statusBar()->showMessage(tr("Input movie was recorded with different software!"));
+
+	JaguarReset();
+
+	if (!JoystickMoviePlay(filename.toUtf8().data()))
+		moviePlayAct->setChecked(false);
+}
+
+
 void MainWin::FrameAdvance(void)
 {
 //printf("Frame Advance...\n");
@@ -1181,7 +1450,7 @@ void MainWin::ReadSettings(void)
 	vjs.GPUEnabled       = settings.value("GPUEnabled", true).toBool();
 	vjs.DSPEnabled       = settings.value("DSPEnabled", true).toBool();
 	vjs.audioEnabled     = settings.value("audioEnabled", true).toBool();
-	vjs.usePipelinedDSP  = settings.value("usePipelinedDSP", false).toBool();
+	vjs.dspEngine        = settings.value("dspEngine", DSP_ENGINE_INTERPRETER).toUInt();
 	vjs.fullscreen       = settings.value("fullscreen", false).toBool();
 	vjs.useOpenGL        = settings.value("useOpenGL", true).toBool();
 	vjs.glFilter         = settings.value("glFilterType", 1).toInt();
@@ -1189,17 +1458,36 @@ void MainWin::ReadSettings(void)
 	vjs.allowWritesToROM = settings.value("writeROM", false).toBool();
 	vjs.biosType         = settings.value("biosType", BT_M_SERIES).toInt();
 	vjs.useFastBlitter   = settings.value("useFastBlitter", false).toBool();
+	vjs.audioSync        = settings.value("audioSync", false).toBool();
+	vjs.audioLatency     = settings.value("audioLatency", 12).toInt();
+	vjs.idleSkip         = settings.value("idleSkip", true).toBool();
+	vjs.parallelGPU      = settings.value("parallelGPU", false).toBool();
+	vjs.runAhead         = settings.value("runAhead", 0).toInt();
 	strcpy(vjs.EEPROMPath, settings.value("EEPROMs", QStandardPaths::writableLocation(QStandardPaths::DataLocation).append("/eeproms/")).toString().toUtf8().data());
 	strcpy(vjs.ROMPath, settings.value("ROMs", QStandardPaths::writableLocation(QStandardPaths::DataLocation).append("/software/")).toString().toUtf8().data());
 	strcpy(vjs.alpineROMPath, settings.value("DefaultROM", "").toString().toUtf8().data());
 	strcpy(vjs.absROMPath, settings.value("DefaultABS", "").toString().toUtf8().data());
+	strcpy(vjs.CDImagePath, settings.value("CDImage", "").toString().toUtf8().data());
+	strcpy(vjs.bootCachePath, settings.value("bootCache", QStandardPaths::writableLocation(QStandardPaths::CacheLocation).append("/boot/")).toString().toUtf8().data());
+
+	if (vjs.bootCachePath[0])
+		QDir().mkpath(vjs.bootCachePath);
+
+	if (vjs.dspEngine > DSP_ENGINE_LOCKSTEP)
+		vjs.dspEngine = DSP_ENGINE_INTERPRETER;
+
+	// Optional external file DB; we fall back to the built-in one if it's not
+	// there (or if it doesn't know about a particular file)
+	FileDBLoad(settings.value("fileDB", QStandardPaths::writableLocation(QStandardPaths::DataLocation).append("/filedb.bin")).toString().toUtf8().data(),
+		settings.value("useBuiltInFileDB", true).toBool());
 
 WriteLog("MainWin: Paths\n");
 WriteLog("   EEPROMPath = \"%s\"\n", vjs.EEPROMPath);
 WriteLog("      ROMPath = \"%s\"\n", vjs.ROMPath);
 WriteLog("AlpineROMPath = \"%s\"\n", vjs.alpineROMPath);
 WriteLog("   absROMPath = \"%s\"\n", vjs.absROMPath);
-WriteLog("Pipelined DSP = %s\n", (vjs.usePipelinedDSP ? "ON" : "off"));
+WriteLog("bootCachePath = \"%s\"\n", vjs.bootCachePath);
+WriteLog("DSP engine = %s\n", dspEngineName[vjs.dspEngine]);
 
 #if 0
 	// Keybindings in order of U, D, L, R, C, B, A, Op, Pa, 0-9, #, *
@@ -1271,7 +1559,7 @@ void MainWin::WriteSettings(void)
 	settings.setValue("GPUEnabled", vjs.GPUEnabled);
 	settings.setValue("DSPEnabled", vjs.DSPEnabled);
 	settings.setValue("audioEnabled", vjs.audioEnabled);
-	settings.setValue("usePipelinedDSP", vjs.usePipelinedDSP);
+	settings.setValue("dspEngine", vjs.dspEngine);
 	settings.setValue("fullscreen", vjs.fullscreen);
 	settings.setValue("useOpenGL", vjs.useOpenGL);
 	settings.setValue("glFilterType", vjs.glFilter);
@@ -1279,12 +1567,19 @@ void MainWin::WriteSettings(void)
 	settings.setValue("writeROM", vjs.allowWritesToROM);
 	settings.setValue("biosType", vjs.biosType);
 	settings.setValue("useFastBlitter", vjs.useFastBlitter);
+	settings.setValue("audioSync", vjs.audioSync);
+	settings.setValue("audioLatency", vjs.audioLatency);
+	settings.setValue("idleSkip", vjs.idleSkip);
+	settings.setValue("parallelGPU", vjs.parallelGPU);
+	settings.setValue("runAhead", vjs.runAhead);
 	settings.setValue("JagBootROM", vjs.jagBootPath);
 	settings.setValue("CDBootROM", vjs.CDBootPath);
 	settings.setValue("EEPROMs", vjs.EEPROMPath);
 	settings.setValue("ROMs", vjs.ROMPath);
 	settings.setValue("DefaultROM", vjs.alpineROMPath);
 	settings.setValue("DefaultABS", vjs.absROMPath);
+	settings.setValue("CDImage", vjs.CDImagePath);
+	settings.setValue("bootCache", vjs.bootCachePath);
 
 #if 0
 	settings.setValue("p1k_up", vjs.p1KeyBindings[BUTTON_U]);
@@ -61,6 +61,10 @@ class MainWin: public QMainWindow
 		void LoadSoftware(QString);
 		void ToggleCDUsage(void);
 		void FrameAdvance(void);
+		void ToggleFastForward(void);
+		void ToggleRecording(void);
+		void ToggleMovieRecording(void);
+		void ToggleMoviePlayback(void);
 		void ToggleFullScreen(void);
 
 		void ShowMemoryBrowserWin(void);
@@ -71,9 +75,11 @@ class MainWin: public QMainWindow
 
 	private:
 		void HandleKeys(QKeyEvent *, bool);
-		void HandleGamepads(void);
+		static void HandleGamepads(void);
 		void SetFullScreen(bool state = true);
 		void ResizeMainWindow(void);
+		void SetTimerInterval(void);
+		bool FrameIsDue(void);
 		void ReadSettings(void);
 		void WriteSettings(void);
 		void WriteUISettings(void);
@@ -110,6 +116,12 @@ class MainWin: public QMainWindow
 		uint32_t ringBufferPointer;
 		uint32_t ringBuffer[RING_BUFFER_SIZE];
 	private:
+		QElapsedTimer pacingClock;
+		double nextFrameTime;
+		double emulatedTime;
+		double averageLead;
+		uint64_t lastPresentTime;
+		bool fastForward;
 		QPoint mainWinPosition;
 //		QSize mainWinSize;
 		int lastEditedProfile;
@@ -137,6 +149,10 @@ class MainWin: public QMainWindow
 		QAction * configAct;
 		QAction * useCDAct;
 		QAction * frameAdvanceAct;
+		QAction * fastForwardAct;
+		QAction * recordAct;
+		QAction * movieRecordAct;
+		QAction * moviePlayAct;
 		QAction * fullScreenAct;
 
 		QAction * memBrowseAct;
@@ -0,0 +1,829 @@
+//
+// JAGRISC.H: Jaguar RISC core
+//
+// TOM's GPU & JERRY's DSP are the same RISC processor, give or take a handful
+// of opcodes, the size of the local RAM, the number of interrupt sources & the
+// width of the MAC accumulator. The instruction set, the IRQ logic, the idle
+// loop detection & the execution loop live here, once, as a template on a
+// chip description. GPU.CPP & DSP.CPP each supply one of those (a struct with
+// the chip's state, its memory handlers & a few hooks), along with their own
+// opcodes & opcode table, and GPUExec() & DSPExec() call the result.
+//
+// A chip description C has to provide:
+//
+//   WHO, RAM_BASE, RAM_SIZE	Who's asking (for the memory handlers), & where
+//								the local RAM is
+//   IRQ_SOURCES				Number of interrupt sources (5 or 6)
+//   HAS_STOREP				Whether opcode #48 (STOREP) writes to memory
+//   MAC, IdleState			Accumulator & idle loop snapshot types
+//   Reg(), AltReg(), etc.		References to the chip's registers & flags
+//   ReadWord(), ReadLong(), WriteLong()
+//   ExternalReadByte(), etc.	Byte & word accesses outside of local RAM
+//   PendingIRQs()				Latched & enabled interrupt bits
+//   BeginExec(), PreInstruction(), PostInstruction(), Tracing()
+//   MayExecute()				Whether to go on to the next instruction (or stop
+//								short of it, leaving the rest of the cycles)
+//   SkipIdleLoop()				Whether to skip ahead once an idle loop is found
+//								(or stop there instead)
+//   Dispatch(), Cycles(), OpcodeUse(), SaveIdleState()
+//
+
+#ifndef __JAGRISC_H__
+#define __JAGRISC_H__
+
+#include <string.h>
+#include "jagdasm.h"
+#include "jaguar.h"
+#include "log.h"
+#include "machine.h"
+#include "settings.h"
+
+extern int start_logging;
+
+#define RM				C::Reg()[C::Op1()]
+#define RN				C::Reg()[C::Op2()]
+#define ALTERNATE_RM	C::AltReg()[C::Op1()]
+#define ALTERNATE_RN	C::AltReg()[C::Op2()]
+#define IMM_1			C::Op1()
+#define IMM_2			C::Op2()
+// 5-bit quick values: 0 means 32
+#define QUICK(n)		((((n) - 1) & 0x1F) + 1)
+
+#define SET_C_ADD(a,b)		(C::FlagC() = ((uint32_t)(b) > (uint32_t)(~(a))))
+#define SET_C_SUB(a,b)		(C::FlagC() = ((uint32_t)(b) > (uint32_t)(a)))
+#define SET_ZN(r)			(C::FlagResult() = (r), C::FlagsPending() = true)
+#define SET_ZNC_ADD(a,b,r)	(SET_ZN(r), SET_C_ADD(a,b))
+#define SET_ZNC_SUB(a,b,r)	(SET_ZN(r), SET_C_SUB(a,b))
+
+template <class C> struct JaguarRISC
+{
+	enum { FLAGS_IMASK = 0x0008, IDLE_LOOP_BYTES = 32 };
+
+	//
+	// Z & N are worked out lazily: most results are overwritten long before
+	// anything looks at the flags, so the ALU opcodes just note the last
+	// result, & it's turned into Z & N here when a branch condition is tested
+	// or the flags register is read. (C is still set on the spot, as that's no
+	// more work than keeping the operands around.)
+	//
+	static inline void UpdateFlags(void)
+	{
+		if (C::FlagsPending())
+		{
+			C::FlagZ() = (C::FlagResult() == 0);
+			C::FlagN() = C::FlagResult() >> 31;
+			C::FlagsPending() = false;
+		}
+	}
+
+	static inline bool BranchCondition(uint32_t condition)
+	{
+		// Condition 0 is "always", so the flags don't need to be worked out then
+		if (condition)
+			UpdateFlags();
+
+		uint32_t flags = (C::FlagN() << 2) | (C::FlagC() << 1) | C::FlagZ();
+		return C::BranchTable()[condition + ((flags & 7) << 5)];
+	}
+
+	static inline bool IsLocal(uint32_t address)
+	{
+		return (address - C::RAM_BASE) < C::RAM_SIZE;
+	}
+
+	//
+	// Interrupts: the highest numbered latched & enabled source wins
+	//
+	static void HandleIRQs(void)
+	{
+		// Bail out if we're already in an interrupt!
+		if (C::Flags() & FLAGS_IMASK)
+			return;
+
+		uint32_t bits = C::PendingIRQs();
+
+		if (!bits)
+			return;
+
+		uint32_t which = C::IRQ_SOURCES - 1;
+
+		while (!(bits & (1 << which)))
+			which--;
+
+		if (start_logging)
+			WriteLog("%s: Generating IRQ #%i\n", C::Name(), which);
+
+		// Set the interrupt flag (which forces register bank #0)
+		C::Flags() |= FLAGS_IMASK;
+		C::UpdateRegisterBanks();
+
+		// subqt  #4,r31		; pre-decrement stack pointer
+		// move   pc,r30		; address of interrupted code
+		// store  r30,(r31)		; store return address
+		// (-2 because we've executed the instruction already)
+		C::Reg()[31] -= 4;
+		C::Reg()[30] = C::PC() - 2;
+		C::WriteLong(C::Reg()[31], C::Reg()[30]);
+
+		// movei  #service_address,r30  ; pointer to ISR entry
+		// jump  (r30)					; jump to ISR
+		// nop
+		C::PC() = C::Reg()[30] = C::RAM_BASE + (which * 0x10);
+	}
+
+	//
+	// Says whether the code from <start> to <end> has any stores or branches
+	// in it (other than the one closing the loop at <end> - 2)
+	//
+	static bool LoopCanWrite(uint32_t start, uint32_t end)
+	{
+		for(uint32_t pc=start; pc<=end; pc+=2)
+		{
+			uint32_t index = C::ReadWord(pc) >> 10;
+
+			// STOREB, STOREW, STORE, STOREP, STORE (R14/R15+n) & (R14/R15+Rn)
+			if ((index >= 45 && index <= 47) || (index == 48 && C::HAS_STOREP)
+				|| index == 49 || index == 50 || index == 60 || index == 61)
+				return true;
+
+			// JUMP & JR could go anywhere...
+			if ((index == 52 || index == 53) && (pc != end - 2))
+				return true;
+
+			// MOVEI has a 32-bit immediate after it
+			if (index == 38)
+				pc += 4;
+		}
+
+		return false;
+	}
+
+	//
+	// Called when the branch at <branchPC> just took us backward (or back to
+	// itself). If the loop it closes can't write anything, and we came around
+	// to the same place with exactly the same registers as the last time, the
+	// chip is going to keep doing this until an interrupt (or something
+	// outside of it) comes along.
+	//
+	static bool IsIdleLoop(uint32_t branchPC)
+	{
+		uint32_t target = C::PC();
+
+		if ((branchPC - target) > IDLE_LOOP_BYTES)
+			return false;
+
+		if ((target != idleLoopStart) || (branchPC != idleLoopEnd))
+		{
+			idleLoopStart = target;
+			idleLoopEnd = branchPC;
+			// Delay slot included
+			idleLoopCanWrite = LoopCanWrite(target, branchPC + 2);
+			idleStateValid = false;
+		}
+
+		if (idleLoopCanWrite)
+			return false;
+
+		typename C::IdleState state;
+		UpdateFlags();
+		C::SaveIdleState(state);
+
+		bool idle = idleStateValid && (memcmp(&state, &idleState, sizeof(state)) == 0);
+		idleState = state;
+		idleStateValid = true;
+
+		return idle;
+	}
+
+	//
+	// Run for the given # of cycles (or until the chip stops). Returns what's
+	// left over, which is less than zero if the last instruction ran past the
+	// end.
+	//
+	static int32_t Exec(int32_t cycles)
+	{
+		if (!C::BeginExec(cycles))
+			return cycles;
+
+		C::InExec()++;
+
+		while (cycles > 0 && (C::Control() & 0x01))
+		{
+			if (!C::MayExecute())
+				break;
+
+			C::PreInstruction();
+
+			uint32_t pc = C::PC();
+			uint16_t opcode = C::ReadWord(pc);
+			uint32_t index = opcode >> 10;
+			C::Op1() = (opcode >> 5) & 0x1F;
+			C::Op2() = opcode & 0x1F;
+
+			if (C::Tracing())
+			{
+				static char buffer[512];
+				dasmjag(C::DASM_TYPE, buffer, pc);
+				WriteLog("%s: [%08X] %s (RM=%08X, RN=%08X) -> ", C::Name(), pc, buffer, RM, RN);
+			}
+
+			C::PC() += 2;
+			C::Dispatch(index);
+			cycles -= C::Cycles(index);
+			C::OpcodeUse(index)++;
+
+			// A JUMP/JR that went backward (or back to itself, like JR *) may
+			// have closed a spin loop; if so, there's no point in running it
+			// until the next event. (Not when we're running a delay slot,
+			// though.)
+			bool idle = vjs.idleSkip && (index == 52 || index == 53) && (C::PC() <= pc)
+				&& (C::InExec() == 1) && (cycles > 0) && IsIdleLoop(pc);
+
+			if (C::Tracing())
+				WriteLog("(RM=%08X, RN=%08X)\n", RM, RN);
+
+			C::PostInstruction();
+
+			if (idle)
+			{
+				if (!C::SkipIdleLoop())
+					break;
+
+				idleCycles += cycles;
+				cycles = 0;
+			}
+		}
+
+		C::InExec()--;
+
+		return cycles;
+	}
+
+	static uint64_t IdleCycles(void)
+	{
+		return idleCycles;
+	}
+
+	// For a chip that stopped at an idle loop instead of skipping it: the
+	// skip, after the fact
+	static void SkipIdleCycles(uint32_t cycles)
+	{
+		idleCycles += cycles;
+	}
+
+	//
+	// Everything the idle loop detector remembers, so a chip can be put back
+	// the way it was (see GPU.CPP)
+	//
+	struct IdleTracker
+	{
+		uint32_t loopStart, loopEnd;
+		bool loopCanWrite, stateValid;
+		typename C::IdleState state;
+	};
+
+	static void SaveIdleTracker(IdleTracker & t)
+	{
+		t.loopStart = idleLoopStart, t.loopEnd = idleLoopEnd;
+		t.loopCanWrite = idleLoopCanWrite, t.stateValid = idleStateValid;
+		t.state = idleState;
+	}
+
+	static void RestoreIdleTracker(const IdleTracker & t)
+	{
+		idleLoopStart = t.loopStart, idleLoopEnd = t.loopEnd;
+		idleLoopCanWrite = t.loopCanWrite, idleStateValid = t.stateValid;
+		idleState = t.state;
+	}
+
+	//
+	// Opcodes common to both chips
+	//
+
+	static void opcode_jump(void)
+	{
+		if (BranchCondition(IMM_2))
+		{
+			if (C::Tracing())
+				WriteLog("    --> JUMP: Branch taken.\n");
+
+			uint32_t delayed_pc = RM;
+			Exec(1);
+			C::PC() = delayed_pc;
+		}
+	}
+
+	static void opcode_jr(void)
+	{
+		if (BranchCondition(IMM_2))
+		{
+			if (C::Tracing())
+				WriteLog("    --> JR: Branch taken.\n");
+
+			int32_t offset = (IMM_1 & 0x10 ? 0xFFFFFFF0 | IMM_1 : IMM_1);	// Sign extend IMM_1
+			int32_t delayed_pc = C::PC() + (offset * 2);
+			Exec(1);
+			C::PC() = delayed_pc;
+		}
+	}
+
+	static void opcode_add(void)
+	{
+		uint32_t res = RN + RM;
+		SET_ZNC_ADD(RN, RM, res);
+		RN = res;
+	}
+
+	static void opcode_addc(void)
+	{
+		uint32_t res = RN + RM + C::FlagC();
+		uint32_t carry = C::FlagC();
+		SET_ZNC_ADD(RN + carry, RM, res);
+		RN = res;
+	}
+
+	static void opcode_addq(void)
+	{
+		uint32_t r1 = QUICK(IMM_1);
+		uint32_t res = RN + r1;
+		SET_ZNC_ADD(RN, r1, res);
+		RN = res;
+	}
+
+	static void opcode_addqt(void)
+	{
+		RN += QUICK(IMM_1);
+	}
+
+	static void opcode_sub(void)
+	{
+		uint32_t res = RN - RM;
+		SET_ZNC_SUB(RN, RM, res);
+		RN = res;
+	}
+
+	static void opcode_subc(void)
+	{
+		// This is how the hardware does it: RN + ~RM + ~C, with C inverted
+		uint64_t res = (uint64_t)RN + (uint64_t)(RM ^ 0xFFFFFFFF) + (C::FlagC() ^ 1);
+		C::FlagC() = ((res >> 32) & 0x01) ^ 1;
+		RN = (res & 0xFFFFFFFF);
+		SET_ZN(RN);
+	}
+
+	static void opcode_subq(void)
+	{
+		uint32_t r1 = QUICK(IMM_1);
+		uint32_t res = RN - r1;
+		SET_ZNC_SUB(RN, r1, res);
+		RN = res;
+	}
+
+	static void opcode_subqt(void)
+	{
+		RN -= QUICK(IMM_1);
+	}
+
+	static void opcode_cmp(void)
+	{
+		uint32_t res = RN - RM;
+		SET_ZNC_SUB(RN, RM, res);
+	}
+
+	static void opcode_cmpq(void)
+	{
+		uint32_t r1 = (int32_t)(IMM_1 << 27) >> 27;	// Sign extend IMM_1
+		uint32_t res = RN - r1;
+		SET_ZNC_SUB(RN, r1, res);
+	}
+
+	static void opcode_and(void)
+	{
+		RN = RN & RM;
+		SET_ZN(RN);
+	}
+
+	static void opcode_or(void)
+	{
+		RN = RN | RM;
+		SET_ZN(RN);
+	}
+
+	static void opcode_xor(void)
+	{
+		RN = RN ^ RM;
+		SET_ZN(RN);
+	}
+
+	static void opcode_not(void)
+	{
+		RN = ~RN;
+		SET_ZN(RN);
+	}
+
+	static void opcode_move_pc(void)
+	{
+		RN = C::PC() - 2;
+	}
+
+	static void opcode_nop(void)
+	{
+	}
+
+	//
+	// Loads & stores. Local RAM can only be accessed a long at a time, so
+	// byte & word accesses there go through the chip's long handlers.
+	// According to the docs, & "Do The Same", long loads are long aligned
+	// wherever they come from; stores are only aligned in local RAM. (Power
+	// Drive Rally seems to contradict the idea that only LOADs in local RAM
+	// are aligned...)
+	//
+	// Preliminary testing on real hardware seems to confirm that something
+	// strange goes on with unaligned reads in main memory. When the address is
+	// off by 1, the result is the same as the long address with the top byte
+	// replaced by something. So if the read is from $401, and $400 has 12 34
+	// 56 78, the value read will be $nn345678, where nn is a currently unknown
+	// value. Off by 2 gives $nnnn5678, & off by 3 gives $nnnnnn78. It may be
+	// that the "unknown" values come from the prefetch queue; they seem to be
+	// stable, though. Sometimes, however, the off by 2 case returns $12345678!
+	//
+
+	static void opcode_loadb(void)
+	{
+		if (IsLocal(RM))
+			RN = C::ReadLong(RM) & 0xFF;
+		else
+			RN = C::ExternalReadByte(RM);
+	}
+
+	static void opcode_loadw(void)
+	{
+		if (IsLocal(RM))
+			RN = C::ReadLong(RM & 0xFFFFFFFE) & 0xFFFF;
+		else
+			RN = C::ExternalReadWord(RM & 0xFFFFFFFE);
+	}
+
+	static void opcode_load(void)
+	{
+		RN = C::ReadLong(RM & 0xFFFFFFFC);
+	}
+
+	static void opcode_load_r14_indexed(void)
+	{
+		RN = C::ReadLong((C::Reg()[14] + (QUICK(IMM_1) << 2)) & 0xFFFFFFFC);
+	}
+
+	static void opcode_load_r15_indexed(void)
+	{
+		RN = C::ReadLong((C::Reg()[15] + (QUICK(IMM_1) << 2)) & 0xFFFFFFFC);
+	}
+
+	static void opcode_load_r14_ri(void)
+	{
+		RN = C::ReadLong((C::Reg()[14] + RM) & 0xFFFFFFFC);
+	}
+
+	static void opcode_load_r15_ri(void)
+	{
+		RN = C::ReadLong((C::Reg()[15] + RM) & 0xFFFFFFFC);
+	}
+
+	static inline void StoreLong(uint32_t address, uint32_t data)
+	{
+		if (IsLocal(address))
+			C::WriteLong(address & 0xFFFFFFFC, data);
+		else
+			C::WriteLong(address, data);
+	}
+
+	static void opcode_storeb(void)
+	{
+		if (IsLocal(RM))
+			C::WriteLong(RM, RN & 0xFF);
+		else
+			C::ExternalWriteByte(RM, RN);
+	}
+
+	static void opcode_storew(void)
+	{
+		if (IsLocal(RM))
+			C::WriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF);
+		else
+			C::ExternalWriteWord(RM, RN);
+	}
+
+	static void opcode_store(void)
+	{
+		StoreLong(RM, RN);
+	}
+
+	static void opcode_store_r14_indexed(void)
+	{
+		StoreLong(C::Reg()[14] + (QUICK(IMM_1) << 2), RN);
+	}
+
+	static void opcode_store_r15_indexed(void)
+	{
+		StoreLong(C::Reg()[15] + (QUICK(IMM_1) << 2), RN);
+	}
+
+	static void opcode_store_r14_ri(void)
+	{
+		StoreLong(C::Reg()[14] + RM, RN);
+	}
+
+	static void opcode_store_r15_ri(void)
+	{
+		StoreLong(C::Reg()[15] + RM, RN);
+	}
+
+	static void opcode_movei(void)
+	{
+		// This instruction is followed by 32-bit value in LSW / MSW format...
+		RN = (uint32_t)C::ReadWord(C::PC()) | ((uint32_t)C::ReadWord(C::PC() + 2) << 16);
+		C::PC() += 4;
+	}
+
+	static void opcode_moveta(void)
+	{
+		ALTERNATE_RN = RM;
+	}
+
+	static void opcode_movefa(void)
+	{
+		RN = ALTERNATE_RM;
+	}
+
+	static void opcode_move(void)
+	{
+		RN = RM;
+	}
+
+	static void opcode_moveq(void)
+	{
+		RN = IMM_1;
+	}
+
+	//
+	// Multiplies & the MAC unit. The accumulator is 32 bits wide on the GPU &
+	// 40 bits wide on the DSP (kept in a 64-bit MAC there).
+	//
+
+	static void opcode_mult(void)
+	{
+		RN = (uint16_t)RM * (uint16_t)RN;
+		SET_ZN(RN);
+	}
+
+	static void opcode_imult(void)
+	{
+		RN = (int16_t)RN * (int16_t)RM;
+		SET_ZN(RN);
+	}
+
+	static void opcode_imultn(void)
+	{
+		// This is OK, since this multiply won't overflow 32 bits...
+		int32_t res = (int32_t)((int16_t)RN * (int16_t)RM);
+		C::Acc() = (typename C::MAC)res;
+		SET_ZN(res);
+	}
+
+	static void opcode_imacn(void)
+	{
+		int32_t res = (int16_t)RM * (int16_t)RN;
+		C::Acc() += (typename C::MAC)res;
+	}
+
+	static void opcode_resmac(void)
+	{
+		RN = (uint32_t)C::Acc();
+	}
+
+	static void opcode_mmult(void)
+	{
+		int count = C::MatrixControl() & 0x0F;		// Matrix width
+		uint32_t addr = C::PointerToMatrix();		// In the chip's RAM
+		uint32_t step = (C::MatrixControl() & 0x10 ? 4 * count : 4);	// Column/row stepping
+		int64_t accum = 0;
+
+		for(int i=0; i<count; i++)
+		{
+			int16_t a;
+			if (i & 0x01)
+				a = (int16_t)((C::AltReg()[IMM_1 + (i >> 1)] >> 16) & 0xFFFF);
+			else
+				a = (int16_t)(C::AltReg()[IMM_1 + (i >> 1)] & 0xFFFF);
+
+			int16_t b = (int16_t)C::ReadWord(addr + 2);
+			accum += a * b;
+			addr += step;
+		}
+
+		uint32_t res = RN = (int32_t)accum;
+		// carry flag to do (out of the last add)
+		SET_ZN(res);
+	}
+
+	static void opcode_mtoi(void)
+	{
+		uint32_t _RM = RM;
+		uint32_t res = RN = (((int32_t)_RM >> 8) & 0xFF800000) | (_RM & 0x007FFFFF);
+		SET_ZN(res);
+	}
+
+	static void opcode_normi(void)
+	{
+		uint32_t _RM = RM;
+		uint32_t res = 0;
+
+		if (_RM)
+		{
+			while ((_RM & 0xFFC00000) == 0)
+			{
+				_RM <<= 1;
+				res--;
+			}
+			while ((_RM & 0xFF800000) != 0)
+			{
+				_RM >>= 1;
+				res++;
+			}
+		}
+
+		RN = res;
+		SET_ZN(res);
+	}
+
+	static void opcode_div(void)	// RN / RM
+	{
+		// Real algorithm, courtesy of SCPCD: NYAN!
+		uint32_t q = RN;
+		uint32_t r = 0;
+
+		// If 16.16 division, stuff top 16 bits of RN into remainder and put the
+		// bottom 16 of RN in top 16 of quotient
+		if (C::DivControl() & 0x01)
+			q <<= 16, r = RN >> 16;
+
+		for(int i=0; i<32; i++)
+		{
+			uint32_t sign = r & 0x80000000;
+			r = (r << 1) | ((q >> 31) & 0x01);
+			r += (sign ? RM : -RM);
+			q = (q << 1) | (((~r) >> 31) & 0x01);
+		}
+
+		RN = q;
+		C::Remain() = r;
+	}
+
+	static void opcode_abs(void)
+	{
+		C::FlagC() = RN >> 31;
+
+		// N.B.: 0x80000000 stays as it is (N = 1, Z = 0)
+		if (C::FlagC())
+			RN = -RN;
+
+		SET_ZN(RN);
+	}
+
+	static void opcode_neg(void)
+	{
+		uint32_t res = -RN;
+		SET_ZNC_SUB(0, RN, res);
+		RN = res;
+	}
+
+	//
+	// Bits, shifts & rotates
+	//
+
+	static void opcode_btst(void)
+	{
+		UpdateFlags();
+		C::FlagZ() = (~RN >> IMM_1) & 1;
+	}
+
+	static void opcode_bset(void)
+	{
+		uint32_t res = RN | (1 << IMM_1);
+		RN = res;
+		SET_ZN(res);
+	}
+
+	static void opcode_bclr(void)
+	{
+		uint32_t res = RN & ~(1 << IMM_1);
+		RN = res;
+		SET_ZN(res);
+	}
+
+	static void opcode_sh(void)
+	{
+		if (RM & 0x80000000)		// Shift left
+		{
+			C::FlagC() = RN >> 31;
+			RN = ((int32_t)RM <= -32 ? 0 : RN << -(int32_t)RM);
+		}
+		else						// Shift right
+		{
+			C::FlagC() = RN & 0x01;
+			RN = (RM >= 32 ? 0 : RN >> RM);
+		}
+
+		SET_ZN(RN);
+	}
+
+	static void opcode_shlq(void)
+	{
+		// The shift count is encoded as 32 - n
+		int32_t r1 = 32 - IMM_1;
+		uint32_t res = RN << r1;
+		SET_ZN(res); C::FlagC() = (RN >> 31) & 1;
+		RN = res;
+	}
+
+	static void opcode_shrq(void)
+	{
+		int32_t r1 = QUICK(IMM_1);
+		uint32_t res = RN >> r1;
+		SET_ZN(res); C::FlagC() = RN & 1;
+		RN = res;
+	}
+
+	static void opcode_sha(void)
+	{
+		uint32_t res;
+
+		if ((int32_t)RM < 0)
+		{
+			res = ((int32_t)RM <= -32) ? 0 : (RN << -(int32_t)RM);
+			C::FlagC() = RN >> 31;
+		}
+		else
+		{
+			res = ((int32_t)RM >= 32) ? ((int32_t)RN >> 31) : ((int32_t)RN >> (int32_t)RM);
+			C::FlagC() = RN & 0x01;
+		}
+
+		RN = res;
+		SET_ZN(res);
+	}
+
+	static void opcode_sharq(void)
+	{
+		uint32_t res = (int32_t)RN >> QUICK(IMM_1);
+		SET_ZN(res); C::FlagC() = RN & 0x01;
+		RN = res;
+	}
+
+	static void opcode_ror(void)
+	{
+		uint32_t r1 = RM & 0x1F;
+		uint32_t res = (RN >> r1) | (RN << (32 - r1));
+		SET_ZN(res); C::FlagC() = (RN >> 31) & 1;
+		RN = res;
+	}
+
+	static void opcode_rorq(void)
+	{
+		uint32_t r1 = QUICK(IMM_1);
+		uint32_t r2 = RN;
+		uint32_t res = (r2 >> r1) | (r2 << (32 - r1));
+		RN = res;
+		SET_ZN(res); C::FlagC() = (r2 >> 31) & 0x01;
+	}
+
+	// Idle loop detection: what the chip looked like the last time it came
+	// around a short backward branch
+	static MACHINE_STATE uint32_t idleLoopStart, idleLoopEnd;
+	static MACHINE_STATE bool idleLoopCanWrite;
+	static MACHINE_STATE bool idleStateValid;
+	static MACHINE_STATE typename C::IdleState idleState;
+	static MACHINE_STATE uint64_t idleCycles;
+};
+
+template <class C> MACHINE_STATE uint32_t JaguarRISC<C>::idleLoopStart = 0xFFFFFFFF;
+template <class C> MACHINE_STATE uint32_t JaguarRISC<C>::idleLoopEnd;
+template <class C> MACHINE_STATE bool JaguarRISC<C>::idleLoopCanWrite;
+template <class C> MACHINE_STATE bool JaguarRISC<C>::idleStateValid;
+template <class C> MACHINE_STATE typename C::IdleState JaguarRISC<C>::idleState;
+template <class C> MACHINE_STATE uint64_t JaguarRISC<C>::idleCycles = 0;
+
+#undef RM
+#undef RN
+#undef ALTERNATE_RM
+#undef ALTERNATE_RN
+#undef IMM_1
+#undef IMM_2
+#undef QUICK
+#undef SET_C_ADD
+#undef SET_C_SUB
+#undef SET_ZN
+#undef SET_ZNC_ADD
+#undef SET_ZNC_SUB
+
+#endif	// __JAGRISC_H__
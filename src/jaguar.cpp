@@ -20,7 +20,9 @@
 #include <SDL.h>
 #include "SDL_opengl.h"
 #include "blitter.h"
+#include "capture.h"
 #include "cdrom.h"
+#include "crc32.h"
 #include "dac.h"
 #include "dsp.h"
 #include "eeprom.h"
@@ -35,6 +37,7 @@
 #include "memtrack.h"
 #include "mmu.h"
 #include "settings.h"
+#include "state.h"
 #include "tom.h"
 
 #define CPU_DEBUG
@@ -55,6 +58,10 @@ unsigned jaguar_unknown_readword(unsigned address, uint32_t who = UNKNOWN);
 void jaguar_unknown_writebyte(unsigned address, unsigned data, uint32_t who = UNKNOWN);
 void jaguar_unknown_writeword(unsigned address, unsigned data, uint32_t who = UNKNOWN);
 void M68K_show_context(void);
+static void SyncGPU(void);
+static void BootCacheFrame(void);
+static void BootCacheLookup(void);
+static uint64_t GetMicroseconds(void);
 
 // External variables
 
@@ -64,16 +71,28 @@ extern int effect_start;
 extern int effect_start2, effect_start3, effect_start4, effect_start5, effect_start6;
 #endif
 
-// Really, need to include memory.h for this, but it might interfere with some stuff...
-extern uint8_t jagMemSpace[];
-
 // Internal variables
 
 uint32_t jaguar_active_memory_dumps = 0;
 
-uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
-bool jaguarCartInserted = false;
-bool lowerField = false;
+MACHINE_STATE uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
+MACHINE_STATE bool jaguarCartInserted = false;
+MACHINE_STATE bool lowerField = false;
+static MACHINE_STATE uint64_t systemClock = 0;		// RISC cycles to the start of this slice
+static MACHINE_STATE bool m68kInSlice = false;
+MACHINE_STATE bool jaguarRunningAhead = false;		// In a frame that'll be thrown away
+static MACHINE_STATE JaguarRunAheadStats runAheadStats;
+
+// Boot cache (see BootCacheFrame())
+enum { BOOT_CACHE_IDLE, BOOT_CACHE_PENDING, BOOT_CACHE_RUNNING };
+#define BOOT_CACHE_MAX_FRAMES	1200
+static MACHINE_STATE int bootCache = BOOT_CACHE_IDLE;
+static MACHINE_STATE char bootCacheFile[MAX_PATH + 48];
+static MACHINE_STATE char bootCacheName[MAX_PATH + 32];	// Without the EEPROM part
+static MACHINE_STATE uint32_t bootCacheEEPROMCRC;
+static MACHINE_STATE uint32_t bootCacheEEPROMActivity;
+static MACHINE_STATE uint32_t bootFrames;				// Run since the reset
+static MACHINE_STATE uint32_t bootFramesSkipped;
 
 #ifdef CPU_DEBUG_MEMORY
 uint8_t writeMemMax[0x400000], writeMemMin[0x400000];
@@ -81,25 +100,25 @@ uint8_t readMem[0x400000];
 uint32_t returnAddr[4000], raPtr = 0xFFFFFFFF;
 #endif
 
-uint32_t pcQueue[0x400];
-uint32_t a0Queue[0x400];
-uint32_t a1Queue[0x400];
-uint32_t a2Queue[0x400];
-uint32_t a3Queue[0x400];
-uint32_t a4Queue[0x400];
-uint32_t a5Queue[0x400];
-uint32_t a6Queue[0x400];
-uint32_t a7Queue[0x400];
-uint32_t d0Queue[0x400];
-uint32_t d1Queue[0x400];
-uint32_t d2Queue[0x400];
-uint32_t d3Queue[0x400];
-uint32_t d4Queue[0x400];
-uint32_t d5Queue[0x400];
-uint32_t d6Queue[0x400];
-uint32_t d7Queue[0x400];
-uint32_t srQueue[0x400];
-uint32_t pcQPtr = 0;
+MACHINE_STATE uint32_t pcQueue[0x400];
+MACHINE_STATE uint32_t a0Queue[0x400];
+MACHINE_STATE uint32_t a1Queue[0x400];
+MACHINE_STATE uint32_t a2Queue[0x400];
+MACHINE_STATE uint32_t a3Queue[0x400];
+MACHINE_STATE uint32_t a4Queue[0x400];
+MACHINE_STATE uint32_t a5Queue[0x400];
+MACHINE_STATE uint32_t a6Queue[0x400];
+MACHINE_STATE uint32_t a7Queue[0x400];
+MACHINE_STATE uint32_t d0Queue[0x400];
+MACHINE_STATE uint32_t d1Queue[0x400];
+MACHINE_STATE uint32_t d2Queue[0x400];
+MACHINE_STATE uint32_t d3Queue[0x400];
+MACHINE_STATE uint32_t d4Queue[0x400];
+MACHINE_STATE uint32_t d5Queue[0x400];
+MACHINE_STATE uint32_t d6Queue[0x400];
+MACHINE_STATE uint32_t d7Queue[0x400];
+MACHINE_STATE uint32_t srQueue[0x400];
+MACHINE_STATE uint32_t pcQPtr = 0;
 bool startM68KTracing = false;
 
 // Breakpoint on memory access vars (exported)
@@ -1066,9 +1085,9 @@ unsigned int m68k_read_memory_8(unsigned int address)
 //	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFF))
 //		retVal = CDROMReadByte(address);
 	else if ((address >= 0xF00000) && (address <= 0xF0FFFF))
-		retVal = TOMReadByte(address, M68K);
+		SyncGPU(), retVal = TOMReadByte(address, M68K);
 	else if ((address >= 0xF10000) && (address <= 0xF1FFFF))
-		retVal = JERRYReadByte(address, M68K);
+		GPUAbandonSpeculation(), retVal = JERRYReadByte(address, M68K);
 	else
 		retVal = jaguar_unknown_readbyte(address, M68K);
 
@@ -1172,19 +1191,18 @@ unsigned int m68k_read_memory_16(unsigned int address)
 			retVal = MTReadWord(address);
 		}
 		else
-			retVal = (jaguarMainROM[address - 0x800000] << 8)
-				| jaguarMainROM[address - 0x800000 + 1];
+			retVal = GET16(jaguarMainROM, address - 0x800000);
 	}
 	else if ((address >= 0xE00000) && (address <= 0xE3FFFE))
 //		retVal = (jaguarBootROM[address - 0xE00000] << 8) | jaguarBootROM[address - 0xE00000 + 1];
 //		retVal = (jaguarDevBootROM1[address - 0xE00000] << 8) | jaguarDevBootROM1[address - 0xE00000 + 1];
-		retVal = (jagMemSpace[address] << 8) | jagMemSpace[address + 1];
+		retVal = GET16(jagMemSpace, address);
 	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFE))
 		retVal = CDROMReadWord(address, M68K);
 	else if ((address >= 0xF00000) && (address <= 0xF0FFFE))
-		retVal = TOMReadWord(address, M68K);
+		SyncGPU(), retVal = TOMReadWord(address, M68K);
 	else if ((address >= 0xF10000) && (address <= 0xF1FFFE))
-		retVal = JERRYReadWord(address, M68K);
+		GPUAbandonSpeculation(), retVal = JERRYReadWord(address, M68K);
 	else
 		retVal = jaguar_unknown_readword(address, M68K);
 
@@ -1231,6 +1249,9 @@ unsigned int m68k_read_memory_32(unsigned int address)
 
 		return retVal;
 	}
+	// Note that the Jaguar only has 2M of RAM, not 4!
+	else if (address <= 0x1FFFFC)
+		return GET32(jaguarMainRAM, address);
 
 	return (m68k_read_memory_16(address) << 16) | m68k_read_memory_16(address + 2);
 #else
@@ -1241,6 +1262,8 @@ unsigned int m68k_read_memory_32(unsigned int address)
 
 void m68k_write_memory_8(unsigned int address, unsigned int value)
 {
+	m68k_write_count++;					// For the idle loop detector
+
 #ifdef ALPINE_FUNCTIONS
 	// Check if breakpoint on memory is active, and deal with it
 	if (bpmActive && address == bpmAddress1)
@@ -1281,14 +1304,19 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
 #ifndef USE_NEW_MMU
 	// Note that the Jaguar only has 2M of RAM, not 4!
 	if ((address >= 0x000000) && (address <= 0x1FFFFF))
+	{
+		if (gpuSpeculating)
+			GPUSpecOtherWrite(address, 1);
+
 		jaguarMainRAM[address] = value;
+	}
 //hmm...
 //	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFF))
 //		CDROMWriteByte(address, value, M68K);
 	else if ((address >= 0xF00000) && (address <= 0xF0FFFF))
-		TOMWriteByte(address, value, M68K);
+		SyncGPU(), TOMWriteByte(address, value, M68K);
 	else if ((address >= 0xF10000) && (address <= 0xF1FFFF))
-		JERRYWriteByte(address, value, M68K);
+		GPUAbandonSpeculation(), JERRYWriteByte(address, value, M68K);
 	else
 		jaguar_unknown_writebyte(address, value, M68K);
 #else
@@ -1299,6 +1327,8 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
 
 void m68k_write_memory_16(unsigned int address, unsigned int value)
 {
+	m68k_write_count++;					// For the idle loop detector
+
 #ifdef ALPINE_FUNCTIONS
 	// Check if breakpoint on memory is active, and deal with it
 	if (bpmActive && address == bpmAddress1)
@@ -1369,6 +1399,9 @@ if (address == 0xF02110)
 	{
 /*		jaguar_mainRam[address] = value >> 8;
 		jaguar_mainRam[address + 1] = value & 0xFF;*/
+		if (gpuSpeculating)
+			GPUSpecOtherWrite(address, 2);
+
 		SET16(jaguarMainRAM, address, value);
 	}
 	// Memory Track device writes....
@@ -1380,9 +1413,9 @@ if (address == 0xF02110)
 	else if ((address >= 0xDFFF00) && (address <= 0xDFFFFE))
 		CDROMWriteWord(address, value, M68K);
 	else if ((address >= 0xF00000) && (address <= 0xF0FFFE))
-		TOMWriteWord(address, value, M68K);
+		SyncGPU(), TOMWriteWord(address, value, M68K);
 	else if ((address >= 0xF10000) && (address <= 0xF1FFFE))
-		JERRYWriteWord(address, value, M68K);
+		GPUAbandonSpeculation(), JERRYWriteWord(address, value, M68K);
 	else
 	{
 		jaguar_unknown_writeword(address, value, M68K);
@@ -1400,6 +1433,8 @@ if (address == 0xF02110)
 
 void m68k_write_memory_32(unsigned int address, unsigned int value)
 {
+	m68k_write_count++;					// For the idle loop detector
+
 #ifdef ALPINE_FUNCTIONS
 	// Check if breakpoint on memory is active, and deal with it
 	if (bpmActive && address == bpmAddress1)
@@ -1668,20 +1703,22 @@ uint16_t JaguarReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 	// First 2M is mirrored in the $0 - $7FFFFF range
 	if (offset < 0x800000)
 	{
-		return (jaguarMainRAM[(offset+0) & 0x1FFFFF] << 8) | jaguarMainRAM[(offset+1) & 0x1FFFFF];
+		offset &= 0x1FFFFF;
+
+		if (offset == 0x1FFFFF)
+			return (jaguarMainRAM[0x1FFFFF] << 8) | jaguarMainRAM[0];
+
+		return GET16(jaguarMainRAM, offset);
 	}
 	else if ((offset >= 0x800000) && (offset < 0xDFFF00))
-	{
-		offset -= 0x800000;
-		return (jaguarMainROM[offset+0] << 8) | jaguarMainROM[offset+1];
-	}
+		return GET16(jaguarMainROM, offset - 0x800000);
 //	else if ((offset >= 0xDFFF00) && (offset < 0xDFFF00))
 	else if ((offset >= 0xDFFF00) && (offset <= 0xDFFFFE))
 		return CDROMReadWord(offset, who);
 	else if ((offset >= 0xE00000) && (offset <= 0xE3FFFE))
 //		return (jaguarBootROM[(offset+0) & 0x3FFFF] << 8) | jaguarBootROM[(offset+1) & 0x3FFFF];
 //		return (jaguarDevBootROM1[(offset+0) & 0x3FFFF] << 8) | jaguarDevBootROM1[(offset+1) & 0x3FFFF];
-		return (jagMemSpace[offset + 0] << 8) | jagMemSpace[offset + 1];
+		return GET16(jagMemSpace, offset);
 	else if ((offset >= 0xF00000) && (offset <= 0xF0FFFE))
 		return TOMReadWord(offset, who);
 	else if ((offset >= 0xF10000) && (offset <= 0xF1FFFE))
@@ -1847,8 +1884,16 @@ if (who == GPU && (gpu_pc == 0xF03604 || gpu_pc == 0xF03638))
 if (offset == 0x11D31A + 0x48000 || offset == 0x11D31A)
 	WriteLog("JWW: %s writing star %04X at %08X...\n", whoName[who], data, offset);//*/
 
-		jaguarMainRAM[(offset+0) & 0x1FFFFF] = data >> 8;
-		jaguarMainRAM[(offset+1) & 0x1FFFFF] = data & 0xFF;
+		offset &= 0x1FFFFF;
+
+		if (offset == 0x1FFFFF)
+		{
+			jaguarMainRAM[0x1FFFFF] = data >> 8;
+			jaguarMainRAM[0] = data & 0xFF;
+		}
+		else
+			SET16(jaguarMainRAM, offset, data);
+
 		return;
 	}
 	else if (offset >= 0xDFFF00 && offset <= 0xDFFFFE)
@@ -1874,14 +1919,22 @@ if (offset == 0x11D31A + 0x48000 || offset == 0x11D31A)
 }
 
 
-// We really should re-do this so that it does *real* 32-bit access... !!! FIX !!!
+// RAM & ROM get a real 32-bit access; everything else goes a word at a time
 uint32_t JaguarReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	offset &= 0xFFFFFF;
+
+	// First 2M is mirrored in the $0 - $7FFFFF range
+	if ((offset < 0x800000) && ((offset & 0x1FFFFF) <= 0x1FFFFC))
+		return GET32(jaguarMainRAM, offset & 0x1FFFFF);
+	else if ((offset >= 0x800000) && (offset <= 0xDFFEFC))
+		return GET32(jaguarMainROM, offset - 0x800000);
+
 	return (JaguarReadWord(offset, who) << 16) | JaguarReadWord(offset+2, who);
 }
 
 
-// We really should re-do this so that it does *real* 32-bit access... !!! FIX !!!
+// RAM gets a real 32-bit access; everything else goes a word at a time
 void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 {
 /*	extern bool doDSPDis;
@@ -1893,6 +1946,15 @@ void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 /*if (offset == 0x0100)//64*4)
 	WriteLog("M68K: %s wrote dword to VI vector value %08X...\n", whoName[who], data);//*/
 
+	offset &= 0xFFFFFF;
+
+	// First 2M is mirrored in the $0 - $7FFFFF range
+	if ((offset < 0x800000) && ((offset & 0x1FFFFF) <= 0x1FFFFC))
+	{
+		SET32(jaguarMainRAM, offset & 0x1FFFFF, data);
+		return;
+	}
+
 	JaguarWriteWord(offset, data >> 16, who);
 	JaguarWriteWord(offset+2, data & 0xFFFF, who);
 }
@@ -1987,9 +2049,13 @@ void JaguarReset(void)
 	DSPReset();
 	CDROMReset();
     m68k_pulse_reset();								// Reset the 68000
+	m68k_set_idle_skip(vjs.idleSkip);
 	WriteLog("Jaguar: 68K reset. PC=%06X SP=%08X\n", m68k_get_reg(NULL, M68K_REG_PC), m68k_get_reg(NULL, M68K_REG_A7));
 
 	lowerField = false;								// Reset the lower field flag
+	systemClock = 0;
+	bootCache = BOOT_CACHE_PENDING;
+	bootFrames = bootFramesSkipped = 0;
 //	SetCallbackTime(ScanlineCallback, 63.5555);
 //	SetCallbackTime(ScanlineCallback, 31.77775);
 	SetCallbackTime(HalflineCallback, (vjs.hardwareTypeNTSC ? 31.777777777 : 32.0));
@@ -2093,6 +2159,16 @@ void JaguarDone(void)
 	M68K_show_context();
 //#endif
 
+	WriteLog("Jaguar: 68K skipped %llu idle cycles\n", (unsigned long long)m68k_get_idle_cycles());
+
+	if (runAheadStats.frames)
+		WriteLog("Jaguar: Ran ahead of %llu frames, %.2f ms each (%.3f ms to take a %u K snapshot, %.3f ms to put it back)\n",
+			(unsigned long long)runAheadStats.frames,
+			(runAheadStats.snapshotUsec + runAheadStats.aheadUsec + runAheadStats.restoreUsec) / (runAheadStats.frames * 1000.0),
+			runAheadStats.snapshotUsec / (runAheadStats.frames * 1000.0), SnapshotSize(SNAPSHOT_RUN_AHEAD) / 1024,
+			runAheadStats.restoreUsec / (runAheadStats.frames * 1000.0));
+
+	CaptureStop();
 	CDROMDone();
 	GPUDone();
 	DSPDone();
@@ -2162,13 +2238,36 @@ uint8_t * GetRamPtr(void)
 }
 
 
+//
+// The 68K & the GPU don't take turns a slice at a time; the 68K leads, running
+// up to the next event, and the GPU keeps its own clock & is only brought up
+// to where the 68K is when it's about to be looked at or poked (the 68K going
+// into TOM, which is where the GPU & the blitter live), or when an event comes
+// due (the OP looks at what the GPU drew, the PIT interrupts it, etc.). So they
+// line up exactly where they actually meet, and a GPU that's left alone runs
+// in one go up to the next event.
+//
+static void SyncGPU(void)
+{
+	uint64_t clock = systemClock;
+
+	if (m68kInSlice)
+		clock += m68k_cycles_run() * 2;
+
+	GPUCatchUp(clock);
+}
+
+
 //
 // New Jaguar execution stack
 // This executes 1 frame's worth of code.
 //
-bool frameDone;
+MACHINE_STATE bool frameDone;
 void JaguarExecuteNew(void)
 {
+	if ((bootCache != BOOT_CACHE_IDLE) && !jaguarRunningAhead)
+		BootCacheFrame();
+
 	frameDone = false;
 
 	do
@@ -2176,14 +2275,251 @@ void JaguarExecuteNew(void)
 		double timeToNextEvent = GetTimeToNextEvent();
 //WriteLog("JEN: Time to next event (%u) is %f usec (%u RISC cycles)...\n", nextEvent, timeToNextEvent, USEC_TO_RISC_CYCLES(timeToNextEvent));
 
-		m68k_execute(USEC_TO_M68K_CYCLES(timeToNextEvent));
+		uint64_t sliceEnd = systemClock + USEC_TO_RISC_CYCLES(timeToNextEvent);
+
+#ifndef USE_NEW_MMU
+		// (The MMU doesn't tell the GPU what the 68K wrote)
+		GPUSpeculate(sliceEnd);
+#endif
 
-		if (vjs.GPUEnabled)
-			GPUExec(USEC_TO_RISC_CYCLES(timeToNextEvent));
+		m68kInSlice = true;
+		m68k_execute(USEC_TO_M68K_CYCLES(timeToNextEvent));
+		m68kInSlice = false;
 
+		systemClock = sliceEnd;
+		SyncGPU();
 		HandleNextEvent();
  	}
 	while (!frameDone);
+
+	if (CaptureIsRunning() && !jaguarRunningAhead)
+		CaptureVideoFrame(screenBuffer, screenPitch, TOMGetVideoModeWidth(), TOMGetVideoModeHeight());
+}
+
+
+//
+// Run-ahead
+//
+// Plenty of software reads the joypads a frame or two before it does anything
+// about them. To hide that, we run the frame for real, then take a snapshot
+// and run <frames> more with the same input, with the DSP running but nothing
+// it does going out to the host. The last of those is what ends up on the
+// screen, then everything goes back to how it was after the real frame. The
+// host's audio thread is kept out all the while, since it runs the DSP.
+//
+// Whoever runs the DSP themselves (via SDLSoundCallback()) does it after this,
+// same as after JaguarExecuteNew(): it's all put back by then.
+//
+void JaguarExecuteRunAhead(uint32_t frames)
+{
+	JaguarExecuteNew();
+
+	if (frames == 0)
+		return;
+
+	double frameTime = (vjs.hardwareTypeNTSC ? 525.0 * HORIZ_PERIOD_IN_USEC_NTSC
+		: 625.0 * HORIZ_PERIOD_IN_USEC_PAL) / 2.0;
+	uint64_t start = GetMicroseconds();
+
+	DACLockAudioThread();
+	SnapshotSave(SNAPSHOT_RUN_AHEAD);
+	uint64_t saved = GetMicroseconds();
+	jaguarRunningAhead = true;
+
+	for(uint32_t i=0; i<frames; i++)
+	{
+		JaguarExecuteNew();
+		DACRunSilently(frameTime);
+	}
+
+	jaguarRunningAhead = false;
+	uint64_t ranAhead = GetMicroseconds();
+	SnapshotRestore(SNAPSHOT_RUN_AHEAD);
+	DACLockAudioThread(false);
+	uint64_t end = GetMicroseconds();
+
+	runAheadStats.frames++;
+	runAheadStats.snapshotUsec += saved - start;
+	runAheadStats.aheadUsec += ranAhead - saved;
+	runAheadStats.restoreUsec += end - ranAhead;
+	runAheadStats.lastUsec = end - start;
+}
+
+
+void JaguarGetRunAheadStats(JaguarRunAheadStats & stats)
+{
+	stats = runAheadStats;
+}
+
+
+//
+// See STATE.CPP
+//
+void JaguarSnapshot(void)
+{
+	SNAPSHOT(lowerField);
+	SNAPSHOT(systemClock);
+	SNAPSHOT(frameDone);
+	SNAPSHOT(bootFrames);
+	m68k_snapshot(SnapshotData);
+}
+
+
+//
+// Boot cache
+//
+// Booting through the BIOS takes a few seconds, and comes out the same every
+// time for the same software, BIOS & settings. So the first time, we take a
+// snapshot at the start of each frame of the boot, until the BIOS jumps to
+// the software; the one from the start of that last frame goes in
+// vjs.bootCachePath. From then on, the boot is skipped by starting from there
+// instead. The BIOS reads the joypads, so nothing's cached if they're touched
+// during the boot, or if an input movie is running.
+//
+// The EEPROMs aren't in the snapshot (they hold the player's saves). If the
+// boot talks to one, what's in them goes in the name as well, and if the boot
+// changes them, nothing's cached.
+//
+// This is called at the start of each (real) frame from the reset until the
+// boot's done with.
+//
+static void BootCacheFrame(void)
+{
+	if (bootCache == BOOT_CACHE_PENDING)
+	{
+		BootCacheLookup();
+
+		if (bootCache != BOOT_CACHE_RUNNING)
+			return;
+	}
+
+	if (m68k_pc_watch_hit())
+	{
+		// It got there in the last frame, so what we're after is the snapshot
+		// from the start of it
+		m68k_set_pc_watch(0xFFFFFFFF);
+		bootCache = BOOT_CACHE_IDLE;
+
+		if (EepromGetActivity() == bootCacheEEPROMActivity)
+			snprintf(bootCacheFile, sizeof(bootCacheFile), "%s.vjboot", bootCacheName);
+		else if (EepromGetCRC() == bootCacheEEPROMCRC)
+			snprintf(bootCacheFile, sizeof(bootCacheFile), "%s-%08X.vjboot",
+				bootCacheName, (unsigned int)bootCacheEEPROMCRC);
+		else
+		{
+			WriteLog("Jaguar: Boot wrote to the EEPROM, so it can't be cached\n");
+			return;
+		}
+
+		if (SnapshotWriteFile(SNAPSHOT_BOOT, bootCacheFile))
+			WriteLog("Jaguar: Boot took %u frames, cached in \"%s\"\n", bootFrames, bootCacheFile);
+
+		return;
+	}
+
+	bool touched = false;
+
+	for(uint32_t i=0; i<21; i++)
+		touched = touched || joypad0Buttons[i] || joypad1Buttons[i];
+
+	if (touched || JoystickMovieIsRunning() || (bootFrames >= BOOT_CACHE_MAX_FRAMES))
+	{
+		m68k_set_pc_watch(0xFFFFFFFF);
+		bootCache = BOOT_CACHE_IDLE;
+		return;
+	}
+
+	DACLockAudioThread();
+	SnapshotSave(SNAPSHOT_BOOT);
+	DACLockAudioThread(false);
+	bootFrames++;
+}
+
+
+//
+// Called once after the reset: starts from the cached end of the boot if
+// there is one, otherwise gets ready to make one
+//
+static void BootCacheLookup(void)
+{
+	bootCache = BOOT_CACHE_IDLE;
+
+	if ((vjs.bootCachePath[0] == 0) || !vjs.useJaguarBIOS || !jaguarCartInserted
+		|| vjs.hardwareTypeAlpine || JoystickMovieIsRunning())
+		return;
+
+	// Anything that changes how the boot goes has to be in the name
+	uint32_t biosCRC = crc32_calcCheckSum(jagMemSpace + 0xE00000, 0x20000);
+	uint32_t settings = (vjs.hardwareTypeNTSC ? 0x01 : 0) | (vjs.GPUEnabled ? 0x02 : 0)
+		| (vjs.DSPEnabled ? 0x04 : 0) | (vjs.idleSkip ? 0x08 : 0)
+		| (vjs.useFastBlitter ? 0x10 : 0) | (vjs.dspEngine << 5);
+	snprintf(bootCacheName, sizeof(bootCacheName), "%s%08X-%08X-%02X",
+		vjs.bootCachePath, (unsigned int)jaguarMainROMCRC32, (unsigned int)biosCRC,
+		(unsigned int)settings);
+	bootCacheEEPROMCRC = EepromGetCRC();
+	bootCacheEEPROMActivity = EepromGetActivity();
+
+	DACLockAudioThread();
+	snprintf(bootCacheFile, sizeof(bootCacheFile), "%s.vjboot", bootCacheName);
+	bool cached = SnapshotReadFile(SNAPSHOT_BOOT, bootCacheFile);
+
+	if (!cached)
+	{
+		snprintf(bootCacheFile, sizeof(bootCacheFile), "%s-%08X.vjboot",
+			bootCacheName, (unsigned int)bootCacheEEPROMCRC);
+		cached = SnapshotReadFile(SNAPSHOT_BOOT, bootCacheFile);
+	}
+
+	if (cached)
+	{
+		SnapshotRestore(SNAPSHOT_BOOT);
+		m68k_set_pc_watch(0xFFFFFFFF);
+		bootFramesSkipped = bootFrames;
+		WriteLog("Jaguar: Skipped %u frames of booting with \"%s\"\n", bootFrames, bootCacheFile);
+	}
+
+	DACLockAudioThread(false);
+
+	if (!cached)
+	{
+		m68k_set_pc_watch(jaguarRunAddress);
+		bootCache = BOOT_CACHE_RUNNING;
+	}
+}
+
+
+//
+// Starts from the boot cache right away, if there's anything in it for what
+// was just reset, instead of at the start of the next frame; for anything
+// that has to know where it's starting from before it runs (e.g., to line up
+// input). Returns the number of frames skipped.
+//
+uint32_t JaguarStartFromBootCache(void)
+{
+	if (bootCache == BOOT_CACHE_PENDING)
+		BootCacheLookup();
+
+	return bootFramesSkipped;
+}
+
+
+//
+// How many frames of the last boot were skipped by the boot cache
+//
+uint32_t JaguarGetBootFramesSkipped(void)
+{
+	return bootFramesSkipped;
+}
+
+
+static uint64_t GetMicroseconds(void)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return (uint64_t)(((double)SDL_GetPerformanceCounter() * 1000000.0)
+		/ (double)SDL_GetPerformanceFrequency());
+#else
+	return (uint64_t)SDL_GetTicks() * 1000;
+#endif
 }
 
 
@@ -9,6 +9,7 @@ void JaguarSetScreenPitch(uint32_t pitch);
 void JaguarInit(void);
 void JaguarReset(void);
 void JaguarDone(void);
+void JaguarSnapshot(void);
 
 uint8_t JaguarReadByte(uint32_t offset, uint32_t who = UNKNOWN);
 uint16_t JaguarReadWord(uint32_t offset, uint32_t who = UNKNOWN);
@@ -21,13 +22,26 @@ bool JaguarInterruptHandlerIsValid(uint32_t i);
 void JaguarDasm(uint32_t offset, uint32_t qt);
 
 void JaguarExecuteNew(void);
+void JaguarExecuteRunAhead(uint32_t frames);
+
+struct JaguarRunAheadStats
+{
+	uint64_t frames;						// Real frames that were run ahead of
+	uint64_t snapshotUsec, aheadUsec, restoreUsec;
+	uint64_t lastUsec;						// All of it, for the last one
+};
+
+void JaguarGetRunAheadStats(JaguarRunAheadStats & stats);
+uint32_t JaguarStartFromBootCache(void);
+uint32_t JaguarGetBootFramesSkipped(void);
 
 // Exports from JAGUAR.CPP
 
 extern int32_t jaguarCPUInExec;
-extern uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
+extern MACHINE_STATE uint32_t jaguarMainROMCRC32, jaguarROMSize, jaguarRunAddress;
 extern char * jaguarEepromsPath;
-extern bool jaguarCartInserted;
+extern MACHINE_STATE bool jaguarCartInserted;
+extern MACHINE_STATE bool jaguarRunningAhead;
 extern bool bpmActive;
 extern uint32_t bpmAddress1;
 
@@ -167,6 +167,7 @@
 #include "m68000/m68kinterface.h"
 #include "memtrack.h"
 #include "settings.h"
+#include "state.h"
 #include "tom.h"
 //#include "memory.h"
 #include "wavetable.h"
@@ -174,7 +175,7 @@
 //Note that 44100 Hz requires samples every 22.675737 usec.
 //#define JERRY_DEBUG
 
-/*static*/ uint8_t jerry_ram_8[0x10000];
+MACHINE_STATE /*static*/ uint8_t jerry_ram_8[0x10000];
 
 //#define JERRY_CONFIG	0x4002						// ??? What's this ???
 
@@ -182,7 +183,7 @@
 #define JPIT1		0x00
 #define JPIT2		0x02
 #define JPIT3		0x04
-#define JPIT4		0x08
+#define JPIT4		0x06
 #define CLK1		0x10
 #define CLK2		0x12
 #define CLK3		0x14
@@ -194,22 +195,22 @@
 #define SMODE		0xA154
 
 
-uint8_t analog_x, analog_y;
+MACHINE_STATE uint8_t analog_x, analog_y;
 
-static uint32_t JERRYPIT1Prescaler;
-static uint32_t JERRYPIT1Divider;
-static uint32_t JERRYPIT2Prescaler;
-static uint32_t JERRYPIT2Divider;
-static int32_t jerry_timer_1_counter;
-static int32_t jerry_timer_2_counter;
+static MACHINE_STATE uint32_t JERRYPIT1Prescaler;
+static MACHINE_STATE uint32_t JERRYPIT1Divider;
+static MACHINE_STATE uint32_t JERRYPIT2Prescaler;
+static MACHINE_STATE uint32_t JERRYPIT2Divider;
+static MACHINE_STATE int32_t jerry_timer_1_counter;
+static MACHINE_STATE int32_t jerry_timer_2_counter;
 
 //uint32_t JERRYI2SInterruptDivide = 8;
-int32_t JERRYI2SInterruptTimer = -1;
-uint32_t jerryI2SCycles;
-uint32_t jerryIntPending;
+MACHINE_STATE int32_t JERRYI2SInterruptTimer = -1;
+MACHINE_STATE uint32_t jerryI2SCycles;
+MACHINE_STATE uint32_t jerryIntPending;
 
-static uint16_t jerryInterruptMask = 0;
-static uint16_t jerryPendingInterrupt = 0;
+static MACHINE_STATE uint16_t jerryInterruptMask = 0;
+static MACHINE_STATE uint16_t jerryPendingInterrupt = 0;
 
 // Private function prototypes
 
@@ -221,6 +222,60 @@ void JERRYPIT1Callback(void);
 void JERRYPIT2Callback(void);
 void JERRYI2SCallback(void);
 
+static void JERRYWritePITByte(uint32_t offset, uint8_t data, uint32_t who);
+static void JERRYWritePITWord(uint32_t offset, uint16_t data, uint32_t who);
+static void JERRYWriteJINTCTRLByte(uint32_t offset, uint8_t data, uint32_t who);
+static void JERRYWriteJINTCTRLWord(uint32_t offset, uint16_t data, uint32_t who);
+
+//
+// JERRY's registers (offset from $F10000)
+//
+static const IORegister jerryRegisterList[] = {
+	{ JPIT1,    "JPIT1",    "JPIT1", 2, 0, 0xFFFF, JERRYWritePITByte, JERRYWritePITWord },
+	{ JPIT2,    "JPIT2",    "JPIT2", 2, 0, 0xFFFF, JERRYWritePITByte, JERRYWritePITWord },
+	{ JPIT3,    "JPIT3",    "JPIT3", 2, 0, 0xFFFF, JERRYWritePITByte, JERRYWritePITWord },
+	{ JPIT4,    "JPIT4",    "JPIT4", 2, 0, 0xFFFF, JERRYWritePITByte, JERRYWritePITWord },
+	{ CLK1,     "CLK1",     "CLK1", 2, 0, 0xFFFF, NULL, NULL },
+	{ CLK2,     "CLK2",     "CLK2", 2, 0, 0xFFFF, NULL, NULL },
+	{ CLK3,     "CLK3",     "CLK3", 2, 0, 0xFFFF, NULL, NULL },
+	{ JINTCTRL, "JINTCTRL", NULL, 4, IOR_HEX, 0xFFFF, JERRYWriteJINTCTRLByte, JERRYWriteJINTCTRLWord },
+	{ ASIDATA,  "ASIDATA",  NULL, 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ ASICTRL,  "ASICTRL",  NULL, 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ ASICLK,   "ASICLK",   NULL, 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ 0xA100,   "D_FLAGS",  NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA104,   "D_MTXC",   NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA108,   "D_MTXA",   NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA10C,   "D_END",    NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA110,   "D_PC",     NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA114,   "D_CTRL",   NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA118,   "D_MOD",    NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	{ 0xA11C,   "D_DIVCTRL", NULL, 4, IOR_HEX, 0xFFFF, DSPWriteByte, DSPWriteWord },
+	// LTXD/RTXD/SCLK/SMODE $F1A148/4C/50/54 (really 16-bit registers...)
+	{ 0xA148,   "LTXD",     NULL, 4, IOR_HEX, 0xFFFF, DACWriteByte, DACWriteWord },
+	{ 0xA14C,   "RTXD",     NULL, 4, IOR_HEX, 0xFFFF, DACWriteByte, DACWriteWord },
+	{ SCLK,     "SCLK",     NULL, 4, IOR_HEX, 0xFFFF, DACWriteByte, DACWriteWord },
+	{ SMODE,    "SMODE",    NULL, 4, IOR_HEX, 0xFFFF, DACWriteByte, DACWriteWord }
+};
+
+// ...and where each word of them lives in the list. They're in two pages:
+// $F10000 - $F100FF & $F1A100 - $F1A1FF.
+#define JERRY_REGISTER_INDEX(o)	((((o) & 0xF000) == 0xA000 ? 0x80 : 0x00) | (((o) & 0xFF) >> 1))
+static MACHINE_STATE const IORegister * jerryRegister[0x100];
+
+
+static void JERRYBuildRegisterTable(void)
+{
+	memset(jerryRegister, 0, sizeof(jerryRegister));
+
+	for(uint32_t i=0; i<sizeof(jerryRegisterList)/sizeof(IORegister); i++)
+	{
+		const IORegister * reg = &jerryRegisterList[i];
+
+		for(uint32_t j=0; j<reg->size; j+=2)
+			jerryRegister[JERRY_REGISTER_INDEX(reg->offset + j)] = reg;
+	}
+}
+
 
 void JERRYResetI2S(void)
 {
@@ -313,11 +368,14 @@ void JERRYI2SCallback(void)
 	// If INTERNAL flag is set, then JERRY's SCLK is master
 	if (smode & SMODE_INTERNAL)
 	{
-		// This does the 'IRQ enabled' checking...
-		DSPSetIRQLine(DSPIRQ_SSI, ASSERT_LINE);
 //		double usecs = (float)jerryI2SCycles * RISC_CYCLE_IN_USEC;
 //this fix is almost enough to fix timings in tripper, but not quite enough...
 		double usecs = (float)jerryI2SCycles * (vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC);
+		// What's in L/RTXD goes out to the DAC before the DSP gets asked for
+		// the next one
+		DACCaptureSample(1000000.0 / usecs);
+		// This does the 'IRQ enabled' checking...
+		DSPSetIRQLine(DSPIRQ_SSI, ASSERT_LINE);
 		SetCallbackTime(JERRYI2SCallback, usecs, EVENT_JERRY);
 	}
 	else
@@ -362,6 +420,7 @@ void JERRYI2SCallback(void)
 
 void JERRYInit(void)
 {
+	JERRYBuildRegisterTable();
 	JoystickInit();
 	MTInit();
 	memcpy(&jerry_ram_8[0xD000], waveTableROM, 0x1000);
@@ -409,6 +468,26 @@ void JERRYDone(void)
 }
 
 
+// See STATE.CPP
+void JERRYSnapshot(void)
+{
+	SNAPSHOT(jerry_ram_8);
+	SNAPSHOT(analog_x);
+	SNAPSHOT(analog_y);
+	SNAPSHOT(JERRYPIT1Prescaler);
+	SNAPSHOT(JERRYPIT1Divider);
+	SNAPSHOT(JERRYPIT2Prescaler);
+	SNAPSHOT(JERRYPIT2Divider);
+	SNAPSHOT(jerry_timer_1_counter);
+	SNAPSHOT(jerry_timer_2_counter);
+	SNAPSHOT(JERRYI2SInterruptTimer);
+	SNAPSHOT(jerryI2SCycles);
+	SNAPSHOT(jerryIntPending);
+	SNAPSHOT(jerryInterruptMask);
+	SNAPSHOT(jerryPendingInterrupt);
+}
+
+
 bool JERRYIRQEnabled(int irq)
 {
 	// Read the word @ $F10020
@@ -432,19 +511,18 @@ void JERRYDumpIORegistersToLog(void)
 	WriteLog("\n\n---------------------------------------------------------------------\n");
 	WriteLog("JERRY I/O Registers\n");
 	WriteLog("---------------------------------------------------------------------\n");
-	WriteLog("F1%04X    (JPIT1): $%04X\n", JPIT1,    GET16(jerry_ram_8, JPIT1));
-	WriteLog("F1%04X    (JPIT2): $%04X\n", JPIT2,    GET16(jerry_ram_8, JPIT2));
-	WriteLog("F1%04X    (JPIT3): $%04X\n", JPIT3,    GET16(jerry_ram_8, JPIT3));
-	WriteLog("F1%04X    (JPIT4): $%04X\n", JPIT4,    GET16(jerry_ram_8, JPIT4));
-	WriteLog("F1%04X     (CLK1): $%04X\n", CLK1,     GET16(jerry_ram_8, CLK1));
-	WriteLog("F1%04X     (CLK2): $%04X\n", CLK2,     GET16(jerry_ram_8, CLK2));
-	WriteLog("F1%04X     (CLK3): $%04X\n", CLK3,     GET16(jerry_ram_8, CLK3));
-	WriteLog("F1%04X (JINTCTRL): $%04X\n", JINTCTRL, GET16(jerry_ram_8, JINTCTRL));
-	WriteLog("F1%04X  (ASIDATA): $%04X\n", ASIDATA,  GET16(jerry_ram_8, ASIDATA));
-	WriteLog("F1%04X  (ASICTRL): $%04X\n", ASICTRL,  GET16(jerry_ram_8, ASICTRL));
-	WriteLog("F1%04X   (ASICLK): $%04X\n", ASICLK,   GET16(jerry_ram_8, ASICLK));
-	WriteLog("F1%04X     (SCLK): $%04X\n", SCLK,     GET16(jerry_ram_8, SCLK));
-	WriteLog("F1%04X    (SMODE): $%04X\n", SMODE,    GET16(jerry_ram_8, SMODE));
+	for(uint32_t i=0; i<sizeof(jerryRegisterList)/sizeof(IORegister); i++)
+	{
+		const IORegister & reg = jerryRegisterList[i];
+		char name[16];
+		sprintf(name, "(%s)", reg.name);
+
+		if (reg.size == 4)
+			WriteLog("F1%04X %11s: $%08X\n", reg.offset, name, GET32(jerry_ram_8, reg.offset));
+		else
+			WriteLog("F1%04X %11s: $%04X\n", reg.offset, name, GET16(jerry_ram_8, reg.offset));
+	}
+
 	WriteLog("---------------------------------------------------------------------\n\n\n");
 }
 
@@ -551,7 +629,7 @@ return rand() & 0xFFFF;
 	WriteLog("JERRY: Reading word at %08X [%04X]...\n", offset, ((uint16_t)jerry_ram_8[(offset+0)&0xFFFF] << 8) | jerry_ram_8[(offset+1)&0xFFFF]);//*/
 
 	offset &= 0xFFFF;				// Prevent crashing...!
-	return ((uint16_t)jerry_ram_8[offset+0] << 8) | jerry_ram_8[offset+1];
+	return GET16(jerry_ram_8, offset);
 }
 
 
@@ -566,91 +644,36 @@ void JERRYWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 #ifdef JERRY_DEBUG
 	WriteLog("jerry: writing byte %.2x at 0x%.6x\n",data,offset);
 #endif
-	if ((offset >= DSP_CONTROL_RAM_BASE) && (offset < DSP_CONTROL_RAM_BASE + 0x20))
-	{
-		DSPWriteByte(offset, data, who);
-		return;
-	}
-	else if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE + 0x2000))
+	// Sort it out by which 256 byte page it's in
+	switch ((offset >> 8) & 0xFF)
 	{
-		DSPWriteByte(offset, data, who);
-		return;
-	}
-	// SCLK ($F1A150--8 bits wide)
-//NOTE: This should be taken care of in DAC...
-#if 0
-	else if ((offset >= 0xF1A152) && (offset <= 0xF1A153))
+	case 0x00:								// JERRY registers
+	case 0xA1:								// DSP control & I2S
 	{
-#if 0
-//		WriteLog("JERRY: Writing %02X to SCLK...\n", data);
-		if ((offset & 0x03) == 2)
-			sclk = (sclk & 0x00FF) | ((uint32_t)data << 8);
-		else
-			sclk = (sclk & 0xFF00) | (uint32_t)data;
-#else
-		sclk = data;
-#endif
-#warning "!!! SCLK should be handled in dac.cpp !!!"
-		JERRYI2SInterruptTimer = -1;
-		RemoveCallback(JERRYI2SCallback);
-		JERRYI2SCallback();
-//		return;
-	}
-#endif
-	// LTXD/RTXD/SCLK/SMODE $F1A148/4C/50/54 (really 16-bit registers...)
-	else if (offset >= 0xF1A148 && offset <= 0xF1A157)
-	{
-		DACWriteByte(offset, data, who);
-		return;
-	}
-	else if (offset >= 0xF10000 && offset <= 0xF10007)
-	{
-WriteLog("JERRY: Unhandled timer write (BYTE) at %08X...\n", offset);
-		return;
+		const IORegister * reg = jerryRegister[JERRY_REGISTER_INDEX(offset)];
+
+		if (reg && reg->writeByte)
+			reg->writeByte(offset, data, who);
+
+		break;
 	}
-/*	else if ((offset >= 0xF10010) && (offset <= 0xF10015))
-	{
-		clock_byte_write(offset, data);
-		return;
-	}//*/
-	// JERRY -> 68K interrupt enables/latches (need to be handled!)
-	else if (offset >= 0xF10020 && offset <= 0xF10021)//WAS:23)
-	{
-		if (offset == 0xF10020)
+	default:
+		if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE + 0x2000))
+			DSPWriteByte(offset, data, who);
+/*		else if ((offset >= 0xF17C00) && (offset <= 0xF17C01))
+			anajoy_byte_write(offset, data);*/
+		else if ((offset >= 0xF14000) && (offset <= 0xF14003))
 		{
-			// Clear pending interrupts...
-			jerryPendingInterrupt &= ~data;
-		}
-		else if (offset == 0xF10021)
-			jerryInterruptMask = data;
-//WriteLog("JERRY: (68K int en/lat - Unhandled!) Tried to write $%02X to $%08X!\n", data, offset);
-//WriteLog("JERRY: (Previous is partially handled... IRQMask=$%04X)\n", jerryInterruptMask);
-	}
-/*	else if ((offset >= 0xF17C00) && (offset <= 0xF17C01))
-	{
-		anajoy_byte_write(offset, data);
-		return;
-	}*/
-	else if ((offset >= 0xF14000) && (offset <= 0xF14003))
-	{
 WriteLog("JERRYWriteByte: Unhandled byte write to JOYSTICK by %s.\n", whoName[who]);
-//		JoystickWriteByte(offset, data);
-		JoystickWriteWord(offset & 0xFE, (uint16_t)data);
+//			JoystickWriteByte(offset, data);
+			JoystickWriteWord(offset & 0xFE, (uint16_t)data);
 // This is wrong, EEPROM is never written here
-		EepromWriteByte(offset, data);
-		return;
-	}
-	else if ((offset >= 0xF14000) && (offset <= 0xF1A0FF))
-	{
-		EepromWriteByte(offset, data);
-		return;
-	}
-
+			EepromWriteByte(offset, data);
+		}
+		else if ((offset >= 0xF14000) && (offset <= 0xF1A0FF))
+			EepromWriteByte(offset, data);
 //Need to protect write attempts to Wavetable ROM (F1D000-FFF)
-	if (offset >= 0xF1D000 && offset <= 0xF1DFFF)
-		return;
-
-//	jerry_ram_8[offset & 0xFFFF] = data;
+	}
 }
 
 
@@ -666,119 +689,105 @@ void JERRYWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 #ifdef JERRY_DEBUG
 	WriteLog( "JERRY: Writing word %04X at %06X\n", data, offset);
 #endif
-#if 1
-if (offset == 0xF10000)
-	WriteLog("JERRY: JPIT1 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10002)
-	WriteLog("JERRY: JPIT2 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10004)
-	WriteLog("JERRY: JPIT3 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10006)
-	WriteLog("JERRY: JPIT4 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10010)
-	WriteLog("JERRY: CLK1 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10012)
-	WriteLog("JERRY: CLK2 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10014)
-	WriteLog("JERRY: CLK3 word written by %s: %u\n", whoName[who], data);
-//else if (offset == 0xF1A100)
-//	WriteLog("JERRY: D_FLAGS word written by %s: %u\n", whoName[who], data);
-//else if (offset == 0xF1A102)
-//	WriteLog("JERRY: D_FLAGS+2 word written by %s: %u\n", whoName[who], data);
-else if (offset == 0xF10020)
-	WriteLog("JERRY: JINTCTRL word written by %s: $%04X (%s%s%s%s%s%s)\n", whoName[who], data,
-		(data & 0x01 ? "Extrnl " : ""), (data & 0x02 ? "DSP " : ""),
-		(data & 0x04 ? "Timer0 " : ""), (data & 0x08 ? "Timer1 " : ""),
-		(data & 0x10 ? "ASI " : ""), (data & 0x20 ? "I2S " : ""));
-#endif
-
-	if ((offset >= DSP_CONTROL_RAM_BASE) && (offset < DSP_CONTROL_RAM_BASE + 0x20))
-	{
-		DSPWriteWord(offset, data, who);
-		return;
-	}
-	else if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE + 0x2000))
+	// Sort it out by which 256 byte page it's in
+	switch ((offset >> 8) & 0xFF)
 	{
-		DSPWriteWord(offset, data, who);
-		return;
-	}
-//NOTE: This should be taken care of in DAC...
-#if 0
-	else if (offset == 0xF1A152)					// Bottom half of SCLK ($F1A150)
+	case 0x00:								// JERRY registers
+	case 0xA1:								// DSP control & I2S
 	{
-#warning "!!! SCLK should be handled in dac.cpp !!!"
-		WriteLog("JERRY: Writing $%X to SCLK (by %s)...\n", data, whoName[who]);
-//This should *only* be enabled when SMODE has its INTERNAL bit set! !!! FIX !!!
-#if 0
-		sclk = (uint8_t)data;
-#else
-		sclk = data & 0xFF;
-#endif
-		JERRYI2SInterruptTimer = -1;
-		RemoveCallback(JERRYI2SCallback);
-		JERRYI2SCallback();
+		const IORegister * reg = jerryRegister[JERRY_REGISTER_INDEX(offset)];
 
-		DACWriteWord(offset, data, who);
-		return;
-	}
-#endif
-	// LTXD/RTXD/SCLK/SMODE $F1A148/4C/50/54 (really 16-bit registers...)
-	else if (offset >= 0xF1A148 && offset <= 0xF1A156)
-	{
-		DACWriteWord(offset, data, who);
-		return;
-	}
-	else if (offset >= 0xF10000 && offset <= 0xF10007)
-	{
-		switch(offset & 0x07)
-		{
-		case 0:
-			JERRYPIT1Prescaler = data;
-			JERRYResetPIT1();
-			break;
-		case 2:
-			JERRYPIT1Divider = data;
-			JERRYResetPIT1();
-			break;
-		case 4:
-			JERRYPIT2Prescaler = data;
-			JERRYResetPIT2();
+		if (reg == NULL)
 			break;
-		case 6:
-			JERRYPIT2Divider = data;
-			JERRYResetPIT2();
-		}
-		// Need to handle (unaligned) cases???
 
-		return;
+		if (reg->description && (offset == (0xF10000 | reg->offset)))
+			WriteLog("JERRY: %s word written by %s: %u\n", reg->description, whoName[who], data);
+
+		if (reg->writeWord)
+			reg->writeWord(offset, data, who);
+
+		break;
 	}
-	// JERRY -> 68K interrupt enables/latches (need to be handled!)
-	else if (offset >= 0xF10020 && offset <= 0xF10022)
-	{
-		jerryInterruptMask = data & 0xFF;
-		jerryPendingInterrupt &= ~(data >> 8);
-//WriteLog("JERRY: (68K int en/lat - Unhandled!) Tried to write $%04X to $%08X!\n", data, offset);
-//WriteLog("JERRY: (Previous is partially handled... IRQMask=$%04X)\n", jerryInterruptMask);
-		return;
+	default:
+		if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE + 0x2000))
+			DSPWriteWord(offset, data, who);
+		else if ((offset >= 0xF14000) && (offset < 0xF14003))
+		{
+			JoystickWriteWord(offset, data);
+			EepromWriteWord(offset, data);
+		}
+		else if ((offset >= 0xF14000) && (offset <= 0xF1A0FF))
+			EepromWriteWord(offset, data);
+//Need to protect write attempts to Wavetable ROM (F1D000-FFF)
 	}
-	else if (offset >= 0xF14000 && offset < 0xF14003)
+}
+
+
+//
+// JPIT1 - JPIT4 ($F10000 - $F10006): JERRY's timer prescalers & dividers
+//
+static void JERRYWritePITByte(uint32_t offset, uint8_t data, uint32_t who)
+{
+WriteLog("JERRY: Unhandled timer write (BYTE) at %08X...\n", offset);
+}
+
+
+static void JERRYWritePITWord(uint32_t offset, uint16_t data, uint32_t who)
+{
+	switch(offset & 0x07)
 	{
-		JoystickWriteWord(offset, data);
-		EepromWriteWord(offset, data);
-		return;
+	case 0:
+		JERRYPIT1Prescaler = data;
+		JERRYResetPIT1();
+		break;
+	case 2:
+		JERRYPIT1Divider = data;
+		JERRYResetPIT1();
+		break;
+	case 4:
+		JERRYPIT2Prescaler = data;
+		JERRYResetPIT2();
+		break;
+	case 6:
+		JERRYPIT2Divider = data;
+		JERRYResetPIT2();
 	}
-	else if (offset >= 0xF14000 && offset <= 0xF1A0FF)
+	// Need to handle (unaligned) cases???
+}
+
+
+//
+// JINTCTRL ($F10020): JERRY -> 68K interrupt enables/latches
+//
+static void JERRYWriteJINTCTRLByte(uint32_t offset, uint8_t data, uint32_t who)
+{
+	if (offset == 0xF10020)
 	{
-		EepromWriteWord(offset, data);
-		return;
+		// Clear pending interrupts...
+		jerryPendingInterrupt &= ~data;
 	}
+	else if (offset == 0xF10021)
+		jerryInterruptMask = data;
+//WriteLog("JERRY: (68K int en/lat - Unhandled!) Tried to write $%02X to $%08X!\n", data, offset);
+//WriteLog("JERRY: (Previous is partially handled... IRQMask=$%04X)\n", jerryInterruptMask);
+}
 
-//Need to protect write attempts to Wavetable ROM (F1D000-FFF)
-	if (offset >= 0xF1D000 && offset <= 0xF1DFFF)
+
+static void JERRYWriteJINTCTRLWord(uint32_t offset, uint16_t data, uint32_t who)
+{
+	if (offset > 0xF10022)
 		return;
 
-//	jerry_ram_8[(offset+0) & 0xFFFF] = (data >> 8) & 0xFF;
-//	jerry_ram_8[(offset+1) & 0xFFFF] = data & 0xFF;
+	if (offset == 0xF10020)
+		WriteLog("JERRY: JINTCTRL word written by %s: $%04X (%s%s%s%s%s%s)\n", whoName[who], data,
+			(data & 0x01 ? "Extrnl " : ""), (data & 0x02 ? "DSP " : ""),
+			(data & 0x04 ? "Timer0 " : ""), (data & 0x08 ? "Timer1 " : ""),
+			(data & 0x10 ? "ASI " : ""), (data & 0x20 ? "I2S " : ""));
+
+	jerryInterruptMask = data & 0xFF;
+	jerryPendingInterrupt &= ~(data >> 8);
+//WriteLog("JERRY: (68K int en/lat - Unhandled!) Tried to write $%04X to $%08X!\n", data, offset);
+//WriteLog("JERRY: (Previous is partially handled... IRQMask=$%04X)\n", jerryInterruptMask);
 }
 
 
@@ -10,6 +10,7 @@
 void JERRYInit(void);
 void JERRYReset(void);
 void JERRYDone(void);
+void JERRYSnapshot(void);
 void JERRYDumpIORegistersToLog(void);
 
 uint8_t JERRYReadByte(uint32_t offset, uint32_t who = UNKNOWN);
@@ -38,6 +39,6 @@ void JERRYI2SCallback(void);
 // External variables
 
 //extern uint32_t JERRYI2SInterruptDivide;
-extern int32_t JERRYI2SInterruptTimer;
+extern MACHINE_STATE int32_t JERRYI2SInterruptTimer;
 
 #endif
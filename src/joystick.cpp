@@ -15,18 +15,22 @@
 
 #include "joystick.h"
 #include <string.h>			// For memset()
+#include <atomic>
+#include "SDL.h"
 #include "gpu.h"
 #include "jaguar.h"
 #include "log.h"
 #include "settings.h"
+#include "state.h"
+#include "zlib.h"
 
 // Global vars
 
-static uint8_t joystick_ram[4];
-uint8_t joypad0Buttons[21];
-uint8_t joypad1Buttons[21];
-bool audioEnabled = false;
-bool joysticksEnabled = false;
+static MACHINE_STATE uint8_t joystick_ram[4];
+MACHINE_STATE uint8_t joypad0Buttons[21];
+MACHINE_STATE uint8_t joypad1Buttons[21];
+MACHINE_STATE bool audioEnabled = false;
+MACHINE_STATE bool joysticksEnabled = false;
 
 
 bool GUIKeyHeld = false;
@@ -47,6 +51,53 @@ bool blitterSingleStep = false;
 bool bssGo = false;
 bool bssHeld = false;
 
+//
+// What the host says is being held down. The GUI changes this whenever it
+// likes, and we only look at it when the Jaguar actually reads the joypads,
+// so a button pressed halfway through a frame is seen halfway through the
+// frame instead of at the start of the next one. Both pads fit in one 64-bit
+// word (bit (pad * 32) + button), so there's nothing to lock.
+//
+static std::atomic<uint64_t> hostButtons(0);
+static std::atomic<uint64_t> hostChangeTime(0);		// When it last changed (usec)
+static void (* hostPoll)(void) = NULL;
+static uint64_t lastPollTime = 0;
+static MACHINE_STATE uint64_t latchedButtons = 0;	// What the joypads were last set to
+static MACHINE_STATE JoystickLatency latency;
+
+#define HOST_POLL_USEC		1000		// Don't ask the host more often than this
+
+//
+// Input movies: every value JERRY hands back for JOYSTICK & JOYBUTS while the
+// joypads are enabled, frame by frame, so a run can be played back exactly
+// (as long as everything else is deterministic). The file is gzipped, in host
+// byte order:
+//
+//   "VJMOVIE1" <version (uint32)> <sizeof(JoystickMovieInfo) (uint32)>
+//   <JoystickMovieInfo>, then
+//   'J' <value (uint16)>    A read of JOYSTICK
+//   'B' <value (uint16)>    A read of JOYBUTS
+//   'F'                     End of a frame
+//
+// A read that doesn't line up with the movie on playback (the Jaguar reading
+// something else, or reading more than it did in that frame) is a desync; it
+// gets what the joypads have now instead, & the rest of the frame is skipped
+// at the end of it.
+//
+
+#define MOVIE_VERSION		1
+
+static MACHINE_STATE gzFile movieFile = NULL;
+static MACHINE_STATE bool movieRecording = false;
+static MACHINE_STATE int movieNextTag;				// What's coming up on playback
+static MACHINE_STATE JoystickMovieStats movieStats;
+
+static uint64_t GetMicroseconds(void);
+static void JoystickLatch(void);
+static bool JoystickMoviePlayRead(int tag, uint16_t & data);
+static void JoystickMovieRecordRead(int tag, uint16_t data);
+static void JoystickMovieEndFrame(void);
+
 
 void JoystickInit(void)
 {
@@ -61,6 +112,10 @@ void JoystickExec(void)
 	effect_start2 = effect_start3 = effect_start4 = effect_start5 = effect_start6 = 0;
 	blit_start_log = 0;
 	iLeft = iRight = false;
+
+	// Frames that are only looked ahead at (see JAGUAR.CPP) aren't in movies
+	if (movieFile && !jaguarRunningAhead)
+		JoystickMovieEndFrame();
 }
 
 
@@ -69,11 +124,125 @@ void JoystickReset(void)
 	memset(joystick_ram, 0x00, 4);
 	memset(joypad0Buttons, 0, 21);
 	memset(joypad1Buttons, 0, 21);
+	latchedButtons = 0;
+	memset(&latency, 0, sizeof(latency));
+}
+
+
+//
+// See STATE.CPP. What the host is holding down isn't part of the machine, but
+// what it was last latched as is, so anything that changes while looking
+// ahead gets latched again for real.
+//
+void JoystickSnapshot(void)
+{
+	SNAPSHOT(joystick_ram);
+	SNAPSHOT(joypad0Buttons);
+	SNAPSHOT(joypad1Buttons);
+	SNAPSHOT(audioEnabled);
+	SNAPSHOT(joysticksEnabled);
+	SNAPSHOT(latchedButtons);
+	SNAPSHOT(latency);
 }
 
 
 void JoystickDone(void)
 {
+	if (latency.changes)
+		WriteLog("JOYSTICK: Saw %llu changes in host input, %.2f ms after they happened on average (%.2f ms at worst)\n",
+			(unsigned long long)latency.changes, latency.totalUsec / (latency.changes * 1000.0),
+			latency.maxUsec / 1000.0);
+
+	JoystickMovieStop();
+}
+
+
+//
+// Press or let go of a button on pad #0 or #1, from the host side
+//
+void JoystickHostSetButton(uint32_t pad, uint32_t button, bool pressed)
+{
+	uint64_t bit = (uint64_t)1 << ((pad * 32) + button);
+	uint64_t old;
+
+	if (pressed)
+		old = hostButtons.fetch_or(bit, std::memory_order_relaxed);
+	else
+		old = hostButtons.fetch_and(~bit, std::memory_order_relaxed);
+
+	if (((old & bit) != 0) != pressed)
+		hostChangeTime.store(GetMicroseconds(), std::memory_order_release);
+}
+
+
+//
+// Something to call (at most once a millisecond) to bring the host buttons up
+// to date when the joypads are read--gamepads that have to be polled, say
+//
+void JoystickSetHostPoll(void (* poll)(void))
+{
+	hostPoll = poll;
+}
+
+
+void JoystickGetLatency(JoystickLatency & stats)
+{
+	stats = latency;
+}
+
+
+//
+// Bring the joypads up to what the host has right now. Only buttons the host
+// changed are touched, so whatever else sets joypad0/1Buttons (an input
+// script, say) isn't stepped on.
+//
+static void JoystickLatch(void)
+{
+	if (hostPoll)
+	{
+		uint64_t now = GetMicroseconds();
+
+		if ((now - lastPollTime) >= HOST_POLL_USEC)
+		{
+			lastPollTime = now;
+			hostPoll();
+		}
+	}
+
+	uint64_t buttons = hostButtons.load(std::memory_order_acquire);
+	uint64_t changed = buttons ^ latchedButtons;
+
+	if (changed == 0)
+		return;
+
+	for(uint32_t i=BUTTON_FIRST; i<=BUTTON_LAST; i++)
+	{
+		if (changed & ((uint64_t)1 << i))
+			joypad0Buttons[i] = (buttons >> i) & 0x01;
+
+		if (changed & ((uint64_t)1 << (32 + i)))
+			joypad1Buttons[i] = (buttons >> (32 + i)) & 0x01;
+	}
+
+	latchedButtons = buttons;
+
+	uint64_t lag = GetMicroseconds() - hostChangeTime.load(std::memory_order_acquire);
+	latency.changes++;
+	latency.totalUsec += lag;
+
+	if (lag > latency.maxUsec)
+		latency.maxUsec = lag;
+}
+
+
+static uint64_t GetMicroseconds(void)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return (uint64_t)(((double)SDL_GetPerformanceCounter() * 1000000.0)
+		/ (double)SDL_GetPerformanceFrequency());
+#else
+	return (uint64_t)SDL_GetTicks() * 1000;
+#endif
 }
 
 
@@ -95,9 +264,15 @@ uint16_t JoystickReadWord(uint32_t offset)
 		if (!joysticksEnabled)
 			return 0xFFFF;
 
+		uint16_t data = 0xFFFF;
+
+		if (movieFile && !movieRecording && !jaguarRunningAhead && JoystickMoviePlayRead('J', data))
+			return data;
+
+		JoystickLatch();
+
 		// Joystick data returns active low for buttons pressed, high for non-
 		// pressed.
-		uint16_t data = 0xFFFF;
 		uint8_t offset0 = joypad0Offset[joystick_ram[1] & 0x0F];
 		uint8_t offset1 = joypad1Offset[(joystick_ram[1] >> 4) & 0x0F];
 
@@ -123,6 +298,9 @@ uint16_t JoystickReadWord(uint32_t offset)
 			data &= msk2[offset1 / 4];
 		}
 
+		if (movieRecording && !jaguarRunningAhead)
+			JoystickMovieRecordRead('J', data);
+
 		return data;
 	}
 	else if (offset == 2)
@@ -134,6 +312,11 @@ uint16_t JoystickReadWord(uint32_t offset)
 		if (!joysticksEnabled)
 			return data;
 
+		if (movieFile && !movieRecording && !jaguarRunningAhead && JoystickMoviePlayRead('B', data))
+			return data;
+
+		JoystickLatch();
+
 		// Joystick data returns active low for buttons pressed, high for non-
 		// pressed.
 		uint8_t offset0 = joypad0Offset[joystick_ram[1] & 0x0F];
@@ -159,6 +342,9 @@ uint16_t JoystickReadWord(uint32_t offset)
 				data &= (joypad1Buttons[mask[offset1][1]] ? 0xFFFB : 0xFFFF);
 		}
 
+		if (movieRecording && !jaguarRunningAhead)
+			JoystickMovieRecordRead('B', data);
+
 		return data;
 	}
 
@@ -180,3 +366,203 @@ void JoystickWriteWord(uint32_t offset, uint16_t data)
 	}
 }
 
+
+
+static void JoystickMovieCurrentInfo(JoystickMovieInfo & info)
+{
+	info.romCRC = jaguarMainROMCRC32;
+	info.ntsc = vjs.hardwareTypeNTSC;
+	info.bios = vjs.useJaguarBIOS;
+	info.biosType = vjs.biosType;
+	info.gpu = vjs.GPUEnabled;
+	info.dsp = vjs.DSPEnabled;
+	info.idleSkip = vjs.idleSkip;
+	info.dspEngine = vjs.dspEngine;
+}
+
+
+//
+// Start recording a movie. For it to play back, this has to happen at the
+// same point that playback will start from--straight after a reset, say.
+//
+bool JoystickMovieRecord(const char * filename)
+{
+	JoystickMovieStop();
+	movieFile = gzopen(filename, "wb");
+
+	if (movieFile == NULL)
+	{
+		WriteLog("JOYSTICK: Could not create movie \"%s\"!\n", filename);
+		return false;
+	}
+
+	JoystickMovieInfo info;
+	JoystickMovieCurrentInfo(info);
+	uint32_t header[2] = { MOVIE_VERSION, sizeof(JoystickMovieInfo) };
+	gzwrite(movieFile, "VJMOVIE1", 8);
+	gzwrite(movieFile, header, sizeof(header));
+	gzwrite(movieFile, &info, sizeof(info));
+	movieRecording = true;
+	memset(&movieStats, 0, sizeof(movieStats));
+	WriteLog("JOYSTICK: Recording movie \"%s\"...\n", filename);
+
+	return true;
+}
+
+
+static gzFile JoystickMovieOpen(const char * filename, JoystickMovieInfo & info)
+{
+	gzFile fp = gzopen(filename, "rb");
+
+	if (fp == NULL)
+	{
+		WriteLog("JOYSTICK: Could not open movie \"%s\"!\n", filename);
+		return NULL;
+	}
+
+	char magic[8];
+	uint32_t header[2];
+
+	if ((gzread(fp, magic, 8) != 8) || (memcmp(magic, "VJMOVIE1", 8) != 0)
+		|| (gzread(fp, header, sizeof(header)) != sizeof(header))
+		|| (header[0] != MOVIE_VERSION) || (header[1] != sizeof(JoystickMovieInfo))
+		|| (gzread(fp, &info, sizeof(info)) != sizeof(info)))
+	{
+		WriteLog("JOYSTICK: \"%s\" is not a movie (or not one we can read)!\n", filename);
+		gzclose(fp);
+		return NULL;
+	}
+
+	return fp;
+}
+
+
+//
+// What a movie was recorded with, so whoever is about to play it back can set
+// things up the same way first
+//
+bool JoystickMovieReadInfo(const char * filename, JoystickMovieInfo & info)
+{
+	gzFile fp = JoystickMovieOpen(filename, info);
+
+	if (fp == NULL)
+		return false;
+
+	gzclose(fp);
+	return true;
+}
+
+
+//
+// Start playing a movie back. Anything that differs from when it was recorded
+// is only warned about, since it may not matter; the host's joypads are
+// ignored until it runs out.
+//
+bool JoystickMoviePlay(const char * filename)
+{
+	JoystickMovieStop();
+	JoystickMovieInfo info, current;
+	movieFile = JoystickMovieOpen(filename, info);
+
+	if (movieFile == NULL)
+		return false;
+
+	JoystickMovieCurrentInfo(current);
+
+	if (info.romCRC != current.romCRC)
+		WriteLog("JOYSTICK: Movie was recorded with ROM %08X, not %08X!\n",
+			(unsigned int)info.romCRC, (unsigned int)current.romCRC);
+
+	if (memcmp(&info.ntsc, &current.ntsc, sizeof(info) - sizeof(info.romCRC)) != 0)
+		WriteLog("JOYSTICK: Movie was recorded with different settings (NTSC %u, BIOS %u/%u, GPU %u, DSP %u, idle skip %u, DSP engine %u)!\n",
+			info.ntsc, info.bios, info.biosType, info.gpu, info.dsp, info.idleSkip, info.dspEngine);
+
+	movieRecording = false;
+	movieNextTag = gzgetc(movieFile);
+	memset(&movieStats, 0, sizeof(movieStats));
+	WriteLog("JOYSTICK: Playing movie \"%s\"...\n", filename);
+
+	return true;
+}
+
+
+void JoystickMovieStop(void)
+{
+	if (movieFile == NULL)
+		return;
+
+	gzclose(movieFile);
+	movieFile = NULL;
+	WriteLog("JOYSTICK: Movie %s: %llu frames, %llu reads, %llu desyncs\n",
+		(movieRecording ? "recorded" : "played back"), (unsigned long long)movieStats.frames,
+		(unsigned long long)movieStats.reads, (unsigned long long)movieStats.desyncs);
+	movieRecording = false;
+}
+
+
+bool JoystickMovieIsRunning(void)
+{
+	return (movieFile != NULL);
+}
+
+
+void JoystickGetMovieStats(JoystickMovieStats & stats)
+{
+	stats = movieStats;
+}
+
+
+static bool JoystickMoviePlayRead(int tag, uint16_t & data)
+{
+	if (movieNextTag != tag)
+	{
+		movieStats.desyncs++;
+		return false;
+	}
+
+	if (gzread(movieFile, &data, sizeof(data)) != sizeof(data))
+	{
+		movieNextTag = -1;
+		movieStats.desyncs++;
+		return false;
+	}
+
+	movieNextTag = gzgetc(movieFile);
+	movieStats.reads++;
+
+	return true;
+}
+
+
+static void JoystickMovieRecordRead(int tag, uint16_t data)
+{
+	gzputc(movieFile, tag);
+	gzwrite(movieFile, &data, sizeof(data));
+	movieStats.reads++;
+}
+
+
+static void JoystickMovieEndFrame(void)
+{
+	movieStats.frames++;
+
+	if (movieRecording)
+	{
+		gzputc(movieFile, 'F');
+		return;
+	}
+
+	// Whatever the Jaguar didn't get to this time around is no use now
+	while ((movieNextTag == 'J') || (movieNextTag == 'B'))
+	{
+		uint16_t data;
+		gzread(movieFile, &data, sizeof(data));
+		movieNextTag = gzgetc(movieFile);
+		movieStats.desyncs++;
+	}
+
+	movieNextTag = gzgetc(movieFile);
+
+	if (movieNextTag == -1)
+		JoystickMovieStop();
+}
@@ -6,6 +6,7 @@
 #define __JOYSTICK_H__
 
 #include <stdint.h>
+#include "machine.h"
 
 enum { BUTTON_FIRST = 0, BUTTON_U = 0,
 BUTTON_D = 1,
@@ -39,11 +40,47 @@ void JoystickWriteWord(uint32_t, uint16_t);
 //uint8_t JoystickReadByte(uint32_t);
 uint16_t JoystickReadWord(uint32_t);
 void JoystickExec(void);
+void JoystickSnapshot(void);
 
-extern uint8_t joypad0Buttons[];
-extern uint8_t joypad1Buttons[];
-extern bool audioEnabled;
-extern bool joysticksEnabled;
+// Host input (see joystick.cpp)
+
+struct JoystickLatency
+{
+	uint64_t changes;						// Changes seen by the Jaguar
+	uint64_t totalUsec, maxUsec;			// From the host to the Jaguar reading them
+};
+
+void JoystickHostSetButton(uint32_t pad, uint32_t button, bool pressed);
+void JoystickSetHostPoll(void (* poll)(void));
+void JoystickGetLatency(JoystickLatency & stats);
+
+// Input movies (see joystick.cpp)
+
+struct JoystickMovieInfo
+{
+	uint32_t romCRC;						// jaguarMainROMCRC32
+	uint32_t ntsc, bios, biosType;			// What vjs had when it was recorded
+	uint32_t gpu, dsp, idleSkip, dspEngine;
+};
+
+struct JoystickMovieStats
+{
+	uint64_t frames;
+	uint64_t reads;							// Recorded or played back
+	uint64_t desyncs;						// Reads that didn't match the movie
+};
+
+bool JoystickMovieRecord(const char * filename);
+bool JoystickMoviePlay(const char * filename);
+bool JoystickMovieReadInfo(const char * filename, JoystickMovieInfo & info);
+void JoystickMovieStop(void);
+bool JoystickMovieIsRunning(void);
+void JoystickGetMovieStats(JoystickMovieStats & stats);
+
+extern MACHINE_STATE uint8_t joypad0Buttons[];
+extern MACHINE_STATE uint8_t joypad1Buttons[];
+extern MACHINE_STATE bool audioEnabled;
+extern MACHINE_STATE bool joysticksEnabled;
 
 #endif	// __JOYSTICK_H__
 
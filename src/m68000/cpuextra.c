@@ -11,15 +11,15 @@
 #include "inlines.h"
 
 
-uint16_t last_op_for_exception_3;		// Opcode of faulting instruction
-uint32_t last_addr_for_exception_3;		// PC at fault time
-uint32_t last_fault_for_exception_3;	// Address that generated the exception
+MACHINE_STATE uint16_t last_op_for_exception_3;		// Opcode of faulting instruction
+MACHINE_STATE uint32_t last_addr_for_exception_3;		// PC at fault time
+MACHINE_STATE uint32_t last_fault_for_exception_3;	// Address that generated the exception
 
-int OpcodeFamily;						// Used by cpuemu.c...
-int BusCyclePenalty = 0;				// Used by cpuemu.c...
-int CurrentInstrCycles;
+MACHINE_STATE int OpcodeFamily;						// Used by cpuemu.c...
+MACHINE_STATE int BusCyclePenalty = 0;				// Used by cpuemu.c...
+MACHINE_STATE int CurrentInstrCycles;
 
-struct regstruct regs;
+MACHINE_STATE struct regstruct regs;
 
 
 //
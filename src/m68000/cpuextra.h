@@ -12,17 +12,17 @@ struct cputbl
 	uint16_t opcode;
 };
 
-extern uint16_t last_op_for_exception_3;	/* Opcode of faulting instruction */
-extern uint32_t last_addr_for_exception_3;	/* PC at fault time */
-extern uint32_t last_fault_for_exception_3;	/* Address that generated the exception */
+extern MACHINE_STATE uint16_t last_op_for_exception_3;	/* Opcode of faulting instruction */
+extern MACHINE_STATE uint32_t last_addr_for_exception_3;	/* PC at fault time */
+extern MACHINE_STATE uint32_t last_fault_for_exception_3;	/* Address that generated the exception */
 
 /* Family of the latest instruction executed (to check for pairing) */
-extern int OpcodeFamily;			/* see instrmnem in readcpu.h */
+extern MACHINE_STATE int OpcodeFamily;			/* see instrmnem in readcpu.h */
 
 /* How many cycles to add to the current instruction in case a "misaligned" bus access is made */
 /* (used when addressing mode is d8(an,ix)) */
-extern int BusCyclePenalty;
-extern int CurrentInstrCycles;
+extern MACHINE_STATE int BusCyclePenalty;
+extern MACHINE_STATE int CurrentInstrCycles;
 
 extern uint32_t get_disp_ea_000(uint32_t base, uint32_t dp);
 extern void MakeSR(void);
@@ -19,13 +19,13 @@
 
 // Stuff from m68kinterface.c
 extern unsigned long IllegalOpcode(uint32_t opcode);
-extern cpuop_func * cpuFunctionTable[65536];
+extern MACHINE_STATE cpuop_func * cpuFunctionTable[65536];
 
 // Prototypes
 void HandleMovem(char * output, uint16_t data, int direction);
 
 // Local "global" variables
-static long int m68kpc_offset;
+static MACHINE_STATE long int m68kpc_offset;
 
 #if 0
 #define get_ibyte_1(o) get_byte(regs.pc + (regs.pc_p - regs.pc_oldp) + (o) + 1)
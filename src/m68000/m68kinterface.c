@@ -12,6 +12,7 @@
 //
 
 #include "m68kinterface.h"
+#include <string.h>
 //#include <pthread.h>
 #include "cpudefs.h"
 #include "inlines.h"
@@ -35,6 +36,9 @@
 #define EXCEPTION_INTERRUPT_AUTOVECTOR    24
 #define EXCEPTION_TRAP_BASE               32
 
+// Longest loop (in bytes, branch included) we'll consider for idle skipping
+#define IDLE_LOOP_MAX_BYTES               32
+
 // These are found in obj/cpustbl.c (generated by gencpu)
 
 //extern const struct cputbl op_smalltbl_0_ff[];	/* 68040 */
@@ -55,16 +59,41 @@ STATIC_INLINE void m68ki_stack_frame_3word(uint32_t pc, uint32_t sr);
 unsigned long IllegalOpcode(uint32_t opcode);
 void BuildCPUFunctionTable(void);
 void m68k_set_irq2(unsigned int intLevel);
+static int IsIdleLoop(uint32_t branchPC);
 
 // Local "Global" vars
-static int32_t initialCycles;
-cpuop_func * cpuFunctionTable[65536];
+static MACHINE_STATE int32_t initialCycles;
+MACHINE_STATE cpuop_func * cpuFunctionTable[65536];
 
 // By virtue of the fact that m68k_set_irq() can be called asychronously by
 // another thread, we need something along the lines of this:
-static int checkForIRQToHandle = 0;
+static MACHINE_STATE int checkForIRQToHandle = 0;
 //static pthread_mutex_t executionLock = PTHREAD_MUTEX_INITIALIZER;
-static int IRQLevelToHandle = 0;
+static MACHINE_STATE int IRQLevelToHandle = 0;
+
+// Idle loop detection: what the CPU looked like the last time it came around
+// a short backward branch. If it comes around again looking exactly the same,
+// and nothing got written in between, it's going to keep doing that until
+// something outside of it changes.
+struct IdleState
+{
+	uint32_t regs[16];
+	uint32_t usp, isp;
+	unsigned int c, z, n, v, x;
+	int intmask;
+	uint8_t s;
+};
+
+MACHINE_STATE uint32_t m68k_write_count = 0;
+static MACHINE_STATE int idleSkip = 1;
+static MACHINE_STATE uint32_t idleLoopPC = 0xFFFFFFFF;
+static MACHINE_STATE uint32_t idleWriteCount;
+static MACHINE_STATE struct IdleState idleState;
+static MACHINE_STATE uint64_t idleCycles = 0;
+
+// Where m68k_pc_watch_hit() is waiting for the CPU to get to
+static MACHINE_STATE uint32_t watchPC = 0xFFFFFFFF;
+static MACHINE_STATE int watchHit = 0;
 
 #if 0
 #define ADD_CYCLES(A)    m68ki_remaining_cycles += (A)
@@ -90,7 +119,7 @@ void Dasm(uint32_t offset, uint32_t qt)
 #ifdef CPU_DEBUG
 // back up a few instructions...
 //offset -= 100;
-	static char buffer[2048];//, mem[64];
+	static MACHINE_STATE char buffer[2048];//, mem[64];
 	int pc = offset, oldpc;
 	uint32_t i;
 
@@ -147,7 +176,7 @@ void m68k_set_cpu_type(unsigned int type)
 // Pulse the RESET line on the CPU
 void m68k_pulse_reset(void)
 {
-	static uint32_t emulation_initialized = 0;
+	static MACHINE_STATE uint32_t emulation_initialized = 0;
 
 	// The first call to this function initializes the opcode handler jump table
 	if (!emulation_initialized)
@@ -341,13 +370,28 @@ if (inRoutine)
 #ifdef M68K_HOOK_FUNCTION
 		M68KInstructionHook();
 #endif
+		uint32_t pc = m68k_getpc();
 		uint32_t opcode = get_iword(0);
+
+		if (pc == watchPC)
+			watchHit = 1;
 //if ((opcode & 0xFFF8) == 0x31C0)
 //{
 //	printf("MOVE.W D%i, EA\n", opcode & 0x07);
 //}
 		int32_t cycles = (int32_t)(*cpuFunctionTable[opcode])(opcode);
 		regs.remainingCycles -= cycles;
+
+		// If we just went backward a little ways (or branched to ourselves,
+		// like BRA.S *), we might be spinning our wheels waiting on something;
+		// if so, skip to the end of the slice (which is where the next event
+		// is).
+		if (idleSkip && (m68k_getpc() <= pc) && IsIdleLoop(pc)
+			&& (regs.remainingCycles > 0))
+		{
+			idleCycles += regs.remainingCycles;
+			regs.remainingCycles = 0;
+		}
 //		pthread_mutex_unlock(&executionLock);
 
 //printf("Executed opcode $%04X (%i cycles)...\n", opcode, cycles);
@@ -375,6 +419,90 @@ if (inRoutine)
 }
 
 
+//
+// Called when the instruction at <branchPC> just took us backward (or back to
+// itself). Says whether we came back around to the same spot in exactly the
+// same state as the last time, without writing anything in between.
+//
+static int IsIdleLoop(uint32_t branchPC)
+{
+	uint32_t target = m68k_getpc();
+
+	if ((branchPC - target) > IDLE_LOOP_MAX_BYTES)
+		return 0;
+
+	struct IdleState state;
+	memset(&state, 0, sizeof(state));
+	memcpy(state.regs, regs.regs, sizeof(state.regs));
+	state.usp = regs.usp, state.isp = regs.isp;
+	state.c = regs.c, state.z = regs.z, state.n = regs.n, state.v = regs.v;
+	state.x = regs.x, state.intmask = regs.intmask, state.s = regs.s;
+
+	int idle = (target == idleLoopPC) && (m68k_write_count == idleWriteCount)
+		&& (memcmp(&state, &idleState, sizeof(state)) == 0);
+
+	idleLoopPC = target;
+	idleWriteCount = m68k_write_count;
+	idleState = state;
+
+	return idle;
+}
+
+
+void m68k_set_idle_skip(int enable)
+{
+	idleSkip = enable;
+	idleLoopPC = 0xFFFFFFFF;
+}
+
+
+// Number of cycles we didn't have to run because the CPU was idling
+uint64_t m68k_get_idle_cycles(void)
+{
+	return idleCycles;
+}
+
+
+// Hand everything that makes up the CPU to <copy>, a piece at a time. It's
+// the same calls for taking a snapshot as for putting one back (see
+// STATE.CPP in the core).
+void m68k_snapshot(void (* copy)(void * data, uint32_t size))
+{
+	copy(&regs, sizeof(regs));
+	copy(&last_op_for_exception_3, sizeof(last_op_for_exception_3));
+	copy(&last_addr_for_exception_3, sizeof(last_addr_for_exception_3));
+	copy(&last_fault_for_exception_3, sizeof(last_fault_for_exception_3));
+	copy(&OpcodeFamily, sizeof(OpcodeFamily));
+	copy(&BusCyclePenalty, sizeof(BusCyclePenalty));
+	copy(&CurrentInstrCycles, sizeof(CurrentInstrCycles));
+	copy(&initialCycles, sizeof(initialCycles));
+	copy(&checkForIRQToHandle, sizeof(checkForIRQToHandle));
+	copy(&IRQLevelToHandle, sizeof(IRQLevelToHandle));
+	copy(&m68k_write_count, sizeof(m68k_write_count));
+	copy(&idleLoopPC, sizeof(idleLoopPC));
+	copy(&idleWriteCount, sizeof(idleWriteCount));
+	copy(&idleState, sizeof(idleState));
+	copy(&idleCycles, sizeof(idleCycles));
+	copy(&watchPC, sizeof(watchPC));
+	copy(&watchHit, sizeof(watchHit));
+}
+
+
+// Watch for the CPU getting to <address> (0xFFFFFFFF to stop watching)
+void m68k_set_pc_watch(uint32_t address)
+{
+	watchPC = address;
+	watchHit = 0;
+}
+
+
+// Whether it's been there since m68k_set_pc_watch()
+int m68k_pc_watch_hit(void)
+{
+	return watchHit;
+}
+
+
 void m68k_set_irq(unsigned int intLevel)
 {
 	// We need to check for stopped state as well...
@@ -662,12 +790,26 @@ unsigned int m68k_disassemble(char * str_buff, unsigned int pc, unsigned int cpu
 }
 #endif
 
-int m68k_cycles_run(void) {}              /* Number of cycles run so far */
-int m68k_cycles_remaining(void) {}        /* Number of cycles left */
 //void m68k_modify_timeslice(int cycles) {} /* Modify cycles left */
 //void m68k_end_timeslice(void) {}          /* End timeslice now */
 
 
+//
+// Number of cycles run so far in this timeslice. Inside an instruction, this
+// is up to the start of it.
+//
+int m68k_cycles_run(void)
+{
+	return initialCycles - regs.remainingCycles;
+}
+
+
+int m68k_cycles_remaining(void)
+{
+	return regs.remainingCycles;
+}
+
+
 void m68k_modify_timeslice(int cycles)
 {
 	regs.remainingCycles = cycles;
@@ -680,7 +822,8 @@ void m68k_end_timeslice(void)
 	m68ki_initial_cycles = GET_CYCLES();
 	SET_CYCLES(0);
 #else
-	initialCycles = regs.remainingCycles;
+	// Whatever's left over was never run
+	initialCycles -= regs.remainingCycles;
 	regs.remainingCycles = 0;
 #endif
 }
@@ -11,6 +11,9 @@
 #ifndef __M68KINTERFACE_H__
 #define __M68KINTERFACE_H__
 
+#include <stdint.h>
+#include "../machine.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -101,6 +104,20 @@ void M68KInstructionHook(void);
 void M68KDebugHalt(void);
 void M68KDebugResume(void);
 
+// Idle loop detection. The user's m68k_write_memory_* functions must bump
+// m68k_write_count on every write for it to work.
+extern MACHINE_STATE uint32_t m68k_write_count;
+void m68k_set_idle_skip(int enable);
+uint64_t m68k_get_idle_cycles(void);
+
+// In-memory snapshots
+void m68k_snapshot(void (* copy)(void * data, uint32_t size));
+
+// For noticing when the CPU gets somewhere (the BIOS handing over to a cart,
+// say), without the cost of M68KInstructionHook()
+void m68k_set_pc_watch(uint32_t address);
+int m68k_pc_watch_hit(void);
+
 /* Peek at the internals of a CPU context.  This can either be a context
  * retrieved using m68k_get_context() or the currently running context.
  * If context is NULL, the currently running CPU context will be used.
@@ -24,7 +24,7 @@
 
 #include "readcpu.h"
 
-int nr_cpuop_funcs;
+MACHINE_STATE int nr_cpuop_funcs;
 
 const struct mnemolookup lookuptab[] = {
 	{ i_ILLG, "ILLEGAL" },
@@ -154,7 +154,7 @@ const struct mnemolookup lookuptab[] = {
 };
 
 
-struct instr * table68k;
+MACHINE_STATE struct instr * table68k;
 
 
 STATIC_INLINE amodes mode_from_str(const char * str)
@@ -953,7 +953,7 @@ void read_table68k(void)
 }
 
 
-static int mismatch;
+static MACHINE_STATE int mismatch;
 
 
 static void handle_merges (long int opcode)
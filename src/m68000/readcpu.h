@@ -88,7 +88,7 @@ struct instr_def {
 extern const struct instr_def defs68k[];
 extern int n_defs68k;
 
-extern struct instr {
+extern MACHINE_STATE struct instr {
     long int handler;
     unsigned char dreg;
     unsigned char sreg;
@@ -114,6 +114,6 @@ extern struct instr {
 extern void read_table68k(void);
 extern void do_merges(void);
 extern int get_no_mismatches(void);
-extern int nr_cpuop_funcs;
+extern MACHINE_STATE int nr_cpuop_funcs;
 
 #endif /* ifndef UAE_READCPU_H */
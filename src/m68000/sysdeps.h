@@ -33,6 +33,7 @@
 
 #include <stdarg.h>
 #include <stdint.h>
+#include "../machine.h"
 
 
 #if EEXIST == ENOTEMPTY
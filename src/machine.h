@@ -0,0 +1,30 @@
+//
+// MACHINE.H: Per-machine state
+//
+// Everything that makes up one emulated Jaguar (memory, the CPU & chip
+// registers, the event queues, settings, etc.) is kept in globals marked with
+// MACHINE_STATE. Normally that expands to nothing. Built with
+// JAGUAR_MULTI_MACHINE defined (e.g. make CPPFLAGS=-DJAGUAR_MULTI_MACHINE),
+// it makes them thread local instead: every thread that calls JaguarInit()
+// then gets a whole Jaguar of its own, so several can be run at once in the
+// same process.
+//
+// N.B.: In that case, the DSP has to be run on the same thread as the rest of
+//       its machine (by calling SDLSoundCallback() directly), instead of from
+//       the host's audio thread.
+//
+
+#ifndef __MACHINE_H__
+#define __MACHINE_H__
+
+#ifdef JAGUAR_MULTI_MACHINE
+#ifdef __cplusplus
+#define MACHINE_STATE	thread_local
+#else
+#define MACHINE_STATE	__thread
+#endif
+#else
+#define MACHINE_STATE
+#endif
+
+#endif	// __MACHINE_H__
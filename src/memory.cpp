@@ -28,16 +28,29 @@ N.B.: Jaguar RAM is only 2 megs. ROM is 6 megs max, IO is 128K
 */
 
 #include "memory.h"
+#include "state.h"
 
 // N.B.: 6M of RAM is wasted in this arrangement (main RAM mirrored there)...
 //       From $200000-7FFFFF
+#ifdef JAGUAR_MULTI_MACHINE
+// Far too big to go in every thread's TLS block (which comes out of its
+// stack), so each machine gets its memory space from the heap instead
+static MACHINE_STATE struct MemorySpace
+{
+	uint8_t * memory;
+	MemorySpace() { memory = new uint8_t[0xF20000](); }
+	~MemorySpace() { delete[] memory; }
+} memorySpace;
+MACHINE_STATE uint8_t * jagMemSpace = memorySpace.memory;
+#else
 uint8_t jagMemSpace[0xF20000];					// The entire memory space of the Jaguar...!
+#endif
 
-uint8_t * jaguarMainRAM = &jagMemSpace[0x000000];
-uint8_t * jaguarMainROM = &jagMemSpace[0x800000];
-uint8_t * cdRAM         = &jagMemSpace[0xDFFF00];
-uint8_t * gpuRAM        = &jagMemSpace[0xF03000];
-uint8_t * dspRAM        = &jagMemSpace[0xF1B000];
+MACHINE_STATE uint8_t * jaguarMainRAM = &jagMemSpace[0x000000];
+MACHINE_STATE uint8_t * jaguarMainROM = &jagMemSpace[0x800000];
+MACHINE_STATE uint8_t * cdRAM         = &jagMemSpace[0xDFFF00];
+MACHINE_STATE uint8_t * gpuRAM        = &jagMemSpace[0xF03000];
+MACHINE_STATE uint8_t * dspRAM        = &jagMemSpace[0xF1B000];
 
 #if 0
 union Word
@@ -118,17 +131,17 @@ unsigned long ByteSwap1 (unsigned long nLongNumber)
 //Not sure if this is a good approach yet...
 //should be if we use proper aliasing, and htonl and friends...
 #if 1
-uint32_t & butch     = *((uint32_t *)&jagMemSpace[0xDFFF00]);	// base of Butch == interrupt control register, R/W
-uint32_t & dscntrl   = *((uint32_t *)&jagMemSpace[0xDFFF04]);	// DSA control register, R/W
-uint16_t & ds_data   = *((uint16_t *)&jagMemSpace[0xDFFF0A]);	// DSA TX/RX data, R/W
-uint32_t & i2cntrl   = *((uint32_t *)&jagMemSpace[0xDFFF10]);	// i2s bus control register, R/W
-uint32_t & sbcntrl   = *((uint32_t *)&jagMemSpace[0xDFFF14]);	// CD subcode control register, R/W
-uint32_t & subdata   = *((uint32_t *)&jagMemSpace[0xDFFF18]);	// Subcode data register A
-uint32_t & subdatb   = *((uint32_t *)&jagMemSpace[0xDFFF1C]);	// Subcode data register B
-uint32_t & sb_time   = *((uint32_t *)&jagMemSpace[0xDFFF20]);	// Subcode time and compare enable (D24)
-uint32_t & fifo_data = *((uint32_t *)&jagMemSpace[0xDFFF24]);	// i2s FIFO data
-uint32_t & i2sdat2   = *((uint32_t *)&jagMemSpace[0xDFFF28]);	// i2s FIFO data (old)
-uint32_t & i2sbus    = *((uint32_t *)&jagMemSpace[0xDFFF2C]);	// BUTCH's I2S interface to EEPROM
+MACHINE_STATE uint32_t & butch     = *((uint32_t *)&jagMemSpace[0xDFFF00]);	// base of Butch == interrupt control register, R/W
+MACHINE_STATE uint32_t & dscntrl   = *((uint32_t *)&jagMemSpace[0xDFFF04]);	// DSA control register, R/W
+MACHINE_STATE uint16_t & ds_data   = *((uint16_t *)&jagMemSpace[0xDFFF0A]);	// DSA TX/RX data, R/W
+MACHINE_STATE uint32_t & i2cntrl   = *((uint32_t *)&jagMemSpace[0xDFFF10]);	// i2s bus control register, R/W
+MACHINE_STATE uint32_t & sbcntrl   = *((uint32_t *)&jagMemSpace[0xDFFF14]);	// CD subcode control register, R/W
+MACHINE_STATE uint32_t & subdata   = *((uint32_t *)&jagMemSpace[0xDFFF18]);	// Subcode data register A
+MACHINE_STATE uint32_t & subdatb   = *((uint32_t *)&jagMemSpace[0xDFFF1C]);	// Subcode data register B
+MACHINE_STATE uint32_t & sb_time   = *((uint32_t *)&jagMemSpace[0xDFFF20]);	// Subcode time and compare enable (D24)
+MACHINE_STATE uint32_t & fifo_data = *((uint32_t *)&jagMemSpace[0xDFFF24]);	// i2s FIFO data
+MACHINE_STATE uint32_t & i2sdat2   = *((uint32_t *)&jagMemSpace[0xDFFF28]);	// i2s FIFO data (old)
+MACHINE_STATE uint32_t & i2sbus    = *((uint32_t *)&jagMemSpace[0xDFFF2C]);	// BUTCH's I2S interface to EEPROM
 #else
 uint32_t butch, dscntrl, ds_data, i2cntrl, sbcntrl, subdata, subdatb, sb_time, fifo_data, i2sdat2, i2sbus;
 #endif
@@ -153,118 +166,136 @@ uint32_t butch, dscntrl, ds_data, i2cntrl, sbcntrl, subdata, subdatb, sb_time, f
 
 // Look at <endian.h> and see if that header is portable or not.
 
-uint16_t & memcon1   = *((uint16_t *)&jagMemSpace[0xF00000]);
-uint16_t & memcon2   = *((uint16_t *)&jagMemSpace[0xF00002]);
-uint16_t & hc        = *((uint16_t *)&jagMemSpace[0xF00004]);
-uint16_t & vc        = *((uint16_t *)&jagMemSpace[0xF00006]);
-uint16_t & lph       = *((uint16_t *)&jagMemSpace[0xF00008]);
-uint16_t & lpv       = *((uint16_t *)&jagMemSpace[0xF0000A]);
-uint64_t & obData    = *((uint64_t *)&jagMemSpace[0xF00010]);
-uint32_t & olp       = *((uint32_t *)&jagMemSpace[0xF00020]);
-uint16_t & obf       = *((uint16_t *)&jagMemSpace[0xF00026]);
-uint16_t & vmode     = *((uint16_t *)&jagMemSpace[0xF00028]);
-uint16_t & bord1     = *((uint16_t *)&jagMemSpace[0xF0002A]);
-uint16_t & bord2     = *((uint16_t *)&jagMemSpace[0xF0002C]);
-uint16_t & hp        = *((uint16_t *)&jagMemSpace[0xF0002E]);
-uint16_t & hbb       = *((uint16_t *)&jagMemSpace[0xF00030]);
-uint16_t & hbe       = *((uint16_t *)&jagMemSpace[0xF00032]);
-uint16_t & hs        = *((uint16_t *)&jagMemSpace[0xF00034]);
-uint16_t & hvs       = *((uint16_t *)&jagMemSpace[0xF00036]);
-uint16_t & hdb1      = *((uint16_t *)&jagMemSpace[0xF00038]);
-uint16_t & hdb2      = *((uint16_t *)&jagMemSpace[0xF0003A]);
-uint16_t & hde       = *((uint16_t *)&jagMemSpace[0xF0003C]);
-uint16_t & vp        = *((uint16_t *)&jagMemSpace[0xF0003E]);
-uint16_t & vbb       = *((uint16_t *)&jagMemSpace[0xF00040]);
-uint16_t & vbe       = *((uint16_t *)&jagMemSpace[0xF00042]);
-uint16_t & vs        = *((uint16_t *)&jagMemSpace[0xF00044]);
-uint16_t & vdb       = *((uint16_t *)&jagMemSpace[0xF00046]);
-uint16_t & vde       = *((uint16_t *)&jagMemSpace[0xF00048]);
-uint16_t & veb       = *((uint16_t *)&jagMemSpace[0xF0004A]);
-uint16_t & vee       = *((uint16_t *)&jagMemSpace[0xF0004C]);
-uint16_t & vi        = *((uint16_t *)&jagMemSpace[0xF0004E]);
-uint16_t & pit0      = *((uint16_t *)&jagMemSpace[0xF00050]);
-uint16_t & pit1      = *((uint16_t *)&jagMemSpace[0xF00052]);
-uint16_t & heq       = *((uint16_t *)&jagMemSpace[0xF00054]);
-uint32_t & bg        = *((uint32_t *)&jagMemSpace[0xF00058]);
-uint16_t & int1      = *((uint16_t *)&jagMemSpace[0xF000E0]);
-uint16_t & int2      = *((uint16_t *)&jagMemSpace[0xF000E2]);
-uint8_t  * clut      =   (uint8_t *) &jagMemSpace[0xF00400];
-uint8_t  * lbuf      =   (uint8_t *) &jagMemSpace[0xF00800];
-uint32_t & g_flags   = *((uint32_t *)&jagMemSpace[0xF02100]);
-uint32_t & g_mtxc    = *((uint32_t *)&jagMemSpace[0xF02104]);
-uint32_t & g_mtxa    = *((uint32_t *)&jagMemSpace[0xF02108]);
-uint32_t & g_end     = *((uint32_t *)&jagMemSpace[0xF0210C]);
-uint32_t & g_pc      = *((uint32_t *)&jagMemSpace[0xF02110]);
-uint32_t & g_ctrl    = *((uint32_t *)&jagMemSpace[0xF02114]);
-uint32_t & g_hidata  = *((uint32_t *)&jagMemSpace[0xF02118]);
-uint32_t & g_divctrl = *((uint32_t *)&jagMemSpace[0xF0211C]);
-uint32_t g_remain;								// Dual register with $F0211C
-uint32_t & a1_base   = *((uint32_t *)&jagMemSpace[0xF02200]);
-uint32_t & a1_flags  = *((uint32_t *)&jagMemSpace[0xF02204]);
-uint32_t & a1_clip   = *((uint32_t *)&jagMemSpace[0xF02208]);
-uint32_t & a1_pixel  = *((uint32_t *)&jagMemSpace[0xF0220C]);
-uint32_t & a1_step   = *((uint32_t *)&jagMemSpace[0xF02210]);
-uint32_t & a1_fstep  = *((uint32_t *)&jagMemSpace[0xF02214]);
-uint32_t & a1_fpixel = *((uint32_t *)&jagMemSpace[0xF02218]);
-uint32_t & a1_inc    = *((uint32_t *)&jagMemSpace[0xF0221C]);
-uint32_t & a1_finc   = *((uint32_t *)&jagMemSpace[0xF02220]);
-uint32_t & a2_base   = *((uint32_t *)&jagMemSpace[0xF02224]);
-uint32_t & a2_flags  = *((uint32_t *)&jagMemSpace[0xF02228]);
-uint32_t & a2_mask   = *((uint32_t *)&jagMemSpace[0xF0222C]);
-uint32_t & a2_pixel  = *((uint32_t *)&jagMemSpace[0xF02230]);
-uint32_t & a2_step   = *((uint32_t *)&jagMemSpace[0xF02234]);
-uint32_t & b_cmd     = *((uint32_t *)&jagMemSpace[0xF02238]);
-uint32_t & b_count   = *((uint32_t *)&jagMemSpace[0xF0223C]);
-uint64_t & b_srcd    = *((uint64_t *)&jagMemSpace[0xF02240]);
-uint64_t & b_dstd    = *((uint64_t *)&jagMemSpace[0xF02248]);
-uint64_t & b_dstz    = *((uint64_t *)&jagMemSpace[0xF02250]);
-uint64_t & b_srcz1   = *((uint64_t *)&jagMemSpace[0xF02258]);
-uint64_t & b_srcz2   = *((uint64_t *)&jagMemSpace[0xF02260]);
-uint64_t & b_patd    = *((uint64_t *)&jagMemSpace[0xF02268]);
-uint32_t & b_iinc    = *((uint32_t *)&jagMemSpace[0xF02270]);
-uint32_t & b_zinc    = *((uint32_t *)&jagMemSpace[0xF02274]);
-uint32_t & b_stop    = *((uint32_t *)&jagMemSpace[0xF02278]);
-uint32_t & b_i3      = *((uint32_t *)&jagMemSpace[0xF0227C]);
-uint32_t & b_i2      = *((uint32_t *)&jagMemSpace[0xF02280]);
-uint32_t & b_i1      = *((uint32_t *)&jagMemSpace[0xF02284]);
-uint32_t & b_i0      = *((uint32_t *)&jagMemSpace[0xF02288]);
-uint32_t & b_z3      = *((uint32_t *)&jagMemSpace[0xF0228C]);
-uint32_t & b_z2      = *((uint32_t *)&jagMemSpace[0xF02290]);
-uint32_t & b_z1      = *((uint32_t *)&jagMemSpace[0xF02294]);
-uint32_t & b_z0      = *((uint32_t *)&jagMemSpace[0xF02298]);
-uint16_t & jpit1     = *((uint16_t *)&jagMemSpace[0xF10000]);
-uint16_t & jpit2     = *((uint16_t *)&jagMemSpace[0xF10002]);
-uint16_t & jpit3     = *((uint16_t *)&jagMemSpace[0xF10004]);
-uint16_t & jpit4     = *((uint16_t *)&jagMemSpace[0xF10006]);
-uint16_t & clk1      = *((uint16_t *)&jagMemSpace[0xF10010]);
-uint16_t & clk2      = *((uint16_t *)&jagMemSpace[0xF10012]);
-uint16_t & clk3      = *((uint16_t *)&jagMemSpace[0xF10014]);
-uint16_t & j_int     = *((uint16_t *)&jagMemSpace[0xF10020]);
-uint16_t & asidata   = *((uint16_t *)&jagMemSpace[0xF10030]);
-uint16_t & asictrl   = *((uint16_t *)&jagMemSpace[0xF10032]);
-uint16_t asistat;									// Dual register with $F10032
-uint16_t & asiclk    = *((uint16_t *)&jagMemSpace[0xF10034]);
-uint16_t & joystick  = *((uint16_t *)&jagMemSpace[0xF14000]);
-uint16_t & joybuts   = *((uint16_t *)&jagMemSpace[0xF14002]);
-uint32_t & d_flags   = *((uint32_t *)&jagMemSpace[0xF1A100]);
-uint32_t & d_mtxc    = *((uint32_t *)&jagMemSpace[0xF1A104]);
-uint32_t & d_mtxa    = *((uint32_t *)&jagMemSpace[0xF1A108]);
-uint32_t & d_end     = *((uint32_t *)&jagMemSpace[0xF1A10C]);
-uint32_t & d_pc      = *((uint32_t *)&jagMemSpace[0xF1A110]);
-uint32_t & d_ctrl    = *((uint32_t *)&jagMemSpace[0xF1A114]);
-uint32_t & d_mod     = *((uint32_t *)&jagMemSpace[0xF1A118]);
-uint32_t & d_divctrl = *((uint32_t *)&jagMemSpace[0xF1A11C]);
-uint32_t d_remain;								// Dual register with $F0211C
-uint32_t & d_machi   = *((uint32_t *)&jagMemSpace[0xF1A120]);
-uint16_t & ltxd      = *((uint16_t *)&jagMemSpace[0xF1A148]);
-uint16_t lrxd;									// Dual register with $F1A148
-uint16_t & rtxd      = *((uint16_t *)&jagMemSpace[0xF1A14C]);
-uint16_t rrxd;									// Dual register with $F1A14C
-uint8_t  & sclk      = *((uint8_t *) &jagMemSpace[0xF1A150]);
-uint8_t sstat;									// Dual register with $F1A150
-uint32_t & smode     = *((uint32_t *)&jagMemSpace[0xF1A154]);
+MACHINE_STATE uint16_t & memcon1   = *((uint16_t *)&jagMemSpace[0xF00000]);
+MACHINE_STATE uint16_t & memcon2   = *((uint16_t *)&jagMemSpace[0xF00002]);
+MACHINE_STATE uint16_t & hc        = *((uint16_t *)&jagMemSpace[0xF00004]);
+MACHINE_STATE uint16_t & vc        = *((uint16_t *)&jagMemSpace[0xF00006]);
+MACHINE_STATE uint16_t & lph       = *((uint16_t *)&jagMemSpace[0xF00008]);
+MACHINE_STATE uint16_t & lpv       = *((uint16_t *)&jagMemSpace[0xF0000A]);
+MACHINE_STATE uint64_t & obData    = *((uint64_t *)&jagMemSpace[0xF00010]);
+MACHINE_STATE uint32_t & olp       = *((uint32_t *)&jagMemSpace[0xF00020]);
+MACHINE_STATE uint16_t & obf       = *((uint16_t *)&jagMemSpace[0xF00026]);
+MACHINE_STATE uint16_t & vmode     = *((uint16_t *)&jagMemSpace[0xF00028]);
+MACHINE_STATE uint16_t & bord1     = *((uint16_t *)&jagMemSpace[0xF0002A]);
+MACHINE_STATE uint16_t & bord2     = *((uint16_t *)&jagMemSpace[0xF0002C]);
+MACHINE_STATE uint16_t & hp        = *((uint16_t *)&jagMemSpace[0xF0002E]);
+MACHINE_STATE uint16_t & hbb       = *((uint16_t *)&jagMemSpace[0xF00030]);
+MACHINE_STATE uint16_t & hbe       = *((uint16_t *)&jagMemSpace[0xF00032]);
+MACHINE_STATE uint16_t & hs        = *((uint16_t *)&jagMemSpace[0xF00034]);
+MACHINE_STATE uint16_t & hvs       = *((uint16_t *)&jagMemSpace[0xF00036]);
+MACHINE_STATE uint16_t & hdb1      = *((uint16_t *)&jagMemSpace[0xF00038]);
+MACHINE_STATE uint16_t & hdb2      = *((uint16_t *)&jagMemSpace[0xF0003A]);
+MACHINE_STATE uint16_t & hde       = *((uint16_t *)&jagMemSpace[0xF0003C]);
+MACHINE_STATE uint16_t & vp        = *((uint16_t *)&jagMemSpace[0xF0003E]);
+MACHINE_STATE uint16_t & vbb       = *((uint16_t *)&jagMemSpace[0xF00040]);
+MACHINE_STATE uint16_t & vbe       = *((uint16_t *)&jagMemSpace[0xF00042]);
+MACHINE_STATE uint16_t & vs        = *((uint16_t *)&jagMemSpace[0xF00044]);
+MACHINE_STATE uint16_t & vdb       = *((uint16_t *)&jagMemSpace[0xF00046]);
+MACHINE_STATE uint16_t & vde       = *((uint16_t *)&jagMemSpace[0xF00048]);
+MACHINE_STATE uint16_t & veb       = *((uint16_t *)&jagMemSpace[0xF0004A]);
+MACHINE_STATE uint16_t & vee       = *((uint16_t *)&jagMemSpace[0xF0004C]);
+MACHINE_STATE uint16_t & vi        = *((uint16_t *)&jagMemSpace[0xF0004E]);
+MACHINE_STATE uint16_t & pit0      = *((uint16_t *)&jagMemSpace[0xF00050]);
+MACHINE_STATE uint16_t & pit1      = *((uint16_t *)&jagMemSpace[0xF00052]);
+MACHINE_STATE uint16_t & heq       = *((uint16_t *)&jagMemSpace[0xF00054]);
+MACHINE_STATE uint32_t & bg        = *((uint32_t *)&jagMemSpace[0xF00058]);
+MACHINE_STATE uint16_t & int1      = *((uint16_t *)&jagMemSpace[0xF000E0]);
+MACHINE_STATE uint16_t & int2      = *((uint16_t *)&jagMemSpace[0xF000E2]);
+MACHINE_STATE uint8_t  * clut      =   (uint8_t *) &jagMemSpace[0xF00400];
+MACHINE_STATE uint8_t  * lbuf      =   (uint8_t *) &jagMemSpace[0xF00800];
+MACHINE_STATE uint32_t & g_flags   = *((uint32_t *)&jagMemSpace[0xF02100]);
+MACHINE_STATE uint32_t & g_mtxc    = *((uint32_t *)&jagMemSpace[0xF02104]);
+MACHINE_STATE uint32_t & g_mtxa    = *((uint32_t *)&jagMemSpace[0xF02108]);
+MACHINE_STATE uint32_t & g_end     = *((uint32_t *)&jagMemSpace[0xF0210C]);
+MACHINE_STATE uint32_t & g_pc      = *((uint32_t *)&jagMemSpace[0xF02110]);
+MACHINE_STATE uint32_t & g_ctrl    = *((uint32_t *)&jagMemSpace[0xF02114]);
+MACHINE_STATE uint32_t & g_hidata  = *((uint32_t *)&jagMemSpace[0xF02118]);
+MACHINE_STATE uint32_t & g_divctrl = *((uint32_t *)&jagMemSpace[0xF0211C]);
+MACHINE_STATE uint32_t g_remain;								// Dual register with $F0211C
+MACHINE_STATE uint32_t & a1_base   = *((uint32_t *)&jagMemSpace[0xF02200]);
+MACHINE_STATE uint32_t & a1_flags  = *((uint32_t *)&jagMemSpace[0xF02204]);
+MACHINE_STATE uint32_t & a1_clip   = *((uint32_t *)&jagMemSpace[0xF02208]);
+MACHINE_STATE uint32_t & a1_pixel  = *((uint32_t *)&jagMemSpace[0xF0220C]);
+MACHINE_STATE uint32_t & a1_step   = *((uint32_t *)&jagMemSpace[0xF02210]);
+MACHINE_STATE uint32_t & a1_fstep  = *((uint32_t *)&jagMemSpace[0xF02214]);
+MACHINE_STATE uint32_t & a1_fpixel = *((uint32_t *)&jagMemSpace[0xF02218]);
+MACHINE_STATE uint32_t & a1_inc    = *((uint32_t *)&jagMemSpace[0xF0221C]);
+MACHINE_STATE uint32_t & a1_finc   = *((uint32_t *)&jagMemSpace[0xF02220]);
+MACHINE_STATE uint32_t & a2_base   = *((uint32_t *)&jagMemSpace[0xF02224]);
+MACHINE_STATE uint32_t & a2_flags  = *((uint32_t *)&jagMemSpace[0xF02228]);
+MACHINE_STATE uint32_t & a2_mask   = *((uint32_t *)&jagMemSpace[0xF0222C]);
+MACHINE_STATE uint32_t & a2_pixel  = *((uint32_t *)&jagMemSpace[0xF02230]);
+MACHINE_STATE uint32_t & a2_step   = *((uint32_t *)&jagMemSpace[0xF02234]);
+MACHINE_STATE uint32_t & b_cmd     = *((uint32_t *)&jagMemSpace[0xF02238]);
+MACHINE_STATE uint32_t & b_count   = *((uint32_t *)&jagMemSpace[0xF0223C]);
+MACHINE_STATE uint64_t & b_srcd    = *((uint64_t *)&jagMemSpace[0xF02240]);
+MACHINE_STATE uint64_t & b_dstd    = *((uint64_t *)&jagMemSpace[0xF02248]);
+MACHINE_STATE uint64_t & b_dstz    = *((uint64_t *)&jagMemSpace[0xF02250]);
+MACHINE_STATE uint64_t & b_srcz1   = *((uint64_t *)&jagMemSpace[0xF02258]);
+MACHINE_STATE uint64_t & b_srcz2   = *((uint64_t *)&jagMemSpace[0xF02260]);
+MACHINE_STATE uint64_t & b_patd    = *((uint64_t *)&jagMemSpace[0xF02268]);
+MACHINE_STATE uint32_t & b_iinc    = *((uint32_t *)&jagMemSpace[0xF02270]);
+MACHINE_STATE uint32_t & b_zinc    = *((uint32_t *)&jagMemSpace[0xF02274]);
+MACHINE_STATE uint32_t & b_stop    = *((uint32_t *)&jagMemSpace[0xF02278]);
+MACHINE_STATE uint32_t & b_i3      = *((uint32_t *)&jagMemSpace[0xF0227C]);
+MACHINE_STATE uint32_t & b_i2      = *((uint32_t *)&jagMemSpace[0xF02280]);
+MACHINE_STATE uint32_t & b_i1      = *((uint32_t *)&jagMemSpace[0xF02284]);
+MACHINE_STATE uint32_t & b_i0      = *((uint32_t *)&jagMemSpace[0xF02288]);
+MACHINE_STATE uint32_t & b_z3      = *((uint32_t *)&jagMemSpace[0xF0228C]);
+MACHINE_STATE uint32_t & b_z2      = *((uint32_t *)&jagMemSpace[0xF02290]);
+MACHINE_STATE uint32_t & b_z1      = *((uint32_t *)&jagMemSpace[0xF02294]);
+MACHINE_STATE uint32_t & b_z0      = *((uint32_t *)&jagMemSpace[0xF02298]);
+MACHINE_STATE uint16_t & jpit1     = *((uint16_t *)&jagMemSpace[0xF10000]);
+MACHINE_STATE uint16_t & jpit2     = *((uint16_t *)&jagMemSpace[0xF10002]);
+MACHINE_STATE uint16_t & jpit3     = *((uint16_t *)&jagMemSpace[0xF10004]);
+MACHINE_STATE uint16_t & jpit4     = *((uint16_t *)&jagMemSpace[0xF10006]);
+MACHINE_STATE uint16_t & clk1      = *((uint16_t *)&jagMemSpace[0xF10010]);
+MACHINE_STATE uint16_t & clk2      = *((uint16_t *)&jagMemSpace[0xF10012]);
+MACHINE_STATE uint16_t & clk3      = *((uint16_t *)&jagMemSpace[0xF10014]);
+MACHINE_STATE uint16_t & j_int     = *((uint16_t *)&jagMemSpace[0xF10020]);
+MACHINE_STATE uint16_t & asidata   = *((uint16_t *)&jagMemSpace[0xF10030]);
+MACHINE_STATE uint16_t & asictrl   = *((uint16_t *)&jagMemSpace[0xF10032]);
+MACHINE_STATE uint16_t asistat;									// Dual register with $F10032
+MACHINE_STATE uint16_t & asiclk    = *((uint16_t *)&jagMemSpace[0xF10034]);
+MACHINE_STATE uint16_t & joystick  = *((uint16_t *)&jagMemSpace[0xF14000]);
+MACHINE_STATE uint16_t & joybuts   = *((uint16_t *)&jagMemSpace[0xF14002]);
+MACHINE_STATE uint32_t & d_flags   = *((uint32_t *)&jagMemSpace[0xF1A100]);
+MACHINE_STATE uint32_t & d_mtxc    = *((uint32_t *)&jagMemSpace[0xF1A104]);
+MACHINE_STATE uint32_t & d_mtxa    = *((uint32_t *)&jagMemSpace[0xF1A108]);
+MACHINE_STATE uint32_t & d_end     = *((uint32_t *)&jagMemSpace[0xF1A10C]);
+MACHINE_STATE uint32_t & d_pc      = *((uint32_t *)&jagMemSpace[0xF1A110]);
+MACHINE_STATE uint32_t & d_ctrl    = *((uint32_t *)&jagMemSpace[0xF1A114]);
+MACHINE_STATE uint32_t & d_mod     = *((uint32_t *)&jagMemSpace[0xF1A118]);
+MACHINE_STATE uint32_t & d_divctrl = *((uint32_t *)&jagMemSpace[0xF1A11C]);
+MACHINE_STATE uint32_t d_remain;								// Dual register with $F0211C
+MACHINE_STATE uint32_t & d_machi   = *((uint32_t *)&jagMemSpace[0xF1A120]);
+MACHINE_STATE uint16_t & ltxd      = *((uint16_t *)&jagMemSpace[0xF1A148]);
+MACHINE_STATE uint16_t lrxd;									// Dual register with $F1A148
+MACHINE_STATE uint16_t & rtxd      = *((uint16_t *)&jagMemSpace[0xF1A14C]);
+MACHINE_STATE uint16_t rrxd;									// Dual register with $F1A14C
+MACHINE_STATE uint8_t  & sclk      = *((uint8_t *) &jagMemSpace[0xF1A150]);
+MACHINE_STATE uint8_t sstat;									// Dual register with $F1A150
+MACHINE_STATE uint32_t & smode     = *((uint32_t *)&jagMemSpace[0xF1A154]);
 
 // Memory debugging identifiers
 
 const char * whoName[10] =
 	{ "Unknown", "Jaguar", "DSP", "GPU", "TOM", "JERRY", "M68K", "Blitter", "OP", "Debugger" };
+
+
+//
+// See STATE.CPP. Main RAM & the chips' registers are all there is of the
+// memory space that can change; the rest is ROM.
+//
+void MemorySnapshot(void)
+{
+	SnapshotData(&jagMemSpace[0x000000], 0x200000);
+	SnapshotData(&jagMemSpace[0xDFFF00], 0x100);
+	SnapshotData(&jagMemSpace[0xF00000], 0x20000);
+	SNAPSHOT(g_remain);
+	SNAPSHOT(d_remain);
+	SNAPSHOT(asistat);
+	SNAPSHOT(lrxd);
+	SNAPSHOT(rrxd);
+	SNAPSHOT(sstat);
+}
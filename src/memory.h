@@ -8,51 +8,57 @@
 #define __MEMORY_H__
 
 #include <stdint.h>
+#include <string.h>
+#include "machine.h"
 
+#ifdef JAGUAR_MULTI_MACHINE
+extern MACHINE_STATE uint8_t * jagMemSpace;
+#else
 extern uint8_t jagMemSpace[];
+#endif
 
-extern uint8_t * jaguarMainRAM;
-extern uint8_t * jaguarMainROM;
-extern uint8_t * gpuRAM;
-extern uint8_t * dspRAM;
+extern MACHINE_STATE uint8_t * jaguarMainRAM;
+extern MACHINE_STATE uint8_t * jaguarMainROM;
+extern MACHINE_STATE uint8_t * gpuRAM;
+extern MACHINE_STATE uint8_t * dspRAM;
 
 #if 1
-extern uint32_t & butch, & dscntrl;
-extern uint16_t & ds_data;
-extern uint32_t & i2cntrl, & sbcntrl, & subdata, & subdatb, & sb_time, & fifo_data, & i2sdat2, & i2sbus;
+extern MACHINE_STATE uint32_t & butch, & dscntrl;
+extern MACHINE_STATE uint16_t & ds_data;
+extern MACHINE_STATE uint32_t & i2cntrl, & sbcntrl, & subdata, & subdatb, & sb_time, & fifo_data, & i2sdat2, & i2sbus;
 #else
-extern uint32_t butch, dscntrl, ds_data, i2cntrl, sbcntrl, subdata, subdatb, sb_time, fifo_data, i2sdat2, i2sbus;
+extern MACHINE_STATE uint32_t butch, dscntrl, ds_data, i2cntrl, sbcntrl, subdata, subdatb, sb_time, fifo_data, i2sdat2, i2sbus;
 #endif
 
-extern uint16_t & memcon1, & memcon2, & hc, & vc, & lph, & lpv;
-extern uint64_t & obData;
-extern uint32_t & olp;
-extern uint16_t & obf, & vmode, & bord1, & bord2, & hp, & hbb, & hbe, & hs,
+extern MACHINE_STATE uint16_t & memcon1, & memcon2, & hc, & vc, & lph, & lpv;
+extern MACHINE_STATE uint64_t & obData;
+extern MACHINE_STATE uint32_t & olp;
+extern MACHINE_STATE uint16_t & obf, & vmode, & bord1, & bord2, & hp, & hbb, & hbe, & hs,
 	& hvs, & hdb1, & hdb2, & hde, & vp, & vbb, & vbe, & vs, & vdb, & vde,
 	& veb, & vee, & vi, & pit0, & pit1, & heq;
-extern uint32_t & bg;
-extern uint16_t & int1, & int2;
-extern uint8_t * clut, * lbuf;
-extern uint32_t & g_flags, & g_mtxc, & g_mtxa, & g_end, & g_pc, & g_ctrl,
+extern MACHINE_STATE uint32_t & bg;
+extern MACHINE_STATE uint16_t & int1, & int2;
+extern MACHINE_STATE uint8_t * clut, * lbuf;
+extern MACHINE_STATE uint32_t & g_flags, & g_mtxc, & g_mtxa, & g_end, & g_pc, & g_ctrl,
 	& g_hidata, & g_divctrl;
-extern uint32_t g_remain;
-extern uint32_t & a1_base, & a1_flags, & a1_clip, & a1_pixel, & a1_step,
+extern MACHINE_STATE uint32_t g_remain;
+extern MACHINE_STATE uint32_t & a1_base, & a1_flags, & a1_clip, & a1_pixel, & a1_step,
 	& a1_fstep, & a1_fpixel, & a1_inc, & a1_finc, & a2_base, & a2_flags,
 	& a2_mask, & a2_pixel, & a2_step, & b_cmd, & b_count;
-extern uint64_t & b_srcd, & b_dstd, & b_dstz, & b_srcz1, & b_srcz2, & b_patd;
-extern uint32_t & b_iinc, & b_zinc, & b_stop, & b_i3, & b_i2, & b_i1, & b_i0, & b_z3,
+extern MACHINE_STATE uint64_t & b_srcd, & b_dstd, & b_dstz, & b_srcz1, & b_srcz2, & b_patd;
+extern MACHINE_STATE uint32_t & b_iinc, & b_zinc, & b_stop, & b_i3, & b_i2, & b_i1, & b_i0, & b_z3,
 	& b_z2, & b_z1, & b_z0;
-extern uint16_t & jpit1, & jpit2, & jpit3, & jpit4, & clk1, & clk2, & clk3, & j_int,
+extern MACHINE_STATE uint16_t & jpit1, & jpit2, & jpit3, & jpit4, & clk1, & clk2, & clk3, & j_int,
 	& asidata, & asictrl;
-extern uint16_t asistat;
-extern uint16_t & asiclk, & joystick, & joybuts;
-extern uint32_t & d_flags, & d_mtxc, & d_mtxa, & d_end, & d_pc, & d_ctrl,
+extern MACHINE_STATE uint16_t asistat;
+extern MACHINE_STATE uint16_t & asiclk, & joystick, & joybuts;
+extern MACHINE_STATE uint32_t & d_flags, & d_mtxc, & d_mtxa, & d_end, & d_pc, & d_ctrl,
 	& d_mod, & d_divctrl;
-extern uint32_t d_remain;
-extern uint32_t & d_machi;
-extern uint16_t & ltxd, lrxd, & rtxd, rrxd;
-extern uint8_t & sclk, sstat;
-extern uint32_t & smode;
+extern MACHINE_STATE uint32_t d_remain;
+extern MACHINE_STATE uint32_t & d_machi;
+extern MACHINE_STATE uint16_t & ltxd, lrxd, & rtxd, rrxd;
+extern MACHINE_STATE uint8_t & sclk, sstat;
+extern MACHINE_STATE uint32_t & smode;
 /*
 uint16_t & ltxd      = *((uint16_t *)&jagMemSpace[0xF1A148]);
 uint16_t lrxd;									// Dual register with $F1A148
@@ -68,6 +74,26 @@ uint32_t & smode     = *((uint32_t *)&jagMemSpace[0xF1A154]);
 enum { UNKNOWN, JAGUAR, DSP, GPU, TOM, JERRY, M68K, BLITTER, OP, DEBUG };
 extern const char * whoName[10];
 
+void MemorySnapshot(void);
+
+// I/O register tables (TOM & JERRY). Each chip keeps a list of its registers,
+// which is used to dispatch writes, to trace them & to dump the registers.
+// Registers without write handlers are just stored.
+
+enum { IOR_HEX = 0x01, IOR_VIDEO = 0x02 };
+
+struct IORegister
+{
+	uint32_t offset;
+	const char * name;				// For register dumps
+	const char * description;		// For tracing writes (NULL: don't)
+	uint8_t size;					// In bytes
+	uint8_t flags;					// IOR_* flags
+	uint16_t mask;					// Significant bits
+	void (* writeByte)(uint32_t offset, uint8_t data, uint32_t who);
+	void (* writeWord)(uint32_t offset, uint16_t data, uint32_t who);
+};
+
 // BIOS identification enum
 
 //enum { BIOS_NORMAL=0x01, BIOS_CD=0x02, BIOS_STUB1=0x04, BIOS_STUB2=0x08, BIOS_DEV_CD=0x10 };
@@ -75,7 +101,41 @@ extern const char * whoName[10];
 
 // Some handy macros to help converting native endian to big endian (jaguar native)
 // & vice versa
+//
+// Everything in jagMemSpace is kept the way the Jaguar sees it (big endian),
+// so that bytes are just bytes and ROM images, DMA & the like can be copied
+// straight in. Word & long accesses then come down to one host load or store
+// plus a byte swap (which GCC & clang turn into a single instruction, or
+// nothing at all on big endian hosts). The memcpy()s keep unaligned accesses
+// legal, and compile down to plain moves.
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__)
+	#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		#define ESAFE16(x)	__builtin_bswap16(x)
+		#define ESAFE32(x)	__builtin_bswap32(x)
+		#define ESAFE64(x)	__builtin_bswap64(x)
+	#else
+		#define ESAFE16(x)	(x)
+		#define ESAFE32(x)	(x)
+		#define ESAFE64(x)	(x)
+	#endif
+#endif
 
+#ifdef ESAFE16
+static inline uint16_t GetBE16(const uint8_t * p) { uint16_t v; memcpy(&v, p, 2); return ESAFE16(v); }
+static inline uint32_t GetBE32(const uint8_t * p) { uint32_t v; memcpy(&v, p, 4); return ESAFE32(v); }
+static inline uint64_t GetBE64(const uint8_t * p) { uint64_t v; memcpy(&v, p, 8); return ESAFE64(v); }
+static inline void SetBE16(uint8_t * p, uint16_t v) { v = ESAFE16(v); memcpy(p, &v, 2); }
+static inline void SetBE32(uint8_t * p, uint32_t v) { v = ESAFE32(v); memcpy(p, &v, 4); }
+static inline void SetBE64(uint8_t * p, uint64_t v) { v = ESAFE64(v); memcpy(p, &v, 8); }
+
+#define SET64(r, a, v)	SetBE64(&(r)[(a)], (v))
+#define GET64(r, a)		GetBE64(&(r)[(a)])
+#define SET32(r, a, v)	SetBE32(&(r)[(a)], (v))
+#define GET32(r, a)		GetBE32(&(r)[(a)])
+#define SET16(r, a, v)	SetBE16(&(r)[(a)], (v))
+#define GET16(r, a)		GetBE16(&(r)[(a)])
+#else
 #define SET64(r, a, v) 	r[(a)] = ((v) & 0xFF00000000000000) >> 56, r[(a)+1] = ((v) & 0x00FF000000000000) >> 48, \
 						r[(a)+2] = ((v) & 0x0000FF0000000000) >> 40, r[(a)+3] = ((v) & 0x000000FF00000000) >> 32, \
 						r[(a)+4] = ((v) & 0xFF000000) >> 24, r[(a)+5] = ((v) & 0x00FF0000) >> 16, \
@@ -86,29 +146,9 @@ extern const char * whoName[10];
 						((uint64_t)r[(a)+6] << 8) | (uint64_t)r[(a)+7])
 #define SET32(r, a, v)	r[(a)] = ((v) & 0xFF000000) >> 24, r[(a)+1] = ((v) & 0x00FF0000) >> 16, \
 						r[(a)+2] = ((v) & 0x0000FF00) >> 8, r[(a)+3] = (v) & 0x000000FF
-#define GET32(r, a)		((r[(a)] << 24) | (r[(a)+1] << 16) | (r[(a)+2] << 8) | r[(a)+3])
+#define GET32(r, a)		(((uint32_t)r[(a)] << 24) | (r[(a)+1] << 16) | (r[(a)+2] << 8) | r[(a)+3])
 #define SET16(r, a, v)	r[(a)] = ((v) & 0xFF00) >> 8, r[(a)+1] = (v) & 0xFF
 #define GET16(r, a)		((r[(a)] << 8) | r[(a)+1])
-
-//This doesn't seem to work on OSX. So have to figure something else out. :-(
-//byteswap.h doesn't exist on OSX.
-#if 0
-// This is GCC specific, but we can fix that if we need to...
-// Big plus of this approach is that these compile down to single instructions on little
-// endian machines while one big endian machines we don't have any overhead. :-)
-
-#include <byteswap.h>
-#include <endian.h>
-
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-	#define ESAFE16(x)	bswap_16(x)
-	#define ESAFE32(x)	bswap_32(x)
-	#define ESAFE64(x)	bswap_64(x)
-#else
-	#define ESAFE16(x)	(x)
-	#define ESAFE32(x)	(x)
-	#define ESAFE64(x)	(x)
-#endif
 #endif
 
 #if 0
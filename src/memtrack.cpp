@@ -27,6 +27,7 @@
 #include <string.h>
 #include <log.h>
 #include <settings.h>
+#include <state.h>
 
 
 #define MEMTRACK_FILENAME	"memtrack.eeprom"
@@ -35,11 +36,11 @@
 enum { MT_NONE, MT_PROD_ID, MT_RESET, MT_WRITE_ENABLE };
 enum { MT_IDLE, MT_PHASE1, MT_PHASE2 };
 
-uint8_t mtMem[0x20000];
-uint8_t mtCommand = MT_NONE;
-uint8_t mtState = MT_IDLE;
-bool haveMT = false;
-char mtFilename[MAX_PATH];
+MACHINE_STATE uint8_t mtMem[0x20000];
+MACHINE_STATE uint8_t mtCommand = MT_NONE;
+MACHINE_STATE uint8_t mtState = MT_IDLE;
+MACHINE_STATE bool haveMT = false;
+MACHINE_STATE char mtFilename[MAX_PATH];
 
 // Private function prototypes
 void MTWriteFile(void);
@@ -77,6 +78,15 @@ void MTDone(void)
 }
 
 
+// See STATE.CPP
+void MTSnapshot(void)
+{
+	SNAPSHOT(mtMem);
+	SNAPSHOT(mtCommand);
+	SNAPSHOT(mtState);
+}
+
+
 void MTWriteFile(void)
 {
 	if (!haveMT)
@@ -3,10 +3,12 @@
 //
 
 #include <stdint.h>
+#include "machine.h"
 
 void MTInit(void);
 void MTReset(void);
 void MTDone(void);
+void MTSnapshot(void);
 
 uint16_t MTReadWord(uint32_t addr);
 uint32_t MTReadLong(uint32_t addr);
@@ -22,6 +22,7 @@
 #include "log.h"
 #include "m68000/m68kinterface.h"
 #include "memory.h"
+#include "state.h"
 #include "tom.h"
 
 //#define OP_DEBUG
@@ -63,20 +64,20 @@ uint64_t OPLoadPhrase(uint32_t offset);
 // Local global variables
 
 // Blend tables (64K each)
-static uint8_t op_blend_y[0x10000];
-static uint8_t op_blend_cr[0x10000];
+static MACHINE_STATE uint8_t op_blend_y[0x10000];
+static MACHINE_STATE uint8_t op_blend_cr[0x10000];
 // There may be a problem with this "RAM" overlapping (and thus being independent of)
 // some of the regular TOM RAM...
 //#warning objectp_ram is separated from TOM RAM--need to fix that!
 //static uint8_t objectp_ram[0x40];			// This is based at $F00000
-uint8_t objectp_running = 0;
+MACHINE_STATE uint8_t objectp_running = 0;
 //bool objectp_stop_reading_list;
 
 static uint8_t op_bitmap_bit_depth[8] = { 1, 2, 4, 8, 16, 24, 32, 0 };
 //static uint32_t op_bitmap_bit_size[8] =
 //	{ (uint32_t)(0.125*65536), (uint32_t)(0.25*65536), (uint32_t)(0.5*65536), (uint32_t)(1*65536),
 //	  (uint32_t)(2*65536),     (uint32_t)(1*65536),    (uint32_t)(1*65536),   (uint32_t)(1*65536) };
-static uint32_t op_pointer;
+static MACHINE_STATE uint32_t op_pointer;
 
 int32_t phraseWidthToPixels[8] = { 64, 32, 16, 8, 4, 2, 0, 0 };
 
@@ -142,12 +143,23 @@ static const char * opType[8] =
 { "(BITMAP)", "(SCALED BITMAP)", "(GPU INT)", "(BRANCH)", "(STOP)", "???", "???", "???" };
 static const char * ccType[8] =
 	{ "==", "<", ">", "(opflag set)", "(second half line)", "?", "?", "?" };
-static uint32_t object[8192];
-static uint32_t numberOfObjects;
+static MACHINE_STATE uint32_t object[8192];
+static MACHINE_STATE uint32_t numberOfObjects;
 //static uint32_t objectLink[8192];
 //static uint32_t numberOfLinks;
 
 
+//
+// See STATE.CPP. The object list itself is in TOM's registers & main RAM; the
+// list of objects found in it is only for the log.
+//
+void OPSnapshot(void)
+{
+	SNAPSHOT(objectp_running);
+	SNAPSHOT(op_pointer);
+}
+
+
 void OPDone(void)
 {
 //#warning "!!! Fix OL dump so that it follows links !!!"
@@ -366,21 +378,20 @@ void OPSetCurrentObject(uint64_t object)
 	objectp_ram[0x15] = object & 0xFF; object >>= 8;
 	objectp_ram[0x14] = object & 0xFF;*/
 // Let's try regular good old big endian...
-	tomRam8[0x17] = object & 0xFF; object >>= 8;
-	tomRam8[0x16] = object & 0xFF; object >>= 8;
-	tomRam8[0x15] = object & 0xFF; object >>= 8;
-	tomRam8[0x14] = object & 0xFF; object >>= 8;
-
-	tomRam8[0x13] = object & 0xFF; object >>= 8;
-	tomRam8[0x12] = object & 0xFF; object >>= 8;
-	tomRam8[0x11] = object & 0xFF; object >>= 8;
-	tomRam8[0x10] = object & 0xFF;
+	SET64(tomRam8, 0x10, object);
 }
 
 
 uint64_t OPLoadPhrase(uint32_t offset)
 {
-	offset &= ~0x07;						// 8 byte alignment
+	offset &= 0xFFFFF8;						// 8 byte alignment
+
+	// Phrases in RAM & ROM can be read in one go
+	if (offset < 0x800000)
+		return GET64(jaguarMainRAM, offset & 0x1FFFFF);
+	else if (offset <= 0xDFFEF8)
+		return GET64(jaguarMainROM, offset - 0x800000);
+
 	return ((uint64_t)JaguarReadLong(offset, OP) << 32) | (uint64_t)JaguarReadLong(offset+4, OP);
 }
 
@@ -1056,7 +1067,7 @@ if (depth > 5)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		// Fetch 1st phrase...
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 //Note that firstPix should only be honored *if* we start with the 1st phrase of the bitmap
 //i.e., we didn't clip on the margin... !!! FIX !!!
 		pixels <<= firstPix;						// Skip first N pixels (N=firstPix)...
@@ -1094,7 +1105,7 @@ if (depth > 5)
 			i = 0;
 			// Fetch next phrase...
 			data += pitch;
-			pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			pixels = OPLoadPhrase(data);
 		}
 	}
 	else if (depth == 1)							// 2 BPP
@@ -1108,7 +1119,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = OPLoadPhrase(data);
 			data += pitch;
 
 			for(int i=0; i<32; i++)
@@ -1152,7 +1163,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = OPLoadPhrase(data);
 			data += pitch;
 
 			for(int i=0; i<16; i++)
@@ -1191,7 +1202,7 @@ if (firstPix)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		// Fetch 1st phrase...
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 //Note that firstPix should only be honored *if* we start with the 1st phrase of the bitmap
 //i.e., we didn't clip on the margin... !!! FIX !!!
 		firstPix &= 0x30;							// Only top two bits are valid for 8 BPP
@@ -1234,7 +1245,7 @@ if (firstPix)
 			i = 0;
 			// Fetch next phrase...
 			data += pitch;
-			pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			pixels = OPLoadPhrase(data);
 		}
 	}
 	else if (depth == 4)							// 16 BPP
@@ -1247,7 +1258,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = OPLoadPhrase(data);
 			data += pitch;
 
 			for(int i=0; i<4; i++)
@@ -1295,7 +1306,7 @@ if (firstPix)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = OPLoadPhrase(data);
 			data += pitch;
 
 			for(int i=0; i<2; i++)
@@ -1556,7 +1567,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1609,7 +1620,7 @@ wide, so we could probably go back to that (as long as we make it an int16_t and
 				int phrasesToSkip = pixCount / 64, pixelShift = pixCount % 64;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = OPLoadPhrase(data);
 				pixels <<= 1 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1625,7 +1636,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1673,7 +1684,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 32, pixelShift = pixCount % 32;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = OPLoadPhrase(data);
 				pixels <<= 2 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1689,7 +1700,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1737,7 +1748,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 16, pixelShift = pixCount % 16;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = OPLoadPhrase(data);
 				pixels <<= 4 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1752,7 +1763,7 @@ if (firstPix)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1797,7 +1808,7 @@ if (firstPix)
 				int phrasesToSkip = pixCount / 8, pixelShift = pixCount % 8;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = OPLoadPhrase(data);
 				pixels <<= 8 * pixelShift;
 				iwidth -= phrasesToSkip;
 				pixCount = pixelShift;
@@ -1812,7 +1823,7 @@ if (firstPix != 0)
 		int32_t lbufDelta = ((int8_t)((flags << 7) & 0xFF) >> 5) | 0x02;
 
 		int pixCount = 0;
-		uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+		uint64_t pixels = OPLoadPhrase(data);
 
 		while ((int32_t)iwidth > 0)
 		{
@@ -1858,7 +1869,7 @@ if (firstPix != 0)
 				int phrasesToSkip = pixCount / 4, pixelShift = pixCount % 4;
 
 				data += (pitch << 3) * phrasesToSkip;
-				pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+				pixels = OPLoadPhrase(data);
 				pixels <<= 16 * pixelShift;
 
 				iwidth -= phrasesToSkip;
@@ -1880,7 +1891,7 @@ if (firstPix != 0)
 		while (iwidth--)
 		{
 			// Fetch phrase...
-			uint64_t pixels = ((uint64_t)JaguarReadLong(data, OP) << 32) | JaguarReadLong(data + 4, OP);
+			uint64_t pixels = OPLoadPhrase(data);
 			data += pitch << 3;						// Multiply pitch * 8 (optimize: precompute this value)
 
 			for(int i=0; i<2; i++)
@@ -6,10 +6,12 @@
 #define __OBJECTP_H__
 
 #include <stdint.h>
+#include "machine.h"
 
 void OPInit(void);
 void OPReset(void);
 void OPDone(void);
+void OPSnapshot(void);
 
 uint64_t OPLoadPhrase(uint32_t offset);
 
@@ -26,6 +28,6 @@ void OPSetCurrentObject(uint64_t object);
 
 // Exported variables
 
-extern uint8_t objectp_running;
+extern MACHINE_STATE uint8_t objectp_running;
 
 #endif	// __OBJECTP_H__
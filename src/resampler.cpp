@@ -0,0 +1,357 @@
+//
+// RESAMPLER.CPP: Band-limited sample rate converter
+//
+// JERRY puts out samples at whatever rate SCLK (or BUTCH) says, which has
+// nothing to do with the rate the host wants. Samples are captured at their
+// real rate, and converted here with a windowed sinc filter. The filter is
+// kept as a table of RESAMPLER_PHASES phases; output samples falling between
+// two phases use a blend of both.
+//
+// Cutoff is set just below the Nyquist frequency of the lower of the two
+// rates, so downsampling from a high SCLK rate doesn't alias.
+//
+
+#include "resampler.h"
+
+#include <math.h>
+#include <string.h>
+#include "log.h"
+#include "machine.h"
+
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define RESAMPLER_HAVE_SSE
+#endif
+
+//#define RESAMPLER_CHECK				// Check output against the direct formula (see utils/resamplercheck.cpp)
+
+// Filter length in input samples. Must be a multiple of 4.
+#define RESAMPLER_TAPS		32
+#define RESAMPLER_PHASES	256
+// Input ring size; must be a power of two
+#define RESAMPLER_RING		8192
+#define RESAMPLER_MASK		(RESAMPLER_RING - 1)
+// Kaiser window shape
+#define RESAMPLER_BETA		8.0
+
+// Local variables
+
+// Each sample goes in twice (at i and i + RESAMPLER_RING for the first
+// RESAMPLER_TAPS slots) so the filter can always read its taps in one run.
+static MACHINE_STATE float ringL[RESAMPLER_RING + RESAMPLER_TAPS];
+static MACHINE_STATE float ringR[RESAMPLER_RING + RESAMPLER_TAPS];
+static MACHINE_STATE float coeffs[RESAMPLER_PHASES + 1][RESAMPLER_TAPS];
+static MACHINE_STATE uint32_t writeCount;				// Total samples written
+static MACHINE_STATE uint32_t readCount;				// Index of the first tap of the next output
+static MACHINE_STATE double phase;					// Fractional position between samples
+static MACHINE_STATE double step;						// Input samples per output sample
+static MACHINE_STATE double inputRate, outputRate;
+static MACHINE_STATE double speed = 1.0;				// Playback speed (fast forward)
+static MACHINE_STATE double cutoff;
+static MACHINE_STATE int16_t lastLeft, lastRight;
+#ifdef RESAMPLER_CHECK
+static MACHINE_STATE double worstError;				// Furthest off CheckOne() has seen
+#endif
+
+// Private function prototypes
+
+static void BuildFilter(void);
+static double FilterTap(double x);
+static double BesselI0(double x);
+static void FilterOne(const float * l, const float * r, const float * c0,
+	const float * c1, float blend, float & outL, float & outR);
+static int16_t Clamp(float sample);
+#ifdef RESAMPLER_CHECK
+static void CheckOne(uint32_t base, double position, float outL, float outR);
+#endif
+
+
+void ResamplerInit(double inRate, double outRate)
+{
+	inputRate = inRate;
+	outputRate = outRate;
+	speed = 1.0;
+	BuildFilter();
+	ResamplerReset();
+}
+
+
+//
+// Throw away anything buffered & start over with silence
+//
+void ResamplerReset(void)
+{
+	memset(ringL, 0, sizeof(ringL));
+	memset(ringR, 0, sizeof(ringR));
+	// Prime with one filter's worth of silence (plus a little, since the
+	// number of samples JERRY makes per host buffer wobbles a bit); this is
+	// the resampler's delay
+	writeCount = RESAMPLER_TAPS + 4;
+	readCount = 0;
+	phase = 0;
+	lastLeft = lastRight = 0;
+}
+
+
+//
+// JERRY changed its output rate. Only rebuilds the filter if the rate
+// actually moved.
+//
+void ResamplerSetInputRate(double inRate)
+{
+	if (inRate == inputRate)
+		return;
+
+	inputRate = inRate;
+	BuildFilter();
+}
+
+
+//
+// Play the input back <newSpeed> times faster than it was made. This only
+// changes how far we step through the input per output sample; the filter
+// stays the one built for the real input rate, so changing speed costs
+// nothing (fast forward changes it every frame).
+//
+void ResamplerSetSpeed(double newSpeed)
+{
+	if (newSpeed == speed)
+		return;
+
+	speed = newSpeed;
+	step = (inputRate * speed) / outputRate;
+}
+
+
+void ResamplerWrite(int16_t left, int16_t right)
+{
+	// If the reader isn't keeping up, drop the oldest samples
+	if ((writeCount - readCount) >= (RESAMPLER_RING - RESAMPLER_TAPS))
+		readCount++;
+
+	uint32_t i = writeCount & RESAMPLER_MASK;
+	ringL[i] = (float)left;
+	ringR[i] = (float)right;
+
+	if (i < RESAMPLER_TAPS)
+	{
+		ringL[i + RESAMPLER_RING] = (float)left;
+		ringR[i + RESAMPLER_RING] = (float)right;
+	}
+
+	writeCount++;
+}
+
+
+//
+// Make <frames> stereo samples at the output rate. Every output costs the
+// same, so the time taken only depends on <frames>. If we run out of input,
+// the rest of the buffer holds the last sample; returns the number of frames
+// that were actually made from input.
+//
+uint32_t ResamplerRead(int16_t * buffer, uint32_t frames)
+{
+	uint32_t made = 0;
+
+	for(; made<frames; made++)
+	{
+		if ((writeCount - readCount) < RESAMPLER_TAPS)
+			break;
+
+		double position = phase * RESAMPLER_PHASES;
+		uint32_t p = (uint32_t)position;
+		float blend = (float)(position - p);
+		uint32_t base = readCount & RESAMPLER_MASK;
+		float left, right;
+
+		FilterOne(&ringL[base], &ringR[base], coeffs[p], coeffs[p + 1], blend,
+			left, right);
+#ifdef RESAMPLER_CHECK
+		CheckOne(base, phase, left, right);
+#endif
+		lastLeft = buffer[(made * 2) + 0] = Clamp(left);
+		lastRight = buffer[(made * 2) + 1] = Clamp(right);
+
+		phase += step;
+		uint32_t whole = (uint32_t)phase;
+		readCount += whole;
+		phase -= whole;
+	}
+
+	for(uint32_t i=made; i<frames; i++)
+	{
+		buffer[(i * 2) + 0] = lastLeft;
+		buffer[(i * 2) + 1] = lastRight;
+	}
+
+	return made;
+}
+
+
+//
+// Kaiser windowed sinc, one row per phase. Row p is the filter for an output
+// sample that falls p/RESAMPLER_PHASES of the way past the centre tap.
+//
+static void BuildFilter(void)
+{
+	double ratio = inputRate / outputRate;
+	step = ratio * speed;
+	// Cycles per input sample; leave a little room for the transition band
+	cutoff = 0.5 * (ratio > 1.0 ? 1.0 / ratio : 1.0) * 0.92;
+
+	for(uint32_t p=0; p<=RESAMPLER_PHASES; p++)
+	{
+		double sum = 0;
+		double frac = (double)p / RESAMPLER_PHASES;
+
+		for(uint32_t k=0; k<RESAMPLER_TAPS; k++)
+		{
+			double h = FilterTap((double)k - (RESAMPLER_TAPS / 2 - 1) - frac);
+			coeffs[p][k] = (float)h;
+			sum += h;
+		}
+
+		// Unity gain at DC for every phase, otherwise we get a buzz at the
+		// output rate
+		for(uint32_t k=0; k<RESAMPLER_TAPS; k++)
+			coeffs[p][k] = (float)(coeffs[p][k] / sum);
+	}
+
+	WriteLog("RESAMPLER: %.1f Hz -> %.1f Hz, cutoff at %.1f Hz\n", inputRate,
+		outputRate, cutoff * inputRate);
+}
+
+
+//
+// The filter at <x> input samples from the centre. The window has its
+// pedestal (1 / I0(beta)) taken off so it really gets to zero at the ends;
+// otherwise the end taps would jump as they slide out of the window, and
+// blending between the last two phases couldn't follow.
+//
+static double FilterTap(double x)
+{
+	double w = x / (RESAMPLER_TAPS / 2);
+
+	if (fabs(w) >= 1.0)
+		return 0;
+
+	double i0Beta = BesselI0(RESAMPLER_BETA);
+	double window = (BesselI0(RESAMPLER_BETA * sqrt(1.0 - (w * w))) - 1.0)
+		/ (i0Beta - 1.0);
+	double arg = 2.0 * M_PI * cutoff * x;
+	double sinc = (x == 0 ? 1.0 : sin(arg) / arg);
+
+	return 2.0 * cutoff * sinc * window;
+}
+
+
+static double BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+
+	for(int k=1; k<32; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+
+		if (term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+
+#ifdef RESAMPLER_HAVE_SSE
+static void FilterOne(const float * l, const float * r, const float * c0,
+	const float * c1, float blend, float & outL, float & outR)
+{
+	__m128 b = _mm_set1_ps(blend);
+	__m128 accL = _mm_setzero_ps();
+	__m128 accR = _mm_setzero_ps();
+
+	for(uint32_t k=0; k<RESAMPLER_TAPS; k+=4)
+	{
+		__m128 h0 = _mm_loadu_ps(c0 + k);
+		__m128 h = _mm_add_ps(h0, _mm_mul_ps(b, _mm_sub_ps(_mm_loadu_ps(c1 + k), h0)));
+		accL = _mm_add_ps(accL, _mm_mul_ps(h, _mm_loadu_ps(l + k)));
+		accR = _mm_add_ps(accR, _mm_mul_ps(h, _mm_loadu_ps(r + k)));
+	}
+
+	// Horizontal sums: L in the low half, R in the high half
+	__m128 lr = _mm_add_ps(_mm_movelh_ps(accL, accR), _mm_movehl_ps(accR, accL));
+	lr = _mm_add_ps(lr, _mm_shuffle_ps(lr, lr, _MM_SHUFFLE(2, 3, 0, 1)));
+	outL = _mm_cvtss_f32(lr);
+	outR = _mm_cvtss_f32(_mm_movehl_ps(lr, lr));
+}
+#else
+static void FilterOne(const float * l, const float * r, const float * c0,
+	const float * c1, float blend, float & outL, float & outR)
+{
+	float accL = 0, accR = 0;
+
+	for(uint32_t k=0; k<RESAMPLER_TAPS; k++)
+	{
+		float h = c0[k] + (blend * (c1[k] - c0[k]));
+		accL += h * l[k];
+		accR += h * r[k];
+	}
+
+	outL = accL;
+	outR = accR;
+}
+#endif
+
+
+static int16_t Clamp(float sample)
+{
+	if (sample >= 32767.0f)
+		return 32767;
+
+	if (sample <= -32768.0f)
+		return -32768;
+
+	return (int16_t)lrintf(sample);
+}
+
+
+#ifdef RESAMPLER_CHECK
+//
+// Work the output sample out straight from the formula in double precision
+// and complain if the fast path is too far off (more than about -90 dB).
+//
+static void CheckOne(uint32_t base, double position, float outL, float outR)
+{
+	double sum = 0, refL = 0, refR = 0;
+
+	for(uint32_t k=0; k<RESAMPLER_TAPS; k++)
+	{
+		double h = FilterTap((double)k - (RESAMPLER_TAPS / 2 - 1) - position);
+		refL += h * ringL[base + k];
+		refR += h * ringR[base + k];
+		sum += h;
+	}
+
+	refL /= sum, refR /= sum;
+	double error = fmax(fabs(refL - outL), fabs(refR - outR));
+
+	if (error > worstError)
+		worstError = error;
+
+	if (error > 1.0)
+		WriteLog("RESAMPLER: Output off by %f/%f at phase %f\n", refL - outL,
+			refR - outR, position);
+}
+
+
+//
+// How far off the fast path has been from the direct formula (in 16-bit
+// sample units) since the last call
+//
+double ResamplerGetWorstError(void)
+{
+	double error = worstError;
+	worstError = 0;
+	return error;
+}
+#endif
@@ -0,0 +1,20 @@
+//
+// RESAMPLER.H: Band-limited sample rate converter
+//
+
+#ifndef __RESAMPLER_H__
+#define __RESAMPLER_H__
+
+#include <stdint.h>
+
+void ResamplerInit(double inRate, double outRate);
+void ResamplerReset(void);
+void ResamplerSetInputRate(double inRate);
+void ResamplerSetSpeed(double speed);
+void ResamplerWrite(int16_t left, int16_t right);
+uint32_t ResamplerRead(int16_t * buffer, uint32_t frames);
+#ifdef RESAMPLER_CHECK
+double ResamplerGetWorstError(void);
+#endif
+
+#endif	// __RESAMPLER_H__
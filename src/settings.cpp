@@ -16,5 +16,5 @@
 
 // Global variables
 
-VJSettings vjs;
+MACHINE_STATE VJSettings vjs;
 
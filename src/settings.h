@@ -17,6 +17,7 @@
 #endif
 #endif
 #include <stdint.h>
+#include "machine.h"
 
 // Settings struct
 
@@ -28,7 +29,7 @@ struct VJSettings
 	bool useJaguarBIOS;
 	bool GPUEnabled;
 	bool DSPEnabled;
-	bool usePipelinedDSP;
+	uint32_t dspEngine;			// DSP_ENGINE_* (see dsp.h)
 	bool fullscreen;
 	bool useOpenGL;
 	uint32_t glFilter;
@@ -39,6 +40,11 @@ struct VJSettings
 	bool allowWritesToROM;
 	uint32_t biosType;
 	bool useFastBlitter;
+	bool audioSync;				// Pace emulation off of the audio clock
+	uint32_t audioLatency;		// Target audio latency (ms) when audioSync is on
+	bool idleSkip;				// Skip over idle loops in the 68K, GPU & DSP
+	bool parallelGPU;			// Run the GPU ahead on another thread (see gpu.cpp)
+	uint32_t runAhead;			// Frames to run ahead of the input, 0 for none (see jaguar.cpp)
 
 	// Keybindings in order of U, D, L, R, C, B, A, Op, Pa, 0-9, #, *
 
@@ -53,6 +59,8 @@ struct VJSettings
 	char EEPROMPath[MAX_PATH];
 	char alpineROMPath[MAX_PATH];
 	char absROMPath[MAX_PATH];
+	char CDImagePath[MAX_PATH];
+	char bootCachePath[MAX_PATH];	// Post-BIOS snapshots go here, none if empty (see jaguar.cpp)
 };
 
 // Render types
@@ -65,6 +73,6 @@ enum { BT_K_SERIES, BT_M_SERIES, BT_STUBULATOR_1, BT_STUBULATOR_2 };
 
 // Exported variables
 
-extern VJSettings vjs;
+extern MACHINE_STATE VJSettings vjs;
 
 #endif	// __SETTINGS_H__
@@ -12,6 +12,57 @@
 //
 
 #include "state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "blitter.h"
+#include "cdrom.h"
+#include "dsp.h"
+#include "eeprom.h"
+#include "event.h"
+#include "gpu.h"
+#include "jaguar.h"
+#include "jerry.h"
+#include "joystick.h"
+#include "log.h"
+#include "memory.h"
+#include "memtrack.h"
+#include "op.h"
+#include "settings.h"
+#include "tom.h"
+
+//
+// In-memory snapshots
+//
+// Each machine has a few, in slots (one for run-ahead, one for the boot
+// cache). Each chip hands over its state with SnapshotData() from its
+// XXXSnapshot() function, which is called both to take the snapshot and to
+// put it back, so the two can't get out of step. They're only taken between
+// frames (around JaguarExecuteNew()), so anything that only lives inside of a
+// timeslice can be left out.
+//
+// Nothing in a snapshot points anywhere (the event list's callbacks go in by
+// number, see EVENT.CPP), so one can be written out & read back in by another
+// run, as long as the layout hasn't changed; the size is checked for that.
+//
+
+#define SNAPSHOT_VERSION	2
+
+struct Snapshot
+{
+	uint8_t * data;
+	uint32_t size, capacity;
+};
+
+static MACHINE_STATE Snapshot snapshots[SNAPSHOT_SLOTS];
+static MACHINE_STATE Snapshot * snapshot;			// The one being taken/put back
+static MACHINE_STATE uint32_t snapshotSlot;
+static MACHINE_STATE uint32_t snapshotPtr;
+static MACHINE_STATE bool snapshotRestoring;
+
+static void SnapshotWalk(void);
+
 
 bool SaveState(void)
 {
@@ -23,3 +74,180 @@ bool LoadState(void)
 	return false;
 }
 
+
+void SnapshotSave(uint32_t slot)
+{
+	snapshot = &snapshots[slot];
+	snapshotSlot = slot;
+	snapshotRestoring = false;
+	snapshotPtr = 0;
+	SnapshotWalk();
+	snapshot->size = snapshotPtr;
+}
+
+
+bool SnapshotRestore(uint32_t slot)
+{
+	snapshot = &snapshots[slot];
+	snapshotSlot = slot;
+
+	if (snapshot->size == 0)
+		return false;
+
+	snapshotRestoring = true;
+	snapshotPtr = 0;
+	SnapshotWalk();
+
+	if (snapshotPtr != snapshot->size)
+		WriteLog("STATE: Snapshot was %u bytes, but %u were put back!\n", snapshot->size, snapshotPtr);
+
+	return true;
+}
+
+
+uint32_t SnapshotSize(uint32_t slot)
+{
+	return snapshots[slot].size;
+}
+
+
+//
+// For the XXXSnapshot() functions: the slot being taken or put back, for
+// anything that only belongs in some of them
+//
+uint32_t SnapshotSlot(void)
+{
+	return snapshotSlot;
+}
+
+
+void SnapshotData(void * data, uint32_t size)
+{
+	if (snapshotRestoring)
+	{
+		if (snapshotPtr + size <= snapshot->size)
+			memcpy(data, snapshot->data + snapshotPtr, size);
+	}
+	else
+	{
+		if (snapshotPtr + size > snapshot->capacity)
+		{
+			snapshot->capacity = (snapshotPtr + size) * 2;
+			snapshot->data = (uint8_t *)realloc(snapshot->data, snapshot->capacity);
+		}
+
+		memcpy(snapshot->data + snapshotPtr, data, size);
+	}
+
+	snapshotPtr += size;
+}
+
+
+//
+// A snapshot on disk is "VJSNAPSH", the version & the size, then the snapshot
+// itself, gzipped. It goes in under another name first and is then renamed,
+// so nobody reading it can see half of one.
+//
+bool SnapshotWriteFile(uint32_t slot, const char * filename)
+{
+	const Snapshot & s = snapshots[slot];
+
+	if (s.size == 0)
+		return false;
+
+	char tempName[MAX_PATH + 8];
+	snprintf(tempName, sizeof(tempName), "%s.new", filename);
+	gzFile fp = gzopen(tempName, "wb1");
+
+	if (fp == NULL)
+	{
+		WriteLog("STATE: Could not create \"%s\"!\n", tempName);
+		return false;
+	}
+
+	uint32_t header[2] = { SNAPSHOT_VERSION, s.size };
+	bool ok = (gzwrite(fp, "VJSNAPSH", 8) == 8)
+		&& (gzwrite(fp, header, sizeof(header)) == (int)sizeof(header))
+		&& (gzwrite(fp, s.data, s.size) == (int)s.size);
+
+	if ((gzclose(fp) != Z_OK) || !ok)
+	{
+		WriteLog("STATE: Could not write \"%s\"!\n", tempName);
+		remove(tempName);
+		return false;
+	}
+
+	// Windows won't rename over a file that's already there
+	remove(filename);
+
+	if (rename(tempName, filename) != 0)
+	{
+		remove(tempName);
+		return false;
+	}
+
+	return true;
+}
+
+
+//
+// Anything that isn't a whole snapshot of the same size as the one we'd take
+// is turned down, & the slot is left alone
+//
+bool SnapshotReadFile(uint32_t slot, const char * filename)
+{
+	gzFile fp = gzopen(filename, "rb");
+
+	if (fp == NULL)
+		return false;
+
+	char id[8];
+	uint32_t header[2];
+	bool ok = (gzread(fp, id, 8) == 8) && (memcmp(id, "VJSNAPSH", 8) == 0)
+		&& (gzread(fp, header, sizeof(header)) == (int)sizeof(header))
+		&& (header[0] == SNAPSHOT_VERSION);
+
+	if (ok)
+	{
+		// The size we'd get if we took one now
+		Snapshot & s = snapshots[slot];
+		SnapshotSave(slot);
+		ok = (header[1] == s.size);
+
+		if (ok)
+		{
+			uint8_t extra;
+			ok = (gzread(fp, s.data, s.size) == (int)s.size) && (gzread(fp, &extra, 1) == 0);
+		}
+
+		if (!ok)
+			s.size = 0;
+	}
+
+	if ((gzclose(fp) != Z_OK) || !ok)
+	{
+		WriteLog("STATE: \"%s\" isn't a snapshot we can use.\n", filename);
+		snapshots[slot].size = 0;
+		return false;
+	}
+
+	return true;
+}
+
+
+static void SnapshotWalk(void)
+{
+	MemorySnapshot();
+	JaguarSnapshot();
+	EventSnapshot();
+	TOMSnapshot();
+	JERRYSnapshot();
+	OPSnapshot();
+	BlitterSnapshot();
+	GPUSnapshot();
+	DSPSnapshot();
+	CDROMSnapshot();
+	EepromSnapshot();
+	MTSnapshot();
+	JoystickSnapshot();
+}
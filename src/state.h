@@ -7,7 +7,25 @@
 #ifndef __STATE_H__
 #define __STATE_H__
 
+#include <stdint.h>
+
 bool SaveState(void);
 bool LoadState(void);
 
+// In-memory snapshots (see state.cpp)
+
+enum { SNAPSHOT_RUN_AHEAD = 0, SNAPSHOT_BOOT, SNAPSHOT_SLOTS };
+
+void SnapshotSave(uint32_t slot);
+bool SnapshotRestore(uint32_t slot);
+uint32_t SnapshotSize(uint32_t slot);
+uint32_t SnapshotSlot(void);
+bool SnapshotWriteFile(uint32_t slot, const char * filename);
+bool SnapshotReadFile(uint32_t slot, const char * filename);
+
+// For the XXXSnapshot() functions: copies one piece of state into the
+// snapshot, or back out of it
+void SnapshotData(void * data, uint32_t size);
+#define SNAPSHOT(x)		SnapshotData(&(x), sizeof(x))
+
 #endif	// __STATE_H__
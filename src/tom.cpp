@@ -264,6 +264,7 @@
 //#include "memory.h"
 #include "op.h"
 #include "settings.h"
+#include "state.h"
 
 #define NEW_TIMER_SYSTEM
 
@@ -346,18 +347,18 @@
 //(It's easier to do it here, though...)
 //#define TOM_DEBUG
 
-uint8_t tomRam8[0x4000];
-uint32_t tomWidth, tomHeight;
-uint32_t tomTimerPrescaler;
-uint32_t tomTimerDivider;
-int32_t tomTimerCounter;
-uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
+MACHINE_STATE uint8_t tomRam8[0x4000];
+MACHINE_STATE uint32_t tomWidth, tomHeight;
+MACHINE_STATE uint32_t tomTimerPrescaler;
+MACHINE_STATE uint32_t tomTimerDivider;
+MACHINE_STATE int32_t tomTimerCounter;
+MACHINE_STATE uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
 	tom_gpu_int_pending, tom_video_int_pending;
 
 // These are set by the "user" of the Jaguar core lib, since these are
 // OS/system dependent.
-uint32_t * screenBuffer;
-uint32_t screenPitch;
+MACHINE_STATE uint32_t * screenBuffer;
+MACHINE_STATE uint32_t screenPitch;
 
 static const char * videoMode_to_str[8] =
 	{ "16 BPP CRY", "24 BPP RGB", "16 BPP DIRECT", "16 BPP RGB",
@@ -557,21 +558,71 @@ Vertical resolution: 238 lines
 */
 
 // 16-bit color lookup tables
-uint32_t RGB16ToRGB32[0x10000];
-uint32_t CRY16ToRGB32[0x10000];
-uint32_t MIX16ToRGB32[0x10000];
-
+//
+// These are generated by the compiler, so they sit in read-only data (shared
+// by every machine in the process, and between processes) instead of being
+// filled in at startup. Define TOM_COMPACT_COLOR_TABLES to trade the 512K of
+// tables for 2K and a multiply per CRY pixel, which is kinder to the cache.
 
 #warning "This is not endian-safe. !!! FIX !!!"
-void TOMFillLookupTables(void)
+// NOTE: Jaguar 16-bit (non-CRY) color is RBG 556 like so:
+//       RRRR RBBB BBGG GGGG
+static constexpr uint32_t TOMRGB16ToRGB32(uint32_t color)
 {
-	// NOTE: Jaguar 16-bit (non-CRY) color is RBG 556 like so:
-	//       RRRR RBBB BBGG GGGG
-	for(uint32_t i=0; i<0x10000; i++)
-		RGB16ToRGB32[i] = 0x000000FF
-			| ((i & 0xF800) << 16)					// Red
-			| ((i & 0x003F) << 18)					// Green
-			| ((i & 0x07C0) << 5);					// Blue
+	return 0x000000FF
+		| ((color & 0xF800) << 16)					// Red
+		| ((color & 0x003F) << 18)					// Green
+		| ((color & 0x07C0) << 5);					// Blue
+}
+
+#ifdef TOM_COMPACT_COLOR_TABLES
+// Each cyan/red pair's red, green & blue, 16 bits apiece, so one multiply by
+// the intensity scales all three at once (255 * 255 can't spill into the next
+// channel).
+struct CRYColorTable
+{
+	uint64_t color[0x100];
+};
+
+static constexpr CRYColorTable MakeCRYColorTable(void)
+{
+	CRYColorTable table = {};
+
+	for(uint32_t i=0; i<0x100; i++)
+		table.color[i] = ((uint64_t)redcv[i >> 4][i & 0x0F] << 32)
+			| ((uint64_t)greencv[i >> 4][i & 0x0F] << 16)
+			| (uint64_t)bluecv[i >> 4][i & 0x0F];
+
+	return table;
+}
+
+static constexpr CRYColorTable cryColorTable = MakeCRYColorTable();
+
+static inline uint32_t TOMCRY16ToRGB32(uint32_t color)
+{
+	uint64_t rgb = cryColorTable.color[color >> 8] * (color & 0x00FF);
+
+	return 0x000000FF
+		| ((uint32_t)(rgb >> 16) & 0xFF000000)		// Red
+		| ((uint32_t)(rgb >> 8) & 0x00FF0000)		// Green
+		| ((uint32_t)rgb & 0x0000FF00);				// Blue
+}
+
+static inline uint32_t TOMMIX16ToRGB32(uint32_t color)
+{
+	return (color & 0x01 ? TOMRGB16ToRGB32(color) : TOMCRY16ToRGB32(color));
+}
+#else
+// RGB pixels are only a few shifts, so they don't get a table of their own.
+struct ColorTables
+{
+	uint32_t cry[0x10000];
+	uint32_t mix[0x10000];
+};
+
+static constexpr ColorTables MakeColorTables(void)
+{
+	ColorTables tables = {};
 
 	for(uint32_t i=0; i<0x10000; i++)
 	{
@@ -583,11 +634,19 @@ void TOMFillLookupTables(void)
 			g = (((uint32_t)greencv[cyan][red]) * intensity) >> 8,
 			b = (((uint32_t)bluecv[cyan][red]) * intensity) >> 8;
 
-		CRY16ToRGB32[i] = 0x000000FF | (r << 24) | (g << 16) | (b << 8);
-		MIX16ToRGB32[i] = (i & 0x01 ? RGB16ToRGB32[i] : CRY16ToRGB32[i]);
+		tables.cry[i] = 0x000000FF | (r << 24) | (g << 16) | (b << 8);
+		tables.mix[i] = (i & 0x01 ? TOMRGB16ToRGB32(i) : tables.cry[i]);
 	}
+
+	return tables;
 }
 
+static constexpr ColorTables colorTables = MakeColorTables();
+
+#define TOMCRY16ToRGB32(color)	colorTables.cry[color]
+#define TOMMIX16ToRGB32(color)	colorTables.mix[color]
+#endif
+
 
 void TOMSetPendingJERRYInt(void)
 {
@@ -704,7 +763,7 @@ void tom_render_16bpp_cry_rgb_mix_scanline(uint32_t * backbuffer)
 	{
 		uint16_t color = (*current_line_buffer++) << 8;
 		color |= *current_line_buffer++;
-		*backbuffer++ = MIX16ToRGB32[color];
+		*backbuffer++ = TOMMIX16ToRGB32(color);
 		width--;
 	}
 }
@@ -747,7 +806,7 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
 	{
 		uint16_t color = (*current_line_buffer++) << 8;
 		color |= *current_line_buffer++;
-		*backbuffer++ = CRY16ToRGB32[color];
+		*backbuffer++ = TOMCRY16ToRGB32(color);
 		width--;
 	}
 }
@@ -857,7 +916,7 @@ void tom_render_16bpp_rgb_scanline(uint32_t * backbuffer)
 	{
 		uint32_t color = (*current_line_buffer++) << 8;
 		color |= *current_line_buffer++;
-		*backbuffer++ = RGB16ToRGB32[color];
+		*backbuffer++ = TOMRGB16ToRGB32(color);
 		width--;
 	}
 }
@@ -1059,12 +1118,75 @@ void tom_render_24bpp_scanline(uint32_t * backbuffer)
 }
 
 
+static void TOMWritePITByte(uint32_t offset, uint8_t data, uint32_t who);
+static void TOMWritePITWord(uint32_t offset, uint16_t data, uint32_t who);
+static void TOMWriteVMODE(uint32_t offset, uint16_t data, uint32_t who);
+static void TOMWriteHP(uint32_t offset, uint16_t data, uint32_t who);
+static void TOMWriteVP(uint32_t offset, uint16_t data, uint32_t who);
+static void TOMWriteINT1(uint32_t offset, uint16_t data, uint32_t who);
+
+//
+// TOM's registers ($F00000 - $F000FF)
+//
+static const IORegister tomRegisterList[] = {
+	{ MEMCON1, "MEMCON1", "Memory Config 1", 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ MEMCON2, "MEMCON2", "Memory Config 2", 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ HC,      "HC",      NULL, 2, 0, 0x07FF, NULL, NULL },
+	{ VC,      "VC",      NULL, 2, 0, 0x0FFF, NULL, NULL },
+	{ OLP,     "OLP",     NULL, 4, 0, 0xFFFF, NULL, NULL },
+	{ OBF,     "OBF",     NULL, 2, 0, 0xFFFF, NULL, NULL },
+	{ VMODE,   "VMODE",   NULL, 2, IOR_VIDEO, 0x0FFF, NULL, TOMWriteVMODE },
+	{ BORD1,   "BORD1",   "Border 1", 2, IOR_HEX | IOR_VIDEO, 0xFFFF, NULL, NULL },
+	{ BORD2,   "BORD2",   "Border 2", 2, IOR_HEX | IOR_VIDEO, 0xFFFF, NULL, NULL },
+	{ HP,      "HP",      NULL, 2, IOR_VIDEO, 0x03FF, NULL, TOMWriteHP },
+	{ HBB,     "HBB",     "Horizontal Blank Begin", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ HBE,     "HBE",     "Horizontal Blank End", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ HS,      "HS",      "Horizontal Sync", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ HVS,     "HVS",     "Horizontal Vertical Sync", 2, IOR_VIDEO, 0x03FF, NULL, NULL },
+	{ HDB1,    "HDB1",    "Horizontal Display Begin 1", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ HDB2,    "HDB2",    "Horizontal Display Begin 2", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ HDE,     "HDE",     "Horizontal Display End", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VP,      "VP",      NULL, 2, IOR_VIDEO, 0x07FF, NULL, TOMWriteVP },
+	{ VBB,     "VBB",     "Vertical Blank Begin", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VBE,     "VBE",     "Vertical Blank End", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VS,      "VS",      "Vertical Sync", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VDB,     "VDB",     "Vertical Display Begin", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VDE,     "VDE",     "Vertical Display End", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VEB,     "VEB",     "Vertical Equalization Begin", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VEE,     "VEE",     "Vertical Equalization End", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ VI,      "VI",      "Vertical Interrupt", 2, IOR_VIDEO, 0x07FF, NULL, NULL },
+	{ PIT0,    "PIT0",    "PIT0", 2, 0, 0xFFFF, TOMWritePITByte, TOMWritePITWord },
+	{ PIT1,    "PIT1",    "PIT1", 2, 0, 0xFFFF, TOMWritePITByte, TOMWritePITWord },
+	{ HEQ,     "HEQ",     "Horizontal Equalization End", 2, 0, 0x03FF, NULL, NULL },
+	{ BG,      "BG",      NULL, 2, IOR_HEX, 0xFFFF, NULL, NULL },
+	{ INT1,    "INT1",    NULL, 2, IOR_HEX, 0xFFFF, NULL, TOMWriteINT1 },
+	{ INT2,    "INT2",    NULL, 2, IOR_HEX, 0xFFFF, NULL, NULL }
+};
+
+// ...and where each word of them lives in the list
+static MACHINE_STATE const IORegister * tomRegister[0x80];
+
+
+static void TOMBuildRegisterTable(void)
+{
+	memset(tomRegister, 0, sizeof(tomRegister));
+
+	for(uint32_t i=0; i<sizeof(tomRegisterList)/sizeof(IORegister); i++)
+	{
+		const IORegister * reg = &tomRegisterList[i];
+
+		for(uint32_t j=0; j<reg->size; j+=2)
+			tomRegister[(reg->offset + j) >> 1] = reg;
+	}
+}
+
+
 //
 // TOM initialization
 //
 void TOMInit(void)
 {
-	TOMFillLookupTables();
+	TOMBuildRegisterTable();
 	OPInit();
 	BlitterInit();
 	TOMReset();
@@ -1081,6 +1203,26 @@ void TOMDone(void)
 }
 
 
+//
+// See STATE.CPP. The screen buffer & the color lookup tables belong to the
+// host, so they stay put.
+//
+void TOMSnapshot(void)
+{
+	SNAPSHOT(tomRam8);
+	SNAPSHOT(tomWidth);
+	SNAPSHOT(tomHeight);
+	SNAPSHOT(tomTimerPrescaler);
+	SNAPSHOT(tomTimerDivider);
+	SNAPSHOT(tomTimerCounter);
+	SNAPSHOT(tom_jerry_int_pending);
+	SNAPSHOT(tom_timer_int_pending);
+	SNAPSHOT(tom_object_int_pending);
+	SNAPSHOT(tom_gpu_int_pending);
+	SNAPSHOT(tom_video_int_pending);
+}
+
+
 uint32_t TOMGetVideoModeWidth(void)
 {
 	// Note that the following PWIDTH values have the following pixel aspect
@@ -1226,38 +1368,18 @@ void TOMDumpIORegistersToLog(void)
 	WriteLog("\n\n---------------------------------------------------------------------\n");
 	WriteLog("TOM I/O Registers\n");
 	WriteLog("---------------------------------------------------------------------\n");
-	WriteLog("F000%02X (MEMCON1): $%04X\n", MEMCON1, GET16(tomRam8, MEMCON1));
-	WriteLog("F000%02X (MEMCON2): $%04X\n", MEMCON2, GET16(tomRam8, MEMCON2));
-	WriteLog("F000%02X      (HC): $%04X\n", HC,      GET16(tomRam8, HC));
-	WriteLog("F000%02X      (VC): $%04X\n", VC,      GET16(tomRam8, VC));
-	WriteLog("F000%02X     (OLP): $%08X\n", OLP,     GET32(tomRam8, OLP));
-	WriteLog("F000%02X     (OBF): $%04X\n", OBF,     GET16(tomRam8, OBF));
-	WriteLog("F000%02X   (VMODE): $%04X\n", VMODE,   GET16(tomRam8, VMODE));
-	WriteLog("F000%02X   (BORD1): $%04X\n", BORD1,   GET16(tomRam8, BORD1));
-	WriteLog("F000%02X   (BORD2): $%04X\n", BORD2,   GET16(tomRam8, BORD2));
-	WriteLog("F000%02X      (HP): $%04X\n", HP,      GET16(tomRam8, HP));
-	WriteLog("F000%02X     (HBB): $%04X\n", HBB,     GET16(tomRam8, HBB));
-	WriteLog("F000%02X     (HBE): $%04X\n", HBE,     GET16(tomRam8, HBE));
-	WriteLog("F000%02X      (HS): $%04X\n", HS,      GET16(tomRam8, HS));
-	WriteLog("F000%02X     (HVS): $%04X\n", HVS,     GET16(tomRam8, HVS));
-	WriteLog("F000%02X    (HDB1): $%04X\n", HDB1,    GET16(tomRam8, HDB1));
-	WriteLog("F000%02X    (HDB2): $%04X\n", HDB2,    GET16(tomRam8, HDB2));
-	WriteLog("F000%02X     (HDE): $%04X\n", HDE,     GET16(tomRam8, HDE));
-	WriteLog("F000%02X      (VP): $%04X\n", VP,      GET16(tomRam8, VP));
-	WriteLog("F000%02X     (VBB): $%04X\n", VBB,     GET16(tomRam8, VBB));
-	WriteLog("F000%02X     (VBE): $%04X\n", VBE,     GET16(tomRam8, VBE));
-	WriteLog("F000%02X      (VS): $%04X\n", VS,      GET16(tomRam8, VS));
-	WriteLog("F000%02X     (VDB): $%04X\n", VDB,     GET16(tomRam8, VDB));
-	WriteLog("F000%02X     (VDE): $%04X\n", VDE,     GET16(tomRam8, VDE));
-	WriteLog("F000%02X     (VEB): $%04X\n", VEB,     GET16(tomRam8, VEB));
-	WriteLog("F000%02X     (VEE): $%04X\n", VEE,     GET16(tomRam8, VEE));
-	WriteLog("F000%02X      (VI): $%04X\n", VI,      GET16(tomRam8, VI));
-	WriteLog("F000%02X    (PIT0): $%04X\n", PIT0,    GET16(tomRam8, PIT0));
-	WriteLog("F000%02X    (PIT1): $%04X\n", PIT1,    GET16(tomRam8, PIT1));
-	WriteLog("F000%02X     (HEQ): $%04X\n", HEQ,     GET16(tomRam8, HEQ));
-	WriteLog("F000%02X      (BG): $%04X\n", BG,      GET16(tomRam8, BG));
-	WriteLog("F000%02X    (INT1): $%04X\n", INT1,    GET16(tomRam8, INT1));
-	WriteLog("F000%02X    (INT2): $%04X\n", INT2,    GET16(tomRam8, INT2));
+	for(uint32_t i=0; i<sizeof(tomRegisterList)/sizeof(IORegister); i++)
+	{
+		const IORegister & reg = tomRegisterList[i];
+		char name[16];
+		sprintf(name, "(%s)", reg.name);
+
+		if (reg.size == 4)
+			WriteLog("F000%02X %9s: $%08X\n", reg.offset, name, GET32(tomRam8, reg.offset));
+		else
+			WriteLog("F000%02X %9s: $%04X\n", reg.offset, name, GET16(tomRam8, reg.offset));
+	}
+
 	WriteLog("---------------------------------------------------------------------\n\n\n");
 }
 
@@ -1357,6 +1479,7 @@ if (offset >= 0xF02000 && offset <= 0xF020FF)
 
 
 #define TOM_STRICT_MEMORY_ACCESS
+
 //
 // TOM byte access (write)
 //
@@ -1388,58 +1511,38 @@ void TOMWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 		return;
 #endif
 
-	if ((offset >= GPU_CONTROL_RAM_BASE) && (offset < GPU_CONTROL_RAM_BASE+0x20))
-	{
-		GPUWriteByte(offset, data, who);
-		return;
-	}
-	else if ((offset >= GPU_WORK_RAM_BASE) && (offset < GPU_WORK_RAM_BASE+0x1000))
-	{
-		GPUWriteByte(offset, data, who);
-		return;
-	}
-/*	else if ((offset >= 0xF00010) && (offset < 0xF00028))
+	// Sort it out by which 256 byte page it's in
+	switch ((offset >> 8) & 0x3F)
 	{
-		OPWriteByte(offset, data, who);
-		return;
-	}*/
-	else if ((offset >= 0xF02200) && (offset < 0xF022A0))
-	{
-		BlitterWriteByte(offset, data, who);
-		return;
-	}
-	else if (offset == 0xF00050)
+	case 0x00:								// TOM registers
 	{
-		tomTimerPrescaler = (tomTimerPrescaler & 0x00FF) | (data << 8);
-		TOMResetPIT();
-		return;
-	}
-	else if (offset == 0xF00051)
-	{
-		tomTimerPrescaler = (tomTimerPrescaler & 0xFF00) | data;
-		TOMResetPIT();
-		return;
-	}
-	else if (offset == 0xF00052)
-	{
-		tomTimerDivider = (tomTimerDivider & 0x00FF) | (data << 8);
-		TOMResetPIT();
-		return;
-	}
-	else if (offset == 0xF00053)
-	{
-		tomTimerDivider = (tomTimerDivider & 0xFF00) | data;
-		TOMResetPIT();
-		return;
+		const IORegister * reg = tomRegister[(offset & 0xFF) >> 1];
+
+		if (reg && reg->writeByte)
+			reg->writeByte(offset, data, who);
+
+		break;
 	}
-	else if (offset >= 0xF00400 && offset <= 0xF007FF)	// CLUT (A & B)
-	{
+	case 0x04: case 0x05: case 0x06: case 0x07:	// CLUT (A & B)
 		// Writing to one CLUT writes to the other
 		offset &= 0x5FF;		// Mask out $F00600 (restrict to $F00400-5FF)
 		tomRam8[offset] = data, tomRam8[offset + 0x200] = data;
+		break;
+	case 0x21:								// GPU control
+		if ((offset & 0xFF) < 0x20)
+			GPUWriteByte(offset, data, who);
+
+		break;
+	case 0x22:								// Blitter
+		if ((offset & 0xFF) < 0xA0)
+			BlitterWriteByte(offset, data, who);
+
+		break;
+	case 0x30: case 0x31: case 0x32: case 0x33: case 0x34: case 0x35: case 0x36: case 0x37:
+	case 0x38: case 0x39: case 0x3A: case 0x3B: case 0x3C: case 0x3D: case 0x3E: case 0x3F:
+		GPUWriteByte(offset, data, who);	// GPU RAM
+		break;
 	}
-
-//	tomRam8[offset & 0x3FFF] = data;
 }
 
 
@@ -1474,177 +1577,144 @@ void TOMWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 		return;
 #endif
 
-//if (offset == 0xF00000 + MEMCON1)
-//	WriteLog("TOM: Memory Configuration 1 written by %s: %04X\n", whoName[who], data);
-//if (offset == 0xF00000 + MEMCON2)
-//	WriteLog("TOM: Memory Configuration 2 written by %s: %04X\n", whoName[who], data);
-if (offset >= 0xF02000 && offset <= 0xF020FF)
-	WriteLog("TOM: WriteWord attempted to GPU register file by %s (unimplemented)!\n", whoName[who]);
-
-	if ((offset >= GPU_CONTROL_RAM_BASE) && (offset < GPU_CONTROL_RAM_BASE+0x20))
+	// Sort it out by which 256 byte page it's in
+	switch ((offset >> 8) & 0x3F)
 	{
-		GPUWriteWord(offset, data, who);
-		return;
-	}
-	else if ((offset >= GPU_WORK_RAM_BASE) && (offset < GPU_WORK_RAM_BASE+0x1000))
+	case 0x00:								// TOM registers
 	{
-		GPUWriteWord(offset, data, who);
-		return;
-	}
-//What's so special about this?
-/*	else if ((offset >= 0xF00000) && (offset < 0xF00002))
-	{
-		TOMWriteByte(offset, data >> 8);
-		TOMWriteByte(offset+1, data & 0xFF);
-	}*/
-/*	else if ((offset >= 0xF00010) && (offset < 0xF00028))
-	{
-		OPWriteWord(offset, data, who);
-		return;
-	}*/
-	else if (offset == 0xF00050)
-	{
-		tomTimerPrescaler = data;
-		TOMResetPIT();
-		return;
-	}
-	else if (offset == 0xF00052)
-	{
-		tomTimerDivider = data;
-		TOMResetPIT();
-		return;
-	}
-	else if (offset == 0xF000E0)
-	{
-//Check this out...
-		if (data & 0x0100)
-			tom_video_int_pending = 0;
-		if (data & 0x0200)
-			tom_gpu_int_pending = 0;
-		if (data & 0x0400)
-			tom_object_int_pending = 0;
-		if (data & 0x0800)
-			tom_timer_int_pending = 0;
-		if (data & 0x1000)
-			tom_jerry_int_pending = 0;
-
-//		return;
-	}
-	else if ((offset >= 0xF02200) && (offset <= 0xF0229F))
-	{
-		BlitterWriteWord(offset, data, who);
-		return;
+		const IORegister * reg = tomRegister[(offset & 0xFF) >> 1];
+
+		if (reg == NULL)
+			break;
+
+		if (reg->writeWord)
+			reg->writeWord(offset, data, who);
+
+		if (reg->description)
+			WriteLog((reg->flags & IOR_HEX ? "TOM: %s written by %s: $%04X\n"
+				: "TOM: %s written by %s: %u\n"), reg->description, whoName[who], data & reg->mask);
+
+		// detect screen resolution changes
+//This may go away in the future, if we do the virtualized screen thing...
+//This may go away soon!
+// TOM Shouldn't be mucking around with this, it's up to the host system to properly
+// handle this kind of crap.
+// NOTE: This is needed somehow, need to get rid of the dependency on this crap.
+//       N.B.: It's used in the rendering functions... So...
+#warning "!!! Need to get rid of this dependency !!!"
+		if (reg->flags & IOR_VIDEO)
+		{
+			uint32_t width = TOMGetVideoModeWidth(), height = TOMGetVideoModeHeight();
+
+			if ((width != tomWidth) || (height != tomHeight))
+			{
+				tomWidth = width, tomHeight = height;
+
+#warning "!!! TOM: ResizeScreen commented out !!!"
+// No need to resize anything, since we're prepared for this...
+//				if (vjs.renderType == RT_NORMAL)
+//					ResizeScreen(tomWidth, tomHeight);
+			}
+		}
+
+		break;
 	}
-	else if (offset >= 0xF00400 && offset <= 0xF007FE)	// CLUT (A & B)
-	{
+	case 0x04: case 0x05: case 0x06: case 0x07:	// CLUT (A & B)
 		// Writing to one CLUT writes to the other
 		offset &= 0x5FF;		// Mask out $F00600 (restrict to $F00400-5FF)
 // Watch out for unaligned writes here! (Not fixed yet)
 #warning "!!! Watch out for unaligned writes here !!! FIX !!!"
 		SET16(tomRam8, offset, data);
 		SET16(tomRam8, offset + 0x200, data);
+		break;
+	case 0x20:
+		WriteLog("TOM: WriteWord attempted to GPU register file by %s (unimplemented)!\n", whoName[who]);
+		break;
+	case 0x21:								// GPU control
+		if ((offset & 0xFF) < 0x20)
+			GPUWriteWord(offset, data, who);
+
+		break;
+	case 0x22:								// Blitter
+		if ((offset & 0xFF) < 0xA0)
+			BlitterWriteWord(offset, data, who);
+
+		break;
+	case 0x30: case 0x31: case 0x32: case 0x33: case 0x34: case 0x35: case 0x36: case 0x37:
+	case 0x38: case 0x39: case 0x3A: case 0x3B: case 0x3C: case 0x3D: case 0x3E: case 0x3F:
+		GPUWriteWord(offset, data, who);	// GPU RAM
+		break;
 	}
+}
 
-	offset &= 0x3FFF;
-	if (offset == 0x28)			// VMODE (Why? Why not OBF?)
+
+//
+// PIT0 & PIT1 ($F00050 & $F00052): TOM's timer prescaler & divider
+//
+static void TOMWritePITByte(uint32_t offset, uint8_t data, uint32_t who)
+{
+	uint32_t & reg = ((offset & 0x02) ? tomTimerDivider : tomTimerPrescaler);
+
+	if (offset & 0x01)
+		reg = (reg & 0xFF00) | data;
+	else
+		reg = (reg & 0x00FF) | (data << 8);
+
+	TOMResetPIT();
+}
+
+
+static void TOMWritePITWord(uint32_t offset, uint16_t data, uint32_t who)
+{
+	if (offset & 0x02)
+		tomTimerDivider = data;
+	else
+		tomTimerPrescaler = data;
+
+	TOMResetPIT();
+}
+
+
+static void TOMWriteVMODE(uint32_t offset, uint16_t data, uint32_t who)
+{
 //Actually, we should check to see if the Enable bit of VMODE is set before doing this... !!! FIX !!!
 #warning "Actually, we should check to see if the Enable bit of VMODE is set before doing this... !!! FIX !!!"
-		objectp_running = 1;
-
-	if (offset >= 0x30 && offset <= 0x4E)
-		data &= 0x07FF;			// These are (mostly) 11-bit registers
-	if (offset == 0x2E || offset == 0x36 || offset == 0x54)
-		data &= 0x03FF;			// These are all 10-bit registers
-
-// Fix a lockup bug... :-P
-//	TOMWriteByte(0xF00000 | offset, data >> 8, who);
-//	TOMWriteByte(0xF00000 | (offset+1), data & 0xFF, who);
-
-if (offset == MEMCON1)
-	WriteLog("TOM: Memory Config 1 written by %s: $%04X\n", whoName[who], data);
-if (offset == MEMCON2)
-	WriteLog("TOM: Memory Config 2 written by %s: $%04X\n", whoName[who], data);
-//if (offset == OLP)
-//	WriteLog("TOM: Object List Pointer written by %s: $%04X\n", whoName[who], data);
-//if (offset == OLP + 2)
-//	WriteLog("TOM: Object List Pointer +2 written by %s: $%04X\n", whoName[who], data);
-//if (offset == OBF)
-//	WriteLog("TOM: Object Processor Flag written by %s: %u\n", whoName[who], data);
-if (offset == VMODE)
+	objectp_running = 1;
+
 	WriteLog("TOM: Video Mode written by %s: %04X. PWIDTH = %u, MODE = %s, flags:%s%s (VC = %u) (M68K PC = %06X)\n", whoName[who], data, ((data >> 9) & 0x07) + 1, videoMode_to_str[(data & MODE) >> 1], (data & BGEN ? " BGEN" : ""), (data & VARMOD ? " VARMOD" : ""), GET16(tomRam8, VC), m68k_get_reg(NULL, M68K_REG_PC));
-if (offset == BORD1)
-	WriteLog("TOM: Border 1 written by %s: $%04X\n", whoName[who], data);
-if (offset == BORD2)
-	WriteLog("TOM: Border 2 written by %s: $%04X\n", whoName[who], data);
-if (offset == HP)
+}
+
+
+static void TOMWriteHP(uint32_t offset, uint16_t data, uint32_t who)
+{
+	data &= 0x03FF;
 	WriteLog("TOM: Horizontal Period written by %s: %u (+1*2 = %u)\n", whoName[who], data, (data + 1) * 2);
-if (offset == HBB)
-	WriteLog("TOM: Horizontal Blank Begin written by %s: %u\n", whoName[who], data);
-if (offset == HBE)
-	WriteLog("TOM: Horizontal Blank End written by %s: %u\n", whoName[who], data);
-if (offset == HS)
-	WriteLog("TOM: Horizontal Sync written by %s: %u\n", whoName[who], data);
-if (offset == HVS)
-	WriteLog("TOM: Horizontal Vertical Sync written by %s: %u\n", whoName[who], data);
-if (offset == HDB1)
-	WriteLog("TOM: Horizontal Display Begin 1 written by %s: %u\n", whoName[who], data);
-if (offset == HDB2)
-	WriteLog("TOM: Horizontal Display Begin 2 written by %s: %u\n", whoName[who], data);
-if (offset == HDE)
-	WriteLog("TOM: Horizontal Display End written by %s: %u\n", whoName[who], data);
-if (offset == VP)
+}
+
+
+static void TOMWriteVP(uint32_t offset, uint16_t data, uint32_t who)
+{
+	data &= 0x07FF;
 	WriteLog("TOM: Vertical Period written by %s: %u (%sinterlaced)\n", whoName[who], data, (data & 0x01 ? "non-" : ""));
-if (offset == VBB)
-	WriteLog("TOM: Vertical Blank Begin written by %s: %u\n", whoName[who], data);
-if (offset == VBE)
-	WriteLog("TOM: Vertical Blank End written by %s: %u\n", whoName[who], data);
-if (offset == VS)
-	WriteLog("TOM: Vertical Sync written by %s: %u\n", whoName[who], data);
-if (offset == VDB)
-	WriteLog("TOM: Vertical Display Begin written by %s: %u\n", whoName[who], data);
-if (offset == VDE)
-	WriteLog("TOM: Vertical Display End written by %s: %u\n", whoName[who], data);
-if (offset == VEB)
-	WriteLog("TOM: Vertical Equalization Begin written by %s: %u\n", whoName[who], data);
-if (offset == VEE)
-	WriteLog("TOM: Vertical Equalization End written by %s: %u\n", whoName[who], data);
-if (offset == VI)
-	WriteLog("TOM: Vertical Interrupt written by %s: %u\n", whoName[who], data);
-if (offset == PIT0)
-	WriteLog("TOM: PIT0 written by %s: %u\n", whoName[who], data);
-if (offset == PIT1)
-	WriteLog("TOM: PIT1 written by %s: %u\n", whoName[who], data);
-if (offset == HEQ)
-	WriteLog("TOM: Horizontal Equalization End written by %s: %u\n", whoName[who], data);
-//if (offset == BG)
-//	WriteLog("TOM: Background written by %s: %u\n", whoName[who], data);
-//if (offset == INT1)
-//	WriteLog("TOM: CPU Interrupt Control written by %s: $%04X (%s%s%s%s%s)\n", whoName[who], data, (data & 0x01 ? "Video" : ""), (data & 0x02 ? " GPU" : ""), (data & 0x04 ? " OP" : ""), (data & 0x08 ? " TOMPIT" : ""), (data & 0x10 ? " Jerry" : ""));
-
-	// detect screen resolution changes
-//This may go away in the future, if we do the virtualized screen thing...
-//This may go away soon!
-// TOM Shouldn't be mucking around with this, it's up to the host system to properly
-// handle this kind of crap.
-// NOTE: This is needed somehow, need to get rid of the dependency on this crap.
-//       N.B.: It's used in the rendering functions... So...
-#warning "!!! Need to get rid of this dependency !!!"
-#if 1
-	if ((offset >= 0x28) && (offset <= 0x4F))
-	{
-		uint32_t width = TOMGetVideoModeWidth(), height = TOMGetVideoModeHeight();
+}
 
-		if ((width != tomWidth) || (height != tomHeight))
-		{
-			tomWidth = width, tomHeight = height;
 
-#warning "!!! TOM: ResizeScreen commented out !!!"
-// No need to resize anything, since we're prepared for this...
-//			if (vjs.renderType == RT_NORMAL)
-//				ResizeScreen(tomWidth, tomHeight);
-		}
-	}
-#endif
+//
+// INT1 ($F000E0): Writing the upper byte clears pending interrupts
+//
+static void TOMWriteINT1(uint32_t offset, uint16_t data, uint32_t who)
+{
+//Check this out...
+	if (data & 0x0100)
+		tom_video_int_pending = 0;
+	if (data & 0x0200)
+		tom_gpu_int_pending = 0;
+	if (data & 0x0400)
+		tom_object_int_pending = 0;
+	if (data & 0x0800)
+		tom_timer_int_pending = 0;
+	if (data & 0x1000)
+		tom_jerry_int_pending = 0;
 }
 
 
@@ -28,6 +28,7 @@ enum { IRQ_VIDEO = 0, IRQ_GPU, IRQ_OPFLAG, IRQ_TIMER, IRQ_DSP };
 void TOMInit(void);
 void TOMReset(void);
 void TOMDone(void);
+void TOMSnapshot(void);
 
 uint8_t TOMReadByte(uint32_t offset, uint32_t who = UNKNOWN);
 uint16_t TOMReadWord(uint32_t offset, uint32_t who = UNKNOWN);
@@ -60,14 +61,14 @@ void TOMResetPIT(void);
 
 // Exported variables
 
-extern uint32_t tomWidth;
-extern uint32_t tomHeight;
-extern uint8_t tomRam8[];
-extern uint32_t tomTimerPrescaler;
-extern uint32_t tomTimerDivider;
-extern int32_t tomTimerCounter;
+extern MACHINE_STATE uint32_t tomWidth;
+extern MACHINE_STATE uint32_t tomHeight;
+extern MACHINE_STATE uint8_t tomRam8[];
+extern MACHINE_STATE uint32_t tomTimerPrescaler;
+extern MACHINE_STATE uint32_t tomTimerDivider;
+extern MACHINE_STATE int32_t tomTimerCounter;
 
-extern uint32_t screenPitch;
-extern uint32_t * screenBuffer;
+extern MACHINE_STATE uint32_t screenPitch;
+extern MACHINE_STATE uint32_t * screenBuffer;
 
 #endif	// __TOM_H__
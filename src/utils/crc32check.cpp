@@ -0,0 +1,136 @@
+//
+// crc32check.cpp - Check the fast CRC32 paths against the old one, and time them
+//
+// Usage: crc32check [options]
+//
+// Hashes a batch of random buffers (random lengths, at random alignments)
+// with both crc32_calcCheckSum() and the old byte-at-a-time
+// crc32_calcCheckSumReference(), which have to agree on every one. Then times
+// both over one big buffer and prints how fast each went.
+//
+// The exit status is 0 if everything matched, and 1 if not.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "crc32.h"
+
+static uint32_t seed = 1;
+
+
+//
+// Xorshift; the same buffers every time for the same seed
+//
+static uint32_t Random(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+
+static double Now(void)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//
+// How many GB/s <crc> manages over <buffer>; runs it for about half a second
+//
+static double Benchmark(int (* crc)(unsigned char *, unsigned int), std::vector<uint8_t> & buffer)
+{
+	uint32_t passes = 0;
+	volatile int result = 0;
+	double start = Now(), elapsed;
+
+	do
+	{
+		result ^= crc(buffer.data(), buffer.size());
+		passes++;
+		elapsed = Now() - start;
+	}
+	while (elapsed < 0.5);
+
+	return ((double)buffer.size() * passes) / (elapsed * 1e9);
+}
+
+
+int main(int argc, char * argv[])
+{
+	uint32_t count = 20000, maxLength = 70000, benchMB = 16;
+	bool bench = true;
+
+	for(int i=1; i<argc; i++)
+	{
+		if ((strcmp(argv[i], "--count") == 0) && (i + 1 < argc))
+			count = strtoul(argv[++i], NULL, 0);
+		else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc))
+			seed = strtoul(argv[++i], NULL, 0) | 1;
+		else if ((strcmp(argv[i], "--bench-mb") == 0) && (i + 1 < argc))
+			benchMB = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--no-bench") == 0)
+			bench = false;
+		else
+		{
+			fprintf(stderr, "Usage: crc32check [options]\n\n"
+				"  --count <n>       Number of random buffers to check (default: 20000)\n"
+				"  --seed <n>        Seed for the random buffers (default: 1)\n"
+				"  --bench-mb <n>    Size of the benchmark buffer in MB (default: 16)\n"
+				"  --no-bench        Only check, don't time anything\n");
+			return 1;
+		}
+	}
+
+	// The standard check value first, so a broken table shows up as such
+	unsigned char check[] = "123456789";
+	uint32_t mismatches = 0;
+
+	if ((uint32_t)crc32_calcCheckSum(check, 9) != 0xCBF43926)
+	{
+		printf("\"123456789\" gives %08X, should be CBF43926\n", (uint32_t)crc32_calcCheckSum(check, 9));
+		mismatches++;
+	}
+
+	// Room for the longest buffer at the worst alignment
+	std::vector<uint8_t> buffer(maxLength + 16);
+
+	for(uint32_t i=0; i<count; i++)
+	{
+		uint32_t length = Random() % (maxLength + 1), offset = Random() & 0x0F;
+
+		for(uint32_t j=0; j<length; j++)
+			buffer[offset + j] = (uint8_t)Random();
+
+		uint32_t fast = crc32_calcCheckSum(&buffer[offset], length);
+		uint32_t reference = crc32_calcCheckSumReference(&buffer[offset], length);
+
+		if (fast != reference)
+		{
+			if (mismatches < 10)
+				printf("%u bytes at offset %u: %08X, should be %08X\n", length, offset, fast, reference);
+
+			mismatches++;
+		}
+	}
+
+	printf("%u buffers checked, %u mismatches\n", count, mismatches);
+
+	if (bench)
+	{
+		std::vector<uint8_t> big(benchMB * 1024 * 1024);
+
+		for(size_t i=0; i<big.size(); i++)
+			big[i] = (uint8_t)Random();
+
+		double fast = Benchmark(crc32_calcCheckSum, big);
+		double reference = Benchmark(crc32_calcCheckSumReference, big);
+		printf("%u MB buffer: %.2f GB/s (reference: %.2f GB/s, %.1fx)\n", benchMB, fast, reference, fast / reference);
+	}
+
+	return (mismatches ? 1 : 0);
+}
@@ -0,0 +1,89 @@
+//
+// jagdsptrace.cpp - Check the DSP against traces recorded from real sessions
+//
+// Usage: jagdsptrace [options] <trace>...
+//
+// Traces come from DSPTraceStart() (jagfarm's "dsptrace" option, say). Each
+// one is replayed with nothing of the Jaguar around the DSP: it gets what it
+// read when the trace was recorded, and has to write the same things back
+// out. By default, every instruction is also run through the pipelined core
+// in lockstep, and checked against the interpreter (see DSP.CPP).
+//
+// The details of anything that didn't match go in the log; the exit status
+// is 0 if everything matched, 1 if not, and 2 if a trace couldn't be read.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dac.h"
+#include "dsp.h"
+#include "jaguar.h"
+#include "log.h"
+#include "settings.h"
+
+
+int main(int argc, char * argv[])
+{
+	const char * logName = "/dev/stderr";
+	uint32_t engine = DSP_ENGINE_LOCKSTEP;
+	int first = 1;
+
+	for(; first<argc && argv[first][0]=='-'; first++)
+	{
+		if (strcmp(argv[first], "--interpreter") == 0)
+			engine = DSP_ENGINE_INTERPRETER;
+		else if ((strcmp(argv[first], "--log") == 0) && (first + 1 < argc))
+			logName = argv[++first];
+		else
+		{
+			first = argc;
+			break;
+		}
+	}
+
+	if (first >= argc)
+	{
+		fprintf(stderr, "Usage: jagdsptrace [options] <trace>...\n\n"
+			"  --interpreter     Only check the interpreter against the traces (default:\n"
+			"                    the pipelined core too, in lockstep)\n"
+			"  --log <file>      Where the details go (default: stderr)\n");
+		return 2;
+	}
+
+	if (!LogInit(logName))
+	{
+		fprintf(stderr, "Could not open \"%s\"!\n", logName);
+		return 2;
+	}
+
+	memset(&vjs, 0, sizeof(vjs));
+	vjs.hardwareTypeNTSC = true;
+	vjs.DSPEnabled = true;
+	vjs.dspEngine = engine;
+	// The traces drive the DSP, not host audio
+	DACRunByCaller();
+	JaguarInit();
+
+	int status = 0;
+
+	for(int i=first; i<argc; i++)
+	{
+		DSPReplayStats stats;
+		bool ok = DSPTraceReplay(argv[i], stats);
+
+		printf("%s: %llu slices, %llu instructions, %llu mismatches, %llu lockstep failures%s\n",
+			argv[i], (unsigned long long)stats.slices, (unsigned long long)stats.instructions,
+			(unsigned long long)stats.mismatches, (unsigned long long)stats.divergences,
+			(ok ? "" : " (damaged)"));
+
+		if (!ok)
+			status = 2;
+		else if ((stats.mismatches || stats.divergences) && (status == 0))
+			status = 1;
+	}
+
+	LogDone();
+
+	return status;
+}
@@ -0,0 +1,1025 @@
+//
+// jagfarm.cpp - Run a batch of ROMs headless and report on how they did
+//
+// The manifest is one job per line:
+//
+//   <ROM path> <frames> [options...]
+//
+// where the options are any of:
+//
+//   ntsc, pal          Video standard (default: ntsc)
+//   bios, nobios       Boot through the Jaguar BIOS or not (default: bios)
+//   kseries            Use the K series BIOS instead of the M series one
+//   nogpu, nodsp       Turn off the GPU/DSP
+//   noidle             Don't skip idle loops
+//   dsp=<engine>       DSP engine: interpreter, pipelined or lockstep (default:
+//                      interpreter); lockstep failures go in the report
+//   dsptrace           Record a DSP trace (dsp.trc) for jagdsptrace
+//   input=<file>       Input script (see below)
+//   record             Record an input movie (movie.vjm) of the job
+//   movie=<file>       Play an input movie back; the settings it was recorded
+//                      with override the ones above
+//   timeout=<secs>     Override the default timeout for this job
+//   name=<name>        What to call it in the report (default: the ROM's name)
+//
+// Blank lines and lines starting with '#' are ignored.
+//
+// An input script sets the state of the joypads from a given frame on, one
+// line per change:
+//
+//   <frame> [buttons...]
+//
+// Buttons are U, D, L, R, A, B, C, OPTION, PAUSE, 0-9, * and #; prefix them
+// with "2:" for the second joypad. Anything not listed is released, so a line
+// with just a frame number lets go of everything.
+//
+// Jobs are spread over a pool of worker threads, each with its own queue; a
+// worker that runs out steals from the back of someone else's. By default,
+// every job is run in a child process so that one that crashes or hangs can
+// be killed without taking the rest down. With --in-process, jobs run on the
+// worker threads themselves, using one machine per thread (this needs the
+// core to be built with JAGUAR_MULTI_MACHINE): it's quicker to start each
+// job, but a crash takes everything down and a timeout can only be noticed
+// between frames.
+//
+// Each job gets its own directory under the output directory, for its final
+// screenshot (PNG) and EEPROM. The report is JSON, unless its name ends in
+// ".csv".
+//
+// With --boot-cache, jobs that boot through the BIOS start from a snapshot of
+// where it hands over to the software, if there is one for that software &
+// those settings (the first job to get there leaves one; see JAGUAR.CPP). The
+// frames skipped count as run, but have no hashes; input for them is applied
+// on the first frame that is run.
+//
+// N.B.: This uses fork() & friends, so it's *nix only.
+//
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "SDL.h"
+#include "dac.h"
+#include "dsp.h"
+#include "file.h"
+#include "gpu.h"
+#include "jagbios.h"
+#include "jagbios2.h"
+#include "jaguar.h"
+#include "joystick.h"
+#include "log.h"
+#include "m68000/m68kinterface.h"
+#include "settings.h"
+#include "tom.h"
+
+#define SCREEN_PITCH		1024
+#define SCREEN_HEIGHT		512
+
+enum { JS_OK, JS_TIMEOUT, JS_CRASH, JS_ERROR };
+
+static const char * statusName[4] = { "ok", "timeout", "crash", "error" };
+
+struct InputEvent
+{
+	uint32_t frame;
+	uint8_t buttons[2][21];
+};
+
+struct Job
+{
+	std::string rom;
+	std::string name;
+	std::string inputFile;
+	std::string movieFile;
+	uint32_t frames;
+	bool ntsc;
+	bool bios;
+	bool kSeries;
+	bool gpu;
+	bool dsp;
+	bool idleSkip;
+	uint32_t dspEngine;				// DSP_ENGINE_*
+	bool dspTrace;
+	bool recordMovie;
+	uint32_t timeout;				// In seconds
+	std::vector<InputEvent> input;
+};
+
+// What a job sends back. It's plain data, so it can come through a pipe.
+struct JobInfo
+{
+	int32_t status;
+	int32_t signal;					// What killed it, if it crashed
+	uint32_t framesRun;
+	uint32_t width, height;			// Size of the last frame
+	uint32_t finalHash;
+	double seconds;
+	uint64_t idle68K, idleGPU, idleDSP;
+	uint64_t dspDivergences;		// Lockstep check failures
+	uint32_t bootFramesSkipped;		// By the boot cache
+	uint32_t numHashes;
+	char message[128];
+};
+
+struct JobResult
+{
+	JobInfo info;
+	std::vector<uint32_t> hashes;
+	std::string directory;
+	bool haveScreenshot;
+};
+
+struct WorkQueue
+{
+	SDL_mutex * lock;
+	std::deque<uint32_t> jobs;
+};
+
+// Local variables
+
+static std::vector<Job> jobs;
+static std::vector<JobResult> results;
+static std::vector<WorkQueue> queues;
+static SDL_mutex * outputLock;
+static SDL_mutex * setupLock;		// Machine setup/teardown touches the CD layer, which is shared
+static uint32_t jobsDone = 0;
+static uint32_t hashEvery = 60;
+static bool inProcess = false;
+static std::string outputDir = "farm";
+static std::string bootCacheDir;
+
+// Private function prototypes
+
+static bool ParseManifest(const char * filename, uint32_t frames, uint32_t timeout);
+static bool ParseInputScript(Job & job);
+static int ButtonFromName(const char * name);
+static int DSPEngineFromName(const char * name);
+static bool NextJob(uint32_t worker, uint32_t & job);
+static int WorkerThread(void * data);
+static void RunJobForked(uint32_t n);
+static void RunJob(uint32_t n, JobInfo & info, std::vector<uint32_t> & hashes);
+static double Now(void);
+static bool WritePNG(const char * filename, const uint32_t * screen, uint32_t width, uint32_t height);
+static void WriteChunk(FILE * fp, const char * type, const uint8_t * data, uint32_t length);
+static bool WriteReport(const char * filename);
+static std::string JSONString(const std::string & s);
+
+
+int main(int argc, char * argv[])
+{
+	uint32_t workers = sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t frames = 0, timeout = 300;
+	const char * reportName = NULL, * manifest = NULL, * logName = NULL;
+
+	for(int i=1; i<argc; i++)
+	{
+		if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+			workers = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+			outputDir = argv[++i];
+		else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc))
+			reportName = argv[++i];
+		else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc))
+			frames = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+			timeout = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "--hash-every") == 0) && (i + 1 < argc))
+			hashEvery = atoi(argv[++i]);
+		else if ((strcmp(argv[i], "--log") == 0) && (i + 1 < argc))
+			logName = argv[++i];
+		else if (strcmp(argv[i], "--in-process") == 0)
+			inProcess = true;
+		else if ((strcmp(argv[i], "--boot-cache") == 0) && (i + 1 < argc))
+			bootCacheDir = argv[++i];
+		else if ((argv[i][0] != '-') && (manifest == NULL))
+			manifest = argv[i];
+		else
+		{
+			manifest = NULL;
+			break;
+		}
+	}
+
+	if (manifest == NULL)
+	{
+		fprintf(stderr, "Usage: jagfarm [options] <manifest>\n\n"
+			"  -j <n>            Number of workers (default: one per core)\n"
+			"  -o <dir>          Where to put screenshots & EEPROMs (default: farm)\n"
+			"  -r <file>         Report file, .json or .csv (default: <dir>/report.json)\n"
+			"  -f <frames>       Frames to run, for jobs that don't say\n"
+			"  -t <secs>         Timeout per job (default: 300)\n"
+			"  --hash-every <n>  Frames between hashes in the report (default: 60)\n"
+			"  --log <file>      Write the emulator log here\n"
+			"  --in-process      Run jobs on the worker threads, not in child processes\n"
+			"  --boot-cache <dir>  Keep snapshots of finished BIOS boots here, & skip the\n"
+			"                    boot with them\n");
+		return 2;
+	}
+
+#ifndef JAGUAR_MULTI_MACHINE
+	if (inProcess && (workers > 1))
+	{
+		fprintf(stderr, "Not built with JAGUAR_MULTI_MACHINE; running one job at a time.\n");
+		workers = 1;
+	}
+#endif
+
+	if (hashEvery == 0)
+		hashEvery = 1;
+
+	if (!ParseManifest(manifest, frames, timeout))
+		return 2;
+
+	if (jobs.empty())
+	{
+		fprintf(stderr, "Nothing to do!\n");
+		return 2;
+	}
+
+	if ((mkdir(outputDir.c_str(), 0755) != 0) && (errno != EEXIST))
+	{
+		fprintf(stderr, "Could not create \"%s\"!\n", outputDir.c_str());
+		return 2;
+	}
+
+	if (!bootCacheDir.empty() && (mkdir(bootCacheDir.c_str(), 0755) != 0) && (errno != EEXIST))
+	{
+		fprintf(stderr, "Could not create \"%s\"!\n", bootCacheDir.c_str());
+		return 2;
+	}
+
+	if (logName != NULL)
+		LogInit(logName);
+
+	if (workers < 1)
+		workers = 1;
+
+	if (workers > jobs.size())
+		workers = jobs.size();
+
+	// Deal the jobs out round robin; stealing evens things out from there
+	results.resize(jobs.size());
+	queues.resize(workers);
+
+	for(uint32_t i=0; i<workers; i++)
+		queues[i].lock = SDL_CreateMutex();
+
+	for(uint32_t i=0; i<jobs.size(); i++)
+		queues[i % workers].jobs.push_back(i);
+
+	outputLock = SDL_CreateMutex();
+	setupLock = SDL_CreateMutex();
+	// A job that dies mid-write shouldn't take us with it
+	signal(SIGPIPE, SIG_IGN);
+
+	double start = Now();
+	std::vector<SDL_Thread *> threads(workers);
+
+	for(uint32_t i=0; i<workers; i++)
+	{
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		threads[i] = SDL_CreateThread(WorkerThread, "Farm worker", (void *)(uintptr_t)i);
+#else
+		threads[i] = SDL_CreateThread(WorkerThread, (void *)(uintptr_t)i);
+#endif
+	}
+
+	for(uint32_t i=0; i<workers; i++)
+		SDL_WaitThread(threads[i], NULL);
+
+	double elapsed = Now() - start;
+	uint32_t count[4] = { 0, 0, 0, 0 };
+
+	for(uint32_t i=0; i<results.size(); i++)
+		count[results[i].info.status]++;
+
+	std::string report = (reportName ? reportName : outputDir + "/report.json");
+
+	if (!WriteReport(report.c_str()))
+		fprintf(stderr, "Could not write report to \"%s\"!\n", report.c_str());
+
+	printf("%u jobs in %.1f s: %u ok, %u timed out, %u crashed, %u errors. Report is in \"%s\".\n",
+		(unsigned)jobs.size(), elapsed, count[JS_OK], count[JS_TIMEOUT], count[JS_CRASH],
+		count[JS_ERROR], report.c_str());
+
+	if (logName != NULL)
+		LogDone();
+
+	return (count[JS_OK] == jobs.size() ? 0 : 1);
+}
+
+
+static bool ParseManifest(const char * filename, uint32_t frames, uint32_t timeout)
+{
+	FILE * fp = fopen(filename, "r");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Could not open \"%s\"!\n", filename);
+		return false;
+	}
+
+	char text[2048];
+	int line = 0;
+
+	while (fgets(text, sizeof(text), fp) != NULL)
+	{
+		line++;
+		text[strcspn(text, "\r\n")] = 0;
+		char * tok = strtok(text, " \t");
+
+		if ((tok == NULL) || (tok[0] == '#'))
+			continue;
+
+		Job job;
+		job.rom = tok;
+		job.frames = frames;
+		job.ntsc = job.bios = job.gpu = job.dsp = job.idleSkip = true;
+		job.kSeries = job.dspTrace = job.recordMovie = false;
+		job.dspEngine = DSP_ENGINE_INTERPRETER;
+		job.timeout = timeout;
+
+		// Name it after the ROM, sans path & extension
+		const char * base = strrchr(tok, '/');
+		job.name = (base ? base + 1 : tok);
+		job.name = job.name.substr(0, job.name.find_last_of('.'));
+
+		tok = strtok(NULL, " \t");
+
+		if ((tok != NULL) && isdigit(tok[0]))
+		{
+			job.frames = atoi(tok);
+			tok = strtok(NULL, " \t");
+		}
+
+		for(; tok!=NULL; tok=strtok(NULL, " \t"))
+		{
+			if (strcmp(tok, "ntsc") == 0)
+				job.ntsc = true;
+			else if (strcmp(tok, "pal") == 0)
+				job.ntsc = false;
+			else if (strcmp(tok, "bios") == 0)
+				job.bios = true;
+			else if (strcmp(tok, "nobios") == 0)
+				job.bios = false;
+			else if (strcmp(tok, "kseries") == 0)
+				job.kSeries = true;
+			else if (strcmp(tok, "nogpu") == 0)
+				job.gpu = false;
+			else if (strcmp(tok, "nodsp") == 0)
+				job.dsp = false;
+			else if (strcmp(tok, "noidle") == 0)
+				job.idleSkip = false;
+			else if (strcmp(tok, "dsptrace") == 0)
+				job.dspTrace = true;
+			else if ((strncmp(tok, "dsp=", 4) == 0) && (DSPEngineFromName(tok + 4) >= 0))
+				job.dspEngine = DSPEngineFromName(tok + 4);
+			else if (strncmp(tok, "input=", 6) == 0)
+				job.inputFile = tok + 6;
+			else if (strcmp(tok, "record") == 0)
+				job.recordMovie = true;
+			else if (strncmp(tok, "movie=", 6) == 0)
+				job.movieFile = tok + 6;
+			else if (strncmp(tok, "timeout=", 8) == 0)
+				job.timeout = atoi(tok + 8);
+			else if (strncmp(tok, "name=", 5) == 0)
+				job.name = tok + 5;
+			else
+			{
+				fprintf(stderr, "%s, line %i: Unknown option \"%s\".\n", filename, line, tok);
+				fclose(fp);
+				return false;
+			}
+		}
+
+		if (job.frames == 0)
+		{
+			fprintf(stderr, "%s, line %i: No frame count (and no -f).\n", filename, line);
+			fclose(fp);
+			return false;
+		}
+
+		if (!job.inputFile.empty() && !ParseInputScript(job))
+		{
+			fclose(fp);
+			return false;
+		}
+
+		if (!job.movieFile.empty())
+		{
+			JoystickMovieInfo info;
+
+			if (!JoystickMovieReadInfo(job.movieFile.c_str(), info))
+			{
+				fprintf(stderr, "%s, line %i: Could not read movie \"%s\".\n", filename, line, job.movieFile.c_str());
+				fclose(fp);
+				return false;
+			}
+
+			job.ntsc = info.ntsc;
+			job.bios = info.bios;
+			job.kSeries = (info.biosType == BT_K_SERIES);
+			job.gpu = info.gpu;
+			job.dsp = info.dsp;
+			job.idleSkip = info.idleSkip;
+			job.dspEngine = (info.dspEngine <= DSP_ENGINE_LOCKSTEP ? info.dspEngine : DSP_ENGINE_INTERPRETER);
+		}
+
+		jobs.push_back(job);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+
+static bool ParseInputScript(Job & job)
+{
+	FILE * fp = fopen(job.inputFile.c_str(), "r");
+
+	if (fp == NULL)
+	{
+		fprintf(stderr, "Could not open input script \"%s\"!\n", job.inputFile.c_str());
+		return false;
+	}
+
+	char text[1024];
+	int line = 0;
+
+	while (fgets(text, sizeof(text), fp) != NULL)
+	{
+		line++;
+		text[strcspn(text, "\r\n")] = 0;
+		char * tok = strtok(text, " \t");
+
+		if ((tok == NULL) || (tok[0] == '#'))
+			continue;
+
+		InputEvent event;
+		memset(&event, 0, sizeof(event));
+		event.frame = atoi(tok);
+
+		if (!job.input.empty() && (event.frame < job.input.back().frame))
+		{
+			fprintf(stderr, "%s, line %i: Frames have to be in order.\n", job.inputFile.c_str(), line);
+			fclose(fp);
+			return false;
+		}
+
+		for(tok=strtok(NULL, " \t"); tok!=NULL; tok=strtok(NULL, " \t"))
+		{
+			int pad = 0;
+
+			if (strncmp(tok, "2:", 2) == 0)
+				pad = 1, tok += 2;
+			else if (strncmp(tok, "1:", 2) == 0)
+				tok += 2;
+
+			int button = ButtonFromName(tok);
+
+			if (button < 0)
+			{
+				fprintf(stderr, "%s, line %i: Unknown button \"%s\".\n", job.inputFile.c_str(), line, tok);
+				fclose(fp);
+				return false;
+			}
+
+			event.buttons[pad][button] = 0x01;
+		}
+
+		job.input.push_back(event);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+
+static int ButtonFromName(const char * name)
+{
+	static const struct { const char * name; int button; } buttonNames[] = {
+		{ "U", BUTTON_U }, { "D", BUTTON_D }, { "L", BUTTON_L }, { "R", BUTTON_R },
+		{ "A", BUTTON_A }, { "B", BUTTON_B }, { "C", BUTTON_C },
+		{ "OPTION", BUTTON_OPTION }, { "PAUSE", BUTTON_PAUSE },
+		{ "0", BUTTON_0 }, { "1", BUTTON_1 }, { "2", BUTTON_2 }, { "3", BUTTON_3 },
+		{ "4", BUTTON_4 }, { "5", BUTTON_5 }, { "6", BUTTON_6 }, { "7", BUTTON_7 },
+		{ "8", BUTTON_8 }, { "9", BUTTON_9 }, { "*", BUTTON_s }, { "#", BUTTON_d },
+		{ NULL, -1 }
+	};
+
+	for(int i=0; buttonNames[i].name!=NULL; i++)
+	{
+		if (strcasecmp(name, buttonNames[i].name) == 0)
+			return buttonNames[i].button;
+	}
+
+	return -1;
+}
+
+
+static int DSPEngineFromName(const char * name)
+{
+	for(int i=DSP_ENGINE_INTERPRETER; i<=DSP_ENGINE_LOCKSTEP; i++)
+	{
+		if (strcasecmp(name, dspEngineName[i]) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+
+//
+// Take the next job off of our own queue, or steal one from the back of
+// someone else's if that's empty. Nothing gets added once we start, so if
+// everyone's queue is empty, we're done.
+//
+static bool NextJob(uint32_t worker, uint32_t & job)
+{
+	for(uint32_t i=0; i<queues.size(); i++)
+	{
+		WorkQueue & q = queues[(worker + i) % queues.size()];
+		SDL_LockMutex(q.lock);
+
+		if (!q.jobs.empty())
+		{
+			if (i == 0)
+			{
+				job = q.jobs.front();
+				q.jobs.pop_front();
+			}
+			else
+			{
+				job = q.jobs.back();
+				q.jobs.pop_back();
+			}
+
+			SDL_UnlockMutex(q.lock);
+			return true;
+		}
+
+		SDL_UnlockMutex(q.lock);
+	}
+
+	return false;
+}
+
+
+static int WorkerThread(void * data)
+{
+	uint32_t worker = (uint32_t)(uintptr_t)data;
+	uint32_t n;
+
+	while (NextJob(worker, n))
+	{
+		JobResult & r = results[n];
+		char dir[32];
+		sprintf(dir, "/%03u-", n);
+		r.directory = outputDir + dir + jobs[n].name;
+		mkdir(r.directory.c_str(), 0755);
+
+		if (inProcess)
+			RunJob(n, r.info, r.hashes);
+		else
+			RunJobForked(n);
+
+		r.haveScreenshot = (access((r.directory + "/screenshot.png").c_str(), F_OK) == 0);
+
+		SDL_LockMutex(outputLock);
+		jobsDone++;
+		printf("[%*u/%u] %-7s %7.1f s %7.1f fps  %08X  %s%s%s\n", (int)(jobs.size() > 99 ? 3 : 2),
+			jobsDone, (unsigned)jobs.size(), statusName[r.info.status], r.info.seconds,
+			(r.info.seconds > 0 ? (r.info.framesRun - r.info.bootFramesSkipped) / r.info.seconds : 0), r.info.finalHash,
+			jobs[n].name.c_str(), (r.info.message[0] ? ": " : ""), r.info.message);
+		fflush(stdout);
+		SDL_UnlockMutex(outputLock);
+	}
+
+	return 0;
+}
+
+
+//
+// Run the job in a child process, and watch it from here: if it doesn't send
+// back its results in time, it gets killed.
+//
+static void RunJobForked(uint32_t n)
+{
+	JobResult & r = results[n];
+	memset(&r.info, 0, sizeof(r.info));
+	int fd[2];
+
+	if (pipe(fd) != 0)
+	{
+		r.info.status = JS_ERROR;
+		strcpy(r.info.message, "Could not create pipe");
+		return;
+	}
+
+	double start = Now();
+	pid_t pid = fork();
+
+	if (pid < 0)
+	{
+		close(fd[0]);
+		close(fd[1]);
+		r.info.status = JS_ERROR;
+		strcpy(r.info.message, "Could not fork");
+		return;
+	}
+
+	if (pid == 0)
+	{
+		close(fd[0]);
+		JobInfo info;
+		std::vector<uint32_t> hashes;
+		RunJob(n, info, hashes);
+
+		if ((write(fd[1], &info, sizeof(info)) != sizeof(info))
+			|| (!hashes.empty() && (write(fd[1], &hashes[0], hashes.size() * 4) != (ssize_t)(hashes.size() * 4))))
+			_exit(1);
+
+		_exit(0);
+	}
+
+	close(fd[1]);
+	fcntl(fd[0], F_SETFL, O_NONBLOCK);
+	std::vector<uint8_t> data;
+	double deadline = start + jobs[n].timeout;
+	bool timedOut = false, exited = false;
+	int status = 0;
+
+	// N.B.: Children forked by the other workers can hold on to our pipe's
+	//       write end too, so EOF doesn't mean much; we watch the child itself.
+	while (!exited)
+	{
+		int msLeft = (int)((deadline - Now()) * 1000.0);
+
+		if (msLeft <= 0)
+		{
+			timedOut = true;
+			break;
+		}
+
+		struct pollfd p = { fd[0], POLLIN, 0 };
+		poll(&p, 1, (msLeft < 100 ? msLeft : 100));
+		exited = (waitpid(pid, &status, WNOHANG) == pid);
+
+		uint8_t buffer[4096];
+		ssize_t length;
+
+		while ((length = read(fd[0], buffer, sizeof(buffer))) > 0)
+			data.insert(data.end(), buffer, buffer + length);
+	}
+
+	close(fd[0]);
+
+	if (timedOut)
+	{
+		kill(pid, SIGKILL);
+		waitpid(pid, &status, 0);
+	}
+
+	if (timedOut)
+	{
+		r.info.status = JS_TIMEOUT;
+		r.info.seconds = Now() - start;
+		sprintf(r.info.message, "Killed after %u s", jobs[n].timeout);
+	}
+	else if (WIFSIGNALED(status) || (data.size() < sizeof(JobInfo)))
+	{
+		r.info.status = JS_CRASH;
+		r.info.seconds = Now() - start;
+		r.info.signal = (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+
+		if (r.info.signal)
+			sprintf(r.info.message, "Died with signal %i (%s)", r.info.signal, strsignal(r.info.signal));
+		else
+			sprintf(r.info.message, "Exited without reporting back (status %i)", WEXITSTATUS(status));
+	}
+	else
+	{
+		memcpy(&r.info, &data[0], sizeof(JobInfo));
+		uint32_t numHashes = (data.size() - sizeof(JobInfo)) / 4;
+
+		if (numHashes > r.info.numHashes)
+			numHashes = r.info.numHashes;
+
+		r.hashes.resize(numHashes);
+
+		if (numHashes)
+			memcpy(&r.hashes[0], &data[sizeof(JobInfo)], numHashes * 4);
+	}
+}
+
+
+//
+// Set up a Jaguar just for this job, run it & tear it down again. This is
+// either in a child process, or on a worker thread with its own machine.
+//
+static void RunJob(uint32_t n, JobInfo & info, std::vector<uint32_t> & hashes)
+{
+	const Job & job = jobs[n];
+	const JobResult & r = results[n];
+	std::vector<uint32_t> screen(SCREEN_PITCH * SCREEN_HEIGHT, 0);
+	memset(&info, 0, sizeof(info));
+
+	memset(&vjs, 0, sizeof(vjs));
+	vjs.hardwareTypeNTSC = job.ntsc;
+	vjs.useJaguarBIOS = job.bios;
+	vjs.biosType = (job.kSeries ? BT_K_SERIES : BT_M_SERIES);
+	vjs.GPUEnabled = job.gpu;
+	vjs.DSPEnabled = job.dsp;
+	vjs.idleSkip = job.idleSkip;
+	vjs.dspEngine = job.dspEngine;
+	vjs.audioSync = false;
+	snprintf(vjs.EEPROMPath, MAX_PATH, "%s/", r.directory.c_str());
+
+	if (!bootCacheDir.empty())
+		snprintf(vjs.bootCachePath, MAX_PATH, "%s/", bootCacheDir.c_str());
+
+	// We run the DSP ourselves, as fast as it'll go
+	DACRunByCaller();
+
+	SDL_LockMutex(setupLock);
+	JaguarSetScreenPitch(SCREEN_PITCH);
+	JaguarSetScreenBuffer(&screen[0]);
+	JaguarInit();
+	memcpy(jagMemSpace + 0xE00000, (job.kSeries ? jaguarBootROM : jaguarBootROM2), 0x20000);
+	JaguarReset();
+	bool loaded = JaguarLoadFile((char *)job.rom.c_str());
+	SDL_UnlockMutex(setupLock);
+
+	if (!loaded)
+	{
+		info.status = JS_ERROR;
+		snprintf(info.message, sizeof(info.message), "Could not load \"%s\"", job.rom.c_str());
+	}
+	else
+	{
+		SET32(jaguarMainRAM, 0, 0x00200000);	// Set top of stack...
+
+		if (!job.bios)
+			SET32(jaguarMainRAM, 4, jaguarRunAddress);
+
+		m68k_pulse_reset();
+
+		if (job.dspTrace)
+			DSPTraceStart((r.directory + "/dsp.trc").c_str());
+
+		if (job.recordMovie)
+			JoystickMovieRecord((r.directory + "/movie.vjm").c_str());
+		else if (!job.movieFile.empty())
+			JoystickMoviePlay(job.movieFile.c_str());
+
+		int16_t audio[2 * DAC_AUDIO_RATE / 50];
+		uint32_t audioFrames = DAC_AUDIO_RATE / (job.ntsc ? 60 : 50);
+		uint32_t nextInput = 0;
+		double start = Now();
+
+		// Starting from the boot cache, we're already past the boot; this
+		// has to be known before the first frame, so the input for the
+		// frames skipped goes in on the first one that's run (after the
+		// restore, which would wipe it out)
+		info.bootFramesSkipped = JaguarStartFromBootCache();
+
+		for(info.framesRun=info.bootFramesSkipped; info.framesRun<job.frames; info.framesRun++)
+		{
+			while ((nextInput < job.input.size()) && (job.input[nextInput].frame <= info.framesRun))
+			{
+				memcpy(joypad0Buttons, job.input[nextInput].buttons[0], 21);
+				memcpy(joypad1Buttons, job.input[nextInput].buttons[1], 21);
+				nextInput++;
+			}
+
+			JaguarExecuteNew();
+
+			if (job.dsp)
+				SDLSoundCallback(NULL, (uint8_t *)audio, audioFrames * 4);
+
+			// Hash what's actually on the screen (FNV-1a)
+			info.width = TOMGetVideoModeWidth();
+			info.height = TOMGetVideoModeHeight();
+			uint32_t hash = 2166136261u;
+
+			for(uint32_t y=0; y<info.height; y++)
+			{
+				const uint8_t * p = (const uint8_t *)&screen[y * SCREEN_PITCH];
+
+				for(uint32_t x=0; x<info.width*4; x++)
+					hash = (hash ^ p[x]) * 16777619u;
+			}
+
+			info.finalHash = hash;
+
+			if (((info.framesRun + 1) % hashEvery) == 0)
+				hashes.push_back(hash);
+
+			// A child process gets killed from outside; here, all we can do is
+			// stop between frames
+			if (inProcess && ((Now() - start) > job.timeout))
+			{
+				info.status = JS_TIMEOUT;
+				snprintf(info.message, sizeof(info.message), "Gave up after %u s", job.timeout);
+				info.framesRun++;
+				break;
+			}
+		}
+
+		info.seconds = Now() - start;
+		info.idle68K = m68k_get_idle_cycles();
+		info.idleGPU = GPUGetIdleCycles();
+		info.idleDSP = DSPGetIdleCycles();
+		info.dspDivergences = DSPGetDivergences();
+		DSPTraceStop();
+		JoystickMovieStop();
+		info.numHashes = hashes.size();
+
+		if ((info.width > 0) && (info.height > 0))
+			WritePNG((r.directory + "/screenshot.png").c_str(), &screen[0], info.width, info.height);
+	}
+
+	SDL_LockMutex(setupLock);
+	JaguarDone();
+	SDL_UnlockMutex(setupLock);
+}
+
+
+static double Now(void)
+{
+	struct timeval t;
+	gettimeofday(&t, NULL);
+
+	return t.tv_sec + (t.tv_usec / 1000000.0);
+}
+
+
+static bool WritePNG(const char * filename, const uint32_t * screen, uint32_t width, uint32_t height)
+{
+	// Filter type 0 (none) at the start of every row, then RGB
+	uint32_t rowLength = (width * 3) + 1;
+	std::vector<uint8_t> raw(rowLength * height);
+
+	for(uint32_t y=0; y<height; y++)
+	{
+		uint8_t * row = &raw[y * rowLength];
+		*row++ = 0;
+
+		for(uint32_t x=0; x<width; x++)
+		{
+			uint32_t pixel = screen[(y * SCREEN_PITCH) + x];
+			*row++ = pixel >> 24;
+			*row++ = (pixel >> 16) & 0xFF;
+			*row++ = (pixel >> 8) & 0xFF;
+		}
+	}
+
+	uLongf packedLength = compressBound(raw.size());
+	std::vector<uint8_t> packed(packedLength);
+
+	if (compress2(&packed[0], &packedLength, &raw[0], raw.size(), 6) != Z_OK)
+		return false;
+
+	FILE * fp = fopen(filename, "wb");
+
+	if (fp == NULL)
+		return false;
+
+	uint8_t header[13] = {
+		(uint8_t)(width >> 24), (uint8_t)(width >> 16), (uint8_t)(width >> 8), (uint8_t)width,
+		(uint8_t)(height >> 24), (uint8_t)(height >> 16), (uint8_t)(height >> 8), (uint8_t)height,
+		8, 2, 0, 0, 0		// 8 bits/channel, RGB, deflate, no filter, no interlace
+	};
+
+	fwrite("\x89PNG\r\n\x1A\n", 1, 8, fp);
+	WriteChunk(fp, "IHDR", header, 13);
+	WriteChunk(fp, "IDAT", &packed[0], packedLength);
+	WriteChunk(fp, "IEND", NULL, 0);
+	fclose(fp);
+
+	return true;
+}
+
+
+static void WriteChunk(FILE * fp, const char * type, const uint8_t * data, uint32_t length)
+{
+	uint8_t size[4] = { (uint8_t)(length >> 24), (uint8_t)(length >> 16), (uint8_t)(length >> 8), (uint8_t)length };
+	fwrite(size, 1, 4, fp);
+	fwrite(type, 1, 4, fp);
+
+	if (length)
+		fwrite(data, 1, length, fp);
+
+	// The CRC covers the type as well as the data
+	uLong crc = crc32(0, (const Bytef *)type, 4);
+
+	if (length)
+		crc = crc32(crc, data, length);
+
+	uint8_t crcBytes[4] = { (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+	fwrite(crcBytes, 1, 4, fp);
+}
+
+
+static bool WriteReport(const char * filename)
+{
+	FILE * fp = fopen(filename, "w");
+
+	if (fp == NULL)
+		return false;
+
+	size_t nameLength = strlen(filename);
+	bool csv = (nameLength > 4) && (strcasecmp(filename + nameLength - 4, ".csv") == 0);
+
+	if (csv)
+		fprintf(fp, "name,rom,status,message,frames,frames_run,boot_frames_skipped,seconds,fps,idle_68k,idle_gpu,idle_dsp,dsp_divergences,width,height,final_hash,screenshot\n");
+	else
+		fprintf(fp, "{\n\t\"hashEvery\": %u,\n\t\"jobs\": [\n", hashEvery);
+
+	for(uint32_t i=0; i<jobs.size(); i++)
+	{
+		const Job & job = jobs[i];
+		const JobResult & r = results[i];
+		const JobInfo & info = r.info;
+		double fps = (info.seconds > 0 ? (info.framesRun - info.bootFramesSkipped) / info.seconds : 0);
+		std::string screenshot = (r.haveScreenshot ? r.directory + "/screenshot.png" : "");
+
+		if (csv)
+		{
+			// Quote anything that might have a comma in it
+			fprintf(fp, "\"%s\",\"%s\",%s,\"%s\",%u,%u,%u,%.3f,%.2f,%llu,%llu,%llu,%llu,%u,%u,%08X,\"%s\"\n",
+				job.name.c_str(), job.rom.c_str(), statusName[info.status], info.message,
+				job.frames, info.framesRun, info.bootFramesSkipped, info.seconds, fps, (unsigned long long)info.idle68K,
+				(unsigned long long)info.idleGPU, (unsigned long long)info.idleDSP,
+				(unsigned long long)info.dspDivergences, info.width, info.height, info.finalHash,
+				screenshot.c_str());
+			continue;
+		}
+
+		fprintf(fp, "\t\t{\n\t\t\t\"name\": %s,\n\t\t\t\"rom\": %s,\n", JSONString(job.name).c_str(),
+			JSONString(job.rom).c_str());
+		fprintf(fp, "\t\t\t\"status\": \"%s\",\n\t\t\t\"message\": %s,\n\t\t\t\"signal\": %i,\n",
+			statusName[info.status], JSONString(info.message).c_str(), info.signal);
+		fprintf(fp, "\t\t\t\"settings\": { \"ntsc\": %s, \"bios\": %s, \"gpu\": %s, \"dsp\": %s, \"idleSkip\": %s, \"dspEngine\": \"%s\", \"dspTrace\": %s, \"input\": %s, \"movie\": %s, \"recordMovie\": %s },\n",
+			(job.ntsc ? "true" : "false"), (job.bios ? "true" : "false"), (job.gpu ? "true" : "false"),
+			(job.dsp ? "true" : "false"), (job.idleSkip ? "true" : "false"), dspEngineName[job.dspEngine],
+			(job.dspTrace ? "true" : "false"), JSONString(job.inputFile).c_str(),
+			JSONString(job.movieFile).c_str(), (job.recordMovie ? "true" : "false"));
+		fprintf(fp, "\t\t\t\"frames\": %u,\n\t\t\t\"framesRun\": %u,\n\t\t\t\"bootFramesSkipped\": %u,\n\t\t\t\"seconds\": %.3f,\n\t\t\t\"fps\": %.2f,\n",
+			job.frames, info.framesRun, info.bootFramesSkipped, info.seconds, fps);
+		fprintf(fp, "\t\t\t\"idleCycles\": { \"m68k\": %llu, \"gpu\": %llu, \"dsp\": %llu },\n",
+			(unsigned long long)info.idle68K, (unsigned long long)info.idleGPU, (unsigned long long)info.idleDSP);
+		fprintf(fp, "\t\t\t\"dspDivergences\": %llu,\n", (unsigned long long)info.dspDivergences);
+		fprintf(fp, "\t\t\t\"width\": %u,\n\t\t\t\"height\": %u,\n\t\t\t\"finalHash\": \"%08X\",\n\t\t\t\"hashes\": [",
+			info.width, info.height, info.finalHash);
+
+		for(uint32_t j=0; j<r.hashes.size(); j++)
+			fprintf(fp, "%s\"%08X\"", (j ? ", " : ""), r.hashes[j]);
+
+		fprintf(fp, "],\n\t\t\t\"screenshot\": %s\n\t\t}%s\n", JSONString(screenshot).c_str(),
+			(i + 1 < jobs.size() ? "," : ""));
+	}
+
+	if (!csv)
+		fprintf(fp, "\t]\n}\n");
+
+	fclose(fp);
+	return true;
+}
+
+
+static std::string JSONString(const std::string & s)
+{
+	std::string out = "\"";
+
+	for(size_t i=0; i<s.size(); i++)
+	{
+		char c = s[i];
+
+		if ((c == '"') || (c == '\\'))
+			out += '\\', out += c;
+		else if ((uint8_t)c < 0x20)
+		{
+			char buffer[8];
+			sprintf(buffer, "\\u%04X", (uint8_t)c);
+			out += buffer;
+		}
+		else
+			out += c;
+	}
+
+	return out + "\"";
+}
@@ -0,0 +1,255 @@
+//
+// makefiledb.cpp - Build an external file DB from a text description
+//
+// The text format is one entry per line:
+//
+//   <CRC32 in hex> <flags> <name>
+//
+// where <flags> is a list of flag names separated by '|' (ROM, ALPINE, BIOS,
+// REQ_DSP, REQ_BIOS, NON_WORKING, BAD_DUMP, VERIFIED, STARS_1 - STARS_5), or a
+// number. Blank lines and lines starting with '#' are ignored.
+//
+// Running it with -d dumps the built-in DB in this format, which is a handy
+// place to start from.
+//
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "filedb.h"
+
+struct FlagName
+{
+	const char * name;
+	uint32_t flag;
+};
+
+static const FlagName flagNames[] = {
+	{ "ROM", FF_ROM }, { "ALPINE", FF_ALPINE }, { "BIOS", FF_BIOS },
+	{ "REQ_DSP", FF_REQ_DSP }, { "REQ_BIOS", FF_REQ_BIOS },
+	{ "NON_WORKING", FF_NON_WORKING }, { "BAD_DUMP", FF_BAD_DUMP },
+	{ "VERIFIED", FF_VERIFIED }, { "STARS_2", FF_STARS_2 },
+	{ "STARS_3", FF_STARS_3 }, { "STARS_4", FF_STARS_4 },
+	{ "STARS_5", FF_STARS_5 }, { "STARS_1", FF_STARS_1 }, { NULL, 0 }
+};
+
+struct Entry
+{
+	uint32_t crc32;
+	uint32_t flags;
+	char name[FILEDB_NAME_LENGTH];
+
+	bool operator<(const Entry & e) const { return crc32 < e.crc32; }
+};
+
+
+static void PutLE32(FILE * fp, uint32_t n)
+{
+	fputc(n & 0xFF, fp);
+	fputc((n >> 8) & 0xFF, fp);
+	fputc((n >> 16) & 0xFF, fp);
+	fputc((n >> 24) & 0xFF, fp);
+}
+
+
+static void DumpBuiltIn(void)
+{
+	for(int i=0; romList[i].crc32!=0xFFFFFFFF; i++)
+	{
+		printf("%08X ", romList[i].crc32);
+		uint32_t flags = romList[i].flags;
+		bool first = true;
+
+		// The star ratings are a 3-bit field, not single bits
+		for(int j=0; flagNames[j].name!=NULL; j++)
+		{
+			uint32_t flag = flagNames[j].flag;
+			bool set = (flag >= FF_STARS_2 ? (flags & 0x700) == flag : (flags & flag) != 0);
+
+			if ((flag != 0) && set)
+			{
+				printf("%s%s", (first ? "" : "|"), flagNames[j].name);
+				first = false;
+			}
+		}
+
+		printf("%s %s\n", (first ? "0" : ""), romList[i].name);
+	}
+}
+
+
+static bool ParseFlags(const char * str, uint32_t & flags, int line)
+{
+	flags = 0;
+
+	if (isdigit(str[0]))
+	{
+		flags = strtoul(str, NULL, 0);
+		return true;
+	}
+
+	char buffer[256];
+	strncpy(buffer, str, 255);
+	buffer[255] = 0;
+
+	for(char * tok=strtok(buffer, "|"); tok!=NULL; tok=strtok(NULL, "|"))
+	{
+		// Allow the FF_ prefix too, so entries can be pasted from filedb.cpp
+		if (strncmp(tok, "FF_", 3) == 0)
+			tok += 3;
+
+		int j;
+
+		for(j=0; flagNames[j].name!=NULL; j++)
+		{
+			if (strcmp(tok, flagNames[j].name) == 0)
+			{
+				flags |= flagNames[j].flag;
+				break;
+			}
+		}
+
+		if (flagNames[j].name == NULL)
+		{
+			fprintf(stderr, "Line %i: Unknown flag \"%s\".\n", line, tok);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+int main(int argc, char * argv[])
+{
+	if ((argc == 2) && (strcmp(argv[1], "-d") == 0))
+	{
+		DumpBuiltIn();
+		return 0;
+	}
+
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: makefiledb <input.txt> <output.bin>\n"
+			"       makefiledb -d > <output.txt>\n");
+		return 1;
+	}
+
+	FILE * in = fopen(argv[1], "r");
+
+	if (in == NULL)
+	{
+		fprintf(stderr, "Could not open \"%s\"!\n", argv[1]);
+		return 1;
+	}
+
+	std::vector<Entry> entries;
+	char text[1024];
+	int line = 0;
+
+	while (fgets(text, sizeof(text), in) != NULL)
+	{
+		line++;
+		text[strcspn(text, "\r\n")] = 0;
+
+		if ((text[0] == 0) || (text[0] == '#'))
+			continue;
+
+		char crcStr[32], flagStr[256];
+		int nameStart = 0;
+
+		if (sscanf(text, "%31s %255s %n", crcStr, flagStr, &nameStart) < 2
+			|| (nameStart == 0) || (text[nameStart] == 0))
+		{
+			fprintf(stderr, "Line %i: Malformed entry.\n", line);
+			fclose(in);
+			return 1;
+		}
+
+		Entry e;
+		memset(&e, 0, sizeof(e));
+		e.crc32 = strtoul(crcStr, NULL, 16);
+
+		if (!ParseFlags(flagStr, e.flags, line))
+		{
+			fclose(in);
+			return 1;
+		}
+
+		if (strlen(text + nameStart) >= FILEDB_NAME_LENGTH)
+			fprintf(stderr, "Line %i: Name truncated to %i characters.\n", line, FILEDB_NAME_LENGTH - 1);
+
+		strncpy(e.name, text + nameStart, FILEDB_NAME_LENGTH - 1);
+		entries.push_back(e);
+	}
+
+	fclose(in);
+
+	// Sorted by CRC, so duplicates are easy to spot (first one wins)
+	std::stable_sort(entries.begin(), entries.end());
+
+	for(size_t i=1; i<entries.size(); i++)
+	{
+		if (entries[i].crc32 == entries[i - 1].crc32)
+			fprintf(stderr, "Warning: Duplicate CRC %08X (\"%s\" vs. \"%s\").\n", entries[i].crc32, entries[i - 1].name, entries[i].name);
+	}
+
+	// Keep the hash table at most half full
+	uint32_t slots = 16;
+
+	while (slots < entries.size() * 2)
+		slots <<= 1;
+
+	std::vector<uint32_t> hash(slots, 0);
+
+	for(size_t i=0; i<entries.size(); i++)
+	{
+		uint32_t slot = entries[i].crc32 & (slots - 1);
+		bool duplicate = false;
+
+		while (hash[slot] != 0)
+		{
+			if (entries[hash[slot] - 1].crc32 == entries[i].crc32)
+			{
+				duplicate = true;
+				break;
+			}
+
+			slot = (slot + 1) & (slots - 1);
+		}
+
+		if (!duplicate)
+			hash[slot] = i + 1;
+	}
+
+	FILE * out = fopen(argv[2], "wb");
+
+	if (out == NULL)
+	{
+		fprintf(stderr, "Could not open \"%s\" for writing!\n", argv[2]);
+		return 1;
+	}
+
+	PutLE32(out, FILEDB_MAGIC);
+	PutLE32(out, FILEDB_VERSION);
+	PutLE32(out, entries.size());
+	PutLE32(out, slots);
+
+	for(size_t i=0; i<entries.size(); i++)
+	{
+		PutLE32(out, entries[i].crc32);
+		PutLE32(out, entries[i].flags);
+		fwrite(entries[i].name, 1, FILEDB_NAME_LENGTH, out);
+	}
+
+	for(uint32_t i=0; i<slots; i++)
+		PutLE32(out, hash[i]);
+
+	fclose(out);
+	printf("Wrote %u entries (%u hash slots) to \"%s\".\n", (unsigned)entries.size(), slots, argv[2]);
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+//
+// resamplercheck.cpp - Check the resampler against the direct formula
+//
+// Usage: resamplercheck [options]
+//
+// Feeds a mix of tones & noise through the resampler the way the DAC does (a
+// host buffer at a time) at a spread of SCLK rates, plus the CD rate and a
+// few fast forward speeds. RESAMPLER.CPP is built with RESAMPLER_CHECK here,
+// so every output sample is also worked out straight from the windowed sinc
+// formula in double precision; the worst difference for each rate has to be
+// within the tolerance.
+//
+// The exit status is 0 if every rate was within it, and 1 if not.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dac.h"
+#include "resampler.h"
+
+#ifndef RESAMPLER_CHECK
+#error "resamplercheck needs RESAMPLER.CPP built with RESAMPLER_CHECK defined"
+#endif
+
+// NTSC RISC clock, as in DAC.CPP
+#define RISC_CLOCK_RATE		26590906.0
+// What the host asks for at the default 12 ms of latency
+#define HOST_BUFFER_FRAMES	576
+
+struct CheckCase
+{
+	double rate;
+	double speed;
+	const char * name;
+};
+
+static uint32_t seed = 1;
+
+
+static double Noise(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return ((double)(seed & 0xFFFF) / 32768.0) - 1.0;
+}
+
+
+static double SCLKRate(uint32_t sclk)
+{
+	return RISC_CLOCK_RATE / (32.0 * (2.0 * (sclk + 1)));
+}
+
+
+//
+// Run <seconds> worth of output through at <rate> & <speed>; returns the
+// worst error seen
+//
+static double Check(double rate, double speed, double seconds)
+{
+	static int16_t buffer[HOST_BUFFER_FRAMES * 2];
+	double time = 0, owed = 0;
+	uint32_t buffers = (uint32_t)((seconds * DAC_AUDIO_RATE) / HOST_BUFFER_FRAMES);
+
+	ResamplerInit(rate, DAC_AUDIO_RATE);
+	ResamplerSetSpeed(speed);
+	ResamplerGetWorstError();
+
+	for(uint32_t i=0; i<buffers; i++)
+	{
+		// What JERRY would have sent over I2S while this buffer played
+		owed += (HOST_BUFFER_FRAMES * rate * speed) / DAC_AUDIO_RATE;
+
+		for(; owed>=1.0; owed-=1.0)
+		{
+			// Something low, something near the output's Nyquist frequency
+			// (over it when downsampling) & a little noise, at about -3 dB
+			double left = (sin(2.0 * M_PI * 440.0 * time) * 0.35)
+				+ (sin(2.0 * M_PI * (rate * 0.45) * time) * 0.3) + (Noise() * 0.05);
+			double right = (sin(2.0 * M_PI * 1234.5 * time) * 0.35)
+				+ (sin(2.0 * M_PI * (rate * 0.3) * time) * 0.3) + (Noise() * 0.05);
+			ResamplerWrite((int16_t)(left * 32767.0), (int16_t)(right * 32767.0));
+			time += 1.0 / rate;
+		}
+
+		ResamplerRead(buffer, HOST_BUFFER_FRAMES);
+	}
+
+	return ResamplerGetWorstError();
+}
+
+
+int main(int argc, char * argv[])
+{
+	double tolerance = 1.0, seconds = 2.0;
+
+	for(int i=1; i<argc; i++)
+	{
+		if ((strcmp(argv[i], "--tolerance") == 0) && (i + 1 < argc))
+			tolerance = atof(argv[++i]);
+		else if ((strcmp(argv[i], "--seconds") == 0) && (i + 1 < argc))
+			seconds = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: resamplercheck [options]\n\n"
+				"  --tolerance <n>   Largest difference allowed, in 16-bit sample units\n"
+				"                    (default: 1.0, about -90 dB)\n"
+				"  --seconds <n>     Output to check at each rate (default: 2)\n");
+			return 1;
+		}
+	}
+
+	CheckCase cases[] = {
+		{ SCLKRate(3), 1.0, "SCLK 3" },
+		{ SCLKRate(7), 1.0, "SCLK 7" },
+		{ SCLKRate(8), 1.0, "SCLK 8 (default)" },
+		{ SCLKRate(12), 1.0, "SCLK 12" },
+		{ SCLKRate(19), 1.0, "SCLK 19" },
+		{ SCLKRate(40), 1.0, "SCLK 40" },
+		{ SCLKRate(100), 1.0, "SCLK 100" },
+		{ 44100.0, 1.0, "CD" },
+		{ SCLKRate(19), 2.0, "SCLK 19, 2x" },
+		{ SCLKRate(8), 3.7, "SCLK 8, 3.7x" },
+		{ 44100.0, 8.0, "CD, 8x" },
+	};
+
+	uint32_t failures = 0;
+
+	for(uint32_t i=0; i<sizeof(cases)/sizeof(cases[0]); i++)
+	{
+		double error = Check(cases[i].rate, cases[i].speed, seconds);
+		bool ok = (error <= tolerance);
+		printf("%-18s %8.1f Hz: worst error %.4f%s\n", cases[i].name,
+			cases[i].rate, error, (ok ? "" : " (too far off)"));
+
+		if (!ok)
+			failures++;
+	}
+
+	printf("%u of %u rates out of tolerance\n", failures,
+		(uint32_t)(sizeof(cases) / sizeof(cases[0])));
+
+	return (failures ? 1 : 0);
+}